@@ -0,0 +1,72 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_EXCEPTION_TEMPLATE_SYNTAX_EXCEPTION_HPP
+#define OWEBPP_COMMANDS_EXCEPTION_TEMPLATE_SYNTAX_EXCEPTION_HPP
+
+#include <exception>
+#include <string>
+
+namespace owebpp::console {
+    /** This exception is thrown when a template file can't be compiled.  */
+    class TemplateSyntaxException: public std::exception {
+        public:
+            /* Constructors */
+            /**
+             * Construct an exception for the given template and error.
+             * @param template_name The template that can't be compiled.
+             * @param line The line of the template where the error was found.
+             * @param error The description of the error.
+             */
+            TemplateSyntaxException(const std::string& template_name, size_t line, const std::string& error):
+                m_message("Template " + template_name + " line " + std::to_string(line) + ": " + error) {}
+
+            /* Deleted constructors */
+            TemplateSyntaxException() = delete;
+            TemplateSyntaxException(const TemplateSyntaxException& o) = delete;
+            TemplateSyntaxException(TemplateSyntaxException&& o) = delete;
+
+            /* Deleted assignment operators */
+            TemplateSyntaxException& operator=(const TemplateSyntaxException& o) = delete;
+            TemplateSyntaxException& operator=(TemplateSyntaxException&& o) = delete;
+
+            /* Destructor */
+            virtual ~TemplateSyntaxException() = default;
+
+            /* Functions */
+            /**
+             * Returns to error message of the given exception.
+             * @return The error message
+             */
+            const char* what() const noexcept {
+                return m_message.c_str();
+            }
+
+        private:
+            /* Members */
+            /** The error message. */
+            std::string m_message;
+    };
+}
+
+#endif // OWEBPP_COMMANDS_EXCEPTION_TEMPLATE_SYNTAX_EXCEPTION_HPP
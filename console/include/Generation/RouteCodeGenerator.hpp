@@ -83,8 +83,30 @@ namespace owebpp::console {
              */
             static std::shared_ptr<std::vector<std::shared_ptr<RouteModel>>> buildRoutesModel(YAML::Node& routes_node);
 
+            /**
+             * Read the optional fields of a route that tune how it is run: executor, max_concurrency, max_queue_depth, limiter and shed_status.
+             * @param route The yaml data of the route.
+             * @param route_model The model receiving the fields.
+             * @throw NullOrEmptyRouteFieldException If a field is present but empty.
+             * @throw std::invalid_argument If a field has an invalid value.
+             */
+            static void readExecutionFields(const YAML::Node& route, RouteModel& route_model);
+
+            /**
+             * Read a non negative integer field of a route.
+             * @param node The yaml data of the field.
+             * @param route_name The route name.
+             * @param field_name The field name.
+             * @return The value of the field.
+             * @throw NullOrEmptyRouteFieldException If the field is empty.
+             * @throw std::invalid_argument If the field isn't a non negative integer.
+             */
+            static size_t readCount(const YAML::Node& node, const std::string& route_name, const std::string& field_name);
+
             /**
              * Generates code and writes it to the given file based on the provided model.
+             * Whether a route function is a coroutine returning an owebpp::Task is detected when the generated code is compiled.
+             * The routes with "executor: pool" run on the owebpp::Executor when they are served asynchronously.
              * @param output_file The file to write the code to.
              * @param routes The model to use to write the generated code.
              */
@@ -0,0 +1,164 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_GENERATION_TEMPLATE_CODE_GENERATOR_HPP
+#define OWEBPP_COMMANDS_GENERATION_TEMPLATE_CODE_GENERATOR_HPP
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Model/TemplateNode.hpp"
+
+namespace owebpp::console {
+    /**
+     * This class compiles the template files of a directory into C++ functions writing directly into a response buffer.
+     * Templates support the following syntax:
+     * - {{ value }} writes a value with HTML escaping,
+     * - {{{ value }}} writes a value without escaping,
+     * - {% for item in values %} ... {% endfor %} writes its content for each element of a range,
+     * - {% if value %} ... {% else %} ... {% endif %} writes its content depending on a value, "if not value" is also accepted.
+     * Values are paths such as user.name, resolved against the loop variables or the context given to the generated function.
+     */
+    class TemplateCodeGenerator {
+        public:
+            /* Constructors */
+            /**
+             * Construct an object that can generate code from the template files of a directory.
+             * @param templates_directory The directory containing the template files.
+             * @param output_code_file The file to write the code to.
+             */
+            TemplateCodeGenerator(const std::string_view& templates_directory, const std::string& output_code_file):
+                m_templates_directory(templates_directory),
+                m_output_code_file(output_code_file) {}
+
+            /* Deleted constructors */
+            TemplateCodeGenerator() = delete;
+            TemplateCodeGenerator(const TemplateCodeGenerator& o) = delete;
+            TemplateCodeGenerator(TemplateCodeGenerator&& o) = delete;
+
+            /* Deleted assignment operators */
+            TemplateCodeGenerator& operator=(const TemplateCodeGenerator& o) = delete;
+            TemplateCodeGenerator& operator=(TemplateCodeGenerator&& o) = delete;
+
+            /* Destructor */
+            ~TemplateCodeGenerator() = default;
+
+            /* Functions */
+            /**
+             * Generates code based on the template files.
+             * @param is_generator_ok Avoid logging multiple times an error message, if false then no error message will be logged.
+             * @return true if the code generation worked, false otherwise.
+             */
+            bool generateCode(bool is_generator_ok);
+
+        private:
+            /* Types */
+            /** The parsed templates indexed by the name used in the generated functions. */
+            using TemplatesModel = std::map<std::string, std::vector<std::shared_ptr<TemplateNode>>>;
+
+            /* Functions */
+            /**
+             * Parse all the template files of a directory.
+             * @param templates_directory The directory containing the template files.
+             * @return The parsed templates.
+             */
+            static TemplatesModel buildTemplatesModel(const std::filesystem::path& templates_directory);
+
+            /**
+             * Parse the content of a template.
+             * @param template_name The template name used in error messages.
+             * @param content The template content.
+             * @return The nodes of the template.
+             */
+            static std::vector<std::shared_ptr<TemplateNode>> parseTemplate(const std::string& template_name, const std::string& content);
+
+            /**
+             * Convert a template value path to a C++ expression.
+             * @param template_name The template name used in error messages.
+             * @param line The line of the value used in error messages.
+             * @param path The value path e.g user.name.
+             * @param loop_variables The loop variables in scope.
+             * @return The C++ expression e.g ctx.user.name if user isn't a loop variable.
+             */
+            static std::string convertValuePath(const std::string& template_name, size_t line, const std::string& path, const std::vector<std::string>& loop_variables);
+
+            /**
+             * Build the name used in the generated functions from a template path e.g admin/user_list.html gives AdminUserList.
+             * @param relative_path The template path relative to the templates directory.
+             * @return The name used in the generated functions.
+             */
+            static std::string buildTemplateName(const std::filesystem::path& relative_path);
+
+            /**
+             * Generates code and writes it to the given file based on the parsed templates.
+             * @param output_file The file to write the code to.
+             * @param templates The parsed templates.
+             */
+            static void writeGeneratedTemplatesFile(const std::string& output_file, TemplatesModel& templates);
+
+            /**
+             * Write the literal chunks of the given nodes as constexpr data.
+             * @param fs The stream to write to.
+             * @param nodes The nodes.
+             * @param literal_index The index of the next literal, incremented for each literal written.
+             */
+            static void writeLiterals(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, size_t& literal_index);
+
+            /**
+             * Write the code estimating the output size of the given nodes.
+             * @param fs The stream to write to.
+             * @param nodes The nodes.
+             * @param indentation The indentation of the code.
+             */
+            static void writeEstimateCode(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, const std::string& indentation);
+
+            /**
+             * Write the code rendering the given nodes.
+             * @param fs The stream to write to.
+             * @param nodes The nodes.
+             * @param literals_namespace The namespace holding the literal chunks.
+             * @param literal_index The index of the next literal, incremented for each literal written.
+             * @param indentation The indentation of the code.
+             */
+            static void writeRenderCode(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, const std::string& literals_namespace, size_t& literal_index, const std::string& indentation);
+
+            /**
+             * Convert a text to a C++ string literal.
+             * @param text The text.
+             * @return The quoted and escaped C++ string literal.
+             */
+            static std::string toCppStringLiteral(const std::string& text);
+
+            /* Members */
+            /** The directory containing the template files.*/
+            std::string m_templates_directory;
+
+            /** the file to write the generated code to.*/
+            std::string m_output_code_file;
+    };
+}
+#endif //OWEBPP_COMMANDS_GENERATION_TEMPLATE_CODE_GENERATOR_HPP
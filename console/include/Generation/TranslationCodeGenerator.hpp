@@ -0,0 +1,181 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_GENERATION_TRANSLATION_CODE_GENERATOR_HPP
+#define OWEBPP_COMMANDS_GENERATION_TRANSLATION_CODE_GENERATOR_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace owebpp::console {
+    /**
+     * This class compiles the translation catalogs of a directory into constexpr tables served by owebpp::CompiledTranslator.
+     * Each file holds the translations of the locale named after it:
+     * - <locale>.yaml or <locale>.yml maps the keys to their translation, nested maps give keys joined with dots e.g hello: {world: ...} translates hello.world,
+     * - <locale>.po is a gettext catalog whose msgid are the keys, the fuzzy and untranslated entries are skipped.
+     * The translations of a key must expect the same printf arguments in every locale.
+     * The keys of all the locales are placed by a minimal perfect hash and the translations of each locale are stored in a single string pool.
+     * The same tables can be written to a catalog file mapped by owebpp::MmapTranslator instead of code.
+     */
+    class TranslationCodeGenerator {
+        public:
+            /* Constructors */
+            /**
+             * Construct an object that can generate code from the translation catalogs of a directory.
+             * @param translations_directory The directory containing the translation catalogs.
+             * @param output_code_file The file to write the code or the catalog to.
+             */
+            TranslationCodeGenerator(const std::string_view& translations_directory, const std::string& output_code_file):
+                m_translations_directory(translations_directory),
+                m_output_code_file(output_code_file) {}
+
+            /* Deleted constructors */
+            TranslationCodeGenerator() = delete;
+            TranslationCodeGenerator(const TranslationCodeGenerator& o) = delete;
+            TranslationCodeGenerator(TranslationCodeGenerator&& o) = delete;
+
+            /* Deleted assignment operators */
+            TranslationCodeGenerator& operator=(const TranslationCodeGenerator& o) = delete;
+            TranslationCodeGenerator& operator=(TranslationCodeGenerator&& o) = delete;
+
+            /* Destructor */
+            ~TranslationCodeGenerator() = default;
+
+            /* Functions */
+            /**
+             * Generates code based on the translation catalogs.
+             * @param is_generator_ok Avoid logging multiple times an error message, if false then no error message will be logged.
+             * @return true if the code generation worked, false otherwise.
+             */
+            bool generateCode(bool is_generator_ok);
+
+            /**
+             * Generates a catalog file based on the translation catalogs, it replaces the output file atomically.
+             * @param is_generator_ok Avoid logging multiple times an error message, if false then no error message will be logged.
+             * @return true if the catalog generation worked, false otherwise.
+             */
+            bool generateCatalog(bool is_generator_ok);
+
+        private:
+            /* Constants */
+            /** The number of seeds tried to place the keys of a bucket. */
+            static constexpr uint32_t MAX_SEED = 1u << 24;
+
+            /* Types */
+            /** The translations of each locale, indexed by locale then by key. */
+            using TranslationsModel = std::map<std::string, std::map<std::string, std::string>>;
+
+            /* Functions */
+            /**
+             * Read all the translation catalogs of a directory.
+             * @param translations_directory The directory containing the translation catalogs.
+             * @return The translations of each locale.
+             * @throw std::invalid_argument If a catalog can't be read or two catalogs have the same locale.
+             */
+            static TranslationsModel buildTranslationsModel(const std::filesystem::path& translations_directory);
+
+            /**
+             * Read the translations of a YAML node, the keys of nested maps are joined with dots.
+             * @param file The catalog file used in error messages.
+             * @param node The node.
+             * @param prefix The key of the node.
+             * @param translations The translations the node is read into.
+             * @throw std::invalid_argument If the node holds a sequence.
+             */
+            static void readYamlNode(const std::string& file, const YAML::Node& node, const std::string& prefix, std::map<std::string, std::string>& translations);
+
+            /**
+             * Read the translations of a gettext catalog.
+             * @param file The catalog file used in error messages.
+             * @param content The content of the catalog.
+             * @param translations The translations the catalog is read into.
+             * @throw std::invalid_argument If the catalog has a syntax error.
+             */
+            static void readPoCatalog(const std::string& file, const std::string& content, std::map<std::string, std::string>& translations);
+
+            /**
+             * Unescape a quoted gettext string.
+             * @param file The catalog file used in error messages.
+             * @param line The line of the string used in error messages.
+             * @param quoted The string with its quotes.
+             * @return The unescaped string.
+             * @throw std::invalid_argument If the string isn't quoted or has an unknown escape sequence.
+             */
+            static std::string unquotePoString(const std::string& file, size_t line, const std::string& quoted);
+
+            /**
+             * Check that the translations of a key expect the same arguments in every locale, the translations which aren't valid formats are only reported.
+             * @param translations The translations of each locale.
+             * @throw std::invalid_argument If two locales expect different arguments for a key.
+             */
+            static void checkFormats(const TranslationsModel& translations);
+
+            /**
+             * Compute the seeds of the minimal perfect hash placing the keys, the owebpp::CompiledTranslator::findKey function finds them back.
+             * @param keys The keys, they are reordered to their position.
+             * @return The seed of each bucket.
+             * @throw std::invalid_argument If no seed places the keys of a bucket.
+             */
+            static std::vector<uint32_t> buildPerfectHash(std::vector<std::string>& keys);
+
+            /**
+             * Generates code and writes it to the given file based on the translations.
+             * @param output_file The file to write the code to.
+             * @param translations The translations of each locale.
+             */
+            static void writeGeneratedTranslationsFile(const std::string& output_file, const TranslationsModel& translations);
+
+            /**
+             * Writes the catalog file read by owebpp::MmapCatalog, to a temporary file renamed over the output file.
+             * @param output_file The catalog file.
+             * @param translations The translations of each locale.
+             */
+            static void writeCatalogFile(const std::string& output_file, const TranslationsModel& translations);
+
+            /**
+             * Collect the keys of all the locales.
+             * @param translations The translations of each locale.
+             * @return The keys, in no particular order.
+             */
+            static std::vector<std::string> collectKeys(const TranslationsModel& translations);
+
+            /**
+             * Convert a text to a C++ string literal.
+             * @param text The text.
+             * @return The quoted and escaped C++ string literal.
+             */
+            static std::string toCppStringLiteral(const std::string& text);
+
+            /* Members */
+            /** The directory containing the translation catalogs.*/
+            std::string m_translations_directory;
+
+            /** the file to write the generated code or catalog to.*/
+            std::string m_output_code_file;
+    };
+}
+#endif //OWEBPP_COMMANDS_GENERATION_TRANSLATION_CODE_GENERATOR_HPP
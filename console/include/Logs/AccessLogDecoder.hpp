@@ -0,0 +1,86 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_LOGS_ACCESS_LOG_DECODER_HPP
+#define OWEBPP_COMMANDS_LOGS_ACCESS_LOG_DECODER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace owebpp::console {
+    /** This class turns an access log written with the owebpp::AccessLogFormat::BINARY format into JSON lines, formatted as the JSONL format does. */
+    class AccessLogDecoder {
+        public:
+            /* Constructors */
+            /**
+             * Construct an object that can decode a binary access log file.
+             * @param input_file The binary access log file.
+             * @param output_file The file to write the JSON lines to, empty for the standard output.
+             */
+            AccessLogDecoder(const std::string& input_file, const std::string& output_file):
+                m_input_file(input_file),
+                m_output_file(output_file) {}
+
+            /* Deleted constructors */
+            AccessLogDecoder() = delete;
+            AccessLogDecoder(const AccessLogDecoder& o) = delete;
+            AccessLogDecoder(AccessLogDecoder&& o) = delete;
+
+            /* Deleted assignment operators */
+            AccessLogDecoder& operator=(const AccessLogDecoder& o) = delete;
+            AccessLogDecoder& operator=(AccessLogDecoder&& o) = delete;
+
+            /* Destructor */
+            ~AccessLogDecoder() = default;
+
+            /* Functions */
+            /**
+             * Decode the access log file, a record cut at the end of the file e.g. by a server still writing to it is skipped.
+             * @return The number of decoded records.
+             * @throw std::invalid_argument If a file can't be opened or the input isn't a binary access log.
+             */
+            size_t decode();
+
+        private:
+            /* Functions */
+            /**
+             * Decode the records of a buffer.
+             * @param data The content of the access log file.
+             * @param out The output.
+             * @return The number of decoded records.
+             * @throw std::invalid_argument If a record is invalid.
+             */
+            size_t decodeRecords(std::string_view data, std::ostream& out);
+
+            /* Members */
+            /** The binary access log file. */
+            std::string m_input_file;
+
+            /** The file to write the JSON lines to, empty for the standard output. */
+            std::string m_output_file;
+    };
+}
+
+#endif // OWEBPP_COMMANDS_LOGS_ACCESS_LOG_DECODER_HPP
@@ -0,0 +1,74 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_LOGS_FLIGHT_RECORDER_DUMPER_HPP
+#define OWEBPP_COMMANDS_LOGS_FLIGHT_RECORDER_DUMPER_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace owebpp::console {
+    /** This class writes the log lines kept in the file of an owebpp::FlightRecorder, oldest first. */
+    class FlightRecorderDumper {
+        public:
+            /* Constructors */
+            /**
+             * Construct an object that can dump a flight recorder file.
+             * @param input_file The flight recorder file.
+             * @param output_file The file to write the lines to, empty for the standard output.
+             */
+            FlightRecorderDumper(const std::string& input_file, const std::string& output_file):
+                m_input_file(input_file),
+                m_output_file(output_file) {}
+
+            /* Deleted constructors */
+            FlightRecorderDumper() = delete;
+            FlightRecorderDumper(const FlightRecorderDumper& o) = delete;
+            FlightRecorderDumper(FlightRecorderDumper&& o) = delete;
+
+            /* Deleted assignment operators */
+            FlightRecorderDumper& operator=(const FlightRecorderDumper& o) = delete;
+            FlightRecorderDumper& operator=(FlightRecorderDumper&& o) = delete;
+
+            /* Destructor */
+            ~FlightRecorderDumper() = default;
+
+            /* Functions */
+            /**
+             * Dump the flight recorder file, the records a crashed process didn't finish writing are skipped.
+             * @return The number of dumped lines.
+             * @throw std::invalid_argument If a file can't be opened or the input isn't a flight recorder file.
+             */
+            size_t dump();
+
+        private:
+            /* Members */
+            /** The flight recorder file. */
+            std::string m_input_file;
+
+            /** The file to write the lines to, empty for the standard output. */
+            std::string m_output_file;
+    };
+}
+
+#endif // OWEBPP_COMMANDS_LOGS_FLIGHT_RECORDER_DUMPER_HPP
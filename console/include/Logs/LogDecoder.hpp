@@ -0,0 +1,137 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMMANDS_LOGS_LOG_DECODER_HPP
+#define OWEBPP_COMMANDS_LOGS_LOG_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <owebpp/LogLevel.hpp>
+
+namespace owebpp::console {
+    /** This class turns the output of a logger using the owebpp::LogFormat::BINARY format back into text lines, formatted as the text logger does. */
+    class LogDecoder {
+        public:
+            /* Constructors */
+            /**
+             * Construct an object that can decode a binary log file.
+             * @param input_file The binary log file.
+             * @param output_file The file to write the text to, empty for the standard output.
+             */
+            LogDecoder(const std::string& input_file, const std::string& output_file):
+                m_input_file(input_file),
+                m_output_file(output_file),
+                m_sites() {}
+
+            /* Deleted constructors */
+            LogDecoder() = delete;
+            LogDecoder(const LogDecoder& o) = delete;
+            LogDecoder(LogDecoder&& o) = delete;
+
+            /* Deleted assignment operators */
+            LogDecoder& operator=(const LogDecoder& o) = delete;
+            LogDecoder& operator=(LogDecoder&& o) = delete;
+
+            /* Destructor */
+            ~LogDecoder() = default;
+
+            /* Functions */
+            /**
+             * Decode the log file, a record cut at the end of the file e.g. by a process still writing to it is skipped.
+             * @return The number of decoded logs.
+             * @throw std::invalid_argument If a file can't be opened or the input isn't a binary log.
+             */
+            size_t decode();
+
+        private:
+            /* Types */
+            /** A decoded call site. */
+            struct Site {
+                /** The LogLevel of the logs. */
+                LogLevel level{LogLevel::LOG_DEBUG};
+
+                /** The source line. */
+                uint32_t line{0};
+
+                /** The source column. */
+                uint32_t column{0};
+
+                /** The source file, empty if the metadata wasn't logged. */
+                std::string file{};
+
+                /** The function name. */
+                std::string function{};
+
+                /** The format of the messages. */
+                std::string format{};
+            };
+
+            /* Functions */
+            /**
+             * Decode the records of a buffer.
+             * @param data The content of the log file.
+             * @param out The output.
+             * @return The number of decoded logs.
+             * @throw std::invalid_argument If a record is invalid.
+             */
+            size_t decodeRecords(std::string_view data, std::ostream& out);
+
+            /**
+             * Decode the arguments of an EVENT record and format its message.
+             * @param data The data following the argument count, it starts after the arguments once decoded.
+             * @param argument_count The number of arguments.
+             * @param format The format of the message.
+             * @param message Receives the message.
+             * @return false if the data is cut.
+             * @throw std::invalid_argument If an argument type is unknown.
+             */
+            static bool decodeMessage(std::string_view& data, size_t argument_count, std::string_view format, std::string& message);
+
+            /**
+             * Write a decoded log.
+             * @param out The output.
+             * @param level The LogLevel of the log.
+             * @param timestamp The time of the log in nanoseconds since the epoch.
+             * @param site The site of the log, nullptr for a TEXT record.
+             * @param message The message.
+             */
+            static void writeLine(std::ostream& out, LogLevel level, int64_t timestamp, const Site* site, std::string_view message);
+
+            /* Members */
+            /** The binary log file. */
+            std::string m_input_file;
+
+            /** The file to write the text to, empty for the standard output. */
+            std::string m_output_file;
+
+            /** The sites of the current logger output, they are reset by each HEADER record. */
+            std::map<uint32_t, Site> m_sites;
+    };
+}
+
+#endif // OWEBPP_COMMANDS_LOGS_LOG_DECODER_HPP
@@ -30,6 +30,32 @@
 #include <vector>
 
 namespace owebpp::console {
+    /** Lists where the client code of a route runs. */
+    enum class RouteExecutor {
+        /** On the thread serving the request. */
+        INLINE,
+        /** On the owebpp::Executor thread pool, the response is completed back on the thread serving the request. */
+        POOL
+    };
+
+    /** Lists the ways the concurrency limit of a route is adjusted, see owebpp::LimitAlgorithm. */
+    enum class RouteLimiter {
+        /** The limit is max_concurrency. */
+        STATIC,
+        /** The limit adapts to the observed latency, up to max_concurrency. */
+        AIMD
+    };
+
+    /** Lists the priority classes of the routes, see owebpp::Priority. */
+    enum class RoutePriority {
+        /** Served first by the executor. */
+        HIGH,
+        /** The default class. */
+        NORMAL,
+        /** Served once the higher classes are idle or passed over too often. */
+        LOW
+    };
+
     /** This class represents the data that can be assigned to a route. A route is  */
     class RouteModel {
         public:
@@ -61,7 +87,14 @@ namespace owebpp::console {
                 m_class_name(class_name),
                 m_class_include(class_include),
                 m_function_name(function_name),
-                m_function_parameters(function_parameters){}
+                m_function_parameters(function_parameters),
+                m_executor(RouteExecutor::INLINE),
+                m_max_concurrency(0),
+                m_max_queue_depth(0),
+                m_limiter(RouteLimiter::STATIC),
+                m_shed_status(503),
+                m_priority(RoutePriority::NORMAL),
+                m_timeout_ms(0) {}
 
             /* Deleted constructors */
             RouteModel() = delete;
@@ -124,6 +157,118 @@ namespace owebpp::console {
              */
             const std::shared_ptr<std::vector<std::string>>& getFunctionParameters() const { return m_function_parameters; }
 
+            /**
+             * Getter for the executor running the route function.
+             * @return the route executor.
+             */
+            RouteExecutor getExecutor() const { return m_executor; }
+
+            /**
+             * Setter for the executor running the route function.
+             * @param executor The route executor.
+             * @return The route model.
+             */
+            RouteModel& setExecutor(RouteExecutor executor) {
+                m_executor = executor;
+                return *this;
+            }
+
+            /**
+             * Getter for the maximum number of requests running the route function at once.
+             * @return the maximum concurrency, 0 if the route isn't limited.
+             */
+            size_t getMaxConcurrency() const { return m_max_concurrency; }
+
+            /**
+             * Setter for the maximum number of requests running the route function at once.
+             * @param max_concurrency The maximum concurrency, 0 if the route isn't limited.
+             * @return The route model.
+             */
+            RouteModel& setMaxConcurrency(size_t max_concurrency) {
+                m_max_concurrency = max_concurrency;
+                return *this;
+            }
+
+            /**
+             * Getter for the maximum number of requests waiting for the route once the concurrency limit is reached.
+             * @return the maximum queue depth.
+             */
+            size_t getMaxQueueDepth() const { return m_max_queue_depth; }
+
+            /**
+             * Setter for the maximum number of requests waiting for the route once the concurrency limit is reached.
+             * @param max_queue_depth The maximum queue depth.
+             * @return The route model.
+             */
+            RouteModel& setMaxQueueDepth(size_t max_queue_depth) {
+                m_max_queue_depth = max_queue_depth;
+                return *this;
+            }
+
+            /**
+             * Getter for the way the concurrency limit is adjusted.
+             * @return the limiter algorithm.
+             */
+            RouteLimiter getLimiter() const { return m_limiter; }
+
+            /**
+             * Setter for the way the concurrency limit is adjusted.
+             * @param limiter The limiter algorithm.
+             * @return The route model.
+             */
+            RouteModel& setLimiter(RouteLimiter limiter) {
+                m_limiter = limiter;
+                return *this;
+            }
+
+            /**
+             * Getter for the status code of the responses to the shed requests.
+             * @return the shed status code, 503 or 429.
+             */
+            int getShedStatus() const { return m_shed_status; }
+
+            /**
+             * Setter for the status code of the responses to the shed requests.
+             * @param shed_status The shed status code, 503 or 429.
+             * @return The route model.
+             */
+            RouteModel& setShedStatus(int shed_status) {
+                m_shed_status = shed_status;
+                return *this;
+            }
+
+            /**
+             * Getter for the priority class of the route.
+             * @return the priority class.
+             */
+            RoutePriority getPriority() const { return m_priority; }
+
+            /**
+             * Setter for the priority class of the route.
+             * @param priority The priority class.
+             * @return The route model.
+             */
+            RouteModel& setPriority(RoutePriority priority) {
+                m_priority = priority;
+                return *this;
+            }
+
+            /**
+             * Getter for the time budget of the requests of the route.
+             * @return the time budget in milliseconds, 0 if the route has none.
+             */
+            size_t getTimeoutMs() const { return m_timeout_ms; }
+
+            /**
+             * Setter for the time budget of the requests of the route.
+             * @param timeout_ms The time budget in milliseconds, 0 for none.
+             * @return The route model.
+             */
+            RouteModel& setTimeoutMs(size_t timeout_ms) {
+                m_timeout_ms = timeout_ms;
+                return *this;
+            }
+
         private:
             /* Members */
             /** Name of the route. */
@@ -152,6 +297,27 @@ namespace owebpp::console {
              * The content of the values has no impact currently but it is advised to put "std::string" to avoid breaking your code later on.
              */
             std::shared_ptr<std::vector<std::string>> m_function_parameters;
+
+            /** The executor running the route function, set by the optional executor field. */
+            RouteExecutor m_executor;
+
+            /** The maximum number of requests running the route function at once, 0 if the route isn't limited. */
+            size_t m_max_concurrency;
+
+            /** The maximum number of requests waiting for the route once the concurrency limit is reached. */
+            size_t m_max_queue_depth;
+
+            /** The way the concurrency limit is adjusted. */
+            RouteLimiter m_limiter;
+
+            /** The status code of the responses to the shed requests. */
+            int m_shed_status;
+
+            /** The priority class of the route, set by the optional priority field. */
+            RoutePriority m_priority;
+
+            /** The time budget of the requests of the route in milliseconds, 0 if none. */
+            size_t m_timeout_ms;
     };
 }
 
@@ -0,0 +1,125 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_CORE_COMMANDS_MODEL_TEMPLATE_NODE_HPP
+#define OWEBPP_CORE_COMMANDS_MODEL_TEMPLATE_NODE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace owebpp::console {
+    /** Lists the kinds of element a template is made of. */
+    enum class TemplateNodeType {
+        /** Text written as is. */
+        LITERAL,
+        /** {{ value }}: a value written with HTML escaping. */
+        ESCAPED_VALUE,
+        /** {{{ value }}}: a value written without escaping. */
+        RAW_VALUE,
+        /** {% for item in values %}: children written for each element of a range. */
+        FOR,
+        /** {% if value %}: children written if a value is true, else children otherwise. */
+        IF
+    };
+
+    /** This class represents an element of a parsed template. */
+    class TemplateNode {
+        public:
+            /* Constructors */
+            /**
+             * Construct a TemplateNode.
+             * @param type The kind of element.
+             * @param value The literal text, or the C++ expression of the value, range or condition.
+             * @param variable The loop variable name for FOR nodes.
+             */
+            TemplateNode(TemplateNodeType type, const std::string& value, const std::string& variable):
+                m_type(type),
+                m_value(value),
+                m_variable(variable),
+                m_children(),
+                m_else_children() {}
+
+            /* Deleted constructors */
+            TemplateNode() = delete;
+            TemplateNode(const TemplateNode& o) = delete;
+            TemplateNode(TemplateNode&& o) = delete;
+
+            /* Deleted assignment operators */
+            TemplateNode& operator=(const TemplateNode& o) = delete;
+            TemplateNode& operator=(TemplateNode&& o) = delete;
+
+            /* Destructor */
+            ~TemplateNode() = default;
+
+            /* Getters and Setters */
+            /**
+             * Getter for the node type.
+             * @return the node type.
+             */
+            TemplateNodeType getType() const { return m_type; }
+
+            /**
+             * Getter for the literal text or C++ expression of the node.
+             * @return the node value.
+             */
+            const std::string& getValue() const { return m_value; }
+
+            /**
+             * Getter for the loop variable name.
+             * @return the loop variable name.
+             */
+            const std::string& getVariable() const { return m_variable; }
+
+            /**
+             * Getter for the nodes written in the loop or when the condition is true.
+             * @return the children nodes.
+             */
+            std::vector<std::shared_ptr<TemplateNode>>& getChildren() { return m_children; }
+
+            /**
+             * Getter for the nodes written when the condition is false.
+             * @return the else children nodes.
+             */
+            std::vector<std::shared_ptr<TemplateNode>>& getElseChildren() { return m_else_children; }
+
+        private:
+            /* Members */
+            /** The kind of element. */
+            TemplateNodeType m_type;
+
+            /** The literal text, or the C++ expression of the value, range or condition. */
+            std::string m_value;
+
+            /** The loop variable name for FOR nodes. */
+            std::string m_variable;
+
+            /** The nodes written in the loop or when the condition is true. */
+            std::vector<std::shared_ptr<TemplateNode>> m_children;
+
+            /** The nodes written when the condition is false. */
+            std::vector<std::shared_ptr<TemplateNode>> m_else_children;
+    };
+}
+
+#endif // OWEBPP_CORE_COMMANDS_MODEL_TEMPLATE_NODE_HPP
@@ -125,7 +125,7 @@ namespace owebpp::console {
                 } else {
                     throw MissingRouteFieldException(route_name, "function_name");
                 }
-                routes_models->push_back(std::make_shared<RouteModel>(route_name,
+                std::shared_ptr<RouteModel> route_model(std::make_shared<RouteModel>(route_name,
                     path,
                     allowed_methods,
                     convertYAMLRegexToCppRegex(path, parameters_list),
@@ -133,6 +133,8 @@ namespace owebpp::console {
                     class_include,
                     function_name,
                     parameters_list));
+                readExecutionFields(route, *route_model);
+                routes_models->push_back(route_model);
             }
         } else {
             OWEBPP_LOG_ERROR("Missing [routes] field in yaml file.");
@@ -140,6 +142,85 @@ namespace owebpp::console {
         return routes_models;
     }
 
+    void RouteCodeGenerator::readExecutionFields(const YAML::Node& route, RouteModel& route_model) {
+        const std::string& route_name(route_model.getName());
+        // Retrieve the optional executor node data.
+        const YAML::Node& executor_node(route["executor"]);
+        if(executor_node) {
+            if(executor_node.IsNull() || executor_node.as<std::string>() == "") {
+                throw NullOrEmptyRouteFieldException(route_name, "executor");
+            }
+            std::string executor(executor_node.as<std::string>());
+            if(executor == "pool") {
+                route_model.setExecutor(RouteExecutor::POOL);
+            } else if(executor != "inline") {
+                throw std::invalid_argument("Unknown executor [" + executor + "] for route: " + route_name + ", expected inline or pool.");
+            }
+        }
+        // Retrieve the optional priority node data.
+        const YAML::Node& priority_node(route["priority"]);
+        if(priority_node) {
+            if(priority_node.IsNull() || priority_node.as<std::string>() == "") {
+                throw NullOrEmptyRouteFieldException(route_name, "priority");
+            }
+            std::string priority(priority_node.as<std::string>());
+            if(priority == "high") {
+                route_model.setPriority(RoutePriority::HIGH);
+            } else if(priority == "low") {
+                route_model.setPriority(RoutePriority::LOW);
+            } else if(priority != "normal") {
+                throw std::invalid_argument("Unknown priority [" + priority + "] for route: " + route_name + ", expected high, normal or low.");
+            }
+        }
+        // Retrieve the optional timeout node data.
+        if(route["timeout_ms"]) {
+            route_model.setTimeoutMs(readCount(route["timeout_ms"], route_name, "timeout_ms"));
+        }
+        // Retrieve the optional concurrency limit nodes data.
+        if(route["max_concurrency"]) {
+            route_model.setMaxConcurrency(readCount(route["max_concurrency"], route_name, "max_concurrency"));
+            if(route_model.getMaxConcurrency() == 0) {
+                throw std::invalid_argument("Field [max_concurrency] for route: " + route_name + " must be positive.");
+            }
+        }
+        if(route["max_queue_depth"]) {
+            route_model.setMaxQueueDepth(readCount(route["max_queue_depth"], route_name, "max_queue_depth"));
+        }
+        const YAML::Node& limiter_node(route["limiter"]);
+        if(limiter_node) {
+            if(limiter_node.IsNull() || limiter_node.as<std::string>() == "") {
+                throw NullOrEmptyRouteFieldException(route_name, "limiter");
+            }
+            std::string limiter(limiter_node.as<std::string>());
+            if(limiter == "aimd") {
+                route_model.setLimiter(RouteLimiter::AIMD);
+            } else if(limiter != "static") {
+                throw std::invalid_argument("Unknown limiter [" + limiter + "] for route: " + route_name + ", expected static or aimd.");
+            }
+        }
+        if(route["shed_status"]) {
+            size_t shed_status(readCount(route["shed_status"], route_name, "shed_status"));
+            if(shed_status != 503 && shed_status != 429) {
+                throw std::invalid_argument("Field [shed_status] for route: " + route_name + " must be 503 or 429.");
+            }
+            route_model.setShedStatus(static_cast<int>(shed_status));
+        }
+        if(route_model.getMaxConcurrency() == 0 && (route["max_queue_depth"] || limiter_node || route["shed_status"])) {
+            OWEBPP_LOG_WARNING("Route " + route_name + " has no max_concurrency, its limiter fields are ignored.");
+        }
+    }
+
+    size_t RouteCodeGenerator::readCount(const YAML::Node& node, const std::string& route_name, const std::string& field_name) {
+        if(node.IsNull() || node.as<std::string>() == "") {
+            throw NullOrEmptyRouteFieldException(route_name, field_name);
+        }
+        std::string value(node.as<std::string>());
+        if(value.find_first_not_of("0123456789") != std::string::npos || value.size() > 9) {
+            throw std::invalid_argument("Field [" + field_name + "] for route: " + route_name + " must be a non negative integer, got: " + value);
+        }
+        return std::stoul(value);
+    }
+
     void RouteCodeGenerator::writeGeneratedRoutesFile(const std::string& output_file, const std::shared_ptr<std::vector<std::shared_ptr<RouteModel>>> routes) {
         std::ofstream fs(output_file, fs.trunc);
         if(!fs.is_open()) {
@@ -150,10 +231,15 @@ namespace owebpp::console {
         fs << "#ifndef _oweb_generated_code_hpp" << std::endl;
         fs << "#define _oweb_generated_code_hpp" << std::endl;
         fs << std::endl;
+        fs << "#include <chrono>" << std::endl;
         fs << "#include <memory>" << std::endl;
         fs << "#include <owebpp/AbstractRoute.hpp>" << std::endl;
+        fs << "#include <owebpp/ConcurrencyLimiter.hpp>" << std::endl;
+        fs << "#include <owebpp/Priority.hpp>" << std::endl;
         fs << "#include <owebpp/Response.hpp>" << std::endl;
         fs << "#include <owebpp/Request.hpp>" << std::endl;
+        fs << "#include <owebpp/RouteInvoker.hpp>" << std::endl;
+        fs << "#include <owebpp/Task.hpp>" << std::endl;
         fs << "#include <regex>" << std::endl;
         fs << std::endl;
 
@@ -165,19 +251,57 @@ namespace owebpp::console {
 
             fs << "\tclass _owebpp_genroute_" << (*routes)[i]->getName() << (*routes)[i]->getFunctionName() << " final : public owebpp::AbstractRoute " << '{' << std::endl;
             fs << "\t\tpublic:" << std::endl;
-            fs << "\t\t\t_owebpp_genroute_" << (*routes)[i]->getName() << (*routes)[i]->getFunctionName() << "(const std::string& reg): owebpp::AbstractRoute(" << (*routes)[i]->getAllowedMethods() << ",reg," << (*routes)[i]->getFunctionParameters()->size() << ") {}" << std::endl;
+            fs << "\t\t\t_owebpp_genroute_" << (*routes)[i]->getName() << (*routes)[i]->getFunctionName() << "(const std::string& reg): owebpp::AbstractRoute(" << (*routes)[i]->getAllowedMethods() << ",reg," << (*routes)[i]->getFunctionParameters()->size() << ") {";
+            bool has_body((*routes)[i]->getMaxConcurrency() > 0 || (*routes)[i]->getPriority() != RoutePriority::NORMAL || (*routes)[i]->getTimeoutMs() > 0);
+            if(has_body) {
+                fs << std::endl;
+            }
+            if((*routes)[i]->getMaxConcurrency() > 0) {
+                /* The Router enforces the limiter of the route. */
+                fs << "\t\t\t\tsetLimiter(std::make_unique<owebpp::ConcurrencyLimiter>(" << (*routes)[i]->getMaxConcurrency() << ',' << (*routes)[i]->getMaxQueueDepth() << ','
+                   << ((*routes)[i]->getLimiter() == RouteLimiter::AIMD ? "owebpp::LimitAlgorithm::AIMD" : "owebpp::LimitAlgorithm::STATIC") << ','
+                   << ((*routes)[i]->getShedStatus() == 429 ? "owebpp::HttpStatusCode::TOO_MANY_REQUESTS" : "owebpp::HttpStatusCode::SERVICE_UNAVAILABLE") << "));" << std::endl;
+            }
+            if((*routes)[i]->getPriority() != RoutePriority::NORMAL) {
+                /* The executor serves the jobs of the higher classes first. */
+                fs << "\t\t\t\tsetPriority(" << ((*routes)[i]->getPriority() == RoutePriority::HIGH ? "owebpp::Priority::HIGH" : "owebpp::Priority::LOW") << ");" << std::endl;
+            }
+            if((*routes)[i]->getTimeoutMs() > 0) {
+                /* The Router answers the requests still waiting for the route past this budget with 504. */
+                fs << "\t\t\t\tsetTimeout(std::chrono::milliseconds(" << (*routes)[i]->getTimeoutMs() << "));" << std::endl;
+            }
+            if(has_body) {
+                fs << "\t\t\t";
+            }
+            fs << '}' << std::endl;
             fs << "\t\t\t~_owebpp_genroute_" << (*routes)[i]->getName() << (*routes)[i]->getFunctionName() << "() = default;" << std::endl;
             fs << std::endl;
+            /* The invoker detects from the return type of the client code whether it is a coroutine returning an owebpp::Task. */
             fs << "\t\t\t[[nodiscard]] std::shared_ptr<owebpp::Response> execute(const std::shared_ptr<owebpp::Request>& req, [[maybe_unused]] std::smatch& sm) override {" << std::endl;
-            //fs << "\t\t\t\tstd::unique_ptr<" << (*routes)[i]->getClassName() << "> p = std::make_unique<" << (*routes)[i]->getClassName() << ">();" << std::endl;
-            fs << "\t\t\t\treturn " << (*routes)[i]->getClassName() << "()." << (*routes)[i]->getFunctionName() << "(req";
-
-            /* iterate parameters provided to client code function call */
-            for(size_t cpt = 0; cpt < (*routes)[i]->getFunctionParameters()->size(); cpt++) {
-                fs << ',' << "sm[" << cpt+1 << ']';
-            }
-            fs << ");" << std::endl;
+            fs << "\t\t\t\treturn Invoker::execute(CALL, req, sm);" << std::endl;
             fs << "\t\t\t}" << std::endl;
+            fs << std::endl;
+            fs << "\t\t\t[[nodiscard]] owebpp::Task<std::shared_ptr<owebpp::Response>> executeAsync(const std::shared_ptr<owebpp::Request>& req, [[maybe_unused]] std::smatch& sm) override {" << std::endl;
+            if((*routes)[i]->getExecutor() == RouteExecutor::POOL) {
+                /* The client code runs on the executor when the route is served asynchronously, inline otherwise. */
+                fs << "\t\t\t\treturn Invoker::executeOnPool(CALL, req, sm, getPriority());" << std::endl;
+                fs << "\t\t\t}" << std::endl;
+                fs << std::endl;
+                fs << "\t\t\tbool isAsync() const override { return true; }" << std::endl;
+            } else {
+                fs << "\t\t\t\treturn Invoker::executeAsync(CALL, req, sm);" << std::endl;
+                fs << "\t\t\t}" << std::endl;
+                fs << std::endl;
+                fs << "\t\t\tbool isAsync() const override { return Invoker::isAsync(CALL); }" << std::endl;
+            }
+            fs << std::endl;
+            fs << "\t\tprivate:" << std::endl;
+            fs << "\t\t\tusing Invoker = owebpp::RouteInvoker<" << (*routes)[i]->getClassName() << ',' << (*routes)[i]->getFunctionParameters()->size() << ">;" << std::endl;
+            fs << std::endl;
+            fs << "\t\t\tstatic constexpr auto CALL = [](" << (*routes)[i]->getClassName() << "& handler, const std::shared_ptr<owebpp::Request>& req, const auto&... parameters) {" << std::endl;
+            /* The URL parameters are provided to the client code function call by the invoker. */
+            fs << "\t\t\t\treturn handler." << (*routes)[i]->getFunctionName() << "(req,parameters...);" << std::endl;
+            fs << "\t\t\t};" << std::endl;
             fs << "\t};" << std::endl;
             fs << '}' << std::endl;
             fs << std::endl;
@@ -190,7 +314,7 @@ namespace owebpp::console {
         fs << "}" << std::endl;
         fs << std::endl;
         /* Write code for static initialization of router. */
-        fs << "std::shared_ptr<owebpp::Router> owebpp::Router::s_router = nullptr;" << std::endl;
+        fs << "constinit owebpp::Snapshot<owebpp::Router> owebpp::Router::s_router;" << std::endl;
         fs << std::endl;
         fs << "#endif" << std::endl;
     }
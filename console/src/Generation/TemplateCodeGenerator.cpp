@@ -0,0 +1,374 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+#include "Exception/TemplateSyntaxException.hpp"
+#include "Generation/TemplateCodeGenerator.hpp"
+#include <owebpp/Logger.hpp>
+
+namespace owebpp::console {
+
+    TemplateCodeGenerator::TemplatesModel TemplateCodeGenerator::buildTemplatesModel(const std::filesystem::path& templates_directory) {
+        TemplatesModel templates;
+        if(!std::filesystem::is_directory(templates_directory)) {
+            throw std::invalid_argument("Templates directory " + templates_directory.string() + " does not exist. Aborting code generation.");
+        }
+        for(const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(templates_directory)) {
+            if(entry.is_regular_file()) {
+                std::filesystem::path relative_path(std::filesystem::relative(entry.path(), templates_directory));
+                std::string template_name(buildTemplateName(relative_path));
+                if(templates.contains(template_name)) {
+                    throw std::invalid_argument("Templates " + relative_path.string() + " and another template both generate the name " + template_name + ". Aborting code generation.");
+                }
+                std::ifstream fs(entry.path(), std::ios::binary);
+                if(!fs.is_open()) {
+                    throw std::invalid_argument("Unable to open template file: " + entry.path().string() + " Aborting code generation.");
+                }
+                std::stringstream content;
+                content << fs.rdbuf();
+                templates[template_name] = parseTemplate(relative_path.string(), content.str());
+            }
+        }
+        return templates;
+    }
+
+    std::vector<std::shared_ptr<TemplateNode>> TemplateCodeGenerator::parseTemplate(const std::string& template_name, const std::string& content) {
+        std::vector<std::shared_ptr<TemplateNode>> nodes;
+        /* The block nodes (for, if) currently open and the list their content is added to. */
+        std::vector<std::pair<std::shared_ptr<TemplateNode>, std::vector<std::shared_ptr<TemplateNode>>*>> blocks;
+        std::vector<std::string> loop_variables;
+        std::vector<std::shared_ptr<TemplateNode>>* current(&nodes);
+        size_t line(1);
+        size_t pos(0);
+
+        while(pos < content.size()) {
+            size_t tag_start = std::min(content.find("{{", pos), content.find("{%", pos));
+            size_t literal_end = tag_start == std::string::npos ? content.size() : tag_start;
+            if(literal_end > pos) {
+                std::string literal(content.substr(pos, literal_end - pos));
+                line += std::count(literal.begin(), literal.end(), '\n');
+                current->push_back(std::make_shared<TemplateNode>(TemplateNodeType::LITERAL, literal, ""));
+            }
+            if(tag_start == std::string::npos) {
+                break;
+            }
+
+            bool is_raw(content.compare(tag_start, 3, "{{{") == 0);
+            bool is_statement(content.compare(tag_start, 2, "{%") == 0);
+            std::string opening(is_raw ? "{{{" : (is_statement ? "{%" : "{{"));
+            std::string closing(is_raw ? "}}}" : (is_statement ? "%}" : "}}"));
+            size_t tag_end = content.find(closing, tag_start + opening.size());
+            if(tag_end == std::string::npos) {
+                throw TemplateSyntaxException(template_name, line, "Missing " + closing + " for the tag opened with " + opening + '.');
+            }
+            std::string tag(content.substr(tag_start + opening.size(), tag_end - tag_start - opening.size()));
+            const size_t tag_line(line);
+            line += std::count(tag.begin(), tag.end(), '\n');
+            pos = tag_end + closing.size();
+
+            std::istringstream tag_stream(tag);
+            std::vector<std::string> words;
+            std::string word;
+            while(tag_stream >> word) {
+                words.push_back(word);
+            }
+            if(words.empty()) {
+                throw TemplateSyntaxException(template_name, tag_line, "Empty tag.");
+            }
+
+            if(!is_statement) {
+                if(words.size() != 1) {
+                    throw TemplateSyntaxException(template_name, tag_line, "A value tag must contain a single value, found: " + tag);
+                }
+                current->push_back(std::make_shared<TemplateNode>(is_raw ? TemplateNodeType::RAW_VALUE : TemplateNodeType::ESCAPED_VALUE,
+                                                                  convertValuePath(template_name, tag_line, words[0], loop_variables),
+                                                                  ""));
+            } else if(words[0] == "for") {
+                if(words.size() != 4 || words[2] != "in" || !std::regex_match(words[1], std::regex("[a-zA-Z_][a-zA-Z0-9_]*")) || words[1] == "ctx") {
+                    throw TemplateSyntaxException(template_name, tag_line, "Expected {% for <variable> in <values> %}, found: " + tag);
+                }
+                std::shared_ptr<TemplateNode> node(std::make_shared<TemplateNode>(TemplateNodeType::FOR,
+                                                                                  convertValuePath(template_name, tag_line, words[3], loop_variables),
+                                                                                  words[1]));
+                current->push_back(node);
+                loop_variables.push_back(words[1]);
+                blocks.push_back({node, current});
+                current = &node->getChildren();
+            } else if(words[0] == "if") {
+                bool is_negated(words.size() == 3 && words[1] == "not");
+                if(words.size() != 2 && !is_negated) {
+                    throw TemplateSyntaxException(template_name, tag_line, "Expected {% if [not] <value> %}, found: " + tag);
+                }
+                std::string condition("owebpp::TemplateUtils::isTrue(" + convertValuePath(template_name, tag_line, words.back(), loop_variables) + ')');
+                std::shared_ptr<TemplateNode> node(std::make_shared<TemplateNode>(TemplateNodeType::IF, is_negated ? '!' + condition : condition, ""));
+                current->push_back(node);
+                blocks.push_back({node, current});
+                current = &node->getChildren();
+            } else if(words[0] == "else" && words.size() == 1) {
+                if(blocks.empty() || blocks.back().first->getType() != TemplateNodeType::IF || current == &blocks.back().first->getElseChildren()) {
+                    throw TemplateSyntaxException(template_name, tag_line, "{% else %} without a matching {% if %}.");
+                }
+                current = &blocks.back().first->getElseChildren();
+            } else if((words[0] == "endfor" || words[0] == "endif") && words.size() == 1) {
+                TemplateNodeType expected(words[0] == "endfor" ? TemplateNodeType::FOR : TemplateNodeType::IF);
+                if(blocks.empty() || blocks.back().first->getType() != expected) {
+                    throw TemplateSyntaxException(template_name, tag_line, "{% " + words[0] + " %} without a matching opening tag.");
+                }
+                if(expected == TemplateNodeType::FOR) {
+                    loop_variables.pop_back();
+                }
+                current = blocks.back().second;
+                blocks.pop_back();
+            } else {
+                throw TemplateSyntaxException(template_name, tag_line, "Unknown statement: " + tag);
+            }
+        }
+
+        if(!blocks.empty()) {
+            throw TemplateSyntaxException(template_name, line, std::string("Missing ") + (blocks.back().first->getType() == TemplateNodeType::FOR ? "{% endfor %}." : "{% endif %}."));
+        }
+        return nodes;
+    }
+
+    std::string TemplateCodeGenerator::convertValuePath(const std::string& template_name, size_t line, const std::string& path, const std::vector<std::string>& loop_variables) {
+        if(!std::regex_match(path, std::regex("[a-zA-Z_][a-zA-Z0-9_]*(\\.[a-zA-Z_][a-zA-Z0-9_]*)*"))) {
+            throw TemplateSyntaxException(template_name, line, "Invalid value: " + path);
+        }
+        std::string root(path.substr(0, path.find('.')));
+        bool is_loop_variable(std::find(loop_variables.begin(), loop_variables.end(), root) != loop_variables.end());
+        return is_loop_variable ? path : "ctx." + path;
+    }
+
+    std::string TemplateCodeGenerator::buildTemplateName(const std::filesystem::path& relative_path) {
+        std::filesystem::path without_extension(relative_path);
+        without_extension.replace_extension();
+        std::string name;
+        bool capitalize(true);
+        for(char c : without_extension.string()) {
+            if(std::isalnum(static_cast<unsigned char>(c))) {
+                name += capitalize ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : c;
+                capitalize = false;
+            } else {
+                capitalize = true;
+            }
+        }
+        if(name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+            name = "Template" + name;
+        }
+        return name;
+    }
+
+    void TemplateCodeGenerator::writeGeneratedTemplatesFile(const std::string& output_file, TemplatesModel& templates) {
+        std::ofstream fs(output_file, fs.trunc);
+        if(!fs.is_open()) {
+            throw std::invalid_argument("Unable to open output file: " + output_file + " Aborting code generation.");
+        }
+        /* Write file start. */
+        fs << "/* Do not edit this file, the content is automatically generated. */" << std::endl;
+        fs << "#ifndef _oweb_generated_templates_hpp" << std::endl;
+        fs << "#define _oweb_generated_templates_hpp" << std::endl;
+        fs << std::endl;
+        fs << "#include <owebpp/Template.hpp>" << std::endl;
+        fs << "#include <string>" << std::endl;
+        fs << "#include <string_view>" << std::endl;
+        fs << std::endl;
+        fs << "namespace owebpp::generated::templates {" << std::endl;
+
+        /* Iterate templates and write corresponding code. */
+        for(auto& [name, nodes] : templates) {
+            const std::string literals_namespace("_owebpp_literals_" + name);
+            size_t literal_index(0);
+            fs << "\tnamespace " << literals_namespace << " {" << std::endl;
+            writeLiterals(fs, nodes, literal_index);
+            fs << "\t}" << std::endl;
+            fs << std::endl;
+
+            fs << "\t/** Estimate the output size of the " << name << " template so the output buffer is reserved once. */" << std::endl;
+            fs << "\ttemplate<class Tcontext>" << std::endl;
+            fs << "\t[[nodiscard]] size_t estimate" << name << "Size([[maybe_unused]] const Tcontext& ctx) {" << std::endl;
+            fs << "\t\tsize_t size(0);" << std::endl;
+            writeEstimateCode(fs, nodes, "\t\t");
+            fs << "\t\treturn size;" << std::endl;
+            fs << "\t}" << std::endl;
+            fs << std::endl;
+
+            literal_index = 0;
+            fs << "\t/** Append the " << name << " template rendered with the given context to out. */" << std::endl;
+            fs << "\ttemplate<class Tcontext>" << std::endl;
+            fs << "\tvoid render" << name << "(std::string& out, [[maybe_unused]] const Tcontext& ctx) {" << std::endl;
+            fs << "\t\tout.reserve(out.size() + estimate" << name << "Size(ctx));" << std::endl;
+            writeRenderCode(fs, nodes, literals_namespace, literal_index, "\t\t");
+            fs << "\t}" << std::endl;
+            fs << std::endl;
+        }
+        fs << '}' << std::endl;
+        fs << std::endl;
+        fs << "#endif" << std::endl;
+    }
+
+    void TemplateCodeGenerator::writeLiterals(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, size_t& literal_index) {
+        for(const std::shared_ptr<TemplateNode>& node : nodes) {
+            if(node->getType() == TemplateNodeType::LITERAL) {
+                fs << "\t\tinline constexpr std::string_view LITERAL_" << literal_index++ << " = " << toCppStringLiteral(node->getValue()) << ';' << std::endl;
+            } else {
+                writeLiterals(fs, node->getChildren(), literal_index);
+                writeLiterals(fs, node->getElseChildren(), literal_index);
+            }
+        }
+    }
+
+    void TemplateCodeGenerator::writeEstimateCode(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, const std::string& indentation) {
+        /* The size of the literal chunks of a block is known at generation time. */
+        size_t literals_size(0);
+        for(const std::shared_ptr<TemplateNode>& node : nodes) {
+            if(node->getType() == TemplateNodeType::LITERAL) {
+                literals_size += node->getValue().size();
+            }
+        }
+        if(literals_size > 0) {
+            fs << indentation << "size += " << literals_size << ';' << std::endl;
+        }
+        for(const std::shared_ptr<TemplateNode>& node : nodes) {
+            switch(node->getType()) {
+                case TemplateNodeType::ESCAPED_VALUE:
+                case TemplateNodeType::RAW_VALUE:
+                    fs << indentation << "size += owebpp::TemplateUtils::estimateSize(" << node->getValue() << ");" << std::endl;
+                    break;
+                case TemplateNodeType::FOR:
+                    fs << indentation << "for([[maybe_unused]] const auto& " << node->getVariable() << " : " << node->getValue() << ") {" << std::endl;
+                    writeEstimateCode(fs, node->getChildren(), indentation + '\t');
+                    fs << indentation << '}' << std::endl;
+                    break;
+                case TemplateNodeType::IF:
+                    fs << indentation << "if(" << node->getValue() << ") {" << std::endl;
+                    writeEstimateCode(fs, node->getChildren(), indentation + '\t');
+                    if(!node->getElseChildren().empty()) {
+                        fs << indentation << "} else {" << std::endl;
+                        writeEstimateCode(fs, node->getElseChildren(), indentation + '\t');
+                    }
+                    fs << indentation << '}' << std::endl;
+                    break;
+                case TemplateNodeType::LITERAL:
+                default:
+                    break;
+            }
+        }
+    }
+
+    void TemplateCodeGenerator::writeRenderCode(std::ostream& fs, std::vector<std::shared_ptr<TemplateNode>>& nodes, const std::string& literals_namespace, size_t& literal_index, const std::string& indentation) {
+        for(const std::shared_ptr<TemplateNode>& node : nodes) {
+            switch(node->getType()) {
+                case TemplateNodeType::LITERAL:
+                    fs << indentation << "out.append(" << literals_namespace << "::LITERAL_" << literal_index++ << ");" << std::endl;
+                    break;
+                case TemplateNodeType::ESCAPED_VALUE:
+                    fs << indentation << "owebpp::TemplateUtils::appendEscaped(out, " << node->getValue() << ");" << std::endl;
+                    break;
+                case TemplateNodeType::RAW_VALUE:
+                    fs << indentation << "owebpp::TemplateUtils::appendRaw(out, " << node->getValue() << ");" << std::endl;
+                    break;
+                case TemplateNodeType::FOR:
+                    fs << indentation << "for([[maybe_unused]] const auto& " << node->getVariable() << " : " << node->getValue() << ") {" << std::endl;
+                    writeRenderCode(fs, node->getChildren(), literals_namespace, literal_index, indentation + '\t');
+                    fs << indentation << '}' << std::endl;
+                    break;
+                case TemplateNodeType::IF:
+                    fs << indentation << "if(" << node->getValue() << ") {" << std::endl;
+                    writeRenderCode(fs, node->getChildren(), literals_namespace, literal_index, indentation + '\t');
+                    if(!node->getElseChildren().empty()) {
+                        fs << indentation << "} else {" << std::endl;
+                        writeRenderCode(fs, node->getElseChildren(), literals_namespace, literal_index, indentation + '\t');
+                    }
+                    fs << indentation << '}' << std::endl;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    std::string TemplateCodeGenerator::toCppStringLiteral(const std::string& text) {
+        std::string literal("\"");
+        for(char c : text) {
+            switch(c) {
+                case '"':
+                    literal += "\\\"";
+                    break;
+                case '\\':
+                    literal += "\\\\";
+                    break;
+                case '\n':
+                    literal += "\\n";
+                    break;
+                case '\r':
+                    literal += "\\r";
+                    break;
+                case '\t':
+                    literal += "\\t";
+                    break;
+                default:
+                    if(std::isprint(static_cast<unsigned char>(c))) {
+                        literal += c;
+                    } else {
+                        /* Octal escapes are limited to three digits so they can't swallow the following characters. */
+                        char escaped[5];
+                        std::snprintf(escaped, sizeof(escaped), "\\%03o", static_cast<unsigned char>(c));
+                        literal += escaped;
+                    }
+                    break;
+            }
+        }
+        literal += '"';
+        return literal;
+    }
+
+    bool TemplateCodeGenerator::generateCode(bool is_generator_ok) {
+        try {
+            TemplatesModel templates(buildTemplatesModel(m_templates_directory));
+            writeGeneratedTemplatesFile(m_output_code_file, templates);
+            is_generator_ok = true;
+        } catch(const TemplateSyntaxException& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(e.what());
+            }
+            is_generator_ok = false;
+        } catch(const std::invalid_argument& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(e.what());
+            }
+            is_generator_ok = false;
+        } catch(const std::filesystem::filesystem_error& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(std::string("Error reading templates: ") + e.what());
+            }
+            is_generator_ok = false;
+        }
+        return is_generator_ok;
+    }
+}
@@ -0,0 +1,516 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "Generation/TranslationCodeGenerator.hpp"
+#include <owebpp/CompiledTranslator.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/MmapCatalog.hpp>
+#include <owebpp/TranslationFormat.hpp>
+
+namespace owebpp::console {
+
+    TranslationCodeGenerator::TranslationsModel TranslationCodeGenerator::buildTranslationsModel(const std::filesystem::path& translations_directory) {
+        TranslationsModel translations;
+        if(!std::filesystem::is_directory(translations_directory)) {
+            throw std::invalid_argument("Translations directory " + translations_directory.string() + " does not exist. Aborting code generation.");
+        }
+        for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(translations_directory)) {
+            std::string extension(entry.path().extension().string());
+            if(entry.is_regular_file() && (extension == ".yaml" || extension == ".yml" || extension == ".po")) {
+                std::string locale(entry.path().stem().string());
+                if(translations.contains(locale)) {
+                    throw std::invalid_argument("Several catalogs translate the locale " + locale + ". Aborting code generation.");
+                }
+                std::map<std::string, std::string>& locale_translations(translations[locale]);
+                if(extension == ".po") {
+                    std::ifstream fs(entry.path(), std::ios::binary);
+                    if(!fs.is_open()) {
+                        throw std::invalid_argument("Unable to open translation file: " + entry.path().string() + " Aborting code generation.");
+                    }
+                    std::stringstream content;
+                    content << fs.rdbuf();
+                    readPoCatalog(entry.path().string(), content.str(), locale_translations);
+                } else {
+                    YAML::Node catalog(YAML::LoadFile(entry.path().string()));
+                    if(!catalog.IsMap() && !catalog.IsNull()) {
+                        throw std::invalid_argument(entry.path().string() + " must map the keys to their translation. Aborting code generation.");
+                    }
+                    readYamlNode(entry.path().string(), catalog, "", locale_translations);
+                }
+            }
+        }
+        return translations;
+    }
+
+    void TranslationCodeGenerator::readYamlNode(const std::string& file, const YAML::Node& node, const std::string& prefix, std::map<std::string, std::string>& translations) {
+        if(node.IsMap()) {
+            for(const auto& child : node) {
+                std::string key(child.first.as<std::string>());
+                readYamlNode(file, child.second, prefix.empty() ? key : prefix + '.' + key, translations);
+            }
+        } else if(node.IsScalar()) {
+            translations[prefix] = node.as<std::string>();
+        } else if(node.IsSequence()) {
+            throw std::invalid_argument(file + ": the translation of " + prefix + " is a sequence. Aborting code generation.");
+        }
+    }
+
+    void TranslationCodeGenerator::readPoCatalog(const std::string& file, const std::string& content, std::map<std::string, std::string>& translations) {
+        std::istringstream lines(content);
+        std::string line;
+        size_t line_number(0);
+        std::string context;
+        std::string id;
+        std::string translation;
+        bool is_fuzzy(false);
+        bool has_translation(false);
+        /* The field the quoted strings of the following lines are appended to, nullptr before the first keyword of an entry. */
+        std::string* field(nullptr);
+        std::string ignored;
+        auto finishEntry = [&]() {
+            if(!id.empty() && !translation.empty() && !is_fuzzy) {
+                /* gettext separates the context from the id with an EOT. */
+                translations[context.empty() ? id : context + '\x04' + id] = translation;
+            }
+            context.clear();
+            id.clear();
+            translation.clear();
+            is_fuzzy = false;
+            has_translation = false;
+            field = nullptr;
+        };
+
+        while(std::getline(lines, line)) {
+            line_number++;
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            std::string keyword(line.substr(0, line.find_first_of(" \t")));
+            std::string value(line.substr(std::min(line.size(), keyword.size() + 1)));
+            value.erase(0, value.find_first_not_of(" \t"));
+            if(line.empty()) {
+                finishEntry();
+            } else if(line.starts_with("#,")) {
+                is_fuzzy = is_fuzzy || line.find("fuzzy") != std::string::npos;
+            } else if(line[0] == '#') {
+                /* Comments and references are ignored. */
+            } else if(line[0] == '"') {
+                if(field == nullptr) {
+                    throw std::invalid_argument(file + ":" + std::to_string(line_number) + ": string without a keyword. Aborting code generation.");
+                }
+                *field += unquotePoString(file, line_number, line);
+            } else if(keyword == "msgctxt" || keyword == "msgid") {
+                if(has_translation) {
+                    finishEntry();
+                }
+                field = keyword == "msgid" ? &id : &context;
+                *field = unquotePoString(file, line_number, value);
+            } else if(keyword == "msgstr" || keyword == "msgstr[0]") {
+                field = &translation;
+                *field = unquotePoString(file, line_number, value);
+                has_translation = true;
+            } else if(keyword == "msgid_plural" || keyword.starts_with("msgstr[")) {
+                /* Only the singular translation is compiled. */
+                field = &ignored;
+                *field = unquotePoString(file, line_number, value);
+            } else {
+                throw std::invalid_argument(file + ":" + std::to_string(line_number) + ": unknown keyword " + keyword + ". Aborting code generation.");
+            }
+        }
+        finishEntry();
+    }
+
+    std::string TranslationCodeGenerator::unquotePoString(const std::string& file, size_t line, const std::string& quoted) {
+        if(quoted.size() < 2 || quoted.front() != '"' || quoted.back() != '"') {
+            throw std::invalid_argument(file + ":" + std::to_string(line) + ": expected a quoted string, found: " + quoted + " Aborting code generation.");
+        }
+        std::string result;
+        for(size_t i = 1; i + 1 < quoted.size(); i++) {
+            if(quoted[i] != '\\') {
+                result += quoted[i];
+            } else if(i + 2 < quoted.size()) {
+                i++;
+                switch(quoted[i]) {
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case '"':
+                    case '\\':
+                        result += quoted[i];
+                        break;
+                    default:
+                        throw std::invalid_argument(file + ":" + std::to_string(line) + ": unknown escape sequence \\" + quoted[i] + ". Aborting code generation.");
+                }
+            } else {
+                throw std::invalid_argument(file + ":" + std::to_string(line) + ": unterminated string. Aborting code generation.");
+            }
+        }
+        return result;
+    }
+
+    void TranslationCodeGenerator::checkFormats(const TranslationsModel& translations) {
+        /* The locale and the argument types of the first valid translation of each key. */
+        std::map<std::string, std::pair<std::string, std::vector<owebpp::TranslationArgumentType>>> expected_types;
+        for(const auto& [locale, locale_translations] : translations) {
+            for(const auto& [key, translation] : locale_translations) {
+                owebpp::TranslationFormat format(translation);
+                if(!format.isValid()) {
+                    OWEBPP_LOG_WARNING("Translation of key " + key + " for locale " + locale + " has an " + format.getError() + ", it can only be translated without arguments.");
+                } else {
+                    auto expected(expected_types.try_emplace(key, locale, format.getTypes()).first);
+                    if(expected->second.second != format.getTypes()) {
+                        throw std::invalid_argument("Translations of key " + key + " for locales " + expected->second.first + " and " + locale
+                                                    + " expect different arguments. Aborting code generation.");
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> TranslationCodeGenerator::buildPerfectHash(std::vector<std::string>& keys) {
+        const size_t key_count(keys.size());
+        std::vector<uint32_t> seeds(key_count / 2 + 1, 0);
+        std::vector<std::vector<std::string>> buckets(seeds.size());
+        for(const std::string& key : keys) {
+            buckets[owebpp::CompiledTranslator::mix(owebpp::CompiledTranslator::hash(key), 0) % seeds.size()].push_back(key);
+        }
+        /* The largest buckets are placed first, while most positions are free. */
+        std::vector<size_t> bucket_order(buckets.size());
+        for(size_t i = 0; i < bucket_order.size(); i++) {
+            bucket_order[i] = i;
+        }
+        std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        std::vector<std::string> placed_keys(key_count);
+        std::vector<bool> is_used(key_count, false);
+        std::vector<size_t> slots;
+        for(size_t bucket : bucket_order) {
+            if(buckets[bucket].empty()) {
+                break;
+            }
+            bool is_placed(false);
+            for(uint32_t seed = 1; !is_placed; seed++) {
+                /* Two keys with the same hash are never separated, no seed is tried forever. */
+                if(seed == MAX_SEED) {
+                    throw std::invalid_argument("Unable to build the perfect hash of the translation keys. Aborting code generation.");
+                }
+                slots.clear();
+                is_placed = true;
+                for(const std::string& key : buckets[bucket]) {
+                    size_t slot(owebpp::CompiledTranslator::mix(owebpp::CompiledTranslator::hash(key), seed) % key_count);
+                    if(is_used[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        is_placed = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if(is_placed) {
+                    seeds[bucket] = seed;
+                    for(size_t i = 0; i < slots.size(); i++) {
+                        is_used[slots[i]] = true;
+                        placed_keys[slots[i]] = buckets[bucket][i];
+                    }
+                }
+            }
+        }
+        keys = placed_keys;
+        return seeds;
+    }
+
+    void TranslationCodeGenerator::writeGeneratedTranslationsFile(const std::string& output_file, const TranslationsModel& translations) {
+        std::vector<std::string> keys(collectKeys(translations));
+        std::vector<uint32_t> seeds(buildPerfectHash(keys));
+
+        std::ofstream fs(output_file, fs.trunc);
+        if(!fs.is_open()) {
+            throw std::invalid_argument("Unable to open output file: " + output_file + " Aborting code generation.");
+        }
+        /* Write file start. */
+        fs << "/* Do not edit this file, the content is automatically generated. */" << std::endl;
+        fs << "#ifndef _oweb_generated_translations_hpp" << std::endl;
+        fs << "#define _oweb_generated_translations_hpp" << std::endl;
+        fs << std::endl;
+        fs << "#include <array>" << std::endl;
+        fs << "#include <cstdint>" << std::endl;
+        fs << "#include <owebpp/CompiledTranslator.hpp>" << std::endl;
+        fs << "#include <string_view>" << std::endl;
+        fs << std::endl;
+        fs << "namespace owebpp::generated::translations {" << std::endl;
+        fs << "\tnamespace _owebpp_catalog {" << std::endl;
+
+        fs << "\t\tinline constexpr std::array<uint32_t, " << seeds.size() << "> SEEDS = {";
+        for(size_t i = 0; i < seeds.size(); i++) {
+            fs << (i == 0 ? "" : ", ") << seeds[i];
+        }
+        fs << "};" << std::endl;
+
+        fs << "\t\tinline constexpr std::array<std::string_view, " << keys.size() << "> KEYS = {" << std::endl;
+        for(const std::string& key : keys) {
+            fs << "\t\t\tstd::string_view(" << toCppStringLiteral(key) << ", " << key.size() << ")," << std::endl;
+        }
+        fs << "\t\t};" << std::endl;
+
+        /* Write the pool and the position of the translations of each locale. */
+        size_t locale_index(0);
+        for(const auto& [locale, locale_translations] : translations) {
+            std::string pool;
+            std::string positions;
+            for(const std::string& key : keys) {
+                auto translation(locale_translations.find(key));
+                if(translation == locale_translations.end()) {
+                    positions += "\t\t\t{owebpp::CompiledTranslation::MISSING, 0},\n";
+                } else {
+                    positions += "\t\t\t{" + std::to_string(pool.size()) + ", " + std::to_string(translation->second.size()) + "},\n";
+                    pool += translation->second;
+                }
+            }
+            if(pool.size() >= owebpp::CompiledTranslation::MISSING) {
+                throw std::invalid_argument("The translations of the locale " + locale + " exceed 4GB. Aborting code generation.");
+            }
+            fs << "\t\tinline constexpr std::string_view POOL_" << locale_index << " = std::string_view(" << toCppStringLiteral(pool) << ", " << pool.size() << ");" << std::endl;
+            fs << "\t\tinline constexpr std::array<owebpp::CompiledTranslation, " << keys.size() << "> TRANSLATIONS_" << locale_index << " = {{" << std::endl;
+            fs << positions;
+            fs << "\t\t}};" << std::endl;
+            locale_index++;
+        }
+
+        fs << "\t\tinline constexpr std::array<owebpp::CompiledLocale, " << translations.size() << "> LOCALES = {{" << std::endl;
+        locale_index = 0;
+        for(const auto& [locale, locale_translations] : translations) {
+            fs << "\t\t\t{" << toCppStringLiteral(locale) << ", POOL_" << locale_index << ", TRANSLATIONS_" << locale_index << "}," << std::endl;
+            locale_index++;
+        }
+        fs << "\t\t}};" << std::endl;
+        fs << "\t}" << std::endl;
+        fs << std::endl;
+
+        fs << "\t/** The translation catalog, give it to an owebpp::CompiledTranslator. */" << std::endl;
+        fs << "\tinline constexpr owebpp::CompiledCatalog CATALOG{_owebpp_catalog::SEEDS, _owebpp_catalog::KEYS, _owebpp_catalog::LOCALES};" << std::endl;
+        fs << std::endl;
+        /* Checking every key would exceed the constexpr evaluation limits of large catalogs, the first and last keys catch a change of the hash. */
+        fs << "\tstatic_assert(_owebpp_catalog::KEYS.empty() || (owebpp::CompiledTranslator::findKey(CATALOG, _owebpp_catalog::KEYS.front()) == 0" << std::endl;
+        fs << "\t\t\t\t  && owebpp::CompiledTranslator::findKey(CATALOG, _owebpp_catalog::KEYS.back()) == _owebpp_catalog::KEYS.size() - 1)," << std::endl;
+        fs << "\t\t\t\t  \"The catalog was generated for another version of owebpp::CompiledTranslator, generate it again.\");" << std::endl;
+        fs << '}' << std::endl;
+        fs << std::endl;
+        fs << "#endif" << std::endl;
+    }
+
+    void TranslationCodeGenerator::writeCatalogFile(const std::string& output_file, const TranslationsModel& translations) {
+        std::vector<std::string> keys(collectKeys(translations));
+        std::vector<uint32_t> seeds(buildPerfectHash(keys));
+        auto align = [](std::string& data, uint64_t alignment) {
+            data.resize((data.size() + alignment - 1) / alignment * alignment, '\0');
+        };
+        auto append = [](std::string& data, const auto& value) {
+            data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+
+        /* The key pool also holds the locale names. */
+        std::string key_pool;
+        std::vector<owebpp::MmapCatalog::KeyEntry> key_entries;
+        for(const std::string& key : keys) {
+            key_entries.push_back({static_cast<uint32_t>(key_pool.size()), static_cast<uint32_t>(key.size())});
+            key_pool += key;
+        }
+        std::vector<owebpp::MmapCatalog::LocaleEntry> locale_entries;
+        for(const auto& [locale, locale_translations] : translations) {
+            locale_entries.push_back({{static_cast<uint32_t>(key_pool.size()), static_cast<uint32_t>(locale.size())}, 0, 0, 0});
+            key_pool += locale;
+        }
+        if(key_pool.size() >= owebpp::CompiledTranslation::MISSING) {
+            throw std::invalid_argument("The translation keys exceed 4GB. Aborting catalog generation.");
+        }
+
+        owebpp::MmapCatalog::FileHeader header;
+        std::memcpy(header.magic, owebpp::MmapCatalog::MAGIC.data(), sizeof(header.magic));
+        header.key_count = static_cast<uint32_t>(keys.size());
+        header.bucket_count = static_cast<uint32_t>(seeds.size());
+        header.locale_count = static_cast<uint32_t>(translations.size());
+        std::string data(sizeof(header), '\0');
+        header.seeds_offset = data.size();
+        for(uint32_t seed : seeds) {
+            append(data, seed);
+        }
+        align(data, alignof(owebpp::MmapCatalog::KeyEntry));
+        header.keys_offset = data.size();
+        for(const owebpp::MmapCatalog::KeyEntry& entry : key_entries) {
+            append(data, entry);
+        }
+        header.key_pool_offset = data.size();
+        header.key_pool_size = key_pool.size();
+        data += key_pool;
+        align(data, alignof(owebpp::MmapCatalog::LocaleEntry));
+        header.locales_offset = data.size();
+        data.resize(data.size() + locale_entries.size() * sizeof(owebpp::MmapCatalog::LocaleEntry), '\0');
+
+        /* Each locale has its own pages, so a process only reads the locales it uses. */
+        size_t locale_index(0);
+        for(const auto& [locale, locale_translations] : translations) {
+            std::string pool;
+            align(data, owebpp::MmapCatalog::SECTION_ALIGNMENT);
+            locale_entries[locale_index].translations_offset = data.size();
+            for(const std::string& key : keys) {
+                auto translation(locale_translations.find(key));
+                owebpp::CompiledTranslation position{owebpp::CompiledTranslation::MISSING, 0};
+                if(translation != locale_translations.end()) {
+                    position = {static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(translation->second.size())};
+                    pool += translation->second;
+                }
+                append(data, position);
+            }
+            if(pool.size() >= owebpp::CompiledTranslation::MISSING) {
+                throw std::invalid_argument("The translations of the locale " + locale + " exceed 4GB. Aborting catalog generation.");
+            }
+            locale_entries[locale_index].pool_offset = data.size();
+            locale_entries[locale_index].pool_size = pool.size();
+            data += pool;
+            locale_index++;
+        }
+        std::memcpy(data.data(), &header, sizeof(header));
+        if(!locale_entries.empty()) {
+            std::memcpy(data.data() + header.locales_offset, locale_entries.data(), locale_entries.size() * sizeof(owebpp::MmapCatalog::LocaleEntry));
+        }
+
+        /* The running servers map the new file on their next check and keep reading the old one until then. */
+        std::string temporary_file(output_file + ".tmp");
+        std::ofstream fs(temporary_file, std::ios::binary | std::ios::trunc);
+        if(!fs.is_open()) {
+            throw std::invalid_argument("Unable to open output file: " + temporary_file + " Aborting catalog generation.");
+        }
+        fs.write(data.data(), static_cast<std::streamsize>(data.size()));
+        fs.close();
+        if(!fs) {
+            throw std::invalid_argument("Unable to write output file: " + temporary_file + " Aborting catalog generation.");
+        }
+        std::filesystem::rename(temporary_file, output_file);
+    }
+
+    std::vector<std::string> TranslationCodeGenerator::collectKeys(const TranslationsModel& translations) {
+        std::set<std::string> keys;
+        for(const auto& [locale, locale_translations] : translations) {
+            for(const auto& [key, translation] : locale_translations) {
+                keys.insert(key);
+            }
+        }
+        return std::vector<std::string>(keys.begin(), keys.end());
+    }
+
+    std::string TranslationCodeGenerator::toCppStringLiteral(const std::string& text) {
+        std::string literal("\"");
+        for(char c : text) {
+            switch(c) {
+                case '"':
+                    literal += "\\\"";
+                    break;
+                case '\\':
+                    literal += "\\\\";
+                    break;
+                case '\n':
+                    literal += "\\n";
+                    break;
+                case '\r':
+                    literal += "\\r";
+                    break;
+                case '\t':
+                    literal += "\\t";
+                    break;
+                default:
+                    if(std::isprint(static_cast<unsigned char>(c))) {
+                        literal += c;
+                    } else {
+                        /* Octal escapes are limited to three digits so they can't swallow the following characters. */
+                        char escaped[5];
+                        std::snprintf(escaped, sizeof(escaped), "\\%03o", static_cast<unsigned char>(c));
+                        literal += escaped;
+                    }
+                    break;
+            }
+        }
+        literal += '"';
+        return literal;
+    }
+
+    bool TranslationCodeGenerator::generateCode(bool is_generator_ok) {
+        try {
+            TranslationsModel translations(buildTranslationsModel(m_translations_directory));
+            checkFormats(translations);
+            writeGeneratedTranslationsFile(m_output_code_file, translations);
+            is_generator_ok = true;
+        } catch(const std::invalid_argument& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(e.what());
+            }
+            is_generator_ok = false;
+        } catch(const std::filesystem::filesystem_error& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(std::string("Error reading translations: ") + e.what());
+            }
+            is_generator_ok = false;
+        } catch(const YAML::Exception& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(std::string("Error reading translations: ") + e.what());
+            }
+            is_generator_ok = false;
+        }
+        return is_generator_ok;
+    }
+
+    bool TranslationCodeGenerator::generateCatalog(bool is_generator_ok) {
+        try {
+            TranslationsModel translations(buildTranslationsModel(m_translations_directory));
+            checkFormats(translations);
+            writeCatalogFile(m_output_code_file, translations);
+            is_generator_ok = true;
+        } catch(const std::invalid_argument& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(e.what());
+            }
+            is_generator_ok = false;
+        } catch(const std::filesystem::filesystem_error& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(std::string("Error reading translations: ") + e.what());
+            }
+            is_generator_ok = false;
+        } catch(const YAML::Exception& e) {
+            if(is_generator_ok) {
+                OWEBPP_LOG_ERROR(std::string("Error reading translations: ") + e.what());
+            }
+            is_generator_ok = false;
+        }
+        return is_generator_ok;
+    }
+}
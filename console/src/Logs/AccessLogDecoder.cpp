@@ -0,0 +1,70 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Logs/AccessLogDecoder.hpp"
+#include <owebpp/AccessLog.hpp>
+#include <owebpp/Logger.hpp>
+
+namespace owebpp::console {
+    size_t AccessLogDecoder::decode() {
+        std::ifstream input(m_input_file, std::ios::binary);
+        if(!input.is_open()) {
+            throw std::invalid_argument("Unable to open access log file: " + m_input_file);
+        }
+        std::stringstream content;
+        content << input.rdbuf();
+        std::string data(content.str());
+        if(data.compare(0, owebpp::AccessLog::MAGIC.size() + 1, std::string(1, static_cast<char>(owebpp::AccessLog::RecordType::HEADER)).append(owebpp::AccessLog::MAGIC)) != 0) {
+            throw std::invalid_argument(m_input_file + " is not a binary access log file.");
+        }
+        if(m_output_file.empty()) {
+            return decodeRecords(data, std::cout);
+        }
+        std::ofstream output(m_output_file, std::ios::trunc);
+        if(!output.is_open()) {
+            throw std::invalid_argument("Unable to open output file: " + m_output_file);
+        }
+        return decodeRecords(data, output);
+    }
+
+    size_t AccessLogDecoder::decodeRecords(std::string_view data, std::ostream& out) {
+        size_t count(0);
+        owebpp::AccessLogRecord record;
+        std::string line;
+        while(owebpp::AccessLog::readBinary(data, record)) {
+            line.clear();
+            owebpp::AccessLog::appendJson(line, record);
+            out << line;
+            count++;
+        }
+        if(!data.empty()) {
+            OWEBPP_LOG_WARNING("The last record of " + m_input_file + " is cut, it was skipped.");
+        }
+        return count;
+    }
+}
@@ -0,0 +1,252 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Logs/LogDecoder.hpp"
+#include <owebpp/BinaryLog.hpp>
+#include <owebpp/Logger.hpp>
+
+namespace owebpp::console {
+    /**
+     * Read a native endian value and advance the data.
+     * @param data The data.
+     * @param value Receives the value.
+     * @return false if the data is cut.
+     */
+    template<class T>
+    static bool readRaw(std::string_view& data, T& value) {
+        if(data.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data(), sizeof(T));
+        data.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    /**
+     * Read a string prefixed with its size and advance the data.
+     * @param data The data.
+     * @param value Receives the string, it refers to the data.
+     * @return false if the data is cut.
+     */
+    static bool readString(std::string_view& data, std::string_view& value) {
+        uint32_t size(0);
+        if(!readRaw(data, size) || data.size() < size) {
+            return false;
+        }
+        value = data.substr(0, size);
+        data.remove_prefix(size);
+        return true;
+    }
+
+    size_t LogDecoder::decode() {
+        std::ifstream input(m_input_file, std::ios::binary);
+        if(!input.is_open()) {
+            throw std::invalid_argument("Unable to open log file: " + m_input_file);
+        }
+        std::stringstream content;
+        content << input.rdbuf();
+        std::string data(content.str());
+        if(data.compare(0, owebpp::BinaryLog::MAGIC.size() + 1, std::string(1, static_cast<char>(owebpp::BinaryLog::RecordType::HEADER)).append(owebpp::BinaryLog::MAGIC)) != 0) {
+            throw std::invalid_argument(m_input_file + " is not a binary log file.");
+        }
+        if(m_output_file.empty()) {
+            return decodeRecords(data, std::cout);
+        }
+        std::ofstream output(m_output_file, std::ios::trunc);
+        if(!output.is_open()) {
+            throw std::invalid_argument("Unable to open output file: " + m_output_file);
+        }
+        return decodeRecords(data, output);
+    }
+
+    size_t LogDecoder::decodeRecords(std::string_view data, std::ostream& out) {
+        size_t count(0);
+        bool is_cut(false);
+        std::string message;
+        while(!data.empty() && !is_cut) {
+            owebpp::BinaryLog::RecordType type;
+            readRaw(data, type);
+            switch(type) {
+                case owebpp::BinaryLog::RecordType::HEADER: {
+                    is_cut = data.size() < owebpp::BinaryLog::MAGIC.size();
+                    if(!is_cut) {
+                        if(data.substr(0, owebpp::BinaryLog::MAGIC.size()) != owebpp::BinaryLog::MAGIC) {
+                            throw std::invalid_argument("Invalid header record in " + m_input_file);
+                        }
+                        data.remove_prefix(owebpp::BinaryLog::MAGIC.size());
+                        /* A new logger started writing to the file, the site ids start over. */
+                        m_sites.clear();
+                    }
+                    break;
+                }
+                case owebpp::BinaryLog::RecordType::SITE: {
+                    uint32_t id(0);
+                    uint8_t level(0);
+                    Site site;
+                    std::string_view file, function, format;
+                    is_cut = !readRaw(data, id) || !readRaw(data, level) || !readRaw(data, site.line) || !readRaw(data, site.column)
+                             || !readString(data, file) || !readString(data, function) || !readString(data, format);
+                    if(!is_cut) {
+                        site.level = static_cast<LogLevel>(level);
+                        site.file = file;
+                        site.function = function;
+                        site.format = format;
+                        m_sites[id] = std::move(site);
+                    }
+                    break;
+                }
+                case owebpp::BinaryLog::RecordType::EVENT: {
+                    uint32_t site_id(0);
+                    int64_t timestamp(0);
+                    uint8_t argument_count(0);
+                    is_cut = !readRaw(data, site_id) || !readRaw(data, timestamp) || !readRaw(data, argument_count);
+                    if(!is_cut) {
+                        auto it(m_sites.find(site_id));
+                        std::string unknown_format("<unknown log site " + std::to_string(site_id) + ">");
+                        const Site* site(it == m_sites.end() ? nullptr : &it->second);
+                        message.clear();
+                        is_cut = !decodeMessage(data, argument_count, site == nullptr ? unknown_format : site->format, message);
+                        if(!is_cut) {
+                            writeLine(out, site == nullptr ? LogLevel::LOG_ERROR : site->level, timestamp, site, message);
+                            count++;
+                        }
+                    }
+                    break;
+                }
+                case owebpp::BinaryLog::RecordType::TEXT: {
+                    uint8_t level(0);
+                    int64_t timestamp(0);
+                    std::string_view text;
+                    is_cut = !readRaw(data, level) || !readRaw(data, timestamp) || !readString(data, text);
+                    if(!is_cut) {
+                        writeLine(out, static_cast<LogLevel>(level), timestamp, nullptr, text);
+                        count++;
+                    }
+                    break;
+                }
+                default:
+                    throw std::invalid_argument("Unknown record type " + std::to_string(static_cast<int>(type)) + " in " + m_input_file);
+            }
+        }
+        if(is_cut) {
+            OWEBPP_LOG_WARNING("The last record of " + m_input_file + " is cut, it was skipped.");
+        }
+        return count;
+    }
+
+    bool LogDecoder::decodeMessage(std::string_view& data, size_t argument_count, std::string_view format, std::string& message) {
+        for(size_t i = 0; i < argument_count; i++) {
+            owebpp::BinaryLog::ArgumentType type;
+            if(!readRaw(data, type)) {
+                return false;
+            }
+            size_t placeholder(format.find("{}"));
+            std::string_view prefix(format.substr(0, placeholder));
+            format = placeholder == std::string_view::npos ? std::string_view() : format.substr(placeholder + 2);
+            std::string argument;
+            switch(type) {
+                case owebpp::BinaryLog::ArgumentType::BOOL: {
+                    uint8_t value(0);
+                    if(!readRaw(data, value)) {
+                        return false;
+                    }
+                    owebpp::BinaryLog::appendArgumentText(argument, value != 0);
+                    break;
+                }
+                case owebpp::BinaryLog::ArgumentType::SIGNED: {
+                    int64_t value(0);
+                    if(!readRaw(data, value)) {
+                        return false;
+                    }
+                    owebpp::BinaryLog::appendArgumentText(argument, value);
+                    break;
+                }
+                case owebpp::BinaryLog::ArgumentType::UNSIGNED: {
+                    uint64_t value(0);
+                    if(!readRaw(data, value)) {
+                        return false;
+                    }
+                    owebpp::BinaryLog::appendArgumentText(argument, value);
+                    break;
+                }
+                case owebpp::BinaryLog::ArgumentType::DOUBLE: {
+                    double value(0);
+                    if(!readRaw(data, value)) {
+                        return false;
+                    }
+                    owebpp::BinaryLog::appendArgumentText(argument, value);
+                    break;
+                }
+                case owebpp::BinaryLog::ArgumentType::CHAR: {
+                    char value(0);
+                    if(!readRaw(data, value)) {
+                        return false;
+                    }
+                    owebpp::BinaryLog::appendArgumentText(argument, value);
+                    break;
+                }
+                case owebpp::BinaryLog::ArgumentType::STRING: {
+                    std::string_view value;
+                    if(!readString(data, value)) {
+                        return false;
+                    }
+                    argument = value;
+                    break;
+                }
+                default:
+                    throw std::invalid_argument("Unknown log argument type " + std::to_string(static_cast<int>(type)));
+            }
+            /* Like the text logger, the extra arguments are dropped. */
+            if(placeholder != std::string_view::npos) {
+                message.append(prefix).append(argument);
+            } else {
+                message.append(prefix);
+            }
+        }
+        message.append(format);
+        return true;
+    }
+
+    void LogDecoder::writeLine(std::ostream& out, LogLevel level, int64_t timestamp, const Site* site, std::string_view message) {
+        std::time_t time(std::chrono::system_clock::to_time_t(std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp)))));
+        struct tm local_time;
+        ::localtime_r(&time, &local_time);
+        char date[64];
+        size_t date_size(std::strftime(date, sizeof(date), DEFAULT_DATE_TIME_FORMAT, &local_time));
+        out.write(date, static_cast<std::streamsize>(date_size));
+        out << " [" << owebpp::Logger::logLevelToString(level) << "]: ";
+        if(site != nullptr && !site->file.empty()) {
+            out << "file: " << site->file << '(' << site->line << ':' << site->column << ") `" << site->function << "`: ";
+        }
+        out << message << '\n';
+    }
+}
@@ -23,12 +23,20 @@
 *************************************************************************************/
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <owebpp/Logger.hpp>
 #include <thread>
+#include <vector>
 
 #include "Generation/RouteCodeGenerator.hpp"
+#include "Generation/TemplateCodeGenerator.hpp"
+#include "Generation/TranslationCodeGenerator.hpp"
+#include "Logs/AccessLogDecoder.hpp"
+#include "Logs/FlightRecorderDumper.hpp"
+#include "Logs/LogDecoder.hpp"
 
 // Mandatory logger initialization
 OWEBPP_STATIC_INIT_LOGGER
@@ -40,11 +48,106 @@ OWEBPP_STATIC_INIT_LOGGER
  */
 static void usage([[maybe_unused]] int argc, char** argv) {
     std::cout << argv[0] << std::endl;
-    std::cout << "generate:code:watch <input_yaml_file> <output_cpp_code_file> Watch the input yaml file provided for changes to generate the code for the routes from the given yaml file." << std::endl;
+    std::cout << "generate:code:watch <input_yaml_file> <output_cpp_code_file> [<templates_directory> <output_cpp_templates_file>] Watch the input yaml file provided for changes to generate the code for the routes from the given yaml file." << std::endl;
+    std::cout << "                    When a templates directory is given, the templates are also regenerated when one of its files changes." << std::endl;
     std::cout << "generate:code       <input_yaml_file> <output_cpp_code_file> Generates c++ code for the routes from the given yaml file." << std::endl;
+    std::cout << "generate:templates  <templates_directory> <output_cpp_templates_file> Compiles the templates of the given directory into c++ functions." << std::endl;
+    std::cout << "generate:translations <translations_directory> <output_cpp_translations_file> Compiles the YAML and PO catalogs of the given directory into constexpr tables served by owebpp::CompiledTranslator." << std::endl;
+    std::cout << "generate:translations:catalog <translations_directory> <output_catalog_file> Compiles the YAML and PO catalogs of the given directory into a catalog file mapped by owebpp::MmapTranslator, replaced atomically." << std::endl;
+    std::cout << "logs:decode         <binary_log_file> [<output_text_file>] Turns a log written with the binary log format into text, written to the standard output by default." << std::endl;
+    std::cout << "logs:access         <binary_access_log_file> [<output_jsonl_file>] Turns an access log written with the binary format into JSON lines, written to the standard output by default." << std::endl;
+    std::cout << "logs:dump           <flight_recorder_file> [<output_text_file>] Writes the log lines kept by a flight recorder, e.g. after a crash, to the standard output by default." << std::endl;
     std::cout << "--help                                                              Print this help text." << std::endl;
 }
 
+/** An input file or directory watched for changes and the code generation to run when it changes. */
+struct WatchedInput {
+    /** The name of the generated code, used in logs. */
+    std::string m_name;
+
+    /** The watched file or directory. */
+    std::filesystem::path m_path;
+
+    /** The file the generated code is written to. */
+    std::string m_output;
+
+    /** Generates the code, takes and returns the generator state. */
+    std::function<bool(bool)> m_generate;
+
+    /** The last write time seen for the input. */
+    std::filesystem::file_time_type m_last_write_time;
+
+    /** This variable is used to avoid printing continuously to the console in case of exceptions. */
+    bool m_is_generator_ok;
+
+    /** Whether the input couldn't be read on the last check. */
+    bool m_has_io_error;
+};
+
+/**
+ * Get the last write time of a file, or of the most recently written file of a directory.
+ * @param p The file or directory.
+ * @return The last write time.
+ */
+static std::filesystem::file_time_type getLastWriteTime(const std::filesystem::path& p) {
+    std::filesystem::file_time_type lwt(std::filesystem::last_write_time(p));
+    if(std::filesystem::is_directory(p)) {
+        for(const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(p)) {
+            lwt = std::max(lwt, entry.last_write_time());
+        }
+    }
+    return lwt;
+}
+
+/**
+ * Generate the code of the given inputs and regenerate it each time an input changes. This function never returns.
+ * @param inputs The inputs to watch.
+ */
+[[noreturn]] static void watchInputs(std::vector<WatchedInput>& inputs) {
+    for(WatchedInput& input : inputs) {
+        try {
+            input.m_last_write_time = getLastWriteTime(input.m_path);
+            OWEBPP_LOG_INFO("Generating " + input.m_name + " code from " + input.m_path.string() + " and writing to " + input.m_output);
+            input.m_is_generator_ok = input.m_generate(true);
+        } catch(const std::filesystem::filesystem_error& e) {
+            OWEBPP_LOG_ERROR("Error acquiring " + input.m_path.string() + " data.");
+            input.m_is_generator_ok = false;
+            input.m_has_io_error = true;
+        }
+    }
+
+    while(true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        for(WatchedInput& input : inputs) {
+            try {
+                std::filesystem::file_time_type tmp_lwt(getLastWriteTime(input.m_path));
+
+                /* If the generator is bugged check if we can reestablish it. */
+                if(input.m_has_io_error) {
+                    input.m_last_write_time = tmp_lwt;
+                    OWEBPP_LOG_INFO("Recovered from I/O error on input:" + input.m_path.string());
+                    input.m_is_generator_ok = input.m_generate(input.m_is_generator_ok);
+                }
+
+                if(tmp_lwt > input.m_last_write_time) {
+                    OWEBPP_LOG_INFO("Changes detected, regenerating " + input.m_name + " code.");
+                    input.m_last_write_time = tmp_lwt;
+                    input.m_is_generator_ok = input.m_generate(input.m_is_generator_ok);
+                }
+
+                input.m_has_io_error = false;
+            } catch(const std::filesystem::filesystem_error& e) {
+                input.m_has_io_error = true;
+                if(input.m_is_generator_ok) {
+                    OWEBPP_LOG_ERROR("Error acquiring " + input.m_path.string() + " data.");
+                }
+                input.m_is_generator_ok = false;
+            }
+        }
+    }
+}
+
 /**
  * Provides a list of all functions that are recognized by the program as well as the associated code.
  * @return The list of all functions that are recognized by the program as well as the associated code.
@@ -71,61 +174,123 @@ static std::shared_ptr<std::map<std::string, std::function<int(int, char**)>>> g
                 return 0;
             }
         }, {
-            "generate:code:watch",
+            "generate:templates",
             [](int ac, char** av) {
                 if(ac == 4) {
-                    owebpp::console::RouteCodeGenerator rcg(av[2], av[3]);
+                    owebpp::console::TemplateCodeGenerator tcg(av[2], av[3]);
+
+                    std::string out("Generating templates code from directory ");
+                    out += av[2];
+                    out += " and writing to ";
+                    out += av[3];
+
+                    OWEBPP_LOG_INFO(out);
+
+                    tcg.generateCode(true);
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "generate:translations",
+            [](int ac, char** av) {
+                if(ac == 4) {
+                    owebpp::console::TranslationCodeGenerator tcg(av[2], av[3]);
+
+                    std::string out("Generating translations code from directory ");
+                    out += av[2];
+                    out += " and writing to ";
+                    out += av[3];
+
+                    OWEBPP_LOG_INFO(out);
 
-                    std::filesystem::path p(av[2]);
+                    tcg.generateCode(true);
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "generate:translations:catalog",
+            [](int ac, char** av) {
+                if(ac == 4) {
+                    owebpp::console::TranslationCodeGenerator tcg(av[2], av[3]);
+
+                    std::string out("Generating translation catalog from directory ");
+                    out += av[2];
+                    out += " and writing to ";
+                    out += av[3];
 
-                    std::filesystem::file_time_type lwt;
+                    OWEBPP_LOG_INFO(out);
 
-                    /* This variable is used to avoid printing continuously to the console in case of exceptions */
-                    bool is_generator_ok(true);
-                    bool has_io_error(false);
+                    tcg.generateCatalog(true);
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "generate:code:watch",
+            [](int ac, char** av) {
+                if(ac == 4 || ac == 6) {
+                    owebpp::console::RouteCodeGenerator rcg(av[2], av[3]);
+                    std::vector<WatchedInput> inputs;
+                    inputs.push_back({"routes", av[2], av[3], [&rcg](bool is_generator_ok) { return rcg.generateCode(is_generator_ok); }, {}, true, false});
 
+                    std::unique_ptr<owebpp::console::TemplateCodeGenerator> tcg;
+                    if(ac == 6) {
+                        tcg = std::make_unique<owebpp::console::TemplateCodeGenerator>(av[4], av[5]);
+                        inputs.push_back({"templates", av[4], av[5], [&tcg](bool is_generator_ok) { return tcg->generateCode(is_generator_ok); }, {}, true, false});
+                    }
+                    watchInputs(inputs);
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "logs:decode",
+            [](int ac, char** av) {
+                if(ac == 3 || ac == 4) {
+                    owebpp::console::LogDecoder decoder(av[2], ac == 4 ? av[3] : "");
                     try {
-                        lwt = std::filesystem::last_write_time(p);
-                        std::string out("Generating routes code from configuration file ");
-                        out += p.string();
-                        out += " and writing to ";
-                        out += av[3];
-
-                        OWEBPP_LOG_INFO(out);
-                        is_generator_ok = rcg.generateCode(true);
-                    } catch(const std::filesystem::filesystem_error& e) {
-                        OWEBPP_LOG_ERROR("Error acquiring " + p.string() + " data.");
-                        is_generator_ok = false;
-                        has_io_error = true;
+                        decoder.decode();
+                    } catch(const std::invalid_argument& e) {
+                        OWEBPP_LOG_ERROR(e.what());
+                        return 1;
                     }
-
-                    while(true) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-
-                        try {
-                            std::filesystem::file_time_type tmp_lwt(std::filesystem::last_write_time(p));
-
-                            /* If the generator is bugged check if we can reestablish it. */
-                            if(has_io_error) {
-                                lwt = tmp_lwt;
-                                OWEBPP_LOG_INFO("Recovered from I/O error on input file:" + p.string());
-                                is_generator_ok = rcg.generateCode(is_generator_ok);
-                            }
-
-                            if(tmp_lwt > lwt) {
-                                OWEBPP_LOG_INFO("Changes detected, regenerating routes code.");
-                                lwt = tmp_lwt;
-                                is_generator_ok = rcg.generateCode(is_generator_ok);
-                            }
-
-                            has_io_error = false;
-                        } catch(const std::filesystem::filesystem_error& e) {
-                            has_io_error = true;
-                            if(is_generator_ok) {
-                                OWEBPP_LOG_ERROR("Error acquiring " + p.string() + " data.");
-                            }
-                            is_generator_ok = false;
-                        }
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "logs:access",
+            [](int ac, char** av) {
+                if(ac == 3 || ac == 4) {
+                    owebpp::console::AccessLogDecoder decoder(av[2], ac == 4 ? av[3] : "");
+                    try {
+                        decoder.decode();
+                    } catch(const std::invalid_argument& e) {
+                        OWEBPP_LOG_ERROR(e.what());
+                        return 1;
+                    }
+                } else {
+                    usage(ac, av);
+                }
+                return 0;
+            }
+        }, {
+            "logs:dump",
+            [](int ac, char** av) {
+                if(ac == 3 || ac == 4) {
+                    owebpp::console::FlightRecorderDumper dumper(av[2], ac == 4 ? av[3] : "");
+                    try {
+                        dumper.dump();
+                    } catch(const std::invalid_argument& e) {
+                        OWEBPP_LOG_ERROR(e.what());
+                        return 1;
                     }
                 } else {
                     usage(ac, av);
@@ -0,0 +1,69 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef ASYNC_ROUTE_CLASS_HPP
+#define ASYNC_ROUTE_CLASS_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <owebpp/Awaitables.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+#include <owebpp/Task.hpp>
+
+class AsyncRouteClass {
+    public:
+        /* Constructors */
+        AsyncRouteClass() = default;
+
+        /* Deleted constructors */
+        AsyncRouteClass(const AsyncRouteClass& o) = delete;
+        AsyncRouteClass(AsyncRouteClass&& o) = delete;
+
+        /* Deleted assignment operators */
+        AsyncRouteClass& operator=(const AsyncRouteClass& o) = delete;
+        AsyncRouteClass& operator=(AsyncRouteClass&& o) = delete;
+
+        /* Destructor */
+        virtual ~AsyncRouteClass() = default;
+
+        /**
+         * This method is called when accessing url /async_route/:delay via GET where :delay is a number of milliseconds.
+         * It is a coroutine: the event loop serves other requests while it waits, nginx runs it synchronously.
+         */
+        OWEBPP_COROUTINE_BEGIN
+        [[nodiscard]] owebpp::Task<std::shared_ptr<owebpp::Response>> asyncRouteFunction([[maybe_unused]] const std::shared_ptr<owebpp::Request>& req, const std::string& delay) {
+            unsigned int milliseconds(0);
+            std::from_chars(delay.data(), delay.data() + delay.size(), milliseconds);
+            milliseconds = std::min(milliseconds, 5000U);
+            co_await owebpp::sleepFor(std::chrono::milliseconds(milliseconds));
+            std::shared_ptr<owebpp::Response> res = std::make_shared<owebpp::Response>();
+            res->setContent("waited " + std::to_string(milliseconds) + " ms");
+            co_return res;
+        }
+        OWEBPP_COROUTINE_END
+};
+
+#endif // ASYNC_ROUTE_CLASS_HPP
@@ -26,6 +26,10 @@
 
 #include <owebpp/HttpMethod.hpp>
 #include <owebpp/HttpStatusCode.hpp>
+#include <string>
+#include <vector>
+
+#include "include/_owebpp_generated_templates.hpp"
 
 class AuthRoute {
     public:
@@ -56,11 +60,9 @@ class AuthRoute {
                     res->setContent("could not authenticate.");
                 }
             } else {
-                std::ifstream t("/usr/local/etc/owebpp-example-lib-nginx/index.html");
-                std::stringstream buffer;
-                buffer << t.rdbuf();
-
-                res->setContent(buffer.str());
+                /* The form is rendered by the code generated from templates/auth_form.html. */
+                AuthFormContext context{"URL Encoded Forms", "", {{"username", "myusername"}, {"password", "mypassword"}}};
+                owebpp::generated::templates::renderAuthForm(res->getContentBuffer(), context);
                 res->setContentType("text/html");
                 res->setSatusCode(owebpp::HttpStatusCode::OK);
             }
@@ -68,6 +70,27 @@ class AuthRoute {
         }
 
     private:
+        /* Types */
+        /** A field of the authentication form. */
+        struct AuthFormField {
+            /** The field name. */
+            std::string name;
+
+            /** The field default value. */
+            std::string value;
+        };
+
+        /** The data given to the authentication form template. */
+        struct AuthFormContext {
+            /** The page title. */
+            std::string title;
+
+            /** A message displayed above the form, hidden when empty. */
+            std::string message;
+
+            /** The form fields. */
+            std::vector<AuthFormField> fields;
+        };
 };
 
 #endif // AUTH_ROUTE_HPP
@@ -27,7 +27,7 @@
 #include <owebpp/Authenticator.hpp>
 #include <owebpp/Logger.hpp>
 
-#include "include/BasicUrlEncodedDataParser.hpp"
+#include "include/BasicURLEncodedDataParser.hpp"
 
 /** This class is an example to perform user authentication. */
 class BasicAuthenticator : public owebpp::Authenticator {
@@ -0,0 +1,58 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef FILE_ROUTE_CLASS_HPP
+#define FILE_ROUTE_CLASS_HPP
+
+#include <memory>
+#include <owebpp/ContentSource.hpp>
+#include <owebpp/RangeResponse.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+
+class FileRouteClass {
+    public:
+        /* Constructors */
+        FileRouteClass() = default;
+
+        /* Deleted constructors */
+        FileRouteClass(const FileRouteClass& o) = delete;
+        FileRouteClass(FileRouteClass&& o) = delete;
+
+        /* Deleted assignment operators */
+        FileRouteClass& operator=(const FileRouteClass& o) = delete;
+        FileRouteClass& operator=(FileRouteClass&& o) = delete;
+
+        /* Destructor */
+        virtual ~FileRouteClass() = default;
+
+        /**
+         * This method is called when accessing url /file_route via GET or HEAD.
+         * It serves a file and honors the Range header so clients can resume downloads or read parts of the file.
+         */
+        [[nodiscard]] std::shared_ptr<owebpp::Response> fileRouteFunction(const std::shared_ptr<owebpp::Request>& req) {
+            return owebpp::RangeResponseBuilder::build(req, std::make_shared<owebpp::FileContentSource>("/usr/local/etc/owebpp-example-lib-nginx/index.html"), "text/html");
+        }
+};
+
+#endif // FILE_ROUTE_CLASS_HPP
@@ -0,0 +1,79 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef POOL_ROUTE_CLASS_HPP
+#define POOL_ROUTE_CLASS_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <memory>
+#include <owebpp/HttpStatusCode.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+#include <string>
+
+class PoolRouteClass {
+    public:
+        /* Constructors */
+        PoolRouteClass() = default;
+
+        /* Deleted constructors */
+        PoolRouteClass(const PoolRouteClass& o) = delete;
+        PoolRouteClass(PoolRouteClass&& o) = delete;
+
+        /* Deleted assignment operators */
+        PoolRouteClass& operator=(const PoolRouteClass& o) = delete;
+        PoolRouteClass& operator=(PoolRouteClass&& o) = delete;
+
+        /* Destructor */
+        virtual ~PoolRouteClass() = default;
+
+        /**
+         * This method is called when accessing url /pool_route/:limit via GET where :limit is a number.
+         * It counts the primes below the limit, which is CPU heavy, so the route is declared with "executor: pool" to run on the thread pool.
+         * The count gives up once the client disconnects or the deadline of the request passes.
+         */
+        [[nodiscard]] std::shared_ptr<owebpp::Response> poolRouteFunction(const std::shared_ptr<owebpp::Request>& req, const std::string& limit) {
+            unsigned int max(0);
+            std::from_chars(limit.data(), limit.data() + limit.size(), max);
+            max = std::min(max, 10000000U);
+            unsigned int count(0);
+            for(unsigned int n = 2; n < max; n++) {
+                if(n % 65536 == 0 && req->expired()) {
+                    std::shared_ptr<owebpp::Response> res = std::make_shared<owebpp::Response>();
+                    res->setSatusCode(owebpp::HttpStatusCode::GATEWAY_TIMEOUT);
+                    return res;
+                }
+                bool is_prime(true);
+                for(unsigned int d = 2; d * d <= n && is_prime; d++) {
+                    is_prime = n % d != 0;
+                }
+                count += is_prime ? 1 : 0;
+            }
+            std::shared_ptr<owebpp::Response> res = std::make_shared<owebpp::Response>();
+            res->setContent(std::to_string(count) + " primes below " + std::to_string(max));
+            return res;
+        }
+};
+
+#endif // POOL_ROUTE_CLASS_HPP
@@ -21,8 +21,11 @@
  *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  *    SOFTWARE.
 *************************************************************************************/
+#include <chrono>
 #include <cstdio>
 #include <cstring>
+#include <fcntl.h>
+#include <owebpp/AccessLog.hpp>
 #include <owebpp/Config.hpp>
 #include <owebpp/Logger.hpp>
 #include <owebpp/Request.hpp>
@@ -30,12 +33,16 @@
 #include <owebpp/Router.hpp>
 #include <sstream>
 #include <string>
+#include <system_error>
 
 #include "include/_owebpp_generated_code.hpp"
 
 // Mandatory logger initialization
 OWEBPP_STATIC_INIT_LOGGER
 
+/** The access log of the worker, nullptr if it can't be opened. */
+static std::unique_ptr<owebpp::AccessLog> s_access_log;
+
 extern "C" {
     /* These are c files without an extern "C" guard so we include them here. */
     #include <ngx_http.h>
@@ -61,19 +68,46 @@ extern "C" {
      */
     static std::shared_ptr<owebpp::Request> buildRequest(ngx_link_func_ctx_t *ctx);
 
+    /**
+     * This method returns the time spent in a phase of a request in nanoseconds and starts the next one.
+     */
+    static uint64_t lapTime(std::chrono::steady_clock::time_point& phase_start);
+
     void ngx_link_func_init_cycle([[maybe_unused]] ngx_link_func_cycle_t* cycle) {
-        std::shared_ptr<std::ofstream> output = std::make_shared<std::ofstream>("/var/log/libnginx.log", std::ios::trunc | std::ios::out);
-        std::shared_ptr<owebpp::Logger> logger = std::make_shared<owebpp::Logger>(owebpp::LogLevel::LOG_DEBUG, output, DEFAULT_DATE_TIME_FORMAT);
+        /* The logs are written by a background thread so the worker never waits for the disk. */
+        int log_fd = ::open("/var/log/libnginx.log", O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        std::shared_ptr<owebpp::Logger> logger = log_fd < 0
+            ? std::make_shared<owebpp::Logger>(owebpp::LogLevel::LOG_INFO, nullptr, DEFAULT_DATE_TIME_FORMAT)
+            : std::make_shared<owebpp::Logger>(owebpp::LogLevel::LOG_INFO, log_fd, DEFAULT_DATE_TIME_FORMAT, owebpp::AsyncLogWriter::DEFAULT_CAPACITY, owebpp::LogOverflowPolicy::COUNT);
         owebpp::Logger::setLogger(logger);
+        /* The debug logs of all the workers are kept in a shared ring, "owebpp-console logs:dump" prints them after a crash. */
+        try {
+            logger->setFlightRecorder(std::make_shared<owebpp::FlightRecorder>("/var/log/libnginx.flight"), owebpp::LogLevel::LOG_DEBUG);
+        } catch(const std::system_error& e) {
+            OWEBPP_LOG_WARNING(e.what());
+        }
+        /* The workers append JSON lines to the same file, each line is written by a single write. */
+        try {
+            s_access_log = std::make_unique<owebpp::AccessLog>("/var/log/libnginx.access.jsonl", owebpp::AccessLogFormat::JSONL);
+        } catch(const std::system_error& e) {
+            OWEBPP_LOG_WARNING(e.what());
+        }
         OWEBPP_LOG_INFO("Starting application.");
     }
 
+    static uint64_t lapTime(std::chrono::steady_clock::time_point& phase_start) {
+        std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+        uint64_t elapsed(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start).count()));
+        phase_start = now;
+        return elapsed;
+    }
+
     static std::shared_ptr<owebpp::Request> buildRequest(ngx_link_func_ctx_t *ctx) {
         ngx_http_request_t* req = (ngx_http_request_t*)ctx->__r__;
         owebpp::HttpMethod method(owebpp::HttpMethod::HTTP_UNKNOWN);
         switch(req->method) {
             case NGX_HTTP_UNKNOWN:
-                OWEBPP_LOG_WARNING("Method [UNKNOWN] provided.");
+                OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Method [UNKNOWN] provided.");
                 method = owebpp::HttpMethod::HTTP_UNKNOWN;
                 break;
             case NGX_HTTP_GET:
@@ -122,7 +156,7 @@ extern "C" {
                 method = owebpp::HttpMethod::HTTP_TRACE;
                 break;
             default:
-                OWEBPP_LOG_WARNING("Unknown method provided: " + std::to_string(req->method));
+                OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Unknown method provided: " + std::to_string(req->method));
                 break;
         }
         std::string url((const char*)req->uri.data, req->uri.len);
@@ -145,25 +179,75 @@ extern "C" {
             get_args_map[key] = value;
         }
         std::string body((char*)ctx->req_body, ctx->req_body_len);
-        OWEBPP_LOG_INFO("Processing request: " + owebpp::HttpMethodUtils::convertMethodToString(method) + " " + url + '?'+ get_args);
+        OWEBPP_LOGF_DEBUG("Processing request: {} {}?{}", owebpp::HttpMethodUtils::convertMethodToString(method), url, get_args);
         return std::make_shared<owebpp::Request>(method, url, headers_map, get_args_map, body);
     }
 
     void entryPoint(ngx_link_func_ctx_t *ctx) {
+        owebpp::AccessLogRecord record;
+        record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::chrono::steady_clock::time_point phase_start(std::chrono::steady_clock::now());
         std::shared_ptr<owebpp::Request> request(buildRequest(ctx));
-        std::shared_ptr<owebpp::Response> response = owebpp::Router::getInstance().searchAndExecuteRoute(request);
+        record.parse_time = lapTime(phase_start);
+
+        /* The route is searched and run separately so the access log has the time of each phase. */
+        std::smatch sm;
+        /* A method the server doesn't recognize isn't searched in the routes, it is answered with 501 Not Implemented. */
+        bool is_known_method(request->getMethod() != owebpp::HttpMethod::HTTP_UNKNOWN);
+        owebpp::AbstractRoute* route = is_known_method ? owebpp::Router::getInstance().searchRoute(request, sm) : nullptr;
+        record.routing_time = lapTime(phase_start);
+        std::shared_ptr<owebpp::Response> response;
+        if(route != nullptr) {
+            response = owebpp::Router::executeRoute(*route, request, sm);
+        } else {
+            response = std::make_shared<owebpp::Response>();
+            response->setSatusCode(is_known_method ? owebpp::HttpStatusCode::NOT_FOUND : owebpp::HttpStatusCode::NOT_IMPLEMENTED);
+        }
+
+        /* ngx_link_func only accepts a complete body, streamed responses are gathered before being handed to nginx. */
+        std::string streamed_content;
+        if(response->isStreamed()) {
+            std::string chunk;
+            while(response->getContentProducer()(chunk)) {
+                streamed_content += chunk;
+            }
+        }
+        const std::string& content(response->isStreamed() ? streamed_content : response->getContent());
+        record.handler_time = lapTime(phase_start);
+
+        for(const std::string& header : response->getHeaders()) {
+            size_t separator = header.find(':');
+            if(separator != std::string::npos) {
+                size_t value_start = header.find_first_not_of(' ', separator + 1);
+                value_start = value_start == std::string::npos ? header.size() : value_start;
+                ngx_link_func_add_header_out(ctx, header.data(), separator, header.data() + value_start, header.size() - value_start);
+            }
+        }
 
         ngx_link_func_write_resp(
             ctx,
             (int)response->getSatusCode(),
             std::to_string((int)response->getSatusCode()).data(),
             (response->getContentType() + "; " + response->getCharset()).data(),
-            response->getContent().data(),
-            response->getContent().size()
+            content.data(),
+            content.size()
         );
+
+        if(s_access_log != nullptr) {
+            record.write_time = lapTime(phase_start);
+            record.request_id = s_access_log->nextRequestId(record.pid);
+            record.method = request->getMethod();
+            record.route = route != nullptr ? route->getRegexString() : std::string();
+            record.path = request->getUrl();
+            record.status = static_cast<uint16_t>(response->getSatusCode());
+            record.bytes = content.size();
+            s_access_log->write(record);
+        }
     }
 
     void ngx_link_func_exit_cycle([[maybe_unused]] ngx_link_func_cycle_t* cycle) {
         OWEBPP_LOG_INFO("Exiting application.");
+        owebpp::Logger::getInstance().flush();
+        s_access_log = nullptr;
     }
 }
@@ -0,0 +1,182 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <owebpp/Logger.hpp>
+#include <owebpp/Router.hpp>
+#include <owebpp/server/Server.hpp>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "include/_owebpp_generated_code.hpp"
+
+// Mandatory logger initialization
+OWEBPP_STATIC_INIT_LOGGER
+
+/** The request sent by the benchmark clients. */
+static const std::string BENCHMARK_REQUEST("GET /no_param_route HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+/**
+ * Send requests on one keep-alive connection until the benchmark is over.
+ * @param port The port of the server.
+ * @param pipeline_depth The number of requests sent at once before reading their responses.
+ * @param is_running Set to false when the benchmark is over.
+ * @param requests The number of completed requests.
+ */
+static void runClient(uint16_t port, unsigned int pipeline_depth, const std::atomic<bool>& is_running, std::atomic<unsigned long>& requests) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int enable(1);
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    if(fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        OWEBPP_LOG_ERROR("Can't connect to the benchmarked server.");
+        if(fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+    std::string batch;
+    for(unsigned int i = 0; i < pipeline_depth; i++) {
+        batch.append(BENCHMARK_REQUEST);
+    }
+    std::string response;
+    char buffer[16 * 1024];
+    unsigned long completed(0);
+    while(is_running.load(std::memory_order_relaxed)) {
+        if(send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size())) {
+            break;
+        }
+        /* Read until the heads and the announced contents of all the responses are received. */
+        response.clear();
+        size_t response_start(0);
+        unsigned int received_responses(0);
+        while(received_responses < pipeline_depth) {
+            size_t head_end = response.find("\r\n\r\n", response_start);
+            if(head_end != std::string::npos) {
+                size_t content_length = response.find("Content-Length: ", response_start);
+                size_t expected_end = head_end + 4;
+                if(content_length < head_end) {
+                    size_t value(0);
+                    std::from_chars(response.data() + content_length + 16, response.data() + head_end, value);
+                    expected_end += value;
+                }
+                if(response.size() >= expected_end) {
+                    response_start = expected_end;
+                    received_responses++;
+                    continue;
+                }
+            }
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if(received <= 0) {
+                close(fd);
+                requests += completed;
+                return;
+            }
+            response.append(buffer, static_cast<size_t>(received));
+        }
+        completed += pipeline_depth;
+    }
+    close(fd);
+    requests += completed;
+}
+
+/**
+ * Benchmark a server backend.
+ * @param backend The backend to benchmark.
+ * @param port The port to listen on.
+ * @param connections The number of concurrent connections.
+ * @param duration The benchmark duration.
+ * @param threads The number of server threads.
+ * @param pipeline_depth The number of requests each connection pipelines.
+ */
+static void runBenchmark(owebpp::server::ServerBackend backend, uint16_t port, unsigned int connections, std::chrono::seconds duration, unsigned int threads, unsigned int pipeline_depth) {
+    owebpp::server::ServerConfig config;
+    config.setAddress("127.0.0.1").setPort(port).setThreads(threads).setBackend(backend);
+    owebpp::server::Server server(config);
+    server.start();
+
+    std::atomic<bool> is_running(true);
+    std::atomic<unsigned long> requests(0);
+    std::vector<std::thread> clients;
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    for(unsigned int i = 0; i < connections; i++) {
+        clients.emplace_back(runClient, port, pipeline_depth, std::cref(is_running), std::ref(requests));
+    }
+    std::this_thread::sleep_for(duration);
+    is_running = false;
+    for(std::thread& client : clients) {
+        client.join();
+    }
+    std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+    server.stop();
+    server.wait();
+
+    std::cout << (server.isUsingIoUring() ? "io_uring" : "epoll")
+              << (backend == owebpp::server::ServerBackend::IO_URING && !server.isUsingIoUring() ? " (io_uring fallback)" : "")
+              << ": " << requests.load() << " requests in " << elapsed.count() << "s, "
+              << static_cast<unsigned long>(static_cast<double>(requests.load()) / elapsed.count()) << " requests/s" << std::endl;
+}
+
+/** Program entry. Compare the epoll and io_uring backends on the same route. */
+int main(int argc, char* argv[]) {
+    unsigned int connections(64);
+    std::chrono::seconds duration(5);
+    unsigned int threads(1);
+    unsigned int pipeline_depth(1);
+    try {
+        if(argc > 1) {
+            connections = static_cast<unsigned int>(std::stoul(argv[1]));
+        }
+        if(argc > 2) {
+            duration = std::chrono::seconds(std::stoul(argv[2]));
+        }
+        if(argc > 3) {
+            threads = static_cast<unsigned int>(std::stoul(argv[3]));
+        }
+        if(argc > 4) {
+            pipeline_depth = std::max(1u, static_cast<unsigned int>(std::stoul(argv[4])));
+        }
+    } catch(const std::exception& e) {
+        std::cerr << "Usage: " << argv[0] << " [connections] [seconds] [server_threads] [pipeline_depth]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    owebpp::Logger::setLogger(std::make_shared<owebpp::Logger>(owebpp::LogLevel::LOG_WARNING, nullptr, DEFAULT_DATE_TIME_FORMAT));
+
+    runBenchmark(owebpp::server::ServerBackend::EPOLL, 18888, connections, duration, threads, pipeline_depth);
+    runBenchmark(owebpp::server::ServerBackend::IO_URING, 18889, connections, duration, threads, pipeline_depth);
+    return EXIT_SUCCESS;
+}
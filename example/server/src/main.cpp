@@ -0,0 +1,101 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <owebpp/AccessLog.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/Router.hpp>
+#include <owebpp/server/Server.hpp>
+#include <string>
+#include <system_error>
+
+#include "include/_owebpp_generated_code.hpp"
+
+// Mandatory logger initialization
+OWEBPP_STATIC_INIT_LOGGER
+
+/** Program entry. Serve the example routes until SIGINT or SIGTERM is received, SIGHUP reopens the access log. */
+int main(int argc, char* argv[]) {
+    owebpp::server::ServerConfig config;
+    try {
+        if(argc > 1) {
+            config.setPort(static_cast<uint16_t>(std::stoul(argv[1])));
+        }
+        if(argc > 2) {
+            config.setThreads(static_cast<unsigned int>(std::stoul(argv[2])));
+        }
+        if(argc > 3) {
+            if(std::string(argv[3]) == "io_uring") {
+                config.setBackend(owebpp::server::ServerBackend::IO_URING);
+            } else if(std::string(argv[3]) != "epoll") {
+                throw std::invalid_argument("Unknown backend " + std::string(argv[3]));
+            }
+        }
+        if(argc > 4) {
+            /* The access log is written as JSON lines, or as binary records if its name ends with .bin. */
+            std::string path(argv[4]);
+            bool is_binary(path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0);
+            config.setAccessLog(std::make_shared<owebpp::AccessLog>(path, is_binary ? owebpp::AccessLogFormat::BINARY : owebpp::AccessLogFormat::JSONL));
+        }
+    } catch(const std::exception& e) {
+        OWEBPP_LOG_FATAL("Usage: " + std::string(argv[0]) + " [port] [threads] [epoll|io_uring] [access_log_file]");
+        return EXIT_FAILURE;
+    }
+
+    /* Block the signals before starting the threads so only the main thread receives them. */
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    owebpp::server::Server server(config);
+    try {
+        server.start();
+    } catch(const std::system_error& e) {
+        OWEBPP_LOG_FATAL(e.what());
+        return EXIT_FAILURE;
+    }
+
+    int signal;
+    sigwait(&signals, &signal);
+    while(signal == SIGHUP) {
+        if(config.getAccessLog() != nullptr) {
+            try {
+                config.getAccessLog()->reopen();
+            } catch(const std::system_error& e) {
+                OWEBPP_LOG_ERROR(e.what());
+            }
+        }
+        sigwait(&signals, &signal);
+    }
+    OWEBPP_LOG_INFO("Stopping server.");
+    server.stop();
+    server.wait();
+    return EXIT_SUCCESS;
+}
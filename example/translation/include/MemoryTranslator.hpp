@@ -24,11 +24,17 @@
 #ifndef MEMORY_TRANSLATOR_HPP
 #define MEMORY_TRANSLATOR_HPP
 
+#include <chrono>
 #include <map>
+#include <memory>
 #include <owebpp/Logger.hpp>
+#include <owebpp/Snapshot.hpp>
 #include <owebpp/Translator.hpp>
 
-/** This class uses in memory data to perform translations. */
+/**
+ * This class uses in memory data to perform translations.
+ * The translations of the locale are published as an immutable snapshot, setTranslations() replaces them while other threads translate.
+ */
 class MemoryTranslator : public owebpp::Translator {
     public:
         /* Constructors */
@@ -37,9 +43,9 @@ class MemoryTranslator : public owebpp::Translator {
          * @param local The language to use for translation.
          * @param translations The translation data to use for translations.
          */
-        MemoryTranslator(const std::string& local, std::map<std::string,std::map<std::string, std::string>> translations):
+        MemoryTranslator(const std::string& local, const std::map<std::string,std::map<std::string, std::string>>& translations):
             m_local(local),
-            m_translations(translations) {}
+            m_catalog(makeCatalog(local, translations)) {}
 
         /* Deleted constructors */
         MemoryTranslator(const MemoryTranslator& r) = delete;
@@ -60,28 +66,101 @@ class MemoryTranslator : public owebpp::Translator {
          */
         std::string getTranslatedText(const std::string& key) override {
             std::string tr(key);
+            const Translation* translation(findTranslation(m_catalog.load().get(), key));
+            if(translation != nullptr) {
+                tr = translation->text;
+            }
+            return tr;
+        }
+
+        /**
+         * Get the translation of a key parsed when the translations were set.
+         * @param key The key.
+         * @return The parsed translation, or the parsed key if no translation was found.
+         */
+        std::shared_ptr<const owebpp::TranslationFormat> getTranslationFormat(const std::string& key) override {
+            std::shared_ptr<const owebpp::TranslationFormat> format;
+            std::shared_ptr<const Catalog> catalog(m_catalog.load());
+            const Translation* translation(findTranslation(catalog.get(), key));
+            if(translation != nullptr) {
+                /* The parsed translation shares the ownership of the snapshot it belongs to. */
+                format = std::shared_ptr<const owebpp::TranslationFormat>(catalog, &translation->format);
+            } else {
+                format = std::make_shared<const owebpp::TranslationFormat>(key);
+            }
+            return format;
+        }
+
+        /**
+         * Replace the translations, the following translations use them.
+         * @param translations The translation data to use for translations.
+         */
+        void setTranslations(const std::map<std::string,std::map<std::string, std::string>>& translations) {
+            m_catalog.store(makeCatalog(m_local, translations));
+        }
+
+    private:
+        /* Types */
+        /** A translation and its parsed form. */
+        struct Translation {
+            /** The translation. */
+            std::string text{};
+
+            /** The parsed translation. */
+            owebpp::TranslationFormat format;
+        };
+
+        /** The translations of the locale indexed by key. */
+        using Catalog = std::map<std::string, Translation>;
+
+        /* Functions */
+        /**
+         * Build the catalog of a locale.
+         * @param local The locale.
+         * @param translations The translation data.
+         * @return The catalog, nullptr if the locale is not supported.
+         */
+        static std::shared_ptr<const Catalog> makeCatalog(const std::string& local, const std::map<std::string,std::map<std::string, std::string>>& translations) {
+            std::shared_ptr<Catalog> catalog;
+            auto locale_translations(translations.find(local));
+            if(locale_translations != translations.end()) {
+                catalog = std::make_shared<Catalog>();
+                for(const auto& [key, text] : locale_translations->second) {
+                    catalog->emplace(key, Translation{text, owebpp::TranslationFormat(text)});
+                }
+            }
+            return catalog;
+        }
+
+        /**
+         * Find the translation of a key.
+         * @param catalog The catalog of the locale, nullptr if the locale is not supported.
+         * @param key The key.
+         * @return The translation, nullptr if no translation was found.
+         */
+        const Translation* findTranslation(const Catalog* catalog, const std::string& key) const {
+            const Translation* translation(nullptr);
             // Check if language is supported.
-            if(m_translations.find(m_local) == m_translations.end()) {
-                OWEBPP_LOG_WARNING("Locale " + m_local + " is not supported.");
+            if(catalog == nullptr) {
+                OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Locale " + m_local + " is not supported.");
             } else {
-                std::map<std::string, std::string>& tr_map(m_translations[m_local]);
+                auto found(catalog->find(key));
                 // Check if translation  exists.
-                if(tr_map.find(key) == tr_map.end()) {
-                    OWEBPP_LOG_WARNING("Key " + key + " has no translation for locale " + m_local + ".");
+                if(found == catalog->end()) {
+                    OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Key " + key + " has no translation for locale " + m_local + ".");
                 } else {
-                    tr = m_translations[m_local][key];
+                    translation = &found->second;
                 }
             }
-            return tr;
+            return translation;
         }
 
-    private:
         /* Members */
         /** Allows to select for which language the translations should me made. */
         std::string m_local;
 
-        /** The translation data. */
-        std::map<std::string,std::map<std::string, std::string>> m_translations;
+        /** The translations of the locale, nullptr if the locale is not supported. */
+        owebpp::Snapshot<const Catalog> m_catalog;
 };
 
 #endif // MEMORY_TRANSLATOR_HPP
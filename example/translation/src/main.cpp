@@ -27,8 +27,11 @@
 #include <map>
 #include <owebpp/Logger.hpp>
 #include <MemoryTranslator.hpp>
+#include <owebpp/CompiledTranslator.hpp>
 #include <thread>
 
+#include "_owebpp_generated_translations.hpp"
+
 // Mandatory logger initialization
 OWEBPP_STATIC_INIT_LOGGER
 
@@ -67,5 +70,20 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
     std::cout << mt_us.translate("translation.with.parameters", 5, 2.5,"test") << std::endl;
     // Additional example with text and pointers.
     std::cout << mt_us.translate("translation.more.tests", "my test string", &mt_us) << std::endl;
+
+    // Translations replaced while the program runs, e.g. reloaded from a file, are used by the next calls.
+    translations["FR"]["hello.world"] = "Salut le monde.";
+    mt_fr.setTranslations(translations);
+    std::cout << mt_fr.translate("hello.world") << std::endl;
+
+    // The same translations compiled from the catalogs of the translations directory by owebpp-console generate:translations.
+    owebpp::CompiledTranslator ct_us(owebpp::generated::translations::CATALOG, "US");
+    owebpp::CompiledTranslator ct_fr(owebpp::generated::translations::CATALOG, "FR");
+    owebpp::CompiledTranslator ct_es(owebpp::generated::translations::CATALOG, "ES");
+    std::cout << ct_us.lookup("hello.world") << std::endl;
+    std::cout << ct_fr.lookup("hello.world") << std::endl;
+    std::cout << ct_es.lookup("hello.world") << std::endl;
+    std::cout << ct_es.lookup("non.existant.key") << std::endl;
+    std::cout << ct_fr.translate("translation.with.parameters", 5, 2.5) << std::endl;
     return 0;
 }
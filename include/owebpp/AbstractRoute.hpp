@@ -24,9 +24,13 @@
 #ifndef OWEBPP_ABSTRACTROUTE_HPP
 #define OWEBPP_ABSTRACTROUTE_HPP
 
+#include <chrono>
 #include <memory>
+#include <owebpp/ConcurrencyLimiter.hpp>
+#include <owebpp/Priority.hpp>
 #include <owebpp/Request.hpp>
 #include <owebpp/Response.hpp>
+#include <owebpp/Task.hpp>
 #include <regex>
 
 namespace owebpp {
@@ -44,7 +48,10 @@ namespace owebpp {
                 m_allowed_methods(allowed_methods),
                 m_url_regex_string(reg),
                 m_url_regex(m_url_regex_string),
-                m_parameters_number(parameters_number){}
+                m_parameters_number(parameters_number),
+                m_limiter(nullptr),
+                m_priority(Priority::NORMAL),
+                m_timeout(0) {}
 
             /* Deleted constructors */
             AbstractRoute() = delete;
@@ -67,6 +74,23 @@ namespace owebpp {
              */
             [[nodiscard]] virtual std::shared_ptr<Response> execute(const std::shared_ptr<owebpp::Request>& r, std::smatch& sm) = 0;
 
+            /**
+             * This method is extended by the classes in the generated code for the routes whose client code is a coroutine returning an owebpp::Task.
+             * The Task doesn't run until it is started, the URL parameters are copied before this method returns.
+             * @param r The request that was sent to the server.
+             * @param sm The object holding the information about the parameters in the URL.
+             * @return A Task producing the owebpp::Response to the given request, by default it runs execute().
+             */
+            [[nodiscard]] virtual Task<std::shared_ptr<Response>> executeAsync(const std::shared_ptr<owebpp::Request>& r, std::smatch& sm) {
+                return Task<std::shared_ptr<Response>>::fromValue(execute(r, sm));
+            }
+
+            /**
+             * Tell if the client code of this route is a coroutine, the backends with an event loop then run executeAsync() and suspend the request while it waits.
+             * @return true if the route should be run with executeAsync(), false otherwise.
+             */
+            virtual bool isAsync() const { return false; }
+
             /* Getters and Setters*/
             /**
              * Getter for the methods allowed on this route.
@@ -92,6 +116,54 @@ namespace owebpp {
              */
             size_t getParametersNumber() { return m_parameters_number; }
 
+            /**
+             * Getter for the limiter bounding the concurrency of this route.
+             * @return the limiter of this route, nullptr if the route isn't limited.
+             */
+            ConcurrencyLimiter* getLimiter() const { return m_limiter.get(); }
+
+            /**
+             * Setter for the limiter bounding the concurrency of this route, the owebpp::Router enforces it.
+             * @param limiter The limiter, nullptr to lift the limit.
+             * @return The route.
+             */
+            AbstractRoute& setLimiter(std::unique_ptr<ConcurrencyLimiter> limiter) {
+                m_limiter = std::move(limiter);
+                return *this;
+            }
+
+            /**
+             * Getter for the priority class of this route.
+             * @return the priority class of this route.
+             */
+            Priority getPriority() const { return m_priority; }
+
+            /**
+             * Setter for the priority class of this route, the owebpp::Executor serves the jobs of the higher classes first.
+             * @param priority The priority class.
+             * @return The route.
+             */
+            AbstractRoute& setPriority(Priority priority) {
+                m_priority = priority;
+                return *this;
+            }
+
+            /**
+             * Getter for the time budget of the requests of this route.
+             * @return the time budget counted from the reception of a request, 0 if the route has none.
+             */
+            std::chrono::milliseconds getTimeout() const { return m_timeout; }
+
+            /**
+             * Setter for the time budget of the requests of this route, the owebpp::Router answers the requests still waiting for the route past it with 504 Gateway Timeout.
+             * @param timeout The time budget counted from the reception of a request, 0 for none.
+             * @return The route.
+             */
+            AbstractRoute& setTimeout(std::chrono::milliseconds timeout) {
+                m_timeout = timeout;
+                return *this;
+            }
+
         private:
             /* Members */
             /** Methods allowed for the route. */
@@ -105,6 +177,15 @@ namespace owebpp {
 
             /** The number of parameters for this route. */
             size_t m_parameters_number;
+
+            /** The limiter bounding the concurrency of this route, nullptr if none. */
+            std::unique_ptr<ConcurrencyLimiter> m_limiter;
+
+            /** The priority class of this route. */
+            Priority m_priority;
+
+            /** The time budget of the requests of this route, 0 if none. */
+            std::chrono::milliseconds m_timeout;
     };
 }
 #endif // OWEBPP_ABSTRACTROUTE_HPP
@@ -0,0 +1,447 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_ACCESS_LOG_HPP
+#define OWEBPP_ACCESS_LOG_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unistd.h>
+
+#include <owebpp/AsyncLogWriter.hpp>
+#include <owebpp/HttpMethod.hpp>
+
+namespace owebpp {
+    /** Lists the formats of an owebpp::AccessLog. */
+    enum class AccessLogFormat {
+        /** One JSON object per line. */
+        JSONL,
+        /** Native endian records, "owebpp-console logs:access" turns them into JSON lines. */
+        BINARY
+    };
+
+    /** The outcome and timing of a request, the durations are in nanoseconds. */
+    struct AccessLogRecord {
+        /** The time the request was received in nanoseconds since the epoch. */
+        int64_t timestamp{0};
+
+        /** The id of the request, unique in the process. */
+        uint64_t request_id{0};
+
+        /** The id of the process which handled the request, with request_id it identifies the request among the processes writing the same log. */
+        uint32_t pid{0};
+
+        /** The method of the request. */
+        HttpMethod method{HttpMethod::HTTP_UNKNOWN};
+
+        /** The regex of the route which ran the request, empty if none matched. */
+        std::string route{};
+
+        /** The path of the request. */
+        std::string path{};
+
+        /** The status code of the response. */
+        uint16_t status{0};
+
+        /** The number of bytes sent, head included. */
+        uint64_t bytes{0};
+
+        /** The time spent receiving and parsing the request. */
+        uint64_t parse_time{0};
+
+        /** The time spent searching the route. */
+        uint64_t routing_time{0};
+
+        /** The time spent in the route, from its start to its response. */
+        uint64_t handler_time{0};
+
+        /** The time spent sending the response. */
+        uint64_t write_time{0};
+    };
+
+    /**
+     * Writes a record per request to a file, from a background thread through the lock-free ring of an owebpp::AsyncLogWriter.
+     * Requests are sampled, the responses with a 5xx status code are always written.
+     * The file is opened with O_APPEND, reopen() makes the log continue in a new file once the current one was renamed by a log rotation.
+     */
+    class AccessLog {
+        public:
+            /* Constants */
+            /** The magic string of the HEADER record a binary access log file starts with. */
+            static constexpr std::string_view MAGIC = "OWEBACC2";
+
+            /* Types */
+            /** Lists the binary record types, each record starts with its type. */
+            enum class RecordType : uint8_t {
+                /** The start of a file, followed by MAGIC. */
+                HEADER = 0,
+                /** An owebpp::AccessLogRecord. */
+                REQUEST = 1
+            };
+
+            /* Constructors */
+            /**
+             * Open the access log file and start its writer.
+             * @param path The path of the file, it is created if needed and appended to.
+             * @param format The format of the records.
+             * @param sample_rate One request out of sample_rate is written, 1 writes them all.
+             * @param capacity The number of records waiting to be written the log holds, the others are dropped.
+             * @throw std::system_error If the file can't be opened.
+             */
+            AccessLog(const std::string& path, AccessLogFormat format, uint32_t sample_rate = 1, size_t capacity = AsyncLogWriter::DEFAULT_CAPACITY):
+                m_path(path),
+                m_format(format),
+                m_sample_rate(sample_rate == 0 ? 1 : sample_rate),
+                m_fd(openFile(path, format)),
+                m_reopen_mutex(),
+                m_writer(std::make_unique<AsyncLogWriter>(m_fd, capacity, LogOverflowPolicy::DROP)),
+                m_next_request_id(1) {}
+
+            /* Deleted constructors */
+            AccessLog() = delete;
+            AccessLog(const AccessLog& o) = delete;
+            AccessLog(AccessLog&& o) = delete;
+
+            /* Deleted assignment operators */
+            AccessLog& operator=(const AccessLog& o) = delete;
+            AccessLog& operator=(AccessLog&& o) = delete;
+
+            /* Destructor */
+            /** Write the queued records and close the file. */
+            ~AccessLog() {
+                m_writer = nullptr;
+                ::close(m_fd);
+            }
+
+            /* Functions */
+            /**
+             * Get the id of a new request, each thread reserves a block of ids so they don't contend on a counter.
+             * The ids start at 1 in each process, the requests of processes writing the same log are told apart by their process id.
+             * @param pid Receives the id of the process, read when the block is reserved.
+             * @return The id.
+             */
+            uint64_t nextRequestId(uint32_t& pid) {
+                thread_local const AccessLog* owner(nullptr);
+                thread_local uint64_t next(0);
+                thread_local uint64_t end(0);
+                thread_local uint32_t process_id(0);
+                if(owner != this || next == end) {
+                    owner = this;
+                    next = m_next_request_id.fetch_add(REQUEST_ID_BLOCK, std::memory_order_relaxed);
+                    end = next + REQUEST_ID_BLOCK;
+                    process_id = static_cast<uint32_t>(::getpid());
+                }
+                pid = process_id;
+                return next++;
+            }
+
+            /**
+             * Tell if the record of a request must be written, each thread keeps one request out of the sample rate.
+             * @param status The status code of the response.
+             * @return true if the record must be written.
+             */
+            bool isSampled(uint16_t status) const {
+                thread_local uint32_t counter(0);
+                return status >= 500 || m_sample_rate == 1 || ++counter % m_sample_rate == 0;
+            }
+
+            /**
+             * Queue a record if it is sampled, this function can be called from any thread.
+             * @param record The record.
+             */
+            void write(const AccessLogRecord& record) {
+                if(isSampled(record.status)) {
+                    thread_local std::string buffer;
+                    buffer.clear();
+                    if(m_format == AccessLogFormat::BINARY) {
+                        appendBinary(buffer, record);
+                    } else {
+                        appendJson(buffer, record);
+                    }
+                    m_writer->push(buffer);
+                }
+            }
+
+            /**
+             * Reopen the file at its path, e.g. from the thread handling SIGHUP once a log rotation renamed it.
+             * The queued records are written to the previous file, which is then closed.
+             * @throw std::system_error If the file can't be opened, the log then continues in the previous file.
+             */
+            void reopen() {
+                std::lock_guard<std::mutex> lock(m_reopen_mutex);
+                int previous_fd(m_fd);
+                m_fd = openFile(m_path, m_format);
+                m_writer->exchangeFd(m_fd);
+                m_writer->flush();
+                ::close(previous_fd);
+            }
+
+            /** Wait until the records queued before the call are written. */
+            void flush() { m_writer->flush(); }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the number of records dropped because too many were waiting to be written.
+             * @return the number of dropped records.
+             */
+            uint64_t getDroppedCount() const { return m_writer->getDroppedCount(); }
+
+            /**
+             * Append a record as a JSON line.
+             * @param out The output buffer.
+             * @param record The record.
+             */
+            static void appendJson(std::string& out, const AccessLogRecord& record) {
+                out.append("{\"ts\":");
+                appendNumber(out, record.timestamp);
+                out.append(",\"id\":");
+                appendNumber(out, record.request_id);
+                out.append(",\"pid\":");
+                appendNumber(out, record.pid);
+                out.append(",\"method\":\"");
+                out.append(record.method == HttpMethod::HTTP_UNKNOWN ? "-" : HttpMethodUtils::convertMethodToString(record.method));
+                out.append("\",\"route\":");
+                appendJsonString(out, record.route);
+                out.append(",\"path\":");
+                appendJsonString(out, record.path);
+                out.append(",\"status\":");
+                appendNumber(out, record.status);
+                out.append(",\"bytes\":");
+                appendNumber(out, record.bytes);
+                out.append(",\"parse_ns\":");
+                appendNumber(out, record.parse_time);
+                out.append(",\"routing_ns\":");
+                appendNumber(out, record.routing_time);
+                out.append(",\"handler_ns\":");
+                appendNumber(out, record.handler_time);
+                out.append(",\"write_ns\":");
+                appendNumber(out, record.write_time);
+                out.append("}\n");
+            }
+
+            /**
+             * Append a REQUEST record.
+             * @param out The output buffer.
+             * @param record The record.
+             */
+            static void appendBinary(std::string& out, const AccessLogRecord& record) {
+                appendRaw(out, RecordType::REQUEST);
+                appendRaw(out, record.timestamp);
+                appendRaw(out, record.request_id);
+                appendRaw(out, record.pid);
+                appendRaw(out, static_cast<uint64_t>(record.method));
+                appendRaw(out, record.status);
+                appendRaw(out, record.bytes);
+                appendRaw(out, record.parse_time);
+                appendRaw(out, record.routing_time);
+                appendRaw(out, record.handler_time);
+                appendRaw(out, record.write_time);
+                appendString(out, record.route);
+                appendString(out, record.path);
+            }
+
+            /**
+             * Read the next record of a binary access log, the HEADER records are skipped.
+             * @param data The data, it starts after the record once read.
+             * @param record Receives the record.
+             * @return false if there is no complete record left.
+             * @throw std::invalid_argument If a record is invalid.
+             */
+            static bool readBinary(std::string_view& data, AccessLogRecord& record) {
+                RecordType type(RecordType::HEADER);
+                bool is_complete(readRaw(data, type));
+                while(is_complete && type == RecordType::HEADER) {
+                    if(data.size() >= MAGIC.size() && data.substr(0, MAGIC.size()) != MAGIC) {
+                        throw std::invalid_argument("Invalid access log header record.");
+                    }
+                    is_complete = data.size() > MAGIC.size();
+                    data.remove_prefix(std::min(data.size(), MAGIC.size()));
+                    is_complete = is_complete && readRaw(data, type);
+                }
+                if(is_complete) {
+                    if(type != RecordType::REQUEST) {
+                        throw std::invalid_argument("Unknown access log record type " + std::to_string(static_cast<int>(type)) + ".");
+                    }
+                    uint64_t method(0);
+                    is_complete = readRaw(data, record.timestamp) && readRaw(data, record.request_id) && readRaw(data, record.pid) && readRaw(data, method) && readRaw(data, record.status)
+                                  && readRaw(data, record.bytes) && readRaw(data, record.parse_time) && readRaw(data, record.routing_time)
+                                  && readRaw(data, record.handler_time) && readRaw(data, record.write_time)
+                                  && readString(data, record.route) && readString(data, record.path);
+                    record.method = static_cast<HttpMethod>(method);
+                }
+                return is_complete;
+            }
+
+        private:
+            /* Constants */
+            /** The number of request ids a thread reserves at once. */
+            static constexpr uint64_t REQUEST_ID_BLOCK = 1024;
+
+            /* Functions */
+            /**
+             * Open the file of the log, a binary file starts with a HEADER record written before any record can be queued.
+             * @param path The path of the file.
+             * @param format The format of the records.
+             * @return The file descriptor.
+             * @throw std::system_error If the file can't be opened.
+             */
+            static int openFile(const std::string& path, AccessLogFormat format) {
+                int fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644));
+                if(fd < 0) {
+                    throw std::system_error(errno, std::system_category(), "Unable to open access log " + path);
+                }
+                if(format == AccessLogFormat::BINARY) {
+                    std::string header;
+                    appendRaw(header, RecordType::HEADER);
+                    header.append(MAGIC);
+                    if(::write(fd, header.data(), header.size()) != static_cast<ssize_t>(header.size())) {
+                        int error(errno);
+                        ::close(fd);
+                        throw std::system_error(error, std::system_category(), "Unable to write access log " + path);
+                    }
+                }
+                return fd;
+            }
+
+            /**
+             * Append a decimal number.
+             * @param out The output buffer.
+             * @param value The number.
+             */
+            template<class T>
+            static void appendNumber(std::string& out, T value) {
+                char buffer[24];
+                out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+            }
+
+            /**
+             * Append a quoted JSON string.
+             * @param out The output buffer.
+             * @param value The string.
+             */
+            static void appendJsonString(std::string& out, std::string_view value) {
+                static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+                out.push_back('"');
+                for(char c : value) {
+                    if(c == '"' || c == '\\') {
+                        out.push_back('\\');
+                        out.push_back(c);
+                    } else if(static_cast<unsigned char>(c) < 0x20) {
+                        out.append("\\u00");
+                        out.push_back(HEX_DIGITS[(c >> 4) & 0xF]);
+                        out.push_back(HEX_DIGITS[c & 0xF]);
+                    } else {
+                        out.push_back(c);
+                    }
+                }
+                out.push_back('"');
+            }
+
+            /**
+             * Append a native endian value.
+             * @param out The output buffer.
+             * @param value The value.
+             */
+            template<class T>
+            static void appendRaw(std::string& out, T value) {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            /**
+             * Append a string prefixed with its size.
+             * @param out The output buffer.
+             * @param value The string.
+             */
+            static void appendString(std::string& out, std::string_view value) {
+                appendRaw(out, static_cast<uint32_t>(value.size()));
+                out.append(value);
+            }
+
+            /**
+             * Read a native endian value and advance the data.
+             * @param data The data.
+             * @param value Receives the value.
+             * @return false if the data is cut.
+             */
+            template<class T>
+            static bool readRaw(std::string_view& data, T& value) {
+                if(data.size() < sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&value, data.data(), sizeof(T));
+                data.remove_prefix(sizeof(T));
+                return true;
+            }
+
+            /**
+             * Read a string prefixed with its size and advance the data.
+             * @param data The data.
+             * @param value Receives the string.
+             * @return false if the data is cut.
+             */
+            static bool readString(std::string_view& data, std::string& value) {
+                uint32_t size(0);
+                if(!readRaw(data, size) || data.size() < size) {
+                    return false;
+                }
+                value.assign(data.substr(0, size));
+                data.remove_prefix(size);
+                return true;
+            }
+
+            /* Members */
+            /** The path of the file. */
+            std::string m_path;
+
+            /** The format of the records. */
+            AccessLogFormat m_format;
+
+            /** One request out of m_sample_rate is written. */
+            uint32_t m_sample_rate;
+
+            /** The file descriptor of the current file, protected by m_reopen_mutex. */
+            int m_fd;
+
+            /** Serializes the calls to reopen(). */
+            std::mutex m_reopen_mutex;
+
+            /** The writer. */
+            std::unique_ptr<AsyncLogWriter> m_writer;
+
+            /** The first request id of the next block of ids. */
+            std::atomic<uint64_t> m_next_request_id;
+    };
+}
+
+#endif // OWEBPP_ACCESS_LOG_HPP
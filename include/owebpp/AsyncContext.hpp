@@ -0,0 +1,136 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_ASYNC_CONTEXT_HPP
+#define OWEBPP_ASYNC_CONTEXT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <thread>
+
+namespace owebpp {
+    /** An operation a coroutine is suspended on, it stays in the coroutine frame until the AsyncContext completes it. */
+    struct alignas(8) AsyncOperation {
+        /** The suspended coroutine, resumed by the AsyncContext once the operation is over. */
+        std::coroutine_handle<> handle = nullptr;
+
+        /** The result of the operation, a negated errno value on failure. */
+        int64_t result = 0;
+    };
+
+    /**
+     * The interface of the event loops able to resume suspended coroutines, the awaitables of owebpp/Awaitables.hpp submit their operations to the context of the calling thread.
+     * Every function but post() is called on the context thread and completes the operation later on that thread, never before returning.
+     */
+    class AsyncContext {
+        public:
+            /* Constructors */
+            AsyncContext(): m_expected_posts(0) {}
+
+            /* Deleted constructors */
+            AsyncContext(const AsyncContext& o) = delete;
+            AsyncContext(AsyncContext&& o) = delete;
+
+            /* Deleted assignment operators */
+            AsyncContext& operator=(const AsyncContext& o) = delete;
+            AsyncContext& operator=(AsyncContext&& o) = delete;
+
+            /* Destructor */
+            virtual ~AsyncContext() = default;
+
+            /* Functions */
+            /**
+             * Complete an operation at the given time.
+             * @param deadline The time to complete the operation at.
+             * @param operation The operation, its result is 0.
+             */
+            virtual void wakeAt(std::chrono::steady_clock::time_point deadline, AsyncOperation& operation) = 0;
+
+            /**
+             * Complete an operation once a file descriptor is ready.
+             * @param fd The file descriptor, it must be pollable.
+             * @param events The poll events to wait for, POLLIN and/or POLLOUT.
+             * @param operation The operation, its result is the received poll events.
+             */
+            virtual void waitFor(int fd, short events, AsyncOperation& operation) = 0;
+
+            /**
+             * Read from a file at the given offset.
+             * @param fd The file descriptor.
+             * @param buffer The buffer receiving the data, it must stay valid until the operation completes.
+             * @param size The number of bytes to read.
+             * @param offset The file offset to read at.
+             * @param operation The operation, its result is the number of bytes read.
+             */
+            virtual void read(int fd, void* buffer, size_t size, off_t offset, AsyncOperation& operation) = 0;
+
+            /**
+             * Complete an operation from another thread, e.g. a job of the owebpp::Executor, the coroutine is resumed on the context thread.
+             * This function and expectPost() are the only ones that can be called from any thread, each call must follow an expectPost() call.
+             * @param operation The operation, its result is set by the caller beforehand.
+             */
+            virtual void post(AsyncOperation& operation) = 0;
+
+            /** Announce a post() call to come, the context waits for the announced calls before being destroyed. */
+            void expectPost() { m_expected_posts.fetch_add(1, std::memory_order_relaxed); }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the context running on the calling thread.
+             * @return The context of the thread, nullptr if the thread doesn't run any, the awaitables then block.
+             */
+            static AsyncContext* getCurrent() { return s_current; }
+
+            /**
+             * Setter for the context running on the calling thread.
+             * @param context The context of the thread, nullptr if the thread doesn't run any.
+             */
+            static void setCurrent(AsyncContext* context) { s_current = context; }
+
+        protected:
+            /* Functions */
+            /** Account for a completed post() call, this must be the last access of post() to the context. */
+            void onPosted() { m_expected_posts.fetch_sub(1, std::memory_order_release); }
+
+            /** Wait for the announced post() calls, the derived destructors call it before releasing what post() uses. */
+            void waitForExpectedPosts() const {
+                while(m_expected_posts.load(std::memory_order_acquire) > 0) {
+                    std::this_thread::yield();
+                }
+            }
+
+        private:
+            /* Members */
+            /** The number of announced post() calls that didn't return yet. */
+            std::atomic<size_t> m_expected_posts;
+
+            /** The context running on the thread. */
+            static inline thread_local AsyncContext* s_current = nullptr;
+    };
+}
+
+#endif // OWEBPP_ASYNC_CONTEXT_HPP
@@ -0,0 +1,366 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_ASYNC_LOG_WRITER_HPP
+#define OWEBPP_ASYNC_LOG_WRITER_HPP
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+namespace owebpp {
+    /** Lists what happens to a log record when the ring of an owebpp::AsyncLogWriter is full. */
+    enum class LogOverflowPolicy {
+        /** The record is dropped. */
+        DROP,
+        /** The logging thread waits for the writer to make room. */
+        BLOCK,
+        /** The record is dropped and the writer reports the number of dropped records with the next batch. */
+        COUNT
+    };
+
+    /**
+     * Writes formatted log lines to a file descriptor from a background thread, so the logging threads never wait for the disk.
+     * The lines go through a bounded lock-free ring any thread can push to, and the writer gathers the queued lines with a single writev call.
+     * The lines are copied into the buffers of the ring, which the writer swaps with its own, so the buffers are reused once they grew to the size of the lines.
+     */
+    class AsyncLogWriter {
+        public:
+            /* Constants */
+            /** The default number of lines the ring holds. */
+            static constexpr size_t DEFAULT_CAPACITY = 8192;
+
+            /* Constructors */
+            /**
+             * Construct the writer and start its thread.
+             * @param fd The file descriptor the lines are written to, it isn't closed by the writer.
+             * @param capacity The number of lines the ring holds, rounded up to a power of two.
+             * @param overflow_policy What happens to a line pushed while the ring is full.
+             * @param format_drop_report Formats the report of the dropped lines written with the COUNT policy, nullptr for a text line.
+             */
+            AsyncLogWriter(int fd, size_t capacity, LogOverflowPolicy overflow_policy, std::function<std::string(uint64_t)> format_drop_report = nullptr):
+                m_fd(fd),
+                m_overflow_policy(overflow_policy),
+                m_format_drop_report(std::move(format_drop_report)),
+                m_slots(nullptr),
+                m_mask(roundCapacity(capacity) - 1),
+                m_enqueue_position(0),
+                m_dequeue_position(0),
+                m_written_position(0),
+                m_dropped_count(0),
+                m_reported_drops(0),
+                m_is_sleeping(false),
+                m_mutex(),
+                m_wakeup(),
+                m_flushed(),
+                m_stopping(false),
+                m_batch(),
+                m_thread() {
+                m_slots = std::make_unique<Slot[]>(m_mask + 1);
+                for(size_t i = 0; i <= m_mask; i++) {
+                    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                m_thread = std::thread([this]() { run(); });
+            }
+
+            /* Deleted constructors */
+            AsyncLogWriter() = delete;
+            AsyncLogWriter(const AsyncLogWriter& o) = delete;
+            AsyncLogWriter(AsyncLogWriter&& o) = delete;
+
+            /* Deleted assignment operators */
+            AsyncLogWriter& operator=(const AsyncLogWriter& o) = delete;
+            AsyncLogWriter& operator=(AsyncLogWriter&& o) = delete;
+
+            /* Destructor */
+            /** Write the queued lines and stop the thread. */
+            ~AsyncLogWriter() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wakeup.notify_one();
+                m_thread.join();
+            }
+
+            /* Functions */
+            /**
+             * Queue a line, this function can be called from any thread.
+             * @param line The line, including its line feed.
+             * @return true if the line was queued, false if it was dropped.
+             */
+            bool push(std::string_view line) { return push(line, m_overflow_policy); }
+
+            /**
+             * Queue a line with a given overflow policy, e.g. BLOCK for data the next lines can't be read without.
+             * @param line The line, including its line feed.
+             * @param overflow_policy What happens to the line if the ring is full.
+             * @return true if the line was queued, false if it was dropped.
+             */
+            bool push(std::string_view line, LogOverflowPolicy overflow_policy) {
+                size_t position(m_enqueue_position.load(std::memory_order_relaxed));
+                while(true) {
+                    Slot& slot(m_slots[position & m_mask]);
+                    size_t sequence(slot.sequence.load(std::memory_order_acquire));
+                    if(sequence == position) {
+                        if(m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            slot.line.assign(line);
+                            slot.sequence.store(position + 1, std::memory_order_release);
+                            wakeWriter();
+                            return true;
+                        }
+                    } else if(sequence < position + 1) {
+                        /* The slot still holds the line pushed one lap ago, the ring is full. */
+                        if(overflow_policy != LogOverflowPolicy::BLOCK) {
+                            m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+                            return false;
+                        }
+                        wakeWriter();
+                        std::this_thread::yield();
+                        position = m_enqueue_position.load(std::memory_order_relaxed);
+                    } else {
+                        position = m_enqueue_position.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Wait until the lines queued before the call are written. */
+            void flush() {
+                size_t target(m_enqueue_position.load(std::memory_order_acquire));
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.notify_one();
+                m_flushed.wait(lock, [this, target]() { return m_written_position.load(std::memory_order_acquire) >= target; });
+            }
+
+            /**
+             * Make the writer write to another file descriptor, e.g. a log file reopened after being rotated.
+             * The lines queued before the call may still be written to the previous file descriptor, it can be closed once flush() returns.
+             * @param fd The new file descriptor, it isn't closed by the writer.
+             * @return The previous file descriptor.
+             */
+            int exchangeFd(int fd) { return m_fd.exchange(fd, std::memory_order_acq_rel); }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the number of dropped lines.
+             * @return the number of lines dropped since the writer started.
+             */
+            uint64_t getDroppedCount() const { return m_dropped_count.load(std::memory_order_relaxed); }
+
+        private:
+            /* Constants */
+            /** The maximum number of lines gathered by a writev call. */
+            static constexpr size_t MAX_BATCH = 64;
+
+            /** The writer wakes up at least this often, a missed wake up only delays the lines. */
+            static constexpr std::chrono::milliseconds IDLE_TIMEOUT = std::chrono::milliseconds(100);
+
+            /* Types */
+            /** A slot of the ring. */
+            struct Slot {
+                /** The position the slot can be pushed at, or that position + 1 once it holds a line. */
+                std::atomic<size_t> sequence{0};
+
+                /** The line. */
+                std::string line{};
+            };
+
+            /* Functions */
+            /**
+             * Round a capacity up to a power of two.
+             * @param capacity The capacity.
+             * @return The rounded capacity, at least 2.
+             */
+            static size_t roundCapacity(size_t capacity) {
+                size_t rounded(2);
+                while(rounded < capacity) {
+                    rounded <<= 1;
+                }
+                return rounded;
+            }
+
+            /** Wake the writer up if it sleeps, only the first thread seeing it asleep pays for the notification. */
+            void wakeWriter() {
+                if(m_is_sleeping.load(std::memory_order_seq_cst) && m_is_sleeping.exchange(false, std::memory_order_seq_cst)) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_wakeup.notify_one();
+                }
+            }
+
+            /** The writer loop: write the queued lines in batches and sleep when the ring is empty. */
+            void run() {
+                while(true) {
+                    size_t count(takeBatch());
+                    if(count > 0) {
+                        write(count);
+                        {
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            m_written_position.store(m_dequeue_position, std::memory_order_release);
+                        }
+                        m_flushed.notify_all();
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    if(m_stopping) {
+                        break;
+                    }
+                    m_is_sleeping.store(true, std::memory_order_seq_cst);
+                    if(!isReadable()) {
+                        m_wakeup.wait_for(lock, IDLE_TIMEOUT);
+                    }
+                    m_is_sleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Tell if the next slot holds a line.
+             * @return true if a line can be taken.
+             */
+            bool isReadable() const {
+                return m_slots[m_dequeue_position & m_mask].sequence.load(std::memory_order_acquire) == m_dequeue_position + 1;
+            }
+
+            /**
+             * Take the queued lines into the batch, preceded by the report of the lines dropped since the last batch.
+             * @return The number of lines in the batch.
+             */
+            size_t takeBatch() {
+                size_t count(0);
+                if(m_overflow_policy == LogOverflowPolicy::COUNT) {
+                    uint64_t dropped(m_dropped_count.load(std::memory_order_relaxed));
+                    if(dropped != m_reported_drops) {
+                        m_batch[count++] = m_format_drop_report != nullptr
+                            ? m_format_drop_report(dropped - m_reported_drops)
+                            : "[owebpp] " + std::to_string(dropped - m_reported_drops) + " log records dropped, the log ring is full.\n";
+                        m_reported_drops = dropped;
+                    }
+                }
+                while(count <= MAX_BATCH && isReadable()) {
+                    Slot& slot(m_slots[m_dequeue_position & m_mask]);
+                    m_batch[count++].swap(slot.line);
+                    slot.sequence.store(m_dequeue_position + m_mask + 1, std::memory_order_release);
+                    m_dequeue_position++;
+                }
+                return count;
+            }
+
+            /**
+             * Write the lines of the batch with writev, short writes are resumed.
+             * @param count The number of lines in the batch.
+             */
+            void write(size_t count) {
+                iovec iovecs[MAX_BATCH + 1];
+                for(size_t i = 0; i < count; i++) {
+                    iovecs[i].iov_base = m_batch[i].data();
+                    iovecs[i].iov_len = m_batch[i].size();
+                }
+                iovec* next(iovecs);
+                while(count > 0) {
+                    ssize_t written(::writev(m_fd.load(std::memory_order_acquire), next, static_cast<int>(count)));
+                    if(written < 0) {
+                        if(errno == EINTR) {
+                            continue;
+                        }
+                        /* There is nowhere to report the error, the batch is lost. */
+                        return;
+                    }
+                    size_t remaining(static_cast<size_t>(written));
+                    while(count > 0 && remaining >= next->iov_len) {
+                        remaining -= next->iov_len;
+                        next++;
+                        count--;
+                    }
+                    if(count > 0) {
+                        next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+                        next->iov_len -= remaining;
+                    }
+                }
+            }
+
+            /* Members */
+            /** The file descriptor the lines are written to. */
+            std::atomic<int> m_fd;
+
+            /** What happens to a line pushed while the ring is full. */
+            LogOverflowPolicy m_overflow_policy;
+
+            /** Formats the report of the dropped lines, nullptr for a text line. */
+            std::function<std::string(uint64_t)> m_format_drop_report;
+
+            /** The ring. */
+            std::unique_ptr<Slot[]> m_slots;
+
+            /** The capacity of the ring minus one. */
+            size_t m_mask;
+
+            /** The position the next line is pushed at. */
+            alignas(64) std::atomic<size_t> m_enqueue_position;
+
+            /** The position the writer takes the next line at, only used by the writer. */
+            alignas(64) size_t m_dequeue_position;
+
+            /** The position up to which the lines are written. */
+            std::atomic<size_t> m_written_position;
+
+            /** The number of dropped lines. */
+            std::atomic<uint64_t> m_dropped_count;
+
+            /** The number of dropped lines already reported, only used by the writer. */
+            uint64_t m_reported_drops;
+
+            /** Whether the writer sleeps, the logging threads then wake it up. */
+            std::atomic<bool> m_is_sleeping;
+
+            /** The mutex the writer sleeps with. */
+            std::mutex m_mutex;
+
+            /** Wakes the writer up. */
+            std::condition_variable m_wakeup;
+
+            /** Notified when a batch is written. */
+            std::condition_variable m_flushed;
+
+            /** Whether the writer is stopping, protected by m_mutex. */
+            bool m_stopping;
+
+            /** The lines being written, only used by the writer, their buffers go back to the ring. */
+            std::array<std::string, MAX_BATCH + 1> m_batch;
+
+            /** The writer thread. */
+            std::thread m_thread;
+    };
+}
+
+#endif // OWEBPP_ASYNC_LOG_WRITER_HPP
@@ -0,0 +1,175 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_ASYNC_SOCKET_HPP
+#define OWEBPP_ASYNC_SOCKET_HPP
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <owebpp/Awaitables.hpp>
+#include <owebpp/Task.hpp>
+
+namespace owebpp {
+    /**
+     * A non blocking TCP client socket whose operations suspend the awaiting coroutine instead of blocking the event loop.
+     * The socket must outlive the Tasks returned by its functions.
+     */
+    class AsyncSocket final {
+        public:
+            /* Constructors */
+            /** Construct a socket that isn't connected yet. */
+            AsyncSocket(): m_fd(-1) {}
+
+            /* Deleted constructors */
+            AsyncSocket(const AsyncSocket& o) = delete;
+            AsyncSocket(AsyncSocket&& o) = delete;
+
+            /* Deleted assignment operators */
+            AsyncSocket& operator=(const AsyncSocket& o) = delete;
+            AsyncSocket& operator=(AsyncSocket&& o) = delete;
+
+            /* Destructor */
+            ~AsyncSocket() {
+                close();
+            }
+
+            /* Functions */
+            OWEBPP_COROUTINE_BEGIN
+            /**
+             * Connect to a server.
+             * @param address The numeric IPv4 or IPv6 address of the server, host names are not resolved.
+             * @param port The port of the server.
+             * @return A Task producing 0 on success or a negated errno value.
+             */
+            Task<int64_t> connect(std::string address, uint16_t port) {
+                sockaddr_storage storage{};
+                socklen_t storage_size(0);
+                sockaddr_in* address_v4(reinterpret_cast<sockaddr_in*>(&storage));
+                sockaddr_in6* address_v6(reinterpret_cast<sockaddr_in6*>(&storage));
+                if(::inet_pton(AF_INET, address.c_str(), &address_v4->sin_addr) == 1) {
+                    address_v4->sin_family = AF_INET;
+                    address_v4->sin_port = htons(port);
+                    storage_size = sizeof(sockaddr_in);
+                } else if(::inet_pton(AF_INET6, address.c_str(), &address_v6->sin6_addr) == 1) {
+                    address_v6->sin6_family = AF_INET6;
+                    address_v6->sin6_port = htons(port);
+                    storage_size = sizeof(sockaddr_in6);
+                } else {
+                    co_return -EINVAL;
+                }
+                close();
+                m_fd = ::socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if(m_fd < 0) {
+                    co_return -errno;
+                }
+                int64_t result(0);
+                if(::connect(m_fd, reinterpret_cast<sockaddr*>(&storage), storage_size) < 0) {
+                    result = -errno;
+                    if(result == -EINPROGRESS) {
+                        result = co_await waitWritable(m_fd);
+                        if(result >= 0) {
+                            int error(0);
+                            socklen_t error_size(sizeof(error));
+                            ::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &error_size);
+                            result = -error;
+                        }
+                    }
+                }
+                co_return result;
+            }
+
+            /**
+             * Send data, the coroutine is suspended while the socket buffer is full.
+             * @param data The data, it must stay valid until the Task completes.
+             * @param size The size of the data.
+             * @return A Task producing the number of bytes sent, which may be less than size, or a negated errno value.
+             */
+            Task<int64_t> send(const void* data, size_t size) {
+                int64_t result(-EAGAIN);
+                while(result == -EAGAIN) {
+                    ssize_t sent(::send(m_fd, data, size, MSG_NOSIGNAL));
+                    result = sent < 0 ? -errno : sent;
+                    if(result == -EAGAIN || result == -EWOULDBLOCK) {
+                        int64_t events(co_await waitWritable(m_fd));
+                        result = events < 0 ? events : -EAGAIN;
+                    } else if(result == -EINTR) {
+                        result = -EAGAIN;
+                    }
+                }
+                co_return result;
+            }
+
+            /**
+             * Receive data, the coroutine is suspended until data is available.
+             * @param buffer The buffer receiving the data, it must stay valid until the Task completes.
+             * @param size The size of the buffer.
+             * @return A Task producing the number of bytes received, 0 when the server closed the connection, or a negated errno value.
+             */
+            Task<int64_t> receive(void* buffer, size_t size) {
+                int64_t result(-EAGAIN);
+                while(result == -EAGAIN) {
+                    ssize_t received(::recv(m_fd, buffer, size, 0));
+                    result = received < 0 ? -errno : received;
+                    if(result == -EAGAIN || result == -EWOULDBLOCK) {
+                        int64_t events(co_await waitReadable(m_fd));
+                        result = events < 0 ? events : -EAGAIN;
+                    } else if(result == -EINTR) {
+                        result = -EAGAIN;
+                    }
+                }
+                co_return result;
+            }
+
+            OWEBPP_COROUTINE_END
+
+            /** Close the socket. */
+            void close() {
+                if(m_fd >= 0) {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the socket file descriptor.
+             * @return The file descriptor, -1 if the socket isn't connected.
+             */
+            int getFd() const { return m_fd; }
+
+        private:
+            /* Members */
+            /** The socket file descriptor. */
+            int m_fd;
+    };
+}
+
+#endif // OWEBPP_ASYNC_SOCKET_HPP
@@ -0,0 +1,299 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_AWAITABLES_HPP
+#define OWEBPP_AWAITABLES_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <poll.h>
+#include <sys/types.h>
+#include <thread>
+#include <unistd.h>
+
+#include <owebpp/AsyncContext.hpp>
+
+namespace owebpp {
+    /**
+     * Suspends the awaiting coroutine until a deadline.
+     * Without an owebpp::AsyncContext on the calling thread the thread sleeps instead.
+     */
+    class SleepAwaitable final {
+        public:
+            /* Constructors */
+            /**
+             * Construct an awaitable for the given deadline.
+             * @param deadline The time to resume the coroutine at.
+             */
+            explicit SleepAwaitable(std::chrono::steady_clock::time_point deadline): m_deadline(deadline), m_operation() {}
+
+            /* Deleted constructors */
+            SleepAwaitable() = delete;
+            SleepAwaitable(const SleepAwaitable& o) = delete;
+            SleepAwaitable(SleepAwaitable&& o) = delete;
+
+            /* Deleted assignment operators */
+            SleepAwaitable& operator=(const SleepAwaitable& o) = delete;
+            SleepAwaitable& operator=(SleepAwaitable&& o) = delete;
+
+            /* Destructor */
+            ~SleepAwaitable() = default;
+
+            /* Functions */
+            /**
+             * Tell if the coroutine can go on without suspending, i.e. the deadline passed or the thread slept until it.
+             * @return true if the coroutine doesn't suspend.
+             */
+            bool await_ready() const {
+                bool is_ready(std::chrono::steady_clock::now() >= m_deadline);
+                if(!is_ready && AsyncContext::getCurrent() == nullptr) {
+                    std::this_thread::sleep_until(m_deadline);
+                    is_ready = true;
+                }
+                return is_ready;
+            }
+
+            /**
+             * Register the suspended coroutine to be resumed at the deadline.
+             * @param handle The suspended coroutine.
+             */
+            void await_suspend(std::coroutine_handle<> handle) {
+                m_operation.handle = handle;
+                AsyncContext::getCurrent()->wakeAt(m_deadline, m_operation);
+            }
+
+            /** Nothing is produced. */
+            void await_resume() const noexcept {}
+
+        private:
+            /* Members */
+            /** The time to resume the coroutine at. */
+            std::chrono::steady_clock::time_point m_deadline;
+
+            /** The operation submitted to the context. */
+            AsyncOperation m_operation;
+    };
+
+    /**
+     * Suspends the awaiting coroutine until a file descriptor is ready, its result is the received poll events or a negated errno value.
+     * Without an owebpp::AsyncContext on the calling thread the thread blocks in poll() instead.
+     */
+    class PollAwaitable final {
+        public:
+            /* Constructors */
+            /**
+             * Construct an awaitable for the given file descriptor.
+             * @param fd The file descriptor, it must be pollable.
+             * @param events The poll events to wait for, POLLIN and/or POLLOUT.
+             */
+            PollAwaitable(int fd, short events): m_fd(fd), m_events(events), m_operation() {}
+
+            /* Deleted constructors */
+            PollAwaitable() = delete;
+            PollAwaitable(const PollAwaitable& o) = delete;
+            PollAwaitable(PollAwaitable&& o) = delete;
+
+            /* Deleted assignment operators */
+            PollAwaitable& operator=(const PollAwaitable& o) = delete;
+            PollAwaitable& operator=(PollAwaitable&& o) = delete;
+
+            /* Destructor */
+            ~PollAwaitable() = default;
+
+            /* Functions */
+            /**
+             * Tell if the coroutine can go on without suspending, i.e. the thread has no context and blocked until the descriptor was ready.
+             * @return true if the coroutine doesn't suspend.
+             */
+            bool await_ready() {
+                bool is_ready(AsyncContext::getCurrent() == nullptr);
+                if(is_ready) {
+                    pollfd descriptor{m_fd, m_events, 0};
+                    int count(-1);
+                    do {
+                        count = ::poll(&descriptor, 1, -1);
+                    } while(count < 0 && errno == EINTR);
+                    m_operation.result = count < 0 ? -errno : descriptor.revents;
+                }
+                return is_ready;
+            }
+
+            /**
+             * Register the suspended coroutine to be resumed once the descriptor is ready.
+             * @param handle The suspended coroutine.
+             */
+            void await_suspend(std::coroutine_handle<> handle) {
+                m_operation.handle = handle;
+                AsyncContext::getCurrent()->waitFor(m_fd, m_events, m_operation);
+            }
+
+            /**
+             * Get the result of the wait.
+             * @return The received poll events or a negated errno value.
+             */
+            int64_t await_resume() const noexcept { return m_operation.result; }
+
+        private:
+            /* Members */
+            /** The file descriptor. */
+            int m_fd;
+
+            /** The poll events to wait for. */
+            short m_events;
+
+            /** The operation submitted to the context. */
+            AsyncOperation m_operation;
+    };
+
+    /**
+     * Reads from a file at a given offset without blocking the event loop when the backend supports it, its result is the number of bytes read or a negated errno value.
+     * Without an owebpp::AsyncContext on the calling thread the file is read with pread() instead.
+     */
+    class ReadAwaitable final {
+        public:
+            /* Constructors */
+            /**
+             * Construct an awaitable reading from the given file.
+             * @param fd The file descriptor.
+             * @param buffer The buffer receiving the data.
+             * @param size The number of bytes to read.
+             * @param offset The file offset to read at.
+             */
+            ReadAwaitable(int fd, void* buffer, size_t size, off_t offset): m_fd(fd), m_buffer(buffer), m_size(size), m_offset(offset), m_operation() {}
+
+            /* Deleted constructors */
+            ReadAwaitable() = delete;
+            ReadAwaitable(const ReadAwaitable& o) = delete;
+            ReadAwaitable(ReadAwaitable&& o) = delete;
+
+            /* Deleted assignment operators */
+            ReadAwaitable& operator=(const ReadAwaitable& o) = delete;
+            ReadAwaitable& operator=(ReadAwaitable&& o) = delete;
+
+            /* Destructor */
+            ~ReadAwaitable() = default;
+
+            /* Functions */
+            /**
+             * Tell if the coroutine can go on without suspending, i.e. the thread has no context and read the file.
+             * @return true if the coroutine doesn't suspend.
+             */
+            bool await_ready() {
+                bool is_ready(AsyncContext::getCurrent() == nullptr);
+                if(is_ready) {
+                    ssize_t result(-1);
+                    do {
+                        result = ::pread(m_fd, m_buffer, m_size, m_offset);
+                    } while(result < 0 && errno == EINTR);
+                    m_operation.result = result < 0 ? -errno : result;
+                }
+                return is_ready;
+            }
+
+            /**
+             * Submit the read, the suspended coroutine is resumed once it completes.
+             * @param handle The suspended coroutine.
+             */
+            void await_suspend(std::coroutine_handle<> handle) {
+                m_operation.handle = handle;
+                AsyncContext::getCurrent()->read(m_fd, m_buffer, m_size, m_offset, m_operation);
+            }
+
+            /**
+             * Get the result of the read.
+             * @return The number of bytes read or a negated errno value.
+             */
+            int64_t await_resume() const noexcept { return m_operation.result; }
+
+        private:
+            /* Members */
+            /** The file descriptor. */
+            int m_fd;
+
+            /** The buffer receiving the data. */
+            void* m_buffer;
+
+            /** The number of bytes to read. */
+            size_t m_size;
+
+            /** The file offset to read at. */
+            off_t m_offset;
+
+            /** The operation submitted to the context. */
+            AsyncOperation m_operation;
+    };
+
+    /**
+     * Suspend the awaiting coroutine for a duration.
+     * @param duration The duration.
+     * @return The awaitable.
+     */
+    template<class Trep, class Tperiod>
+    inline SleepAwaitable sleepFor(std::chrono::duration<Trep, Tperiod> duration) {
+        return SleepAwaitable(std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(duration));
+    }
+
+    /**
+     * Suspend the awaiting coroutine until a deadline.
+     * @param deadline The deadline.
+     * @return The awaitable.
+     */
+    inline SleepAwaitable sleepUntil(std::chrono::steady_clock::time_point deadline) {
+        return SleepAwaitable(deadline);
+    }
+
+    /**
+     * Suspend the awaiting coroutine until a file descriptor is readable.
+     * @param fd The file descriptor.
+     * @return The awaitable, its result is the received poll events or a negated errno value.
+     */
+    inline PollAwaitable waitReadable(int fd) {
+        return PollAwaitable(fd, POLLIN);
+    }
+
+    /**
+     * Suspend the awaiting coroutine until a file descriptor is writable.
+     * @param fd The file descriptor.
+     * @return The awaitable, its result is the received poll events or a negated errno value.
+     */
+    inline PollAwaitable waitWritable(int fd) {
+        return PollAwaitable(fd, POLLOUT);
+    }
+
+    /**
+     * Read from a file at a given offset.
+     * @param fd The file descriptor.
+     * @param buffer The buffer receiving the data.
+     * @param size The number of bytes to read.
+     * @param offset The file offset to read at.
+     * @return The awaitable, its result is the number of bytes read or a negated errno value.
+     */
+    inline ReadAwaitable readFile(int fd, void* buffer, size_t size, off_t offset) {
+        return ReadAwaitable(fd, buffer, size, offset);
+    }
+}
+
+#endif // OWEBPP_AWAITABLES_HPP
@@ -0,0 +1,357 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_BINARY_LOG_HPP
+#define OWEBPP_BINARY_LOG_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <owebpp/AsyncLogWriter.hpp>
+#include <owebpp/LogLevel.hpp>
+
+namespace owebpp {
+    /** The constant data of a log call site, it is registered once and the logs of the call site only refer to it. */
+    struct LogSite {
+        /**
+         * Build the site of a call with its source location.
+         * @param level The LogLevel of the logs.
+         * @param format The format of the messages, each {} is replaced by the next argument.
+         * @param location The source location of the call.
+         * @return The site.
+         */
+        static constexpr LogSite at(LogLevel level, const char* format, const std::source_location& location) {
+            return LogSite{level, format, location.file_name(), location.function_name(), location.line(), location.column()};
+        }
+
+        /** The LogLevel of the logs. */
+        LogLevel level;
+
+        /** The format of the messages. */
+        const char* format;
+
+        /** The source file, empty if the metadata isn't logged. */
+        const char* file;
+
+        /** The function name, empty if the metadata isn't logged. */
+        const char* function;
+
+        /** The source line. */
+        uint32_t line;
+
+        /** The source column. */
+        uint32_t column;
+    };
+
+    /**
+     * Encodes the logs of the binary format and formats deferred messages.
+     * A binary log is a sequence of records made of a RecordType byte and native endian fields, strings are prefixed with their 32 bits size:
+     * - HEADER: the MAGIC bytes, it starts the output of a logger and resets the sites,
+     * - SITE: id (32 bits), level (8 bits), line and column (32 bits each), file, function and format,
+     * - EVENT: site id (32 bits), time in nanoseconds since the epoch (64 bits), the argument count (8 bits) and each argument as an ArgumentType byte and its value,
+     * - TEXT: level (8 bits), time (64 bits) and the text of a log that was formatted by the caller.
+     * The sites are registered once per process and written to each binary logger before the first log referring to them.
+     */
+    class BinaryLog final {
+        public:
+            /* Deleted constructors */
+            BinaryLog() = delete;
+            BinaryLog(const BinaryLog& o) = delete;
+            BinaryLog(BinaryLog&& o) = delete;
+
+            /* Deleted assignment operators */
+            BinaryLog& operator=(const BinaryLog& o) = delete;
+            BinaryLog& operator=(BinaryLog&& o) = delete;
+
+            /* Deleted destructor */
+            ~BinaryLog() = delete;
+
+            /* Types */
+            /** Lists the record types. */
+            enum class RecordType : uint8_t {
+                HEADER = 0,
+                SITE = 1,
+                EVENT = 2,
+                TEXT = 3
+            };
+
+            /** Lists the argument types of the EVENT records. */
+            enum class ArgumentType : uint8_t {
+                /** 8 bits, 0 or 1. */
+                BOOL = 0,
+                /** 64 bits signed integer. */
+                SIGNED = 1,
+                /** 64 bits unsigned integer. */
+                UNSIGNED = 2,
+                /** 64 bits floating point. */
+                DOUBLE = 3,
+                /** 8 bits character. */
+                CHAR = 4,
+                /** 32 bits size followed by the bytes. */
+                STRING = 5
+            };
+
+            /* Constants */
+            /** The bytes following the type of a HEADER record. */
+            static constexpr std::string_view MAGIC = "OWEBLOG1";
+
+            /* Functions */
+            /**
+             * Register a call site, the OWEBPP_LOGF macros call it once per call site.
+             * @param site The site, it must outlive the process, e.g. a static.
+             * @return The id of the site.
+             */
+            static uint32_t registerSite(const LogSite& site) {
+                Registry& registry(getRegistry());
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                uint32_t id(static_cast<uint32_t>(registry.sites.size()));
+                registry.sites.push_back(&site);
+                std::string record;
+                appendSite(record, id, site);
+                for(AsyncLogWriter* writer : registry.writers) {
+                    /* The logs of the site can't be decoded without it, so it is never dropped. */
+                    writer->push(record, LogOverflowPolicy::BLOCK);
+                }
+                return id;
+            }
+
+            /**
+             * Start writing the registered sites to a writer, the HEADER record and the sites registered so far are pushed first.
+             * @param writer The writer of a binary logger.
+             */
+            static void subscribe(AsyncLogWriter& writer) {
+                Registry& registry(getRegistry());
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                std::string records;
+                appendHeader(records);
+                for(size_t id = 0; id < registry.sites.size(); id++) {
+                    appendSite(records, static_cast<uint32_t>(id), *registry.sites[id]);
+                }
+                writer.push(records, LogOverflowPolicy::BLOCK);
+                registry.writers.push_back(&writer);
+            }
+
+            /**
+             * Stop writing the registered sites to a writer.
+             * @param writer The writer.
+             */
+            static void unsubscribe(AsyncLogWriter& writer) {
+                Registry& registry(getRegistry());
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.writers.erase(std::remove(registry.writers.begin(), registry.writers.end(), &writer), registry.writers.end());
+            }
+
+            /**
+             * Append a HEADER record.
+             * @param out The output buffer.
+             */
+            static void appendHeader(std::string& out) {
+                appendRaw(out, RecordType::HEADER);
+                out.append(MAGIC);
+            }
+
+            /**
+             * Append a SITE record.
+             * @param out The output buffer.
+             * @param id The id of the site.
+             * @param site The site.
+             */
+            static void appendSite(std::string& out, uint32_t id, const LogSite& site) {
+                appendRaw(out, RecordType::SITE);
+                appendRaw(out, id);
+                appendRaw(out, static_cast<uint8_t>(site.level));
+                appendRaw(out, site.line);
+                appendRaw(out, site.column);
+                appendString(out, site.file);
+                appendString(out, site.function);
+                appendString(out, site.format);
+            }
+
+            /**
+             * Append an EVENT record, the arguments are copied as they are and formatted by the decoder.
+             * @param out The output buffer.
+             * @param site_id The id of the site.
+             * @param timestamp The time of the log in nanoseconds since the epoch.
+             * @param args The arguments: booleans, characters, integers, enums, floating points or strings.
+             */
+            template<class... Targs>
+            static void appendEvent(std::string& out, uint32_t site_id, int64_t timestamp, const Targs&... args) {
+                static_assert(sizeof...(Targs) < 256, "A log has at most 255 arguments.");
+                appendRaw(out, RecordType::EVENT);
+                appendRaw(out, site_id);
+                appendRaw(out, timestamp);
+                appendRaw(out, static_cast<uint8_t>(sizeof...(Targs)));
+                (appendArgument(out, args), ...);
+            }
+
+            /**
+             * Append a TEXT record.
+             * @param out The output buffer.
+             * @param level The LogLevel of the log.
+             * @param timestamp The time of the log in nanoseconds since the epoch.
+             * @param text The text of the log.
+             */
+            static void appendText(std::string& out, LogLevel level, int64_t timestamp, std::string_view text) {
+                appendRaw(out, RecordType::TEXT);
+                appendRaw(out, static_cast<uint8_t>(level));
+                appendRaw(out, timestamp);
+                appendString(out, text);
+            }
+
+            /**
+             * Format a message, each {} of the format is replaced by the next argument, the extra {} are kept and the extra arguments are ignored.
+             * @param out The output buffer.
+             * @param format The format.
+             * @param args The arguments.
+             */
+            template<class... Targs>
+            static void formatMessage(std::string& out, std::string_view format, const Targs&... args) {
+                (appendFormatted(out, format, args), ...);
+                out.append(format);
+            }
+
+            /**
+             * Append the text of an argument.
+             * @param out The output buffer.
+             * @param value The argument.
+             */
+            template<class T>
+            static void appendArgumentText(std::string& out, const T& value) {
+                if constexpr(std::is_same_v<T, bool>) {
+                    out.append(value ? "true" : "false");
+                } else if constexpr(std::is_same_v<T, char>) {
+                    out.push_back(value);
+                } else if constexpr(std::is_enum_v<T>) {
+                    appendArgumentText(out, static_cast<std::underlying_type_t<T>>(value));
+                } else if constexpr(std::is_arithmetic_v<T>) {
+                    char buffer[32];
+                    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                    out.append(buffer, end);
+                } else {
+                    static_assert(std::is_convertible_v<const T&, std::string_view>, "Log arguments are booleans, characters, integers, enums, floating points or strings.");
+                    out.append(std::string_view(value));
+                }
+            }
+
+        private:
+            /* Types */
+            /** The registered sites and the writers of the binary loggers. */
+            struct Registry {
+                /** Protects the registry. */
+                std::mutex mutex{};
+
+                /** The sites by id. */
+                std::vector<const LogSite*> sites{};
+
+                /** The writers of the binary loggers. */
+                std::vector<AsyncLogWriter*> writers{};
+            };
+
+            /* Functions */
+            /**
+             * Get the registry of the process.
+             * @return The registry.
+             */
+            static Registry& getRegistry() {
+                static Registry registry;
+                return registry;
+            }
+
+            /**
+             * Append the format up to its next {} followed by an argument, the format then starts after the {}.
+             * @param out The output buffer.
+             * @param format The rest of the format.
+             * @param value The argument.
+             */
+            template<class T>
+            static void appendFormatted(std::string& out, std::string_view& format, const T& value) {
+                size_t placeholder(format.find("{}"));
+                if(placeholder != std::string_view::npos) {
+                    out.append(format.substr(0, placeholder));
+                    appendArgumentText(out, value);
+                    format.remove_prefix(placeholder + 2);
+                }
+            }
+
+            /**
+             * Append a typed argument of an EVENT record.
+             * @param out The output buffer.
+             * @param value The argument.
+             */
+            template<class T>
+            static void appendArgument(std::string& out, const T& value) {
+                if constexpr(std::is_same_v<T, bool>) {
+                    appendRaw(out, ArgumentType::BOOL);
+                    appendRaw(out, static_cast<uint8_t>(value ? 1 : 0));
+                } else if constexpr(std::is_same_v<T, char>) {
+                    appendRaw(out, ArgumentType::CHAR);
+                    appendRaw(out, value);
+                } else if constexpr(std::is_enum_v<T>) {
+                    appendArgument(out, static_cast<std::underlying_type_t<T>>(value));
+                } else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>) {
+                    appendRaw(out, ArgumentType::SIGNED);
+                    appendRaw(out, static_cast<int64_t>(value));
+                } else if constexpr(std::is_integral_v<T>) {
+                    appendRaw(out, ArgumentType::UNSIGNED);
+                    appendRaw(out, static_cast<uint64_t>(value));
+                } else if constexpr(std::is_floating_point_v<T>) {
+                    appendRaw(out, ArgumentType::DOUBLE);
+                    appendRaw(out, static_cast<double>(value));
+                } else {
+                    static_assert(std::is_convertible_v<const T&, std::string_view>, "Log arguments are booleans, characters, integers, enums, floating points or strings.");
+                    appendRaw(out, ArgumentType::STRING);
+                    appendString(out, std::string_view(value));
+                }
+            }
+
+            /**
+             * Append the bytes of a value.
+             * @param out The output buffer.
+             * @param value The value.
+             */
+            template<class T>
+            static void appendRaw(std::string& out, T value) {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            /**
+             * Append a string prefixed with its size.
+             * @param out The output buffer.
+             * @param value The string.
+             */
+            static void appendString(std::string& out, std::string_view value) {
+                appendRaw(out, static_cast<uint32_t>(value.size()));
+                out.append(value);
+            }
+    };
+}
+
+#endif // OWEBPP_BINARY_LOG_HPP
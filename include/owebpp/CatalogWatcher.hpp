@@ -0,0 +1,171 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_CATALOG_WATCHER_HPP
+#define OWEBPP_CATALOG_WATCHER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <owebpp/Logger.hpp>
+
+namespace owebpp {
+    /**
+     * Checks files from a background thread and calls a function when one of them changes, e.g. to reload a translation catalog.
+     * A file changes when it is written or when another file is renamed over it, the function then publishes the new data,
+     * see owebpp::Snapshot, so the threads serving requests never load it themselves.
+     */
+    class CatalogWatcher {
+        public:
+            /* Constants */
+            /** The default interval between two checks of the files. */
+            static constexpr std::chrono::milliseconds DEFAULT_INTERVAL = std::chrono::seconds(1);
+
+            /* Constructors */
+            /**
+             * Construct a watcher and start its thread.
+             * @param interval The interval between two checks of the files.
+             */
+            explicit CatalogWatcher(std::chrono::milliseconds interval = DEFAULT_INTERVAL):
+                m_interval(interval),
+                m_files(),
+                m_mutex(),
+                m_wakeup(),
+                m_stopping(false),
+                m_thread() {
+                m_thread = std::thread([this]() { run(); });
+            }
+
+            /* Deleted constructors */
+            CatalogWatcher(const CatalogWatcher& o) = delete;
+            CatalogWatcher(CatalogWatcher&& o) = delete;
+
+            /* Deleted assignment operators */
+            CatalogWatcher& operator=(const CatalogWatcher& o) = delete;
+            CatalogWatcher& operator=(CatalogWatcher&& o) = delete;
+
+            /* Destructor */
+            /** Stop the thread. */
+            ~CatalogWatcher() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wakeup.notify_one();
+                m_thread.join();
+            }
+
+            /* Functions */
+            /**
+             * Watch a file, the function is called from the thread of the watcher after each change of the file.
+             * The function must not call watch(), its exceptions are logged.
+             * @param path The path of the file.
+             * @param on_change The function.
+             */
+            void watch(const std::string& path, std::function<void()> on_change) {
+                WatchedFile file{path, std::move(on_change), {}, false};
+                file.exists = ::stat(path.c_str(), &file.status) == 0;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_files.push_back(std::move(file));
+            }
+
+        private:
+            /* Types */
+            /** A watched file. */
+            struct WatchedFile {
+                /** The path of the file. */
+                std::string path{};
+
+                /** The function called when the file changes. */
+                std::function<void()> on_change{};
+
+                /** The status of the file when it was last checked. */
+                struct stat status{};
+
+                /** Whether the file existed when it was last checked. */
+                bool exists{false};
+            };
+
+            /* Functions */
+            /** The watcher loop: check the files once per interval until the watcher stops. */
+            void run() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while(!m_wakeup.wait_for(lock, m_interval, [this]() { return m_stopping; })) {
+                    for(WatchedFile& file : m_files) {
+                        check(file);
+                    }
+                }
+            }
+
+            /**
+             * Check a file and call its function if it changed, a file which disappeared is not a change as it is usually being replaced.
+             * @param file The file.
+             */
+            static void check(WatchedFile& file) {
+                struct stat status;
+                if(::stat(file.path.c_str(), &status) == 0) {
+                    bool is_changed(!file.exists || status.st_dev != file.status.st_dev || status.st_ino != file.status.st_ino
+                                    || status.st_size != file.status.st_size || status.st_mtim.tv_sec != file.status.st_mtim.tv_sec
+                                    || status.st_mtim.tv_nsec != file.status.st_mtim.tv_nsec);
+                    file.status = status;
+                    file.exists = true;
+                    if(is_changed) {
+                        try {
+                            file.on_change();
+                        } catch(const std::exception& e) {
+                            OWEBPP_LOG_WARNING("Reloading " + file.path + " failed: " + e.what());
+                        }
+                    }
+                }
+            }
+
+            /* Members */
+            /** The interval between two checks of the files. */
+            std::chrono::milliseconds m_interval;
+
+            /** The watched files, protected by m_mutex. */
+            std::vector<WatchedFile> m_files;
+
+            /** Protects the watched files and the stop flag, only taken by watch() and the watcher thread. */
+            std::mutex m_mutex;
+
+            /** Wakes the watcher up when it stops. */
+            std::condition_variable m_wakeup;
+
+            /** Whether the watcher is stopping, protected by m_mutex. */
+            bool m_stopping;
+
+            /** The watcher thread. */
+            std::thread m_thread;
+    };
+}
+
+#endif // OWEBPP_CATALOG_WATCHER_HPP
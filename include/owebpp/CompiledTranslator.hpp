@@ -0,0 +1,235 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_COMPILED_TRANSLATOR_HPP
+#define OWEBPP_COMPILED_TRANSLATOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <owebpp/Logger.hpp>
+#include <owebpp/TranslationFormat.hpp>
+#include <owebpp/Translator.hpp>
+
+namespace owebpp {
+    /** The position of a translation in the string pool of its locale. */
+    struct CompiledTranslation {
+        /** The offset of the translation in the pool, MISSING if the locale doesn't translate the key. */
+        uint32_t offset{};
+
+        /** The size of the translation. */
+        uint32_t size{};
+
+        /** The offset of a translation the locale doesn't have. */
+        static constexpr uint32_t MISSING = UINT32_MAX;
+    };
+
+    /** The translations of a locale, stored one after the other in a single pool. */
+    struct CompiledLocale {
+        /** The name of the locale. */
+        std::string_view name{};
+
+        /** The translations of the locale. */
+        std::string_view pool{};
+
+        /** The position of the translation of each key, in the order of the keys of the catalog. */
+        std::span<const CompiledTranslation> translations{};
+    };
+
+    /**
+     * A translation catalog generated by "owebpp-console generate:translations".
+     * The keys are placed by a minimal perfect hash: the first hash of a key selects a bucket, and the seed of the bucket gives the second hash placing the key.
+     */
+    struct CompiledCatalog {
+        /** The seed of each bucket. */
+        std::span<const uint32_t> seeds{};
+
+        /** The keys, at the position given by their hash. */
+        std::span<const std::string_view> keys{};
+
+        /** The translations of each locale. */
+        std::span<const CompiledLocale> locales{};
+    };
+
+    /**
+     * This class serves the translations of a compiled catalog, a lookup neither allocates nor compares more than one key.
+     * The translations of the locale are parsed when the translator is created, translate() then renders them without parsing them.
+     */
+    class CompiledTranslator : public Translator {
+        public:
+            /* Constants */
+            /** The index returned for a key the catalog doesn't have. */
+            static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+            /* Constructors */
+            /**
+             * Construct a translator and parse the translations of its locale.
+             * @param catalog The compiled catalog, it must outlive the translator.
+             * @param locale The locale to use for translation.
+             */
+            CompiledTranslator(const CompiledCatalog& catalog, std::string_view locale):
+                m_catalog(catalog),
+                m_locale(nullptr),
+                m_parsed_translations() {
+                for(const CompiledLocale& compiled_locale : m_catalog.locales) {
+                    if(compiled_locale.name == locale) {
+                        m_locale = &compiled_locale;
+                    }
+                }
+                if(m_locale == nullptr) {
+                    OWEBPP_LOG_WARNING("Locale " + std::string(locale) + " is not supported.");
+                } else {
+                    m_parsed_translations.reserve(m_locale->translations.size());
+                    for(const CompiledTranslation& compiled_translation : m_locale->translations) {
+                        m_parsed_translations.emplace_back(compiled_translation.offset == CompiledTranslation::MISSING
+                                                           ? std::string_view() : m_locale->pool.substr(compiled_translation.offset, compiled_translation.size));
+                    }
+                }
+            }
+
+            /* Deleted constructors */
+            CompiledTranslator() = delete;
+            CompiledTranslator(const CompiledTranslator& o) = delete;
+            CompiledTranslator(CompiledTranslator&& o) = delete;
+
+            /* Deleted assignment operators */
+            CompiledTranslator& operator=(const CompiledTranslator& o) = delete;
+            CompiledTranslator& operator=(CompiledTranslator&& o) = delete;
+
+            /* Destructor */
+            virtual ~CompiledTranslator() = default;
+
+            /* Functions */
+            /**
+             * Returns the translation associated to the given key.
+             * @param key The key to use to translate.
+             * @return The translation associated to the key or the key if no translation was found.
+             */
+            std::string getTranslatedText(const std::string& key) override {
+                return std::string(lookup(key));
+            }
+
+            /**
+             * Get the translation of a key parsed when the translator was created.
+             * @param key The key.
+             * @return The parsed translation, valid as long as the translator, or the parsed key if no translation was found.
+             */
+            std::shared_ptr<const TranslationFormat> getTranslationFormat(const std::string& key) override {
+                size_t index(findKey(m_catalog, key));
+                std::shared_ptr<const TranslationFormat> format;
+                if(m_locale != nullptr && index != NOT_FOUND && m_locale->translations[index].offset != CompiledTranslation::MISSING) {
+                    /* The translator owns the parsed translations, the pointer doesn't count references. */
+                    format = std::shared_ptr<const TranslationFormat>(std::shared_ptr<const TranslationFormat>(), &m_parsed_translations[index]);
+                } else {
+                    format = std::make_shared<const TranslationFormat>(lookup(key));
+                }
+                return format;
+            }
+
+            /**
+             * Returns the translation associated to the given key without copying it.
+             * @param key The key to use to translate.
+             * @return The translation associated to the key or the key if no translation was found, it lives as long as the catalog or the key.
+             */
+            std::string_view lookup(std::string_view key) const {
+                std::string_view translation(key);
+                /* An unsupported locale was reported when the translator was created. */
+                if(m_locale != nullptr) {
+                    size_t index(findKey(m_catalog, key));
+                    if(index == NOT_FOUND || m_locale->translations[index].offset == CompiledTranslation::MISSING) {
+                        OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Key " + std::string(key) + " has no translation for locale " + std::string(m_locale->name) + ".");
+                    } else {
+                        const CompiledTranslation& compiled_translation(m_locale->translations[index]);
+                        translation = m_locale->pool.substr(compiled_translation.offset, compiled_translation.size);
+                    }
+                }
+                return translation;
+            }
+
+            /**
+             * Find the index of a key in a catalog.
+             * @param catalog The catalog.
+             * @param key The key.
+             * @return The index of the key, NOT_FOUND if the catalog doesn't have it.
+             */
+            static constexpr size_t findKey(const CompiledCatalog& catalog, std::string_view key) {
+                size_t index(NOT_FOUND);
+                if(!catalog.keys.empty()) {
+                    uint64_t key_hash(hash(key));
+                    uint32_t seed(catalog.seeds[mix(key_hash, 0) % catalog.seeds.size()]);
+                    size_t slot(mix(key_hash, seed) % catalog.keys.size());
+                    if(catalog.keys[slot] == key) {
+                        index = slot;
+                    }
+                }
+                return index;
+            }
+
+            /**
+             * Hash a key once, mix() then derives the hashes placing it, the code generation uses the same functions to place the keys.
+             * @param key The key.
+             * @return The hash of the key.
+             */
+            static constexpr uint64_t hash(std::string_view key) {
+                uint64_t value(14695981039346656037u);
+                for(char c : key) {
+                    value = (value ^ static_cast<uint8_t>(c)) * 1099511628211u;
+                }
+                return value;
+            }
+
+            /**
+             * Derive a hash from the hash of a key and a seed.
+             * @param key_hash The hash of the key.
+             * @param seed The seed.
+             * @return The derived hash.
+             */
+            static constexpr uint32_t mix(uint64_t key_hash, uint32_t seed) {
+                /* FNV-1a mixes the last characters poorly, the finalizer spreads them over all the bits. */
+                uint64_t value(key_hash ^ (seed * 0x9e3779b97f4a7c15u));
+                value ^= value >> 33;
+                value *= 0xff51afd7ed558ccdu;
+                value ^= value >> 33;
+                value *= 0xc4ceb9fe1a85ec53u;
+                value ^= value >> 33;
+                return static_cast<uint32_t>(value);
+            }
+
+        private:
+            /* Members */
+            /** The compiled catalog. */
+            const CompiledCatalog& m_catalog;
+
+            /** The translations of the locale, nullptr if the catalog doesn't have the locale. */
+            const CompiledLocale* m_locale;
+
+            /** The parsed translations of the locale, in the order of the keys of the catalog. */
+            std::vector<TranslationFormat> m_parsed_translations;
+    };
+}
+
+#endif // OWEBPP_COMPILED_TRANSLATOR_HPP
@@ -0,0 +1,384 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_CONCURRENCY_LIMITER_HPP
+#define OWEBPP_CONCURRENCY_LIMITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <owebpp/AsyncContext.hpp>
+#include <owebpp/HttpStatusCode.hpp>
+#include <owebpp/Response.hpp>
+
+namespace owebpp {
+    /** Lists the ways a ConcurrencyLimiter adjusts its limit. */
+    enum class LimitAlgorithm {
+        /** The limit is the configured maximum concurrency. */
+        STATIC,
+        /**
+         * The limit grows by one while the latency stays close to the lowest latency observed recently and the limit is used,
+         * and shrinks by 10% when the latency rises, bounded by the configured maximum concurrency.
+         */
+        AIMD
+    };
+
+    /**
+     * Bounds the number of requests a route runs at once, the requests over the limit wait in a bounded queue and the others are shed before the client code runs.
+     * The counters are atomic so the limiter can be shared by the threads serving the route.
+     * Only coroutines running on an owebpp::AsyncContext can wait in the queue, the other requests are shed right away when the limit is reached.
+     */
+    class ConcurrencyLimiter {
+        public:
+            /* Types */
+            /** The awaitable admitting a request, its result is true if the request may run and false if it is shed. */
+            class AcquireAwaitable final {
+                public:
+                    /* Constructors */
+                    /**
+                     * Construct an awaitable for the given limiter.
+                     * @param limiter The limiter.
+                     */
+                    explicit AcquireAwaitable(ConcurrencyLimiter& limiter): m_limiter(limiter), m_is_admitted(false), m_operation() {}
+
+                    /* Deleted constructors */
+                    AcquireAwaitable() = delete;
+                    AcquireAwaitable(const AcquireAwaitable& o) = delete;
+                    AcquireAwaitable(AcquireAwaitable&& o) = delete;
+
+                    /* Deleted assignment operators */
+                    AcquireAwaitable& operator=(const AcquireAwaitable& o) = delete;
+                    AcquireAwaitable& operator=(AcquireAwaitable&& o) = delete;
+
+                    /* Destructor */
+                    ~AcquireAwaitable() = default;
+
+                    /* Functions */
+                    /**
+                     * Admit the request right away if the limit isn't reached, shed it if it can't wait.
+                     * @return true if the coroutine doesn't suspend.
+                     */
+                    bool await_ready() {
+                        m_is_admitted = m_limiter.tryAcquire();
+                        return m_is_admitted || AsyncContext::getCurrent() == nullptr || m_limiter.m_max_queue_depth == 0;
+                    }
+
+                    /**
+                     * Queue the request if the queue isn't full.
+                     * @param handle The suspended coroutine.
+                     * @return true if the coroutine waits in the queue.
+                     */
+                    bool await_suspend(std::coroutine_handle<> handle) {
+                        m_operation.handle = handle;
+                        return m_limiter.enqueue(m_operation, m_is_admitted);
+                    }
+
+                    /**
+                     * Tell if the request may run, it must then release the limiter once done.
+                     * @return true if the request is admitted, false if it is shed.
+                     */
+                    bool await_resume() const { return m_is_admitted || m_operation.result != 0; }
+
+                private:
+                    /* Members */
+                    /** The limiter. */
+                    ConcurrencyLimiter& m_limiter;
+
+                    /** Whether the request was admitted without waiting. */
+                    bool m_is_admitted;
+
+                    /** The operation of the waiting request, its result is 1 once it is admitted. */
+                    AsyncOperation m_operation;
+            };
+
+            /* Constructors */
+            /**
+             * Construct a limiter.
+             * @param max_concurrency The maximum number of requests running at once, at least 1.
+             * @param max_queue_depth The maximum number of requests waiting for a slot.
+             * @param algorithm The way the limit is adjusted.
+             * @param shed_status The status code of the responses to the shed requests, SERVICE_UNAVAILABLE or TOO_MANY_REQUESTS.
+             */
+            ConcurrencyLimiter(size_t max_concurrency, size_t max_queue_depth, LimitAlgorithm algorithm, HttpStatusCode shed_status):
+                m_max_concurrency(std::max<size_t>(max_concurrency, 1)),
+                m_max_queue_depth(max_queue_depth),
+                m_algorithm(algorithm),
+                m_shed_status(shed_status),
+                m_limit(m_max_concurrency),
+                m_in_flight(0),
+                m_queued(0),
+                m_shed_count(0),
+                m_min_latency(std::numeric_limits<int64_t>::max()),
+                m_samples(0),
+                m_waiters_mutex(),
+                m_waiters() {
+                std::lock_guard<std::mutex> lock(s_limiters_mutex);
+                s_limiters.push_back(this);
+            }
+
+            /* Deleted constructors */
+            ConcurrencyLimiter() = delete;
+            ConcurrencyLimiter(const ConcurrencyLimiter& o) = delete;
+            ConcurrencyLimiter(ConcurrencyLimiter&& o) = delete;
+
+            /* Deleted assignment operators */
+            ConcurrencyLimiter& operator=(const ConcurrencyLimiter& o) = delete;
+            ConcurrencyLimiter& operator=(ConcurrencyLimiter&& o) = delete;
+
+            /* Destructor */
+            ~ConcurrencyLimiter() {
+                std::lock_guard<std::mutex> lock(s_limiters_mutex);
+                s_limiters.erase(std::find(s_limiters.begin(), s_limiters.end(), this));
+            }
+
+            /* Functions */
+            /**
+             * Take a slot if the limit isn't reached.
+             * @return true if the request may run, it must then call release() once done.
+             */
+            bool tryAcquire() {
+                size_t in_flight(m_in_flight.load(std::memory_order_relaxed));
+                while(in_flight < m_limit.load(std::memory_order_relaxed)) {
+                    if(m_in_flight.compare_exchange_weak(in_flight, in_flight + 1, std::memory_order_seq_cst)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * Take a slot, waiting in the queue if the limit is reached: co_await limiter.acquire().
+             * @return The awaitable admitting the request.
+             */
+            AcquireAwaitable acquire() { return AcquireAwaitable(*this); }
+
+            /**
+             * Give a slot back, the slot goes to the oldest waiting request if any.
+             * @param latency The time the request ran for, it drives the adaptive limit.
+             */
+            void release(std::chrono::nanoseconds latency) {
+                if(m_algorithm == LimitAlgorithm::AIMD) {
+                    adjustLimit(latency);
+                }
+                releaseUnused();
+            }
+
+            /** Give a slot back without a latency sample, for a request admitted but answered without running the route. */
+            void releaseUnused() {
+                m_in_flight.fetch_sub(1, std::memory_order_seq_cst);
+                if(m_queued.load(std::memory_order_seq_cst) > 0) {
+                    admitWaiters();
+                }
+            }
+
+            /**
+             * Reject the requests a context has waiting in the queue of any limiter, an event loop calls it once stopped so it doesn't wait for them to be admitted.
+             * The coroutines are posted to the context with a rejected result, they are shed if the context resumes them.
+             * @param context The context.
+             */
+            static void cancelWaiters(AsyncContext& context) {
+                std::lock_guard<std::mutex> limiters_lock(s_limiters_mutex);
+                for(ConcurrencyLimiter* limiter : s_limiters) {
+                    std::lock_guard<std::mutex> lock(limiter->m_waiters_mutex);
+                    auto cancelled(std::stable_partition(limiter->m_waiters.begin(), limiter->m_waiters.end(), [&context](const Waiter& waiter) {
+                        return waiter.context != &context;
+                    }));
+                    for(auto waiter(cancelled); waiter != limiter->m_waiters.end(); ++waiter) {
+                        limiter->m_queued.fetch_sub(1, std::memory_order_relaxed);
+                        waiter->operation->result = 0;
+                        context.post(*waiter->operation);
+                    }
+                    limiter->m_waiters.erase(cancelled, limiter->m_waiters.end());
+                }
+            }
+
+            /**
+             * Count a shed request and build its response, it asks the client to retry a second later.
+             * @return The response.
+             */
+            std::shared_ptr<Response> shed() {
+                m_shed_count.fetch_add(1, std::memory_order_relaxed);
+                std::shared_ptr<Response> response(std::make_shared<Response>());
+                response->setSatusCode(m_shed_status);
+                response->getHeaders().push_back("Retry-After: 1");
+                return response;
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the current limit.
+             * @return The number of requests allowed to run at once.
+             */
+            size_t getLimit() const { return m_limit.load(std::memory_order_relaxed); }
+
+            /**
+             * Getter for the number of running requests.
+             * @return The number of running requests.
+             */
+            size_t getInFlight() const { return m_in_flight.load(std::memory_order_relaxed); }
+
+            /**
+             * Getter for the number of waiting requests.
+             * @return The number of waiting requests.
+             */
+            size_t getQueued() const { return m_queued.load(std::memory_order_relaxed); }
+
+            /**
+             * Getter for the number of shed requests since the start.
+             * @return The number of shed requests.
+             */
+            uint64_t getShedCount() const { return m_shed_count.load(std::memory_order_relaxed); }
+
+        private:
+            /* Types */
+            /** A request waiting for a slot. */
+            struct Waiter {
+                /** The operation of the suspended coroutine. */
+                AsyncOperation* operation;
+
+                /** The context to resume the coroutine on. */
+                AsyncContext* context;
+            };
+
+            /* Constants */
+            /** The number of samples after which the lowest observed latency is forgotten, so the limit follows a lasting change of the route latency. */
+            static constexpr uint64_t MIN_LATENCY_WINDOW = 1000;
+
+            /** The AIMD limit shrinks when the latency exceeds the lowest observed latency times this factor. */
+            static constexpr double LATENCY_TOLERANCE = 2.0;
+
+            /** The factor applied to the AIMD limit when it shrinks. */
+            static constexpr double BACKOFF_RATIO = 0.9;
+
+            /* Functions */
+            /**
+             * Queue a request unless a slot freed up meanwhile or the queue is full.
+             * @param operation The operation of the suspended coroutine.
+             * @param is_admitted Set to true if a slot freed up.
+             * @return true if the request waits in the queue.
+             */
+            bool enqueue(AsyncOperation& operation, bool& is_admitted) {
+                std::lock_guard<std::mutex> lock(m_waiters_mutex);
+                /* Counting the request before retrying ensures a concurrent release() either frees the slot seen here or sees the request. */
+                m_queued.fetch_add(1, std::memory_order_seq_cst);
+                is_admitted = tryAcquire();
+                bool is_queued(!is_admitted && m_waiters.size() < m_max_queue_depth);
+                if(is_queued) {
+                    AsyncContext* context(AsyncContext::getCurrent());
+                    context->expectPost();
+                    m_waiters.push_back(Waiter{&operation, context});
+                } else {
+                    m_queued.fetch_sub(1, std::memory_order_relaxed);
+                }
+                return is_queued;
+            }
+
+            /** Hand the free slots to the oldest waiting requests. */
+            void admitWaiters() {
+                std::lock_guard<std::mutex> lock(m_waiters_mutex);
+                while(!m_waiters.empty() && tryAcquire()) {
+                    Waiter waiter(m_waiters.front());
+                    m_waiters.pop_front();
+                    m_queued.fetch_sub(1, std::memory_order_relaxed);
+                    waiter.operation->result = 1;
+                    waiter.context->post(*waiter.operation);
+                }
+            }
+
+            /**
+             * Adjust the AIMD limit to the latency of a request, a concurrent adjustment may win and this one is then skipped.
+             * @param latency The time the request ran for.
+             */
+            void adjustLimit(std::chrono::nanoseconds latency) {
+                int64_t sample(latency.count());
+                int64_t min_latency(m_min_latency.load(std::memory_order_relaxed));
+                if(sample < min_latency || m_samples.fetch_add(1, std::memory_order_relaxed) % MIN_LATENCY_WINDOW == 0) {
+                    m_min_latency.store(sample, std::memory_order_relaxed);
+                }
+                size_t limit(m_limit.load(std::memory_order_relaxed));
+                size_t new_limit(limit);
+                if(static_cast<double>(sample) > static_cast<double>(min_latency) * LATENCY_TOLERANCE) {
+                    new_limit = std::max<size_t>(static_cast<size_t>(static_cast<double>(limit) * BACKOFF_RATIO), 1);
+                } else if(m_in_flight.load(std::memory_order_relaxed) * 2 >= limit) {
+                    new_limit = std::min(limit + 1, m_max_concurrency);
+                }
+                if(new_limit != limit) {
+                    m_limit.compare_exchange_strong(limit, new_limit, std::memory_order_relaxed);
+                }
+            }
+
+            /* Members */
+            /** The maximum number of requests running at once. */
+            size_t m_max_concurrency;
+
+            /** The maximum number of requests waiting for a slot. */
+            size_t m_max_queue_depth;
+
+            /** The way the limit is adjusted. */
+            LimitAlgorithm m_algorithm;
+
+            /** The status code of the responses to the shed requests. */
+            HttpStatusCode m_shed_status;
+
+            /** The number of requests allowed to run at once. */
+            std::atomic<size_t> m_limit;
+
+            /** The number of running requests. */
+            std::atomic<size_t> m_in_flight;
+
+            /** The number of waiting requests, including the one being queued. */
+            std::atomic<size_t> m_queued;
+
+            /** The number of shed requests. */
+            std::atomic<uint64_t> m_shed_count;
+
+            /** The lowest latency observed in the current window, in nanoseconds. */
+            std::atomic<int64_t> m_min_latency;
+
+            /** The number of latency samples. */
+            std::atomic<uint64_t> m_samples;
+
+            /** The mutex protecting m_waiters. */
+            std::mutex m_waiters_mutex;
+
+            /** The waiting requests, the oldest first. */
+            std::deque<Waiter> m_waiters;
+
+            /** The mutex protecting s_limiters. */
+            static inline std::mutex s_limiters_mutex;
+
+            /** The existing limiters, which cancelWaiters() goes through. */
+            static inline std::vector<ConcurrencyLimiter*> s_limiters;
+    };
+}
+
+#endif // OWEBPP_CONCURRENCY_LIMITER_HPP
@@ -0,0 +1,225 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_CONTENT_SOURCE_HPP
+#define OWEBPP_CONTENT_SOURCE_HPP
+
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace owebpp {
+    /** A content that can be read by parts, used to serve large objects without loading them entirely in memory. */
+    class ContentSource {
+        public:
+            /* Constructors */
+            /** Construct a default content source. */
+            ContentSource() = default;
+
+            /* Deleted constructors */
+            ContentSource(const ContentSource& o) = delete;
+            ContentSource(ContentSource&& o) = delete;
+
+            /* Deleted assignment operators */
+            ContentSource& operator=(const ContentSource& o) = delete;
+            ContentSource& operator=(ContentSource&& o) = delete;
+
+            /* Destructor */
+            virtual ~ContentSource() = default;
+
+            /* Functions */
+            /**
+             * Tell if the content can be read.
+             * @return true if the content is available, false otherwise.
+             */
+            virtual bool isAvailable() const = 0;
+
+            /**
+             * Getter for the content size.
+             * @return The content size in bytes.
+             */
+            virtual size_t getSize() const = 0;
+
+            /**
+             * Read a part of the content.
+             * @param offset The position of the first byte to read.
+             * @param length The number of bytes to read.
+             * @param out Receives the bytes read, its previous content is replaced.
+             * @return true if the requested bytes were read, false otherwise.
+             */
+            virtual bool read(size_t offset, size_t length, std::string& out) const = 0;
+
+            /**
+             * Getter for the strong entity tag identifying the current version of the content.
+             * @return The quoted entity tag or an empty string if the content has none.
+             */
+            virtual std::string getEntityTag() const { return ""; }
+
+            /**
+             * Getter for the last modification date of the content.
+             * @return The HTTP date of the last modification or an empty string if it is unknown.
+             */
+            virtual std::string getLastModified() const { return ""; }
+    };
+
+    /** A content held in memory and shared between the responses serving it. */
+    class BlobContentSource final : public ContentSource {
+        public:
+            /* Constructors */
+            /**
+             * Construct a content source over the given data, the data is shared and never copied as a whole.
+             * @param data The content data.
+             * @param entity_tag The quoted entity tag of the data, may be empty.
+             */
+            BlobContentSource(const std::shared_ptr<const std::string>& data, const std::string& entity_tag):
+                m_data(data),
+                m_entity_tag(entity_tag) {}
+
+            /* Deleted constructors */
+            BlobContentSource() = delete;
+            BlobContentSource(const BlobContentSource& o) = delete;
+            BlobContentSource(BlobContentSource&& o) = delete;
+
+            /* Deleted assignment operators */
+            BlobContentSource& operator=(const BlobContentSource& o) = delete;
+            BlobContentSource& operator=(BlobContentSource&& o) = delete;
+
+            /* Destructor */
+            ~BlobContentSource() = default;
+
+            /* Functions */
+            bool isAvailable() const override { return m_data != nullptr; }
+
+            size_t getSize() const override { return m_data == nullptr ? 0 : m_data->size(); }
+
+            bool read(size_t offset, size_t length, std::string& out) const override {
+                bool ret(false);
+                if(m_data != nullptr && offset <= m_data->size() && length <= m_data->size() - offset) {
+                    out.assign(m_data->data() + offset, length);
+                    ret = true;
+                }
+                return ret;
+            }
+
+            std::string getEntityTag() const override { return m_entity_tag; }
+
+        private:
+            /* Members */
+            /** The content data. */
+            std::shared_ptr<const std::string> m_data;
+
+            /** The quoted entity tag of the data. */
+            std::string m_entity_tag;
+    };
+
+    /** A content read from a file, only the requested parts of the file are read. */
+    class FileContentSource final : public ContentSource {
+        public:
+            /* Constructors */
+            /**
+             * Open the given file, use isAvailable() to know if the file could be opened.
+             * @param path The path of the file.
+             */
+            explicit FileContentSource(const std::string& path):
+                m_fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+                m_size(0),
+                m_modification_time(0) {
+                struct stat file_stat;
+                if(m_fd >= 0 && ::fstat(m_fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+                    m_size = static_cast<size_t>(file_stat.st_size);
+                    m_modification_time = file_stat.st_mtime;
+                } else if(m_fd >= 0) {
+                    ::close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+            /* Deleted constructors */
+            FileContentSource() = delete;
+            FileContentSource(const FileContentSource& o) = delete;
+            FileContentSource(FileContentSource&& o) = delete;
+
+            /* Deleted assignment operators */
+            FileContentSource& operator=(const FileContentSource& o) = delete;
+            FileContentSource& operator=(FileContentSource&& o) = delete;
+
+            /* Destructor */
+            ~FileContentSource() {
+                if(m_fd >= 0) {
+                    ::close(m_fd);
+                }
+            }
+
+            /* Functions */
+            bool isAvailable() const override { return m_fd >= 0; }
+
+            size_t getSize() const override { return m_size; }
+
+            bool read(size_t offset, size_t length, std::string& out) const override {
+                bool ret(m_fd >= 0);
+                out.resize(length);
+                size_t done(0);
+                while(ret && done < length) {
+                    ssize_t r = ::pread(m_fd, out.data() + done, length - done, static_cast<off_t>(offset + done));
+                    if(r > 0) {
+                        done += static_cast<size_t>(r);
+                    } else if(r == 0 || errno != EINTR) {
+                        ret = false;
+                    }
+                }
+                return ret;
+            }
+
+            std::string getEntityTag() const override {
+                char tag[64];
+                std::snprintf(tag, sizeof(tag), "\"%lx-%zx\"", static_cast<unsigned long>(m_modification_time), m_size);
+                return tag;
+            }
+
+            std::string getLastModified() const override {
+                char date[64];
+                struct tm gmt;
+                ::gmtime_r(&m_modification_time, &gmt);
+                size_t size = std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+                return std::string(date, size);
+            }
+
+        private:
+            /* Members */
+            /** The file descriptor of the opened file, -1 if the file couldn't be opened. */
+            int m_fd;
+
+            /** The file size. */
+            size_t m_size;
+
+            /** The file last modification time. */
+            std::time_t m_modification_time;
+    };
+}
+
+#endif // OWEBPP_CONTENT_SOURCE_HPP
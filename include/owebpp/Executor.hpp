@@ -0,0 +1,564 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_EXECUTOR_HPP
+#define OWEBPP_EXECUTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <owebpp/AsyncContext.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/Priority.hpp>
+
+namespace owebpp {
+    /**
+     * A work-stealing thread pool running CPU heavy client code off the I/O threads.
+     * Each worker owns a deque per owebpp::Priority class: it runs its own jobs oldest first, and once it runs out it steals the jobs of the other workers, the workers of its NUMA node first.
+     * The higher classes are served first, but a class passed over STARVATION_LIMIT times in a row on a deque is served next so the lower classes keep progressing.
+     * By default the pool has one worker per CPU the process is allowed to run on, and each worker is bound to the allowed CPUs of its NUMA node so its memory stays local.
+     */
+    class Executor {
+        public:
+            /* Constructors */
+            /**
+             * Construct the pool and start its workers.
+             * @param thread_count The number of workers, 0 for one worker per allowed CPU.
+             */
+            explicit Executor(size_t thread_count = 0):
+                m_workers(),
+                m_next_worker(0),
+                m_pending_jobs(0),
+                m_sleep_mutex(),
+                m_wakeup(),
+                m_stopping(false),
+                m_class_metrics() {
+                std::vector<std::vector<int>> nodes(getNodesCpus());
+                std::vector<size_t> cpu_nodes;
+                for(size_t node = 0; node < nodes.size(); node++) {
+                    cpu_nodes.insert(cpu_nodes.end(), nodes[node].size(), node);
+                }
+                if(thread_count == 0) {
+                    thread_count = std::max<size_t>(cpu_nodes.size(), 1);
+                }
+                /* The workers are spread over the nodes in proportion to their CPUs. */
+                for(size_t i = 0; i < thread_count; i++) {
+                    m_workers.push_back(std::make_unique<Worker>(cpu_nodes.empty() ? 0 : cpu_nodes[i % cpu_nodes.size()]));
+                }
+                for(size_t i = 0; i < thread_count; i++) {
+                    for(size_t j = 1; j < thread_count; j++) {
+                        size_t victim((i + j) % thread_count);
+                        if(m_workers[victim]->node == m_workers[i]->node) {
+                            m_workers[i]->victims.push_back(victim);
+                        }
+                    }
+                    for(size_t j = 1; j < thread_count; j++) {
+                        size_t victim((i + j) % thread_count);
+                        if(m_workers[victim]->node != m_workers[i]->node) {
+                            m_workers[i]->victims.push_back(victim);
+                        }
+                    }
+                }
+                for(size_t i = 0; i < thread_count; i++) {
+                    m_workers[i]->thread = std::thread(&Executor::work, this, i);
+                    if(!nodes.empty()) {
+                        bindToCpus(m_workers[i]->thread, nodes[m_workers[i]->node]);
+                    }
+                }
+            }
+
+            /* Deleted constructors */
+            Executor(const Executor& o) = delete;
+            Executor(Executor&& o) = delete;
+
+            /* Deleted assignment operators */
+            Executor& operator=(const Executor& o) = delete;
+            Executor& operator=(Executor&& o) = delete;
+
+            /* Destructor */
+            /** Run the pending jobs and stop the workers. */
+            ~Executor() {
+                {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                    m_stopping = true;
+                }
+                m_wakeup.notify_all();
+                for(const std::unique_ptr<Worker>& worker : m_workers) {
+                    worker->thread.join();
+                }
+            }
+
+            /* Functions */
+            /**
+             * Queue a job, this function can be called from any thread.
+             * A job submitted by a worker goes to the deque of that worker, other jobs are spread over the workers.
+             * @param job The job, the exceptions it throws are logged.
+             * @param priority The priority class of the job.
+             */
+            void submit(std::function<void()> job, Priority priority = Priority::NORMAL) {
+                size_t index(s_executor == this ? s_worker_index : m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+                size_t priority_class(static_cast<size_t>(priority));
+                m_class_metrics[priority_class].queued.fetch_add(1, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+                    m_workers[index]->jobs[priority_class].push_back(Job{std::move(job), std::chrono::steady_clock::now()});
+                }
+                m_pending_jobs.fetch_add(1, std::memory_order_release);
+                /* Taking the mutex orders the wakeup after the check of a worker going to sleep. */
+                {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                }
+                m_wakeup.notify_one();
+            }
+
+            /* Types */
+            /** A snapshot of the queue of a priority class. */
+            struct QueueMetrics {
+                /** The number of jobs waiting for a worker. */
+                size_t queued;
+
+                /** The number of jobs started since the pool started. */
+                uint64_t started;
+
+                /** The total time the started jobs waited for a worker. */
+                std::chrono::nanoseconds total_wait;
+
+                /** The longest time a started job waited for a worker. */
+                std::chrono::nanoseconds max_wait;
+            };
+
+            /* Getters and Setters */
+            /**
+             * Getter for the queue metrics of a priority class.
+             * @param priority The priority class.
+             * @return A snapshot of the metrics, the fields are read one by one while jobs keep running.
+             */
+            QueueMetrics getQueueMetrics(Priority priority) const {
+                const ClassMetrics& metrics(m_class_metrics[static_cast<size_t>(priority)]);
+                return QueueMetrics{metrics.queued.load(std::memory_order_relaxed),
+                                    metrics.started.load(std::memory_order_relaxed),
+                                    std::chrono::nanoseconds(metrics.total_wait.load(std::memory_order_relaxed)),
+                                    std::chrono::nanoseconds(metrics.max_wait.load(std::memory_order_relaxed))};
+            }
+
+            /**
+             * Getter for the number of workers.
+             * @return The number of workers.
+             */
+            size_t getThreadCount() const { return m_workers.size(); }
+
+            /**
+             * Get the pool shared by the routes run with the pool executor, it is created on first use.
+             * @return The shared pool.
+             */
+            static Executor& getInstance() {
+                static Executor executor;
+                return executor;
+            }
+
+        private:
+            /* Constants */
+            /** A class with waiting jobs is served after being passed over this many times on a deque. */
+            static constexpr unsigned int STARVATION_LIMIT = 8;
+
+            /* Types */
+            /** A queued job. */
+            struct Job {
+                /** The job function. */
+                std::function<void()> function;
+
+                /** The time the job was queued at. */
+                std::chrono::steady_clock::time_point submit_time;
+            };
+
+            /** The metrics of a priority class. */
+            struct ClassMetrics {
+                /** The number of jobs waiting for a worker. */
+                std::atomic<size_t> queued{0};
+
+                /** The number of started jobs. */
+                std::atomic<uint64_t> started{0};
+
+                /** The total time the started jobs waited, in nanoseconds. */
+                std::atomic<int64_t> total_wait{0};
+
+                /** The longest time a started job waited, in nanoseconds. */
+                std::atomic<int64_t> max_wait{0};
+            };
+
+            /** A worker thread and its deques of jobs. */
+            struct Worker {
+                /**
+                 * Construct a worker.
+                 * @param worker_node The index of the NUMA node of the worker.
+                 */
+                explicit Worker(size_t worker_node):
+                    mutex(),
+                    jobs(),
+                    skipped(),
+                    node(worker_node),
+                    victims(),
+                    thread() {}
+
+                /** The mutex protecting the deque. */
+                std::mutex mutex;
+
+                /** The jobs of the worker by priority class, the oldest first. */
+                std::array<std::deque<Job>, PriorityUtils::PRIORITY_COUNT> jobs;
+
+                /** The number of times each class with waiting jobs was passed over since it was last served. */
+                std::array<unsigned int, PriorityUtils::PRIORITY_COUNT> skipped;
+
+                /** The index of the NUMA node of the worker. */
+                size_t node;
+
+                /** The workers to steal from, the workers of the same node first. */
+                std::vector<size_t> victims;
+
+                /** The worker thread. */
+                std::thread thread;
+            };
+
+            /* Functions */
+            /**
+             * The worker loop: run the own jobs, steal when they run out and sleep when there is nothing left.
+             * @param index The index of the worker.
+             */
+            void work(size_t index) {
+                s_executor = this;
+                s_worker_index = index;
+                Worker& worker(*m_workers[index]);
+                while(true) {
+                    std::function<void()> job;
+                    if(take(worker, job) || steal(worker, job)) {
+                        m_pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+                        try {
+                            job();
+                        } catch(const std::exception& e) {
+                            OWEBPP_LOG_ERROR(std::string("Executor job threw an exception: ") + e.what());
+                        }
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                    m_wakeup.wait(lock, [this]() { return m_stopping || m_pending_jobs.load(std::memory_order_acquire) > 0; });
+                    if(m_stopping && m_pending_jobs.load(std::memory_order_acquire) == 0) {
+                        return;
+                    }
+                }
+            }
+
+            /**
+             * Take the oldest job of the class to serve from the deques of a worker, the highest class unless a lower one was passed over too often.
+             * @param worker The worker owning the deques.
+             * @param job Receives the job.
+             * @return true if a job was taken.
+             */
+            bool take(Worker& worker, std::function<void()>& job) {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                size_t chosen(PriorityUtils::PRIORITY_COUNT);
+                for(size_t priority_class = 0; priority_class < PriorityUtils::PRIORITY_COUNT; priority_class++) {
+                    if(!worker.jobs[priority_class].empty()) {
+                        if(chosen == PriorityUtils::PRIORITY_COUNT) {
+                            chosen = priority_class;
+                        } else if(worker.skipped[priority_class] >= STARVATION_LIMIT) {
+                            /* The lowest starving class goes first. */
+                            chosen = priority_class;
+                        }
+                    }
+                }
+                if(chosen == PriorityUtils::PRIORITY_COUNT) {
+                    return false;
+                }
+                for(size_t priority_class = 0; priority_class < PriorityUtils::PRIORITY_COUNT; priority_class++) {
+                    if(priority_class != chosen && !worker.jobs[priority_class].empty()) {
+                        worker.skipped[priority_class]++;
+                    }
+                }
+                worker.skipped[chosen] = 0;
+                Job& front(worker.jobs[chosen].front());
+                int64_t wait((std::chrono::steady_clock::now() - front.submit_time).count());
+                job = std::move(front.function);
+                worker.jobs[chosen].pop_front();
+                ClassMetrics& metrics(m_class_metrics[chosen]);
+                metrics.queued.fetch_sub(1, std::memory_order_relaxed);
+                metrics.started.fetch_add(1, std::memory_order_relaxed);
+                metrics.total_wait.fetch_add(wait, std::memory_order_relaxed);
+                int64_t max_wait(metrics.max_wait.load(std::memory_order_relaxed));
+                while(wait > max_wait && !metrics.max_wait.compare_exchange_weak(max_wait, wait, std::memory_order_relaxed)) {}
+                return true;
+            }
+
+            /**
+             * Take a job from the deques of another worker.
+             * @param worker The stealing worker.
+             * @param job Receives the job.
+             * @return true if a job was stolen.
+             */
+            bool steal(const Worker& worker, std::function<void()>& job) {
+                for(size_t victim : worker.victims) {
+                    if(take(*m_workers[victim], job)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * List the CPUs the process is allowed to run on, grouped by NUMA node. Nodes without allowed CPUs are left out.
+             * @return The allowed CPUs of each node, a single node if the topology is unknown, empty if the affinity can't be read.
+             */
+            static std::vector<std::vector<int>> getNodesCpus() {
+                std::vector<std::vector<int>> nodes;
+                cpu_set_t allowed;
+                CPU_ZERO(&allowed);
+                if(::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+                    return nodes;
+                }
+                std::error_code error;
+                std::vector<std::filesystem::path> node_directories;
+                for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+                    std::string name(entry.path().filename().string());
+                    if(name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                        node_directories.push_back(entry.path());
+                    }
+                }
+                std::sort(node_directories.begin(), node_directories.end());
+                std::vector<bool> is_listed(CPU_SETSIZE, false);
+                for(const std::filesystem::path& directory : node_directories) {
+                    std::vector<int> cpus;
+                    std::ifstream cpulist(directory / "cpulist");
+                    std::string range;
+                    /* The list looks like 0-3,8-11. */
+                    while(std::getline(cpulist, range, ',')) {
+                        size_t dash(range.find('-'));
+                        int first(std::stoi(range.substr(0, dash)));
+                        int last(dash == std::string::npos ? first : std::stoi(range.substr(dash + 1)));
+                        for(int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+                            if(CPU_ISSET(cpu, &allowed) && !is_listed[static_cast<size_t>(cpu)]) {
+                                cpus.push_back(cpu);
+                                is_listed[static_cast<size_t>(cpu)] = true;
+                            }
+                        }
+                    }
+                    if(!cpus.empty()) {
+                        nodes.push_back(cpus);
+                    }
+                }
+                if(nodes.empty()) {
+                    std::vector<int> cpus;
+                    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                        if(CPU_ISSET(cpu, &allowed)) {
+                            cpus.push_back(cpu);
+                        }
+                    }
+                    nodes.push_back(cpus);
+                }
+                return nodes;
+            }
+
+            /**
+             * Bind a thread to a set of CPUs, a failure is only logged.
+             * @param thread The thread.
+             * @param cpus The CPUs.
+             */
+            static void bindToCpus(std::thread& thread, const std::vector<int>& cpus) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for(int cpu : cpus) {
+                    CPU_SET(cpu, &set);
+                }
+                int error(::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set));
+                if(error != 0) {
+                    OWEBPP_LOG_WARNING(std::string("Unable to bind an executor thread to its NUMA node: ") + std::system_category().message(error));
+                }
+            }
+
+            /* Members */
+            /** The workers. */
+            std::vector<std::unique_ptr<Worker>> m_workers;
+
+            /** The worker receiving the next job submitted from outside the pool. */
+            std::atomic<size_t> m_next_worker;
+
+            /** The number of queued jobs. */
+            std::atomic<size_t> m_pending_jobs;
+
+            /** The mutex the idle workers sleep on. */
+            std::mutex m_sleep_mutex;
+
+            /** Wakes the idle workers up when jobs are queued or the pool stops. */
+            std::condition_variable m_wakeup;
+
+            /** Whether the pool is stopping, protected by m_sleep_mutex. */
+            bool m_stopping;
+
+            /** The metrics of each priority class. */
+            std::array<ClassMetrics, PriorityUtils::PRIORITY_COUNT> m_class_metrics;
+
+            /** The pool the calling thread is a worker of, nullptr if none. */
+            static inline thread_local Executor* s_executor = nullptr;
+
+            /** The index of the calling thread in its pool. */
+            static inline thread_local size_t s_worker_index = 0;
+    };
+
+    /**
+     * Suspends the awaiting coroutine while a function runs on an owebpp::Executor, the coroutine is resumed on the thread of its owebpp::AsyncContext with the result.
+     * Without an owebpp::AsyncContext on the calling thread the function runs inline instead.
+     * @tparam T The result type of the function.
+     */
+    template<class T>
+    class ExecutorAwaitable final {
+        public:
+            /* Constructors */
+            /**
+             * Construct an awaitable running the given function.
+             * @param executor The pool to run the function on.
+             * @param function The function.
+             * @param priority The priority class of the function.
+             */
+            ExecutorAwaitable(Executor& executor, std::function<T()> function, Priority priority = Priority::NORMAL):
+                m_executor(executor),
+                m_function(std::move(function)),
+                m_priority(priority),
+                m_result(),
+                m_exception(nullptr),
+                m_operation() {}
+
+            /* Deleted constructors */
+            ExecutorAwaitable() = delete;
+            ExecutorAwaitable(const ExecutorAwaitable& o) = delete;
+            ExecutorAwaitable(ExecutorAwaitable&& o) = delete;
+
+            /* Deleted assignment operators */
+            ExecutorAwaitable& operator=(const ExecutorAwaitable& o) = delete;
+            ExecutorAwaitable& operator=(ExecutorAwaitable&& o) = delete;
+
+            /* Destructor */
+            ~ExecutorAwaitable() = default;
+
+            /* Functions */
+            /**
+             * Run the function inline if the calling thread has no context.
+             * @return true if the function already ran.
+             */
+            bool await_ready() {
+                bool is_ready(AsyncContext::getCurrent() == nullptr);
+                if(is_ready) {
+                    runFunction();
+                }
+                return is_ready;
+            }
+
+            /**
+             * Submit the function to the pool, the coroutine is posted back to its context once the function returns.
+             * @param handle The suspended coroutine.
+             */
+            void await_suspend(std::coroutine_handle<> handle) {
+                m_operation.handle = handle;
+                AsyncContext* context(AsyncContext::getCurrent());
+                context->expectPost();
+                m_executor.submit([this, context]() {
+                    runFunction();
+                    context->post(m_operation);
+                }, m_priority);
+            }
+
+            /**
+             * Get the result of the function.
+             * @return The result.
+             * @throw Any exception thrown by the function.
+             */
+            T await_resume() {
+                if(m_exception != nullptr) {
+                    std::rethrow_exception(m_exception);
+                }
+                return std::move(*m_result);
+            }
+
+        private:
+            /* Functions */
+            /** Run the function and keep its result or exception. */
+            void runFunction() {
+                try {
+                    m_result.emplace(m_function());
+                } catch(...) {
+                    m_exception = std::current_exception();
+                }
+            }
+
+            /* Members */
+            /** The pool to run the function on. */
+            Executor& m_executor;
+
+            /** The function. */
+            std::function<T()> m_function;
+
+            /** The priority class of the function. */
+            Priority m_priority;
+
+            /** The result of the function. */
+            std::optional<T> m_result;
+
+            /** The exception thrown by the function, nullptr if none. */
+            std::exception_ptr m_exception;
+
+            /** The operation posted to the context. */
+            AsyncOperation m_operation;
+    };
+
+    /**
+     * Run a function on the shared owebpp::Executor from a coroutine: co_await owebpp::runOnExecutor([]() { return heavyWork(); }).
+     * @param function The function.
+     * @param priority The priority class of the function.
+     * @return The awaitable producing the result of the function.
+     */
+    template<class Tfunction>
+    ExecutorAwaitable<std::invoke_result_t<Tfunction>> runOnExecutor(Tfunction&& function, Priority priority = Priority::NORMAL) {
+        return ExecutorAwaitable<std::invoke_result_t<Tfunction>>(Executor::getInstance(), std::forward<Tfunction>(function), priority);
+    }
+}
+
+#endif // OWEBPP_EXECUTOR_HPP
@@ -0,0 +1,264 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_FLIGHT_RECORDER_HPP
+#define OWEBPP_FLIGHT_RECORDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace owebpp {
+    /**
+     * Keeps the last log lines in a fixed-size ring mapped from a file, so they survive a crash of the process without a system call per line.
+     * The mapping is shared, the kernel writes it back to the file even if the process is killed, but not if the machine stops.
+     * Any number of threads and processes can write to the same file: a writer reserves its record by moving the write position forward atomically,
+     * copies the line and then writes the position of the record in its header, which is how a reader tells complete records from the others.
+     * "owebpp-console logs:dump" prints the lines kept in the file, oldest first.
+     */
+    class FlightRecorder {
+        public:
+            /* Constants */
+            /** The magic string a flight recorder file starts with. */
+            static constexpr std::string_view MAGIC = "OWEBFLT1";
+
+            /** The size of the file header, the ring follows it. */
+            static constexpr uint64_t FILE_HEADER_SIZE = 64;
+
+            /** The size of a record header: the position of the record and the size of its line. */
+            static constexpr uint64_t RECORD_HEADER_SIZE = 16;
+
+            /** The default size of the ring. */
+            static constexpr uint64_t DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+            /* Constructors */
+            /**
+             * Map the file of the recorder, the lines kept in an existing file of the same capacity are kept.
+             * @param path The path of the file, it is created if needed.
+             * @param capacity The size of the ring, rounded up to a power of two of at least 4096 bytes.
+             * @throw std::system_error If the file can't be created or mapped.
+             */
+            explicit FlightRecorder(const std::string& path, uint64_t capacity = DEFAULT_CAPACITY):
+                m_capacity(roundCapacity(capacity)),
+                m_mapping(nullptr) {
+                int fd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644));
+                if(fd < 0) {
+                    throw std::system_error(errno, std::system_category(), "Unable to open flight recorder " + path);
+                }
+                /* The processes sharing the file don't initialize it concurrently. */
+                ::flock(fd, LOCK_EX);
+                int error(0);
+                struct stat status;
+                if(::fstat(fd, &status) != 0) {
+                    error = errno;
+                } else if(static_cast<uint64_t>(status.st_size) != FILE_HEADER_SIZE + m_capacity && ::ftruncate(fd, 0) != 0) {
+                    error = errno;
+                } else if(::ftruncate(fd, static_cast<off_t>(FILE_HEADER_SIZE + m_capacity)) != 0) {
+                    error = errno;
+                } else {
+                    void* mapping(::mmap(nullptr, FILE_HEADER_SIZE + m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+                    if(mapping == MAP_FAILED) {
+                        error = errno;
+                    } else {
+                        m_mapping = static_cast<char*>(mapping);
+                        if(std::string_view(m_mapping, MAGIC.size()) != MAGIC || readWord(m_mapping, MAGIC.size()) != m_capacity) {
+                            std::memset(m_mapping, 0, FILE_HEADER_SIZE + m_capacity);
+                            std::memcpy(m_mapping + MAGIC.size(), &m_capacity, sizeof(m_capacity));
+                            std::memcpy(m_mapping, MAGIC.data(), MAGIC.size());
+                        }
+                    }
+                }
+                ::flock(fd, LOCK_UN);
+                /* The mapping keeps the file alive. */
+                ::close(fd);
+                if(error != 0) {
+                    throw std::system_error(error, std::system_category(), "Unable to map flight recorder " + path);
+                }
+            }
+
+            /* Deleted constructors */
+            FlightRecorder() = delete;
+            FlightRecorder(const FlightRecorder& o) = delete;
+            FlightRecorder(FlightRecorder&& o) = delete;
+
+            /* Deleted assignment operators */
+            FlightRecorder& operator=(const FlightRecorder& o) = delete;
+            FlightRecorder& operator=(FlightRecorder&& o) = delete;
+
+            /* Destructor */
+            /** Unmap the file, the kernel writes the lines back to it. */
+            ~FlightRecorder() {
+                ::munmap(m_mapping, FILE_HEADER_SIZE + m_capacity);
+            }
+
+            /* Functions */
+            /**
+             * Record a line, this function can be called from any thread and doesn't make any system call.
+             * @param line The line, it is cut if it doesn't fit in the ring.
+             */
+            void write(std::string_view line) {
+                line = line.substr(0, m_capacity - RECORD_HEADER_SIZE);
+                uint64_t size(RECORD_HEADER_SIZE + align(line.size()));
+                uint64_t position(std::atomic_ref<uint64_t>(word(POSITION_OFFSET)).fetch_add(size, std::memory_order_relaxed));
+                uint64_t line_size(line.size());
+                copyToRing(position + sizeof(uint64_t), reinterpret_cast<const char*>(&line_size), sizeof(line_size));
+                copyToRing(position + RECORD_HEADER_SIZE, line.data(), line.size());
+                /* The position is written last, a record whose writer died before has the position of an older record. */
+                std::atomic_ref<uint64_t>(word(FILE_HEADER_SIZE + (position & (m_capacity - 1)))).store(position, std::memory_order_release);
+            }
+
+            /**
+             * Read the complete records of a flight recorder file, oldest first.
+             * @param file The content of the file.
+             * @param on_record Called with each line.
+             * @return The number of records read.
+             * @throw std::invalid_argument If the content isn't a flight recorder file.
+             */
+            template<class Tfunction>
+            static size_t readRecords(std::string_view file, Tfunction on_record) {
+                if(file.size() < FILE_HEADER_SIZE || file.substr(0, MAGIC.size()) != MAGIC
+                   || file.size() != FILE_HEADER_SIZE + readWord(file.data(), MAGIC.size())) {
+                    throw std::invalid_argument("Not a flight recorder file.");
+                }
+                uint64_t capacity(readWord(file.data(), MAGIC.size()));
+                const char* ring(file.data() + FILE_HEADER_SIZE);
+                uint64_t end(readWord(file.data(), POSITION_OFFSET));
+                uint64_t position(end > capacity ? end - capacity : 0);
+                std::string line;
+                size_t count(0);
+                /* The records are found by their position, so the scan resumes after a record overwritten or left incomplete. */
+                while(position + RECORD_HEADER_SIZE <= end) {
+                    uint64_t line_size(readRingWord(ring, capacity, position + sizeof(uint64_t)));
+                    if(readRingWord(ring, capacity, position) == position && line_size <= capacity - RECORD_HEADER_SIZE
+                       && position + RECORD_HEADER_SIZE + line_size <= end) {
+                        line.resize(line_size);
+                        for(uint64_t i = 0; i < line_size; i++) {
+                            line[i] = ring[(position + RECORD_HEADER_SIZE + i) & (capacity - 1)];
+                        }
+                        on_record(std::string_view(line));
+                        count++;
+                        position += RECORD_HEADER_SIZE + align(line_size);
+                    } else {
+                        position += sizeof(uint64_t);
+                    }
+                }
+                return count;
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the size of the ring.
+             * @return The size of the ring in bytes.
+             */
+            uint64_t getCapacity() const { return m_capacity; }
+
+        private:
+            /* Constants */
+            /** The offset of the write position in the file header, it counts the bytes ever reserved. */
+            static constexpr uint64_t POSITION_OFFSET = 16;
+
+            /* Functions */
+            /**
+             * Round a capacity up to a power of two.
+             * @param capacity The capacity.
+             * @return The rounded capacity, at least 4096.
+             */
+            static uint64_t roundCapacity(uint64_t capacity) {
+                uint64_t rounded(4096);
+                while(rounded < capacity) {
+                    rounded <<= 1;
+                }
+                return rounded;
+            }
+
+            /**
+             * Round a size up to a multiple of 8, so the record headers are aligned.
+             * @param size The size.
+             * @return The rounded size.
+             */
+            static uint64_t align(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+            /**
+             * Get an aligned word of the mapping.
+             * @param offset The offset of the word in the file.
+             * @return The word.
+             */
+            uint64_t& word(uint64_t offset) { return *reinterpret_cast<uint64_t*>(m_mapping + offset); }
+
+            /**
+             * Copy data to the ring, it wraps around its end.
+             * @param position The position of the data.
+             * @param data The data.
+             * @param size The size of the data.
+             */
+            void copyToRing(uint64_t position, const char* data, uint64_t size) {
+                uint64_t offset(position & (m_capacity - 1));
+                uint64_t first(std::min(size, m_capacity - offset));
+                std::memcpy(m_mapping + FILE_HEADER_SIZE + offset, data, first);
+                std::memcpy(m_mapping + FILE_HEADER_SIZE, data + first, size - first);
+            }
+
+            /**
+             * Read a word of a buffer.
+             * @param data The buffer.
+             * @param offset The offset of the word.
+             * @return The word.
+             */
+            static uint64_t readWord(const char* data, uint64_t offset) {
+                uint64_t value(0);
+                std::memcpy(&value, data + offset, sizeof(value));
+                return value;
+            }
+
+            /**
+             * Read an aligned word of a ring.
+             * @param ring The ring.
+             * @param capacity The size of the ring.
+             * @param position The position of the word.
+             * @return The word.
+             */
+            static uint64_t readRingWord(const char* ring, uint64_t capacity, uint64_t position) {
+                return readWord(ring, position & (capacity - 1));
+            }
+
+            /* Members */
+            /** The size of the ring. */
+            uint64_t m_capacity;
+
+            /** The mapping of the file. */
+            char* m_mapping;
+    };
+}
+
+#endif // OWEBPP_FLIGHT_RECORDER_HPP
@@ -0,0 +1,139 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_GENERATOR_HPP
+#define OWEBPP_GENERATOR_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace owebpp {
+    /**
+     * A coroutine that lazily produces a sequence of values through co_yield.
+     * It is mainly used to produce the content of a streamed owebpp::Response chunk by chunk, see owebpp::Response::setContentGenerator().
+     */
+    template<class T>
+    class Generator {
+        public:
+            /** The promise type required by the compiler to build a coroutine returning a Generator. */
+            class promise_type {
+                public:
+                    /* Functions */
+                    /**
+                     * Build the Generator returned to the caller of the coroutine.
+                     * @return The Generator associated to this promise.
+                     */
+                    Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+                    /** The coroutine doesn't run until the first value is requested. */
+                    std::suspend_always initial_suspend() noexcept { return {}; }
+
+                    /** Keep the coroutine frame alive so the Generator can detect the end of the sequence. */
+                    std::suspend_always final_suspend() noexcept { return {}; }
+
+                    /**
+                     * Store the yielded value and suspend the coroutine until the next value is requested.
+                     * @param value The yielded value.
+                     */
+                    template<class Tvalue>
+                    std::suspend_always yield_value(Tvalue&& value) {
+                        m_value = std::forward<Tvalue>(value);
+                        return {};
+                    }
+
+                    /** Nothing to do when the sequence ends. */
+                    void return_void() noexcept {}
+
+                    /** Store the exception so it can be rethrown to the consumer. */
+                    void unhandled_exception() { m_exception = std::current_exception(); }
+
+                    /* Members */
+                    /** The last yielded value. */
+                    std::optional<T> m_value = std::nullopt;
+
+                    /** The exception thrown by the coroutine if any. */
+                    std::exception_ptr m_exception = nullptr;
+            };
+
+            /* Constructors */
+            /**
+             * Construct a Generator taking the ownership of the given coroutine.
+             * @param handle The coroutine handle.
+             */
+            explicit Generator(std::coroutine_handle<promise_type> handle):
+                m_handle(handle) {}
+
+            /**
+             * Move construct a Generator, the moved from Generator no longer owns any coroutine.
+             * @param o The Generator to move from.
+             */
+            Generator(Generator&& o) noexcept:
+                m_handle(std::exchange(o.m_handle, nullptr)) {}
+
+            /* Deleted constructors */
+            Generator() = delete;
+            Generator(const Generator& o) = delete;
+
+            /* Deleted assignment operators */
+            Generator& operator=(const Generator& o) = delete;
+            Generator& operator=(Generator&& o) = delete;
+
+            /* Destructor */
+            ~Generator() {
+                if(m_handle) {
+                    m_handle.destroy();
+                }
+            }
+
+            /* Functions */
+            /**
+             * Resume the coroutine until it yields the next value.
+             * @param value Receives the next value of the sequence.
+             * @return true if a value was produced, false if the sequence is over.
+             */
+            bool next(T& value) {
+                bool produced(false);
+                if(m_handle && !m_handle.done()) {
+                    m_handle.resume();
+                    if(m_handle.promise().m_exception) {
+                        std::rethrow_exception(std::exchange(m_handle.promise().m_exception, nullptr));
+                    }
+                    if(!m_handle.done() && m_handle.promise().m_value.has_value()) {
+                        value = std::move(*m_handle.promise().m_value);
+                        m_handle.promise().m_value.reset();
+                        produced = true;
+                    }
+                }
+                return produced;
+            }
+
+        private:
+            /* Members */
+            /** The coroutine producing the values. */
+            std::coroutine_handle<promise_type> m_handle;
+    };
+}
+
+#endif // OWEBPP_GENERATOR_HPP
@@ -25,6 +25,9 @@
 #define OWEBPP_HTTP_METHOD_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
 namespace owebpp {
     /** Lists all the HTTP methods that the framework supports. */
@@ -47,6 +50,20 @@ namespace owebpp {
         HTTP_TRACE=     16384
     };
 
+    /**
+     * Pack the first 8 bytes of a method token into an integer, the missing bytes are 0.
+     * This is a free function so HttpMethodUtils can use it in case labels.
+     * @param token The token.
+     * @return The packed token.
+     */
+    constexpr uint64_t packHttpMethodToken(std::string_view token) {
+        uint64_t packed(0);
+        for(size_t i = 0; i < token.size() && i < 8; i++) {
+            packed |= static_cast<uint64_t>(static_cast<unsigned char>(token[i])) << (8 * i);
+        }
+        return packed;
+    }
+
     /** Provides utility functions to convert to and from string. */
     class HttpMethodUtils final {
         public:
@@ -104,6 +121,67 @@ namespace owebpp {
                 return method;
             }
 
+            /**
+             * Convert a method token to an HttpMethod with a single integer comparison instead of string comparisons.
+             * The token must not contain NUL bytes, which an HTTP token can't contain.
+             * @param token The method token, case sensitive.
+             * @return The HttpMethod corresponding to the given token.
+             */
+            static constexpr HttpMethod convertMethodTokenToValue(std::string_view token) {
+                HttpMethod method = HttpMethod::HTTP_UNKNOWN;
+                if(token.size() <= 8) {
+                    switch(packHttpMethodToken(token)) {
+                        case packHttpMethodToken("GET"):
+                            method = HttpMethod::HTTP_GET;
+                            break;
+                        case packHttpMethodToken("HEAD"):
+                            method = HttpMethod::HTTP_HEAD;
+                            break;
+                        case packHttpMethodToken("POST"):
+                            method = HttpMethod::HTTP_POST;
+                            break;
+                        case packHttpMethodToken("PUT"):
+                            method = HttpMethod::HTTP_PUT;
+                            break;
+                        case packHttpMethodToken("DELETE"):
+                            method = HttpMethod::HTTP_DELETE;
+                            break;
+                        case packHttpMethodToken("MKCOL"):
+                            method = HttpMethod::HTTP_MKCOL;
+                            break;
+                        case packHttpMethodToken("COPY"):
+                            method = HttpMethod::HTTP_COPY;
+                            break;
+                        case packHttpMethodToken("MOVE"):
+                            method = HttpMethod::HTTP_MOVE;
+                            break;
+                        case packHttpMethodToken("OPTIONS"):
+                            method = HttpMethod::HTTP_OPTIONS;
+                            break;
+                        case packHttpMethodToken("PROPFIND"):
+                            method = HttpMethod::HTTP_PROPFIND;
+                            break;
+                        case packHttpMethodToken("LOCK"):
+                            method = HttpMethod::HTTP_LOCK;
+                            break;
+                        case packHttpMethodToken("UNLOCK"):
+                            method = HttpMethod::HTTP_UNLOCK;
+                            break;
+                        case packHttpMethodToken("PATCH"):
+                            method = HttpMethod::HTTP_PATCH;
+                            break;
+                        case packHttpMethodToken("TRACE"):
+                            method = HttpMethod::HTTP_TRACE;
+                            break;
+                        default:
+                            break;
+                    }
+                } else if(token.size() == 9 && packHttpMethodToken(token.substr(0, 8)) == packHttpMethodToken("PROPPATC") && token[8] == 'H') {
+                    method = HttpMethod::HTTP_PROPPATCH;
+                }
+                return method;
+            }
+
             /**
              * Convert an HttpMethod to a string.
              * @param method The HttpMethod to convert to a string.
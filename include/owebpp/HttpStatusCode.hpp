@@ -24,6 +24,9 @@
 #ifndef OWEBPP_HTTP_STATUS_CODE_HPP
 #define OWEBPP_HTTP_STATUS_CODE_HPP
 
+#include <cstddef>
+#include <string_view>
+
 namespace owebpp {
     /** Lists all the HTTP response codes the framework supports. */
     enum class HttpStatusCode: size_t {
@@ -100,5 +103,226 @@ namespace owebpp {
         NOT_EXTENDED = 510,
         NETWORK_AUTHENTICATION_REQUIRED = 511
     };
+
+    /** Provides utility functions for HTTP status codes. */
+    class HttpStatusCodeUtils final {
+        public:
+            /* Deleted constructors */
+            HttpStatusCodeUtils() = delete;
+            HttpStatusCodeUtils(const HttpStatusCodeUtils& o) = delete;
+            HttpStatusCodeUtils(HttpStatusCodeUtils&& o) = delete;
+
+            /* Deleted assignment operators */
+            HttpStatusCodeUtils& operator=(const HttpStatusCodeUtils& o) = delete;
+            HttpStatusCodeUtils& operator=(HttpStatusCodeUtils&& o) = delete;
+
+            /* Deleted destructor */
+            ~HttpStatusCodeUtils() = delete;
+
+            /* Functions */
+            /**
+             * Get the reason phrase sent in the status line for a status code.
+             * @param status_code The status code.
+             * @return The reason phrase of the status code.
+             */
+            static std::string_view getReasonPhrase(HttpStatusCode status_code) {
+                std::string_view phrase;
+                switch(status_code) {
+                    case HttpStatusCode::CONTINUE:
+                        phrase = "Continue";
+                        break;
+                    case HttpStatusCode::SWITCHING_PROTOCOLS:
+                        phrase = "Switching Protocols";
+                        break;
+                    case HttpStatusCode::PROCESSING:
+                        phrase = "Processing";
+                        break;
+                    case HttpStatusCode::EARLY_HINTS:
+                        phrase = "Early Hints";
+                        break;
+                    case HttpStatusCode::OK:
+                        phrase = "OK";
+                        break;
+                    case HttpStatusCode::CREATED:
+                        phrase = "Created";
+                        break;
+                    case HttpStatusCode::ACCEPTED:
+                        phrase = "Accepted";
+                        break;
+                    case HttpStatusCode::NON_AUTHORITATIVE_INFORMATION:
+                        phrase = "Non-Authoritative Information";
+                        break;
+                    case HttpStatusCode::NO_CONTENT:
+                        phrase = "No Content";
+                        break;
+                    case HttpStatusCode::RESET_CONTENT:
+                        phrase = "Reset Content";
+                        break;
+                    case HttpStatusCode::PARTIAL_CONTENT:
+                        phrase = "Partial Content";
+                        break;
+                    case HttpStatusCode::MULTI_STATUS:
+                        phrase = "Multi-Status";
+                        break;
+                    case HttpStatusCode::ALREADY_REPORTED:
+                        phrase = "Already Reported";
+                        break;
+                    case HttpStatusCode::IM_USED:
+                        phrase = "IM Used";
+                        break;
+                    case HttpStatusCode::MULTIPLE_CHOICES:
+                        phrase = "Multiple Choices";
+                        break;
+                    case HttpStatusCode::MOVED_PERMANENTLY:
+                        phrase = "Moved Permanently";
+                        break;
+                    case HttpStatusCode::FOUND:
+                        phrase = "Found";
+                        break;
+                    case HttpStatusCode::SEE_OTHER:
+                        phrase = "See Other";
+                        break;
+                    case HttpStatusCode::NOT_MODIFIED:
+                        phrase = "Not Modified";
+                        break;
+                    case HttpStatusCode::USE_PROXY:
+                        phrase = "Use Proxy";
+                        break;
+                    case HttpStatusCode::UNUSED:
+                        phrase = "Unused";
+                        break;
+                    case HttpStatusCode::TEMPORARY_REDIRECT:
+                        phrase = "Temporary Redirect";
+                        break;
+                    case HttpStatusCode::PERMANENT_REDIRECT:
+                        phrase = "Permanent Redirect";
+                        break;
+                    case HttpStatusCode::BAD_REQUEST:
+                        phrase = "Bad Request";
+                        break;
+                    case HttpStatusCode::UNAUTHORIZED:
+                        phrase = "Unauthorized";
+                        break;
+                    case HttpStatusCode::PAYMENT_REQUIRED:
+                        phrase = "Payment Required";
+                        break;
+                    case HttpStatusCode::FORBIDDENT:
+                        phrase = "Forbidden";
+                        break;
+                    case HttpStatusCode::NOT_FOUND:
+                        phrase = "Not Found";
+                        break;
+                    case HttpStatusCode::METHOD_NOT_ALLOWED:
+                        phrase = "Method Not Allowed";
+                        break;
+                    case HttpStatusCode::NOT_ACCEPTABLE:
+                        phrase = "Not Acceptable";
+                        break;
+                    case HttpStatusCode::PROXY_AUTHENTICATION_REQUIRED:
+                        phrase = "Proxy Authentication Required";
+                        break;
+                    case HttpStatusCode::REQUEST_TIMEOUT:
+                        phrase = "Request Timeout";
+                        break;
+                    case HttpStatusCode::CONFLICT:
+                        phrase = "Conflict";
+                        break;
+                    case HttpStatusCode::GONE:
+                        phrase = "Gone";
+                        break;
+                    case HttpStatusCode::LENGTH_REQUIRED:
+                        phrase = "Length Required";
+                        break;
+                    case HttpStatusCode::PRECONDITION_FAILED:
+                        phrase = "Precondition Failed";
+                        break;
+                    case HttpStatusCode::PAYLOAD_TOO_LARGE:
+                        phrase = "Content Too Large";
+                        break;
+                    case HttpStatusCode::URI_TOO_LONG:
+                        phrase = "URI Too Long";
+                        break;
+                    case HttpStatusCode::UNSUPPORTED_MEDIA_TYPE:
+                        phrase = "Unsupported Media Type";
+                        break;
+                    case HttpStatusCode::RANGE_NOT_SATISFIABLE:
+                        phrase = "Range Not Satisfiable";
+                        break;
+                    case HttpStatusCode::EXPECTATIONS_FAILED:
+                        phrase = "Expectation Failed";
+                        break;
+                    case HttpStatusCode::IM_A_TEA_POT:
+                        phrase = "I'm a teapot";
+                        break;
+                    case HttpStatusCode::MISDIRECTED_REQUEST:
+                        phrase = "Misdirected Request";
+                        break;
+                    case HttpStatusCode::UNPROCESSABLE_CONTENT:
+                        phrase = "Unprocessable Content";
+                        break;
+                    case HttpStatusCode::LOCKED:
+                        phrase = "Locked";
+                        break;
+                    case HttpStatusCode::FAILED_DEPENDENCY:
+                        phrase = "Failed Dependency";
+                        break;
+                    case HttpStatusCode::TOO_EARLY:
+                        phrase = "Too Early";
+                        break;
+                    case HttpStatusCode::UPGRADE_REQUIRED:
+                        phrase = "Upgrade Required";
+                        break;
+                    case HttpStatusCode::PRECONDITION_REQUIRED:
+                        phrase = "Precondition Required";
+                        break;
+                    case HttpStatusCode::TOO_MANY_REQUESTS:
+                        phrase = "Too Many Requests";
+                        break;
+                    case HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE:
+                        phrase = "Request Header Fields Too Large";
+                        break;
+                    case HttpStatusCode::UNAVAILABLE_FOR_LEGAL_REASONS:
+                        phrase = "Unavailable For Legal Reasons";
+                        break;
+                    case HttpStatusCode::INTERNAL_SERVER_ERROR:
+                        phrase = "Internal Server Error";
+                        break;
+                    case HttpStatusCode::NOT_IMPLEMENTED:
+                        phrase = "Not Implemented";
+                        break;
+                    case HttpStatusCode::BAD_GATEWAY:
+                        phrase = "Bad Gateway";
+                        break;
+                    case HttpStatusCode::SERVICE_UNAVAILABLE:
+                        phrase = "Service Unavailable";
+                        break;
+                    case HttpStatusCode::GATEWAY_TIMEOUT:
+                        phrase = "Gateway Timeout";
+                        break;
+                    case HttpStatusCode::HTTP_VERSION_NOT_SUPPORTED:
+                        phrase = "HTTP Version Not Supported";
+                        break;
+                    case HttpStatusCode::VARIANT_ALSO_NEGOTIATES:
+                        phrase = "Variant Also Negotiates";
+                        break;
+                    case HttpStatusCode::INSUFFICIENT_STORAGE:
+                        phrase = "Insufficient Storage";
+                        break;
+                    case HttpStatusCode::LOOP_DETECTED:
+                        phrase = "Loop Detected";
+                        break;
+                    case HttpStatusCode::NOT_EXTENDED:
+                        phrase = "Not Extended";
+                        break;
+                    case HttpStatusCode::NETWORK_AUTHENTICATION_REQUIRED:
+                        phrase = "Network Authentication Required";
+                        break;
+                    default:
+                        phrase = "Unknown";
+                        break;
+                }
+                return phrase;
+            }
+    };
 }
 #endif //OWEBPP_HTTP_STATUS_CODE_HPP
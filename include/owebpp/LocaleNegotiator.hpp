@@ -0,0 +1,252 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_LOCALE_NEGOTIATOR_HPP
+#define OWEBPP_LOCALE_NEGOTIATOR_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <owebpp/LruCache.hpp>
+#include <owebpp/Translator.hpp>
+
+namespace owebpp {
+    /** A language range of an Accept-Language header and its weight. */
+    struct LanguageRange {
+        /** The language range, normalized by owebpp::LocaleNegotiator::normalize(). */
+        std::string range{};
+
+        /** The weight, between 0 and 1. */
+        double quality{1.0};
+    };
+
+    /**
+     * This class chooses the translator of a request from its Accept-Language header among the translators of the available locales.
+     * The negotiated translator is cached per distinct header value, as clients send the same few values over and over.
+     */
+    class LocaleNegotiator {
+        public:
+            /* Constants */
+            /** The default number of header values cached. */
+            static constexpr size_t DEFAULT_CACHE_CAPACITY = 1024;
+
+            /** The longest header value cached, longer ones are negotiated on each request so that they can't evict the common ones. */
+            static constexpr size_t MAXIMUM_CACHED_SIZE = 256;
+
+            /* Constructors */
+            /**
+             * Construct a negotiator.
+             * @param translators The translators indexed by locale, e.g "en-US", the locales are compared without case sensitivity and '_' matches '-'.
+             * @param default_locale The locale used when none of the accepted ones is available.
+             * @param cache_capacity The number of header values cached.
+             * @throw std::invalid_argument If the default locale has no translator.
+             */
+            LocaleNegotiator(const std::map<std::string, std::shared_ptr<Translator>>& translators, const std::string& default_locale,
+                             size_t cache_capacity = DEFAULT_CACHE_CAPACITY):
+                m_translators(),
+                m_default_translator(nullptr),
+                m_cache(cache_capacity) {
+                for(const auto& [locale, translator] : translators) {
+                    if(translator == nullptr) {
+                        throw std::invalid_argument("Locale " + locale + " has no translator.");
+                    }
+                    m_translators.emplace(normalize(locale), translator);
+                }
+                auto default_translator(m_translators.find(normalize(default_locale)));
+                if(default_translator == m_translators.end()) {
+                    throw std::invalid_argument("Default locale " + default_locale + " has no translator.");
+                }
+                m_default_translator = default_translator->second;
+            }
+
+            /* Deleted constructors */
+            LocaleNegotiator() = delete;
+            LocaleNegotiator(const LocaleNegotiator& o) = delete;
+            LocaleNegotiator(LocaleNegotiator&& o) = delete;
+
+            /* Deleted assignment operators */
+            LocaleNegotiator& operator=(const LocaleNegotiator& o) = delete;
+            LocaleNegotiator& operator=(LocaleNegotiator&& o) = delete;
+
+            /* Destructor */
+            ~LocaleNegotiator() = default;
+
+            /* Functions */
+            /**
+             * Get the translator of the most preferred available locale.
+             * @param accept_language The value of the Accept-Language header, empty if it wasn't sent.
+             * @return The translator, the one of the default locale if none of the accepted locales is available.
+             */
+            std::shared_ptr<Translator> resolve(std::string_view accept_language) {
+                std::shared_ptr<Translator> translator;
+                if(accept_language.empty()) {
+                    translator = m_default_translator;
+                } else if(accept_language.size() > MAXIMUM_CACHED_SIZE) {
+                    translator = negotiate(accept_language);
+                } else {
+                    std::optional<std::shared_ptr<Translator>> cached(m_cache.get(accept_language));
+                    if(cached.has_value()) {
+                        translator = *cached;
+                    } else {
+                        translator = negotiate(accept_language);
+                        m_cache.put(accept_language, translator);
+                    }
+                }
+                return translator;
+            }
+
+            /**
+             * Parse the value of an Accept-Language header, see RFC 9110 section 12.5.4.
+             * @param accept_language The header value.
+             * @return The language ranges, the most preferred first, without the ones of weight 0 or with an invalid weight.
+             */
+            static std::vector<LanguageRange> parseAcceptLanguage(std::string_view accept_language) {
+                std::vector<LanguageRange> ranges;
+                while(!accept_language.empty()) {
+                    size_t comma(accept_language.find(','));
+                    std::string_view element(accept_language.substr(0, comma));
+                    accept_language.remove_prefix(comma == std::string_view::npos ? accept_language.size() : comma + 1);
+                    size_t semicolon(element.find(';'));
+                    LanguageRange range{normalize(trim(element.substr(0, semicolon))), 1.0};
+                    bool is_valid(!range.range.empty());
+                    if(is_valid && semicolon != std::string_view::npos) {
+                        std::string_view weight(trim(element.substr(semicolon + 1)));
+                        is_valid = weight.size() > 2 && (weight[0] == 'q' || weight[0] == 'Q') && weight[1] == '=';
+                        if(is_valid) {
+                            weight.remove_prefix(2);
+                            auto [end, error] = std::from_chars(weight.data(), weight.data() + weight.size(), range.quality);
+                            is_valid = error == std::errc() && end == weight.data() + weight.size() && range.quality >= 0.0 && range.quality <= 1.0;
+                        }
+                    }
+                    if(is_valid && range.quality > 0.0) {
+                        ranges.push_back(std::move(range));
+                    }
+                }
+                std::stable_sort(ranges.begin(), ranges.end(), [](const LanguageRange& a, const LanguageRange& b) {
+                    return a.quality > b.quality;
+                });
+                return ranges;
+            }
+
+            /**
+             * Normalize a locale or a language range so that they can be compared, e.g "en_US" becomes "en-us".
+             * @param locale The locale.
+             * @return The normalized locale.
+             */
+            static std::string normalize(std::string_view locale) {
+                std::string normalized(locale);
+                for(char& c : normalized) {
+                    c = c == '_' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                return normalized;
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the translator of the default locale.
+             * @return the translator of the default locale.
+             */
+            const std::shared_ptr<Translator>& getDefaultTranslator() const { return m_default_translator; }
+
+        private:
+            /* Functions */
+            /**
+             * Find the translator of the most preferred available locale, without the cache.
+             * Each range is looked up as is, then without its last subtags, e.g "fr-ca" then "fr", then matches the first locale of the same language, e.g "fr-fr".
+             * @param accept_language The header value.
+             * @return The translator.
+             */
+            std::shared_ptr<Translator> negotiate(std::string_view accept_language) const {
+                std::shared_ptr<Translator> translator;
+                std::vector<LanguageRange> ranges(parseAcceptLanguage(accept_language));
+                for(auto range(ranges.begin()); range != ranges.end() && translator == nullptr; ++range) {
+                    if(range->range == "*") {
+                        translator = m_default_translator;
+                    } else {
+                        translator = lookup(range->range);
+                    }
+                }
+                return translator == nullptr ? m_default_translator : translator;
+            }
+
+            /**
+             * Find the translator of a language range.
+             * @param range The normalized language range.
+             * @return The translator, nullptr if no available locale matches the range.
+             */
+            std::shared_ptr<Translator> lookup(std::string_view range) const {
+                std::shared_ptr<Translator> translator;
+                std::string_view truncated(range);
+                while(translator == nullptr && !truncated.empty()) {
+                    auto exact(m_translators.find(truncated));
+                    if(exact != m_translators.end()) {
+                        translator = exact->second;
+                    } else {
+                        size_t dash(truncated.rfind('-'));
+                        truncated = truncated.substr(0, dash == std::string_view::npos ? 0 : dash);
+                    }
+                }
+                if(translator == nullptr) {
+                    std::string_view language(range.substr(0, range.find('-')));
+                    auto candidate(m_translators.lower_bound(language));
+                    if(candidate != m_translators.end() && candidate->first.size() > language.size()
+                       && candidate->first.compare(0, language.size(), language) == 0 && candidate->first[language.size()] == '-') {
+                        translator = candidate->second;
+                    }
+                }
+                return translator;
+            }
+
+            /**
+             * Remove the spaces and tabulations around a string.
+             * @param value The string.
+             * @return The trimmed string.
+             */
+            static std::string_view trim(std::string_view value) {
+                size_t begin(value.find_first_not_of(" \t"));
+                size_t end(value.find_last_not_of(" \t"));
+                return begin == std::string_view::npos ? std::string_view() : value.substr(begin, end - begin + 1);
+            }
+
+            /* Members */
+            /** The translators indexed by normalized locale. */
+            std::map<std::string, std::shared_ptr<Translator>, std::less<>> m_translators;
+
+            /** The translator of the default locale. */
+            std::shared_ptr<Translator> m_default_translator;
+
+            /** The negotiated translators indexed by header value. */
+            LruCache<std::shared_ptr<Translator>> m_cache;
+    };
+}
+
+#endif // OWEBPP_LOCALE_NEGOTIATOR_HPP
@@ -0,0 +1,74 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_LOG_LEVEL_HPP
+#define OWEBPP_LOG_LEVEL_HPP
+
+/**
+ * The logs below this level are removed at compile time, e.g. -DOWEBPP_MIN_LOG_LEVEL=LOG_WARNING.
+ * Their message expressions are still compiled but never evaluated.
+ */
+#ifndef OWEBPP_MIN_LOG_LEVEL
+    #define OWEBPP_MIN_LOG_LEVEL LOG_DEBUG
+#endif
+
+namespace owebpp {
+    /** Lists the log levels the logger has. */
+    enum class LogLevel {
+        LOG_DEBUG,
+        LOG_INFO,
+        LOG_WARNING,
+        LOG_ERROR,
+        LOG_FATAL
+    };
+
+    /** Utility class for the log levels. */
+    class LogLevelUtils final {
+        public:
+            /* Deleted constructors */
+            LogLevelUtils() = delete;
+            LogLevelUtils(const LogLevelUtils& o) = delete;
+            LogLevelUtils(LogLevelUtils&& o) = delete;
+
+            /* Deleted assignment operators */
+            LogLevelUtils& operator=(const LogLevelUtils& o) = delete;
+            LogLevelUtils& operator=(LogLevelUtils&& o) = delete;
+
+            /* Deleted destructor */
+            ~LogLevelUtils() = delete;
+
+            /* Constants */
+            /** The minimal level of the logs kept at compile time. */
+            static constexpr LogLevel MIN_LOG_LEVEL = LogLevel::OWEBPP_MIN_LOG_LEVEL;
+
+            /* Functions */
+            /**
+             * Tell if the logs of a level are kept at compile time.
+             * @param log_level The LogLevel.
+             * @return true if the logs of the level are compiled in, false otherwise.
+             */
+            static constexpr bool isCompiled(LogLevel log_level) { return log_level >= MIN_LOG_LEVEL; }
+    };
+}
+
+#endif // OWEBPP_LOG_LEVEL_HPP
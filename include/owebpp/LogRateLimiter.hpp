@@ -0,0 +1,133 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_LOG_RATE_LIMITER_HPP
+#define OWEBPP_LOG_RATE_LIMITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace owebpp {
+    /**
+     * Limits the logs of a call site, the OWEBPP_LOG_*_LIMITED macros keep one per call site.
+     * The first logs of each interval are written, the next ones are sampled or suppressed, and the next written log reports how many were suppressed.
+     * The state is kept in relaxed atomic counters, the limit is approximate while a new interval starts but no log ever waits.
+     */
+    class LogRateLimiter {
+        public:
+            /* Constructors */
+            /**
+             * Construct a limiter, its first interval starts now.
+             * @param burst The number of logs written per interval.
+             * @param interval The length of an interval.
+             * @param sample_rate Once the burst is spent, one log out of sample_rate is still written, 0 suppresses them all.
+             */
+            LogRateLimiter(uint64_t burst, std::chrono::milliseconds interval, uint64_t sample_rate = 0):
+                m_burst(burst),
+                m_interval(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()),
+                m_sample_rate(sample_rate),
+                m_window_start(now()),
+                m_count(0),
+                m_suppressed(0) {}
+
+            /* Deleted constructors */
+            LogRateLimiter() = delete;
+            LogRateLimiter(const LogRateLimiter& o) = delete;
+            LogRateLimiter(LogRateLimiter&& o) = delete;
+
+            /* Deleted assignment operators */
+            LogRateLimiter& operator=(const LogRateLimiter& o) = delete;
+            LogRateLimiter& operator=(LogRateLimiter&& o) = delete;
+
+            /* Destructor */
+            ~LogRateLimiter() = default;
+
+            /* Functions */
+            /**
+             * Tell if a log must be written, this function can be called from any thread.
+             * @param suppressed Receives the number of logs suppressed since the last written one, if this one is written.
+             * @return true if the log must be written, false if it is suppressed.
+             */
+            bool tryAcquire(uint64_t& suppressed) {
+                int64_t time(now());
+                int64_t window_start(m_window_start.load(std::memory_order_relaxed));
+                if(time - window_start >= m_interval && m_window_start.compare_exchange_strong(window_start, time, std::memory_order_relaxed)) {
+                    m_count.store(0, std::memory_order_relaxed);
+                }
+                uint64_t count(m_count.fetch_add(1, std::memory_order_relaxed));
+                bool is_written(count < m_burst || (m_sample_rate > 0 && (count - m_burst + 1) % m_sample_rate == 0));
+                if(is_written) {
+                    suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+                } else {
+                    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                }
+                return is_written;
+            }
+
+            /**
+             * Append the number of suppressed logs to a message.
+             * @param message The message.
+             * @param suppressed The number of logs suppressed before it, nothing is appended if it is 0.
+             * @return The message.
+             */
+            static std::string withSummary(std::string message, uint64_t suppressed) {
+                if(suppressed > 0) {
+                    message.append(" (").append(std::to_string(suppressed)).append(" similar messages suppressed)");
+                }
+                return message;
+            }
+
+        private:
+            /* Functions */
+            /**
+             * Get the current time.
+             * @return The time of the steady clock in nanoseconds.
+             */
+            static int64_t now() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            /* Members */
+            /** The number of logs written per interval. */
+            uint64_t m_burst;
+
+            /** The length of an interval in nanoseconds. */
+            int64_t m_interval;
+
+            /** One log out of m_sample_rate is written once the burst is spent, 0 if none is. */
+            uint64_t m_sample_rate;
+
+            /** The start of the current interval in nanoseconds. */
+            std::atomic<int64_t> m_window_start;
+
+            /** The number of logs made in the current interval. */
+            std::atomic<uint64_t> m_count;
+
+            /** The number of logs suppressed since the last written one. */
+            std::atomic<uint64_t> m_suppressed;
+    };
+}
+
+#endif // OWEBPP_LOG_RATE_LIMITER_HPP
@@ -24,58 +24,180 @@
 #ifndef OWEBPP_LOGGER_HPP
 #define OWEBPP_LOGGER_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <chrono>
-#include <iomanip>
+#include <cstdint>
+#include <ctime>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <source_location>
+#include <string>
+#include <string_view>
+
+#include <owebpp/AsyncLogWriter.hpp>
+#include <owebpp/BinaryLog.hpp>
+#include <owebpp/FlightRecorder.hpp>
+#include <owebpp/LogLevel.hpp>
+#include <owebpp/LogRateLimiter.hpp>
+#include <owebpp/Snapshot.hpp>
 
 // This macro allows to choose if the metadata (file, function name, line and column should be printed since it might contain sensitive information.
 #ifdef DISABLE_METADATA_LOG
-    #define OWEBPP_LOG_DEBUG(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_DEBUG, message)
-    #define OWEBPP_LOG_INFO(message)     owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_INFO, message)
-    #define OWEBPP_LOG_WARNING(message)  owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_WARNING, message)
-    #define OWEBPP_LOG_ERROR(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_ERROR, message)
-    #define OWEBPP_LOG_FATAL(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_FATAL, message)
+    #define OWEBPP_LOG_MESSAGE(logger, level, message) logger.log(level, message)
+    #define OWEBPP_LOG_SITE(level, format) owebpp::LogSite{level, format, "", "", 0, 0}
 #else
-    #define OWEBPP_LOG_DEBUG(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_DEBUG, std::source_location::current(), message)
-    #define OWEBPP_LOG_INFO(message)     owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_INFO, std::source_location::current(), message)
-    #define OWEBPP_LOG_WARNING(message)  owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_WARNING, std::source_location::current(), message)
-    #define OWEBPP_LOG_ERROR(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_ERROR, std::source_location::current(), message)
-    #define OWEBPP_LOG_FATAL(message)    owebpp::Logger::getInstance().log(owebpp::LogLevel::LOG_FATAL, std::source_location::current(), message)
+    #define OWEBPP_LOG_MESSAGE(logger, level, message) logger.log(level, std::source_location::current(), message)
+    #define OWEBPP_LOG_SITE(level, format) owebpp::LogSite::at(level, format, std::source_location::current())
 #endif
 
+/**
+ * Log a message, the message expression is only evaluated when the level is written.
+ * The logs below OWEBPP_MIN_LOG_LEVEL are discarded at compile time, the others check the minimal level of the logger first.
+ */
+#define OWEBPP_LOG(level, message)                                                                                      \
+    do {                                                                                                                \
+        if constexpr(owebpp::LogLevelUtils::isCompiled(level)) {                                                        \
+            owebpp::Logger& owebpp_logger(owebpp::Logger::getInstance());                                              \
+            if(owebpp_logger.isEnabled(level)) {                                                                        \
+                OWEBPP_LOG_MESSAGE(owebpp_logger, level, message);                                                      \
+            }                                                                                                           \
+        }                                                                                                               \
+    } while(false)
+
+#define OWEBPP_LOG_DEBUG(message)    OWEBPP_LOG(owebpp::LogLevel::LOG_DEBUG, message)
+#define OWEBPP_LOG_INFO(message)     OWEBPP_LOG(owebpp::LogLevel::LOG_INFO, message)
+#define OWEBPP_LOG_WARNING(message)  OWEBPP_LOG(owebpp::LogLevel::LOG_WARNING, message)
+#define OWEBPP_LOG_ERROR(message)    OWEBPP_LOG(owebpp::LogLevel::LOG_ERROR, message)
+#define OWEBPP_LOG_FATAL(message)    OWEBPP_LOG(owebpp::LogLevel::LOG_FATAL, message)
+
+/**
+ * Log a message of a call site that may fire on every request: the first burst logs of each interval are written, then one out of sample_rate (0 for none).
+ * The next written log tells how many were suppressed. The limiter of the call site is only created once its level is enabled.
+ */
+#define OWEBPP_LOG_SAMPLED(level, burst, interval, sample_rate, message)                                                \
+    do {                                                                                                                \
+        if constexpr(owebpp::LogLevelUtils::isCompiled(level)) {                                                        \
+            owebpp::Logger& owebpp_logger(owebpp::Logger::getInstance());                                              \
+            if(owebpp_logger.isEnabled(level)) {                                                                        \
+                static owebpp::LogRateLimiter owebpp_log_limiter(burst, interval, sample_rate);                         \
+                uint64_t owebpp_log_suppressed(0);                                                                      \
+                if(owebpp_log_limiter.tryAcquire(owebpp_log_suppressed)) {                                              \
+                    OWEBPP_LOG_MESSAGE(owebpp_logger, level, owebpp::LogRateLimiter::withSummary(message, owebpp_log_suppressed)); \
+                }                                                                                                       \
+            }                                                                                                           \
+        }                                                                                                               \
+    } while(false)
+
+#define OWEBPP_LOG_LIMITED(level, burst, interval, message)  OWEBPP_LOG_SAMPLED(level, burst, interval, 0, message)
+
+#define OWEBPP_LOG_DEBUG_LIMITED(burst, interval, message)    OWEBPP_LOG_LIMITED(owebpp::LogLevel::LOG_DEBUG, burst, interval, message)
+#define OWEBPP_LOG_INFO_LIMITED(burst, interval, message)     OWEBPP_LOG_LIMITED(owebpp::LogLevel::LOG_INFO, burst, interval, message)
+#define OWEBPP_LOG_WARNING_LIMITED(burst, interval, message)  OWEBPP_LOG_LIMITED(owebpp::LogLevel::LOG_WARNING, burst, interval, message)
+#define OWEBPP_LOG_ERROR_LIMITED(burst, interval, message)    OWEBPP_LOG_LIMITED(owebpp::LogLevel::LOG_ERROR, burst, interval, message)
+
+/**
+ * Log a message whose formatting is deferred: OWEBPP_LOGF_INFO("Processing request: {} {}", method, url).
+ * The format must be a string literal, each {} is replaced by the next argument. Like OWEBPP_LOG, nothing is evaluated below the minimal log level.
+ * The call site is registered once, then a binary logger only copies the site id and the arguments, and a text logger formats the message right away.
+ */
+#define OWEBPP_LOGF(level, format, ...)                                                                                 \
+    do {                                                                                                                \
+        if constexpr(owebpp::LogLevelUtils::isCompiled(level)) {                                                        \
+            owebpp::Logger& owebpp_logger(owebpp::Logger::getInstance());                                              \
+            if(owebpp_logger.isEnabled(level)) {                                                                        \
+                static constexpr owebpp::LogSite owebpp_log_site(OWEBPP_LOG_SITE(level, format));                       \
+                static const uint32_t owebpp_log_site_id(owebpp::BinaryLog::registerSite(owebpp_log_site));             \
+                owebpp_logger.logf(owebpp_log_site, owebpp_log_site_id __VA_OPT__(,) __VA_ARGS__);                      \
+            }                                                                                                           \
+        }                                                                                                               \
+    } while(false)
+
+#define OWEBPP_LOGF_DEBUG(format, ...)    OWEBPP_LOGF(owebpp::LogLevel::LOG_DEBUG, format __VA_OPT__(,) __VA_ARGS__)
+#define OWEBPP_LOGF_INFO(format, ...)     OWEBPP_LOGF(owebpp::LogLevel::LOG_INFO, format __VA_OPT__(,) __VA_ARGS__)
+#define OWEBPP_LOGF_WARNING(format, ...)  OWEBPP_LOGF(owebpp::LogLevel::LOG_WARNING, format __VA_OPT__(,) __VA_ARGS__)
+#define OWEBPP_LOGF_ERROR(format, ...)    OWEBPP_LOGF(owebpp::LogLevel::LOG_ERROR, format __VA_OPT__(,) __VA_ARGS__)
+#define OWEBPP_LOGF_FATAL(format, ...)    OWEBPP_LOGF(owebpp::LogLevel::LOG_FATAL, format __VA_OPT__(,) __VA_ARGS__)
+
 /** The default time format used by the logger. */
 #define DEFAULT_DATE_TIME_FORMAT "%Y-%m-%d %H:%M:%S"
 
 /** This macro needs to be called at the beginning of the program using the framework. */
-#define OWEBPP_STATIC_INIT_LOGGER std::shared_ptr<owebpp::Logger> owebpp::Logger::s_logger = nullptr;
+#define OWEBPP_STATIC_INIT_LOGGER constinit owebpp::Snapshot<owebpp::Logger> owebpp::Logger::s_logger;
 
 namespace owebpp {
-    /** Lists the log levels the logger has. */
-    enum class LogLevel {
-        LOG_DEBUG,
-        LOG_INFO,
-        LOG_WARNING,
-        LOG_ERROR,
-        LOG_FATAL
+    /** Lists the formats a logger writing from a background thread can use. */
+    enum class LogFormat {
+        /** Text lines. */
+        TEXT,
+        /** The records of owebpp::BinaryLog, the messages of the OWEBPP_LOGF macros are formatted by "owebpp-console logs:decode". */
+        BINARY
     };
 
-    /** This is the logger used by the framework. */
+    /**
+     * This is the logger used by the framework.
+     * Each log is formatted into a line on the logging thread, the line is then either written to an output stream under a mutex or queued to an owebpp::AsyncLogWriter.
+     * In the BINARY format the logs are encoded as owebpp::BinaryLog records instead.
+     */
     class Logger {
         public:
             /* Constructors */
             /**
-             * Create a logger.
+             * Create a logger writing to an output stream on the logging thread, the stream is flushed after errors.
              * @param log_level The minimal logging level for a log to be written to the ouput.
              * @param output The output stream to which logs shall be written.
-             * @param date_time_format The date/time format that should be used when writing logs.
-             * See <a href="https://en.cppreference.com/w/cpp/io/manip/put_time">date/time formats</a>.
+             * @param date_time_format The date/time format that should be used when writing logs, %f is replaced by the milliseconds.
+             * See <a href="https://en.cppreference.com/w/cpp/chrono/c/strftime">date/time formats</a>.
              */
             Logger(LogLevel minimum_log_level, const std::shared_ptr<std::ostream>& output, const std::string& date_time_format):
                 m_minimum_log_level(minimum_log_level),
                 m_output(output),
-                m_date_time_format(date_time_format) {}
+                m_date_time_format(date_time_format),
+                m_date_format(splitDateTimeFormat(date_time_format)),
+                m_output_mutex(),
+                m_writer(nullptr),
+                m_format(LogFormat::TEXT),
+                m_recorder(nullptr),
+                m_recorder_level(minimum_log_level),
+                m_enabled_level(minimum_log_level),
+                m_id(nextId()) {}
+
+            /**
+             * Create a logger writing to a file descriptor from a background thread, the logging threads only format and queue the lines.
+             * @param log_level The minimal logging level for a log to be written to the ouput.
+             * @param fd The file descriptor to which logs shall be written, it isn't closed by the logger.
+             * @param date_time_format The date/time format that should be used when writing logs, %f is replaced by the milliseconds.
+             * @param capacity The number of lines waiting to be written the logger holds.
+             * @param overflow_policy What happens to a log when that many lines are waiting.
+             * @param format The format of the output, the date/time format isn't used by the BINARY format.
+             */
+            Logger(LogLevel minimum_log_level, int fd, const std::string& date_time_format,
+                   size_t capacity = AsyncLogWriter::DEFAULT_CAPACITY, LogOverflowPolicy overflow_policy = LogOverflowPolicy::COUNT, LogFormat format = LogFormat::TEXT):
+                m_minimum_log_level(minimum_log_level),
+                m_output(nullptr),
+                m_date_time_format(date_time_format),
+                m_date_format(splitDateTimeFormat(date_time_format)),
+                m_output_mutex(),
+                m_writer(nullptr),
+                m_format(format),
+                m_recorder(nullptr),
+                m_recorder_level(minimum_log_level),
+                m_enabled_level(minimum_log_level),
+                m_id(nextId()) {
+                if(m_format == LogFormat::BINARY) {
+                    m_writer = std::make_unique<AsyncLogWriter>(fd, capacity, overflow_policy, [](uint64_t dropped) {
+                        std::string record;
+                        BinaryLog::appendText(record, LogLevel::LOG_WARNING, getTimestamp(), std::to_string(dropped) + " log records dropped, the log ring is full.");
+                        return record;
+                    });
+                    BinaryLog::subscribe(*m_writer);
+                } else {
+                    m_writer = std::make_unique<AsyncLogWriter>(fd, capacity, overflow_policy);
+                }
+            }
 
             /** Construct a default logger that writes to clog. */
             Logger():
@@ -90,7 +212,12 @@ namespace owebpp {
             Logger& operator=(Logger&& o) = delete;
 
             /* Destructor */
-            virtual ~Logger() = default;
+            /** The lines waiting to be written are written before the logger is destroyed. */
+            virtual ~Logger() {
+                if(m_format == LogFormat::BINARY) {
+                    BinaryLog::unsubscribe(*m_writer);
+                }
+            }
 
             /* Functions */
             /**
@@ -130,22 +257,11 @@ namespace owebpp {
              * @param message The message to be logged.
              */
             void log(LogLevel log_level, const std::source_location& location, const std::string& message) {
-                if(log_level >= m_minimum_log_level) {
-                    const std::time_t t_c = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-                    getOutput() << std::put_time(std::localtime(&t_c), m_date_time_format.c_str())
-                                << " ["
-                                << logLevelToString(log_level)
-                                << "]: file: "
-                                << location.file_name()
-                                << '('
-                                << location.line()
-                                << ':'
-                                << location.column()
-                                << ") `"
-                                << location.function_name()
-                                << "`: "
-                                << message
-                                << std::endl;
+                if(isEnabled(log_level)) {
+                    std::string& line(startLine(log_level));
+                    appendLocation(line, location.file_name(), location.line(), location.column(), location.function_name());
+                    line.append(message).push_back('\n');
+                    write(log_level, line);
                 }
             }
 
@@ -155,37 +271,255 @@ namespace owebpp {
              * @param message The message to be logged.
              */
             void log(LogLevel log_level, const std::string& message) {
-                if(log_level >= m_minimum_log_level) {
-                    const std::time_t t_c = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-                    getOutput() << std::put_time(std::localtime(&t_c), m_date_time_format.c_str())
-                                << " ["
-                                << logLevelToString(log_level)
-                                << "]: "
-                                << message
-                                << std::endl;
+                if(isEnabled(log_level)) {
+                    std::string& line(startLine(log_level));
+                    line.append(message).push_back('\n');
+                    write(log_level, line);
+                }
+            }
+
+            /**
+             * Log a message of a registered call site, the OWEBPP_LOGF macros call it once the level is checked.
+             * @param site The call site.
+             * @param site_id The id of the call site.
+             * @param args The arguments replacing the {} of the format.
+             */
+            template<class... Targs>
+            void logf(const LogSite& site, uint32_t site_id, const Targs&... args) {
+                if(m_format == LogFormat::BINARY) {
+                    /* The record is copied into the ring, so the buffer of the thread is reused. */
+                    thread_local std::string record;
+                    record.clear();
+                    BinaryLog::appendEvent(record, site_id, getTimestamp(), args...);
+                    m_writer->push(record);
+                } else {
+                    std::string& line(startLine(site.level));
+                    if(site.file[0] != '\0') {
+                        appendLocation(line, site.file, site.line, site.column, site.function);
+                    }
+                    BinaryLog::formatMessage(line, site.format, args...);
+                    line.push_back('\n');
+                    write(site.level, line);
                 }
             }
 
             /**
-             * Set the logger to use for logging.
+             * Tell if the logs of a level are written, to the output or to the flight recorder.
+             * @param log_level The LogLevel.
+             * @return true if the logs of the level are written, false otherwise.
+             */
+            bool isEnabled(LogLevel log_level) const { return log_level >= m_enabled_level; }
+
+            /**
+             * Also write the logs to a flight recorder, whose level can be lower than the level of the output to keep verbose logs at little cost.
+             * It must be called before the logger is used.
+             * @param recorder The flight recorder, nullptr to stop recording.
+             * @param minimum_log_level The minimal logging level for a log to be recorded.
+             * @return The instance of the logger.
+             * @throw std::invalid_argument If the format of the logger is BINARY, the flight recorder keeps text lines.
+             */
+            Logger& setFlightRecorder(const std::shared_ptr<FlightRecorder>& recorder, LogLevel minimum_log_level) {
+                if(m_format == LogFormat::BINARY) {
+                    throw std::invalid_argument("A flight recorder can't be used with the BINARY log format.");
+                }
+                m_recorder = recorder;
+                m_recorder_level = minimum_log_level;
+                m_enabled_level = recorder != nullptr ? std::min(m_minimum_log_level, minimum_log_level) : m_minimum_log_level;
+                return *this;
+            }
+
+            /** Write the logs made so far, e.g. before the process exits. */
+            void flush() {
+                if(m_writer != nullptr) {
+                    m_writer->flush();
+                } else {
+                    std::lock_guard<std::mutex> lock(m_output_mutex);
+                    getOutput().flush();
+                }
+            }
+
+            /**
+             * Getter for the number of logs dropped because too many lines were waiting to be written.
+             * @return the number of dropped logs, always 0 for a logger writing on the logging thread.
+             */
+            uint64_t getDroppedCount() const { return m_writer != nullptr ? m_writer->getDroppedCount() : 0; }
+
+            /**
+             * Set the logger to use for logging, this function can be called while other threads log.
+             * The replaced logger is kept until the end of the program, since threads may still be writing to it.
              * @param logger The logger to use for logging.
              */
             static void setLogger(std::shared_ptr<Logger> logger) {
-                s_logger = logger;
+                s_logger.storeAndRetain(std::move(logger));
             }
 
             /* Singleton call method */
             /**
-             * Get the logger instance.
-             * @return The logger instance.
+             * Get the logger instance, the one a thread last got is read without locking while the logger isn't replaced.
+             * @return The logger instance, it stays valid after being replaced by setLogger().
              */
             static Logger& getInstance() {
-                if(s_logger==nullptr){
-                    s_logger = std::make_shared<Logger>();
-                }
-                return *s_logger;
+                return *s_logger.loadOrCreate([]() { return std::make_shared<Logger>(); });
             }
         private:
+            /* Types */
+            /** The date/time format of a logger, split around its %f field. */
+            struct DateFormat {
+                /** The format before the milliseconds, the whole format if it has no %f field. */
+                std::string head{};
+                /** The format after the milliseconds. */
+                std::string tail{};
+                /** true if the format has a %f field. */
+                bool has_milliseconds{false};
+            };
+
+            /** The date of the last log a thread made, formatted once per second. */
+            struct DateCache {
+                /** The id of the logger which formatted the date. */
+                uint64_t logger_id{0};
+                /** The second of the formatted date. */
+                std::time_t second{-1};
+                /** The formatted date. */
+                std::string date{};
+                /** The offset of the milliseconds in the date, std::string::npos if there are none. */
+                size_t milliseconds_offset{std::string::npos};
+            };
+
+            /* Functions */
+            /**
+             * Split a date/time format around its first %f field, which strftime doesn't know.
+             * @param date_time_format The date/time format.
+             * @return The split format.
+             */
+            static DateFormat splitDateTimeFormat(const std::string& date_time_format) {
+                DateFormat format;
+                size_t i(0);
+                while(i + 1 < date_time_format.size() && !format.has_milliseconds) {
+                    if(date_time_format[i] != '%') {
+                        ++i;
+                    } else if(date_time_format[i + 1] != 'f') {
+                        i += 2;
+                    } else {
+                        format.head = date_time_format.substr(0, i);
+                        format.tail = date_time_format.substr(i + 2);
+                        format.has_milliseconds = true;
+                    }
+                }
+                if(!format.has_milliseconds) {
+                    format.head = date_time_format;
+                }
+                return format;
+            }
+
+            /**
+             * Get a new logger id, the date caches of the threads are keyed by it.
+             * @return The id.
+             */
+            static uint64_t nextId() {
+                static std::atomic<uint64_t> next_id(1);
+                return next_id.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * Start a line in the buffer of the logging thread, with the date and level of the log unless the format is BINARY.
+             * @param log_level The LogLevel of the log.
+             * @return The buffer of the thread, it is reused by its next log.
+             */
+            std::string& startLine(LogLevel log_level) const {
+                thread_local std::string line;
+                line.clear();
+                if(m_format != LogFormat::BINARY) {
+                    appendDate(line);
+                    line.append(" [").append(logLevelToString(log_level)).append("]: ");
+                }
+                return line;
+            }
+
+            /**
+             * Append the current date, each thread formats it once per second and only patches the milliseconds in between.
+             * @param out The output buffer.
+             */
+            void appendDate(std::string& out) const {
+                thread_local DateCache cache;
+                std::chrono::system_clock::time_point now(std::chrono::system_clock::now());
+                std::time_t second(std::chrono::system_clock::to_time_t(now));
+                if(cache.logger_id != m_id || cache.second != second) {
+                    struct tm local_time;
+                    ::localtime_r(&second, &local_time);
+                    char date[64];
+                    cache.date.assign(date, std::strftime(date, sizeof(date), m_date_format.head.c_str(), &local_time));
+                    cache.milliseconds_offset = std::string::npos;
+                    if(m_date_format.has_milliseconds) {
+                        cache.milliseconds_offset = cache.date.size();
+                        cache.date.append("000");
+                        cache.date.append(date, std::strftime(date, sizeof(date), m_date_format.tail.c_str(), &local_time));
+                    }
+                    cache.logger_id = m_id;
+                    cache.second = second;
+                }
+                if(cache.milliseconds_offset != std::string::npos) {
+                    int64_t milliseconds(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+                    cache.date[cache.milliseconds_offset] = static_cast<char>('0' + milliseconds / 100);
+                    cache.date[cache.milliseconds_offset + 1] = static_cast<char>('0' + milliseconds / 10 % 10);
+                    cache.date[cache.milliseconds_offset + 2] = static_cast<char>('0' + milliseconds % 10);
+                }
+                out.append(cache.date);
+            }
+
+            /**
+             * Append the location of a log.
+             * @param out The output buffer.
+             * @param file The file name.
+             * @param line The line.
+             * @param column The column.
+             * @param function The function name.
+             */
+            static void appendLocation(std::string& out, const char* file, uint_least32_t line, uint_least32_t column, const char* function) {
+                char number[16];
+                out.append("file: ").append(file).push_back('(');
+                out.append(number, std::to_chars(number, number + sizeof(number), line).ptr).push_back(':');
+                out.append(number, std::to_chars(number, number + sizeof(number), column).ptr).append(") `");
+                out.append(function).append("`: ");
+            }
+
+            /**
+             * Get the time of a log for the BINARY format.
+             * @return The time in nanoseconds since the epoch.
+             */
+            static int64_t getTimestamp() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            }
+
+            /**
+             * Write a formatted line, the lines of concurrent threads don't interleave.
+             * In the BINARY format the line is written as a TEXT record, without its line feed.
+             * The line is also written to the flight recorder if its level is recorded.
+             * @param log_level The LogLevel of the log.
+             * @param line The line.
+             */
+            void write(LogLevel log_level, std::string_view line) {
+                if(m_recorder != nullptr && log_level >= m_recorder_level) {
+                    m_recorder->write(line);
+                }
+                if(log_level >= m_minimum_log_level) {
+                    if(m_format == LogFormat::BINARY) {
+                        thread_local std::string record;
+                        record.clear();
+                        BinaryLog::appendText(record, log_level, getTimestamp(), line.substr(0, line.size() - 1));
+                        m_writer->push(record);
+                    } else if(m_writer != nullptr) {
+                        m_writer->push(line);
+                    } else {
+                        std::lock_guard<std::mutex> lock(m_output_mutex);
+                        std::ostream& output(getOutput());
+                        output.write(line.data(), static_cast<std::streamsize>(line.size()));
+                        if(log_level >= LogLevel::LOG_ERROR) {
+                            output.flush();
+                        }
+                    }
+                }
+            }
+
             /**
              * Get the output to use for logging.
              * @return The output defined by a logger or clog.
@@ -208,8 +542,32 @@ namespace owebpp {
             /** The date format to use to write date/time in logs. */
             std::string m_date_time_format;
 
+            /** The date format split around its milliseconds. */
+            DateFormat m_date_format;
+
+            /** Serializes the writes to the output stream. */
+            std::mutex m_output_mutex;
+
+            /** The background writer, nullptr if the logs are written to the output stream. */
+            std::unique_ptr<AsyncLogWriter> m_writer;
+
+            /** The format of the output. */
+            LogFormat m_format;
+
+            /** The flight recorder the logs are also written to, nullptr if there isn't any. */
+            std::shared_ptr<FlightRecorder> m_recorder;
+
+            /** The minimal log level for a message to be recorded. */
+            LogLevel m_recorder_level;
+
+            /** The minimal log level for a message to be written to the output or recorded. */
+            LogLevel m_enabled_level;
+
+            /** The id of the logger, unique in the process. */
+            uint64_t m_id;
+
             /** Singleton object */
-            static std::shared_ptr<Logger> s_logger;
+            static Snapshot<Logger> s_logger;
     };
 }
 
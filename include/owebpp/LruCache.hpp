@@ -0,0 +1,141 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_LRU_CACHE_HPP
+#define OWEBPP_LRU_CACHE_HPP
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace owebpp {
+    /**
+     * A small cache keyed by strings which drops its least recently used entries, safe to use from any thread.
+     * The entries are spread over shards by the hash of their key, each guarded by its own mutex, so concurrent threads rarely wait for each other.
+     */
+    template<class Tvalue>
+    class LruCache {
+        public:
+            /* Constants */
+            /** The number of shards. */
+            static constexpr size_t SHARD_COUNT = 8;
+
+            /* Constructors */
+            /**
+             * Construct an empty cache.
+             * @param capacity The number of entries the cache holds, at least one per shard.
+             */
+            explicit LruCache(size_t capacity):
+                m_shards(SHARD_COUNT) {
+                for(Shard& shard : m_shards) {
+                    shard.capacity = std::max<size_t>(1, capacity / SHARD_COUNT);
+                }
+            }
+
+            /* Deleted constructors */
+            LruCache() = delete;
+            LruCache(const LruCache& o) = delete;
+            LruCache(LruCache&& o) = delete;
+
+            /* Deleted assignment operators */
+            LruCache& operator=(const LruCache& o) = delete;
+            LruCache& operator=(LruCache&& o) = delete;
+
+            /* Destructor */
+            ~LruCache() = default;
+
+            /* Functions */
+            /**
+             * Get the value of a key, which becomes the most recently used one.
+             * @param key The key.
+             * @return The value, std::nullopt if the cache doesn't hold the key.
+             */
+            std::optional<Tvalue> get(std::string_view key) {
+                size_t hash(std::hash<std::string_view>()(key));
+                Shard& shard(m_shards[hash % SHARD_COUNT]);
+                std::optional<Tvalue> value;
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto entry(shard.index.find(key));
+                if(entry != shard.index.end()) {
+                    shard.entries.splice(shard.entries.begin(), shard.entries, entry->second);
+                    value = entry->second->second;
+                }
+                return value;
+            }
+
+            /**
+             * Set the value of a key, the least recently used entry of its shard is dropped if the shard is full.
+             * @param key The key.
+             * @param value The value.
+             */
+            void put(std::string_view key, const Tvalue& value) {
+                size_t hash(std::hash<std::string_view>()(key));
+                Shard& shard(m_shards[hash % SHARD_COUNT]);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto entry(shard.index.find(key));
+                if(entry != shard.index.end()) {
+                    entry->second->second = value;
+                    shard.entries.splice(shard.entries.begin(), shard.entries, entry->second);
+                } else {
+                    if(shard.entries.size() >= shard.capacity) {
+                        shard.index.erase(std::string_view(shard.entries.back().first));
+                        shard.entries.pop_back();
+                    }
+                    shard.entries.emplace_front(std::string(key), value);
+                    /* The index refers to the key of the entry, which a list never moves. */
+                    shard.index.emplace(std::string_view(shard.entries.front().first), shard.entries.begin());
+                }
+            }
+
+        private:
+            /* Types */
+            /** The entries of a shard, the most recently used first, and their index. */
+            struct Shard {
+                /** Guards the shard. */
+                std::mutex mutex{};
+
+                /** The entries, the most recently used first. */
+                std::list<std::pair<std::string, Tvalue>> entries{};
+
+                /** The entries indexed by key. */
+                std::unordered_map<std::string_view, typename std::list<std::pair<std::string, Tvalue>>::iterator> index{};
+
+                /** The number of entries the shard holds. */
+                size_t capacity{0};
+            };
+
+            /* Members */
+            /** The shards. */
+            std::vector<Shard> m_shards;
+    };
+}
+
+#endif // OWEBPP_LRU_CACHE_HPP
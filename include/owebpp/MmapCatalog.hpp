@@ -0,0 +1,340 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_MMAP_CATALOG_HPP
+#define OWEBPP_MMAP_CATALOG_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+#include <owebpp/CompiledTranslator.hpp>
+
+namespace owebpp {
+    /**
+     * A translation catalog file generated by "owebpp-console generate:translations:catalog", mapped read-only.
+     * The file holds a header, the perfect hash index of the keys shared with owebpp::CompiledTranslator, a pool of the keys,
+     * and a page aligned section per locale with the position of its translations and their pool.
+     * The pages are shared by all the processes mapping the file and only the sections of the locales in use are read from the disk.
+     * The file must be updated by renaming a new file over it, a file truncated while it is mapped crashes the processes reading it.
+     */
+    class MmapCatalog {
+        public:
+            /* Constants */
+            /** The magic string a catalog file starts with. */
+            static constexpr std::string_view MAGIC = "OWEBTRC1";
+
+            /** The alignment of the locale sections. */
+            static constexpr uint64_t SECTION_ALIGNMENT = 4096;
+
+            /** The index returned for a key or a locale the catalog doesn't have. */
+            static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+            /* Types */
+            /** The header at the start of the file, the offsets are from the start of the file. */
+            struct FileHeader {
+                /** The magic string. */
+                char magic[8]{};
+
+                /** The number of keys. */
+                uint32_t key_count{};
+
+                /** The number of buckets of the perfect hash. */
+                uint32_t bucket_count{};
+
+                /** The number of locales. */
+                uint32_t locale_count{};
+
+                /** Unused, keeps the offsets aligned. */
+                uint32_t reserved{};
+
+                /** The offset of the seed of each bucket, uint32_t each. */
+                uint64_t seeds_offset{};
+
+                /** The offset of the key entries, in the order of the perfect hash. */
+                uint64_t keys_offset{};
+
+                /** The offset of the pool holding the keys and the locale names. */
+                uint64_t key_pool_offset{};
+
+                /** The size of the key pool. */
+                uint64_t key_pool_size{};
+
+                /** The offset of the locale entries. */
+                uint64_t locales_offset{};
+            };
+
+            /** The position of a key or a locale name in the key pool. */
+            struct KeyEntry {
+                /** The offset in the key pool. */
+                uint32_t offset{};
+
+                /** The size. */
+                uint32_t size{};
+            };
+
+            /** The section of a locale. */
+            struct LocaleEntry {
+                /** The name of the locale in the key pool. */
+                KeyEntry name{};
+
+                /** The offset of the position of each translation, owebpp::CompiledTranslation each. */
+                uint64_t translations_offset{};
+
+                /** The offset of the pool of the translations. */
+                uint64_t pool_offset{};
+
+                /** The size of the pool of the translations. */
+                uint64_t pool_size{};
+            };
+
+            /* Constructors */
+            /**
+             * Map a catalog file.
+             * @param path The path of the file.
+             * @throw std::system_error If the file can't be opened or mapped.
+             * @throw std::invalid_argument If the file isn't a valid catalog.
+             */
+            explicit MmapCatalog(const std::string& path):
+                m_mapping(nullptr),
+                m_size(0),
+                m_device(0),
+                m_inode(0),
+                m_modification_time(0),
+                m_header(nullptr),
+                m_seeds(nullptr),
+                m_keys(nullptr),
+                m_key_pool(),
+                m_locales(nullptr) {
+                int fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+                if(fd < 0) {
+                    throw std::system_error(errno, std::system_category(), "Unable to open translation catalog " + path);
+                }
+                struct stat status;
+                int error(::fstat(fd, &status) == 0 ? 0 : errno);
+                if(error == 0 && static_cast<uint64_t>(status.st_size) >= sizeof(FileHeader)) {
+                    m_size = static_cast<uint64_t>(status.st_size);
+                    void* mapping(::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0));
+                    if(mapping == MAP_FAILED) {
+                        error = errno;
+                    } else {
+                        m_mapping = static_cast<const char*>(mapping);
+                        /* The locales are read on demand, reading ahead would load the sections of the unused ones. */
+                        ::madvise(mapping, m_size, MADV_RANDOM);
+                    }
+                }
+                ::close(fd);
+                if(error != 0) {
+                    throw std::system_error(error, std::system_category(), "Unable to map translation catalog " + path);
+                }
+                m_device = static_cast<uint64_t>(status.st_dev);
+                m_inode = static_cast<uint64_t>(status.st_ino);
+                m_modification_time = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+                if(m_mapping == nullptr || !readIndex()) {
+                    if(m_mapping != nullptr) {
+                        ::munmap(const_cast<char*>(m_mapping), m_size);
+                    }
+                    throw std::invalid_argument(path + " is not a valid translation catalog.");
+                }
+            }
+
+            /* Deleted constructors */
+            MmapCatalog() = delete;
+            MmapCatalog(const MmapCatalog& o) = delete;
+            MmapCatalog(MmapCatalog&& o) = delete;
+
+            /* Deleted assignment operators */
+            MmapCatalog& operator=(const MmapCatalog& o) = delete;
+            MmapCatalog& operator=(MmapCatalog&& o) = delete;
+
+            /* Destructor */
+            ~MmapCatalog() {
+                ::munmap(const_cast<char*>(m_mapping), m_size);
+            }
+
+            /* Functions */
+            /**
+             * Find the index of a locale.
+             * @param locale The name of the locale.
+             * @return The index of the locale, NOT_FOUND if the catalog doesn't have it.
+             */
+            size_t findLocale(std::string_view locale) const {
+                size_t index(NOT_FOUND);
+                for(size_t i = 0; i < m_header->locale_count && index == NOT_FOUND; i++) {
+                    if(getString(m_locales[i].name) == locale) {
+                        index = i;
+                    }
+                }
+                return index;
+            }
+
+            /**
+             * Find the index of a key with the perfect hash of owebpp::CompiledTranslator.
+             * @param key The key.
+             * @return The index of the key, NOT_FOUND if the catalog doesn't have it.
+             */
+            size_t findKey(std::string_view key) const {
+                size_t index(NOT_FOUND);
+                if(m_header->key_count != 0) {
+                    uint64_t key_hash(CompiledTranslator::hash(key));
+                    uint32_t seed(m_seeds[CompiledTranslator::mix(key_hash, 0) % m_header->bucket_count]);
+                    size_t slot(CompiledTranslator::mix(key_hash, seed) % m_header->key_count);
+                    if(getString(m_keys[slot]) == key) {
+                        index = slot;
+                    }
+                }
+                return index;
+            }
+
+            /**
+             * Get the translation of a key, the first call for a locale reads its section from the disk.
+             * @param locale_index The index of the locale given by findLocale().
+             * @param key_index The index of the key given by findKey().
+             * @param translation Set to the translation, valid as long as the catalog.
+             * @return true if the locale translates the key, false otherwise.
+             */
+            bool getTranslation(size_t locale_index, size_t key_index, std::string_view& translation) const {
+                const LocaleEntry& locale(m_locales[locale_index]);
+                CompiledTranslation position;
+                std::memcpy(&position, m_mapping + locale.translations_offset + key_index * sizeof(CompiledTranslation), sizeof(position));
+                /* The sections aren't checked when the file is mapped so the unused ones aren't read. */
+                bool is_found(position.offset != CompiledTranslation::MISSING && uint64_t(position.offset) + position.size <= locale.pool_size);
+                if(is_found) {
+                    translation = std::string_view(m_mapping + locale.pool_offset + position.offset, position.size);
+                }
+                return is_found;
+            }
+
+            /**
+             * Tell if a file is the file mapped by the catalog, a file renamed over it is another file.
+             * @param status The status of the file.
+             * @return true if it is the mapped file, false otherwise.
+             */
+            bool isSameFile(const struct stat& status) const {
+                return static_cast<uint64_t>(status.st_dev) == m_device && static_cast<uint64_t>(status.st_ino) == m_inode
+                    && static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec == m_modification_time
+                    && static_cast<uint64_t>(status.st_size) == m_size;
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the number of keys.
+             * @return The number of keys.
+             */
+            size_t getKeyCount() const { return m_header->key_count; }
+
+        private:
+            /* Functions */
+            /**
+             * Read and check the header, the key index and the locale entries.
+             * @return true if they are valid, false otherwise.
+             */
+            bool readIndex() {
+                m_header = reinterpret_cast<const FileHeader*>(m_mapping);
+                const FileHeader& header(*m_header);
+                bool is_valid(std::string_view(header.magic, sizeof(header.magic)) == MAGIC
+                              && (header.key_count == 0 || header.bucket_count != 0)
+                              && isInFile(header.seeds_offset, uint64_t(header.bucket_count) * sizeof(uint32_t), alignof(uint32_t))
+                              && isInFile(header.keys_offset, uint64_t(header.key_count) * sizeof(KeyEntry), alignof(KeyEntry))
+                              && isInFile(header.key_pool_offset, header.key_pool_size, 1)
+                              && isInFile(header.locales_offset, uint64_t(header.locale_count) * sizeof(LocaleEntry), alignof(LocaleEntry)));
+                if(is_valid) {
+                    m_seeds = reinterpret_cast<const uint32_t*>(m_mapping + header.seeds_offset);
+                    m_keys = reinterpret_cast<const KeyEntry*>(m_mapping + header.keys_offset);
+                    m_key_pool = std::string_view(m_mapping + header.key_pool_offset, header.key_pool_size);
+                    m_locales = reinterpret_cast<const LocaleEntry*>(m_mapping + header.locales_offset);
+                }
+                for(size_t i = 0; is_valid && i < header.key_count; i++) {
+                    is_valid = uint64_t(m_keys[i].offset) + m_keys[i].size <= m_key_pool.size();
+                }
+                for(size_t i = 0; is_valid && i < header.locale_count; i++) {
+                    const LocaleEntry& locale(m_locales[i]);
+                    is_valid = uint64_t(locale.name.offset) + locale.name.size <= m_key_pool.size()
+                        && isInFile(locale.translations_offset, uint64_t(header.key_count) * sizeof(CompiledTranslation), alignof(CompiledTranslation))
+                        && isInFile(locale.pool_offset, locale.pool_size, 1);
+                }
+                return is_valid;
+            }
+
+            /**
+             * Tell if a range is in the file.
+             * @param offset The offset of the range.
+             * @param size The size of the range.
+             * @param alignment The alignment of the offset.
+             * @return true if the range is in the file and the offset aligned, false otherwise.
+             */
+            bool isInFile(uint64_t offset, uint64_t size, uint64_t alignment) const {
+                return offset % alignment == 0 && offset <= m_size && size <= m_size - offset;
+            }
+
+            /**
+             * Get a string of the key pool.
+             * @param entry The position of the string.
+             * @return The string.
+             */
+            std::string_view getString(const KeyEntry& entry) const {
+                return m_key_pool.substr(entry.offset, entry.size);
+            }
+
+            /* Members */
+            /** The mapping of the file. */
+            const char* m_mapping;
+
+            /** The size of the file. */
+            uint64_t m_size;
+
+            /** The device of the file. */
+            uint64_t m_device;
+
+            /** The inode of the file. */
+            uint64_t m_inode;
+
+            /** The modification time of the file in nanoseconds. */
+            int64_t m_modification_time;
+
+            /** The header of the file. */
+            const FileHeader* m_header;
+
+            /** The seed of each bucket. */
+            const uint32_t* m_seeds;
+
+            /** The key entries. */
+            const KeyEntry* m_keys;
+
+            /** The pool of the keys and locale names. */
+            std::string_view m_key_pool;
+
+            /** The locale entries. */
+            const LocaleEntry* m_locales;
+    };
+}
+
+#endif // OWEBPP_MMAP_CATALOG_HPP
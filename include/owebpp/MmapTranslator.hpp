@@ -0,0 +1,267 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_MMAP_TRANSLATOR_HPP
+#define OWEBPP_MMAP_TRANSLATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <system_error>
+
+#include <owebpp/Logger.hpp>
+#include <owebpp/MmapCatalog.hpp>
+#include <owebpp/Snapshot.hpp>
+#include <owebpp/Translator.hpp>
+
+namespace owebpp {
+    /**
+     * This class serves the translations of a catalog file mapped read-only, see owebpp::MmapCatalog.
+     * The file is checked at most once per reload interval, a new file renamed over it is mapped and used by the following translations.
+     * With a reload interval of 0, an owebpp::CatalogWatcher calls reload() from its own thread so the translations never wait for a file to be mapped.
+     * The mapped catalog is published as an owebpp::Snapshot, the translations read it without taking a lock while a new one is loaded.
+     * Each translation is parsed the first time it is used and kept with the mapped catalog, translate() then renders it without parsing it.
+     */
+    class MmapTranslator : public Translator {
+        public:
+            /* Constants */
+            /** The default interval between two checks of the file. */
+            static constexpr std::chrono::milliseconds DEFAULT_RELOAD_INTERVAL = std::chrono::seconds(1);
+
+            /* Constructors */
+            /**
+             * Construct a translator.
+             * @param path The path of the catalog file.
+             * @param locale The locale to use for translation.
+             * @param reload_interval The interval between two checks of the file, 0 to only check it when reload() is called.
+             * @throw std::system_error If the file can't be opened or mapped.
+             * @throw std::invalid_argument If the file isn't a valid catalog.
+             */
+            MmapTranslator(const std::string& path, const std::string& locale, std::chrono::milliseconds reload_interval = DEFAULT_RELOAD_INTERVAL):
+                m_path(path),
+                m_locale(locale),
+                m_reload_interval(reload_interval),
+                m_catalog(std::make_shared<const LoadedCatalog>(path, locale)),
+                m_next_check(0) {
+                if(m_catalog.load()->locale_index == MmapCatalog::NOT_FOUND) {
+                    OWEBPP_LOG_WARNING("Locale " + m_locale + " is not supported.");
+                }
+                m_next_check = getNow() + m_reload_interval.count();
+            }
+
+            /* Deleted constructors */
+            MmapTranslator() = delete;
+            MmapTranslator(const MmapTranslator& o) = delete;
+            MmapTranslator(MmapTranslator&& o) = delete;
+
+            /* Deleted assignment operators */
+            MmapTranslator& operator=(const MmapTranslator& o) = delete;
+            MmapTranslator& operator=(MmapTranslator&& o) = delete;
+
+            /* Destructor */
+            virtual ~MmapTranslator() = default;
+
+            /* Functions */
+            /**
+             * Returns the translation associated to the given key.
+             * @param key The key to use to translate.
+             * @return The translation associated to the key or the key if no translation was found.
+             */
+            std::string getTranslatedText(const std::string& key) override {
+                std::string translation(key);
+                /* The snapshot kept by the thread keeps the mapping alive while the translation is copied. */
+                const LoadedCatalog& loaded_catalog(*getLoadedCatalog());
+                size_t key_index(findKey(loaded_catalog, key));
+                std::string_view found;
+                if(key_index != MmapCatalog::NOT_FOUND && loaded_catalog.catalog.getTranslation(loaded_catalog.locale_index, key_index, found)) {
+                    translation.assign(found);
+                }
+                return translation;
+            }
+
+            /**
+             * Get the parsed translation of a key, each translation is parsed the first time it is used and kept with its catalog.
+             * @param key The key.
+             * @return The parsed translation, which keeps its catalog mapped, or the parsed key if no translation was found.
+             */
+            std::shared_ptr<const TranslationFormat> getTranslationFormat(const std::string& key) override {
+                std::shared_ptr<const LoadedCatalog> loaded_catalog(getLoadedCatalog());
+                size_t key_index(findKey(*loaded_catalog, key));
+                std::shared_ptr<const TranslationFormat> format;
+                if(key_index != MmapCatalog::NOT_FOUND) {
+                    format = std::shared_ptr<const TranslationFormat>(loaded_catalog, &loaded_catalog->getParsedTranslation(key_index));
+                } else {
+                    format = std::make_shared<const TranslationFormat>(key);
+                }
+                return format;
+            }
+
+            /**
+             * Map the catalog file again if it was replaced, the current catalog is kept if the new one can't be mapped.
+             * @return true if a new catalog is used, false otherwise.
+             */
+            bool reload() {
+                bool is_reloaded(false);
+                struct stat status;
+                if(::stat(m_path.c_str(), &status) == 0 && !m_catalog.load()->catalog.isSameFile(status)) {
+                    try {
+                        m_catalog.store(std::make_shared<const LoadedCatalog>(m_path, m_locale));
+                        is_reloaded = true;
+                        OWEBPP_LOG_INFO("Translation catalog " + m_path + " reloaded.");
+                    } catch(const std::system_error& e) {
+                        OWEBPP_LOG_WARNING(e.what());
+                    } catch(const std::invalid_argument& e) {
+                        OWEBPP_LOG_WARNING(e.what());
+                    }
+                }
+                return is_reloaded;
+            }
+
+        private:
+            /* Types */
+            /** A mapped catalog and the index of the locale in it. */
+            struct LoadedCatalog {
+                /**
+                 * Map a catalog file.
+                 * @param path The path of the file.
+                 * @param locale The locale to use for translation.
+                 * @throw std::system_error If the file can't be opened or mapped.
+                 * @throw std::invalid_argument If the file isn't a valid catalog.
+                 */
+                LoadedCatalog(const std::string& path, const std::string& locale):
+                    catalog(path),
+                    locale_index(catalog.findLocale(locale)),
+                    parsed_translations(std::make_unique<std::atomic<const TranslationFormat*>[]>(catalog.getKeyCount())) {
+                }
+
+                /* Deleted constructors */
+                LoadedCatalog(const LoadedCatalog&) = delete;
+
+                /* Deleted assignment operators */
+                LoadedCatalog& operator=(const LoadedCatalog&) = delete;
+
+                /* Destructor */
+                ~LoadedCatalog() {
+                    for(size_t i = 0; i < catalog.getKeyCount(); i++) {
+                        delete parsed_translations[i].load(std::memory_order_relaxed);
+                    }
+                }
+
+                /**
+                 * Get the parsed translation of a key, the translation is parsed the first time it is used.
+                 * @param key_index The index of a key with a translation in the locale.
+                 * @return The parsed translation.
+                 */
+                const TranslationFormat& getParsedTranslation(size_t key_index) const {
+                    std::atomic<const TranslationFormat*>& slot(parsed_translations[key_index]);
+                    const TranslationFormat* format(slot.load(std::memory_order_acquire));
+                    if(format == nullptr) {
+                        std::string_view translation;
+                        catalog.getTranslation(locale_index, key_index, translation);
+                        std::unique_ptr<const TranslationFormat> parsed(std::make_unique<const TranslationFormat>(translation));
+                        /* Another thread may have parsed it first, its copy is kept and this one is dropped. */
+                        if(slot.compare_exchange_strong(format, parsed.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                            format = parsed.release();
+                        }
+                    }
+                    return *format;
+                }
+
+                /** The catalog. */
+                MmapCatalog catalog;
+
+                /** The index of the locale in the catalog, MmapCatalog::NOT_FOUND if it doesn't have the locale. */
+                size_t locale_index;
+
+                /** The translations parsed so far, in the order of the keys of the catalog, nullptr until a translation is used. */
+                std::unique_ptr<std::atomic<const TranslationFormat*>[]> parsed_translations;
+            };
+
+            /* Functions */
+            /**
+             * Get the mapped catalog, after checking the file if the reload interval is over.
+             * @return The mapped catalog.
+             */
+            const std::shared_ptr<const LoadedCatalog>& getLoadedCatalog() {
+                if(m_reload_interval.count() > 0) {
+                    int64_t next_check(m_next_check.load(std::memory_order_relaxed));
+                    int64_t now(getNow());
+                    /* A single thread checks the file when the interval is over. */
+                    if(now >= next_check && m_next_check.compare_exchange_strong(next_check, now + m_reload_interval.count(), std::memory_order_relaxed)) {
+                        reload();
+                    }
+                }
+                return m_catalog.load();
+            }
+
+            /**
+             * Find the index of a key which the locale translates.
+             * @param loaded_catalog The mapped catalog.
+             * @param key The key.
+             * @return The index of the key, MmapCatalog::NOT_FOUND if the locale doesn't translate it.
+             */
+            size_t findKey(const LoadedCatalog& loaded_catalog, const std::string& key) const {
+                size_t key_index(MmapCatalog::NOT_FOUND);
+                std::string_view translation;
+                /* An unsupported locale was reported when the translator was created. */
+                if(loaded_catalog.locale_index != MmapCatalog::NOT_FOUND) {
+                    key_index = loaded_catalog.catalog.findKey(key);
+                    if(key_index == MmapCatalog::NOT_FOUND || !loaded_catalog.catalog.getTranslation(loaded_catalog.locale_index, key_index, translation)) {
+                        key_index = MmapCatalog::NOT_FOUND;
+                        OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Key " + key + " has no translation for locale " + m_locale + ".");
+                    }
+                }
+                return key_index;
+            }
+
+            /**
+             * Get the current time of the reload checks.
+             * @return The current time in milliseconds.
+             */
+            static int64_t getNow() {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            /* Members */
+            /** The path of the catalog file. */
+            std::string m_path;
+
+            /** The locale to use for translation. */
+            std::string m_locale;
+
+            /** The interval between two checks of the file. */
+            std::chrono::milliseconds m_reload_interval;
+
+            /** The mapped catalog, replaced when the file is. */
+            Snapshot<const LoadedCatalog> m_catalog;
+
+            /** The time of the next check of the file in milliseconds. */
+            std::atomic<int64_t> m_next_check;
+    };
+}
+
+#endif // OWEBPP_MMAP_TRANSLATOR_HPP
@@ -0,0 +1,96 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_PRIORITY_HPP
+#define OWEBPP_PRIORITY_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace owebpp {
+    /** Lists the priority classes of the routes, the higher classes are served first when requests wait for the owebpp::Executor. */
+    enum class Priority : size_t {
+        /** Latency critical routes, e.g. health checks. */
+        HIGH = 0,
+        /** Interactive routes, the default. */
+        NORMAL = 1,
+        /** Batch routes, e.g. exports. */
+        LOW = 2
+    };
+
+    /** Provides utility functions to convert priorities to and from string. */
+    class PriorityUtils final {
+        public:
+            /* Deleted constructors */
+            PriorityUtils() = delete;
+            PriorityUtils(const PriorityUtils& o) = delete;
+            PriorityUtils(PriorityUtils&& o) = delete;
+
+            /* Deleted assignment operators */
+            PriorityUtils& operator=(const PriorityUtils& o) = delete;
+            PriorityUtils& operator=(PriorityUtils&& o) = delete;
+
+            /* Deleted destructor */
+            ~PriorityUtils() = delete;
+
+            /* Constants */
+            /** The number of priority classes. */
+            static constexpr size_t PRIORITY_COUNT = 3;
+
+            /* Functions */
+            /**
+             * Convert a priority name (high, normal or low) to its value.
+             * @param priority_str The priority name.
+             * @return The priority, std::nullopt if the name is unknown.
+             */
+            static std::optional<Priority> convertPriorityStringToValue(const std::string& priority_str) {
+                std::optional<Priority> priority(std::nullopt);
+                if(priority_str == "high") {
+                    priority = Priority::HIGH;
+                } else if(priority_str == "normal") {
+                    priority = Priority::NORMAL;
+                } else if(priority_str == "low") {
+                    priority = Priority::LOW;
+                }
+                return priority;
+            }
+
+            /**
+             * Convert a priority to its name.
+             * @param priority The priority.
+             * @return The priority name.
+             */
+            static std::string convertPriorityToString(Priority priority) {
+                std::string priority_str("normal");
+                if(priority == Priority::HIGH) {
+                    priority_str = "high";
+                } else if(priority == Priority::LOW) {
+                    priority_str = "low";
+                }
+                return priority_str;
+            }
+    };
+}
+
+#endif // OWEBPP_PRIORITY_HPP
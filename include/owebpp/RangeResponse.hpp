@@ -0,0 +1,336 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_RANGE_RESPONSE_HPP
+#define OWEBPP_RANGE_RESPONSE_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <memory>
+#include <owebpp/ContentSource.hpp>
+#include <owebpp/HttpMethod.hpp>
+#include <owebpp/HttpStatusCode.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace owebpp {
+    /** An inclusive range of bytes of a content. */
+    struct ByteRange {
+        /** The position of the first byte of the range. */
+        size_t first;
+
+        /** The position of the last byte of the range. */
+        size_t last;
+    };
+
+    /** Lists the possible outcomes of a Range header parsing. */
+    enum class RangeParseResult {
+        /** The header is absent or invalid, the full content must be served. */
+        IGNORED,
+        /** At least one range can be served. */
+        SATISFIABLE,
+        /** None of the requested ranges overlap the content. */
+        NOT_SATISFIABLE
+    };
+
+    /** Builds responses serving a content source, only the byte ranges requested through the Range header are read and sent. */
+    class RangeResponseBuilder final {
+        public:
+            /* Deleted constructors */
+            RangeResponseBuilder() = delete;
+            RangeResponseBuilder(const RangeResponseBuilder& o) = delete;
+            RangeResponseBuilder(RangeResponseBuilder&& o) = delete;
+
+            /* Deleted assignment operators */
+            RangeResponseBuilder& operator=(const RangeResponseBuilder& o) = delete;
+            RangeResponseBuilder& operator=(RangeResponseBuilder&& o) = delete;
+
+            /* Deleted destructor */
+            ~RangeResponseBuilder() = delete;
+
+            /* Functions */
+            /**
+             * Build the response serving the given content for the given request.
+             * The response is a 200 with the full content, a 206 with a single range or a multipart/byteranges content, or a 416 if no range can be served.
+             * @param req The request, its Range and If-Range headers are honored for GET requests.
+             * @param source The content to serve.
+             * @param content_type The content type of the content.
+             * @return The response streaming the requested parts of the content.
+             */
+            static std::shared_ptr<Response> build(const std::shared_ptr<Request>& req, const std::shared_ptr<ContentSource>& source, const std::string& content_type) {
+                std::shared_ptr<Response> response = std::make_shared<Response>();
+                if(source == nullptr || !source->isAvailable()) {
+                    response->setSatusCode(HttpStatusCode::NOT_FOUND);
+                    return response;
+                }
+
+                const size_t size(source->getSize());
+                const std::string entity_tag(source->getEntityTag());
+                const std::string last_modified(source->getLastModified());
+                response->getHeaders().push_back("Accept-Ranges: bytes");
+                if(!entity_tag.empty()) {
+                    response->getHeaders().push_back("ETag: " + entity_tag);
+                }
+                if(!last_modified.empty()) {
+                    response->getHeaders().push_back("Last-Modified: " + last_modified);
+                }
+                response->setContentType(content_type);
+
+                std::vector<ByteRange> ranges;
+                RangeParseResult result(RangeParseResult::IGNORED);
+                if(req->getMethod() == HttpMethod::HTTP_GET && isIfRangeMatching(req->getHeader("If-Range"), entity_tag, last_modified)) {
+                    result = parseRangeHeader(req->getHeader("Range"), size, ranges);
+                }
+
+                std::vector<Segment> segments;
+                if(result == RangeParseResult::NOT_SATISFIABLE) {
+                    response->setSatusCode(HttpStatusCode::RANGE_NOT_SATISFIABLE);
+                    response->getHeaders().push_back("Content-Range: bytes */" + std::to_string(size));
+                    return response;
+                } else if(result == RangeParseResult::IGNORED) {
+                    segments.push_back({"", 0, size});
+                } else if(ranges.size() == 1) {
+                    response->setSatusCode(HttpStatusCode::PARTIAL_CONTENT);
+                    response->getHeaders().push_back("Content-Range: " + contentRange(ranges[0], size));
+                    segments.push_back({"", ranges[0].first, ranges[0].last - ranges[0].first + 1});
+                } else {
+                    const std::string boundary(generateBoundary());
+                    response->setSatusCode(HttpStatusCode::PARTIAL_CONTENT);
+                    response->setContentType("multipart/byteranges; boundary=" + boundary);
+                    for(const ByteRange& range : ranges) {
+                        segments.push_back({"\r\n--" + boundary + "\r\nContent-Type: " + content_type + "\r\nContent-Range: " + contentRange(range, size) + "\r\n\r\n",
+                                            range.first,
+                                            range.last - range.first + 1});
+                    }
+                    segments.push_back({"\r\n--" + boundary + "--\r\n", 0, 0});
+                }
+
+                size_t content_length(0);
+                for(const Segment& segment : segments) {
+                    content_length += segment.m_prefix.size() + segment.m_length;
+                }
+                response->setContentProducer(buildProducer(source, std::move(segments)), content_length);
+                return response;
+            }
+
+            /**
+             * Parse a Range header against a content of the given size, overlapping and adjacent ranges are merged.
+             * @param header The Range header value.
+             * @param size The size of the content.
+             * @param ranges Receives the ranges that can be served, sorted by position.
+             * @return Whether the header must be ignored, can be served or can't be satisfied.
+             */
+            static RangeParseResult parseRangeHeader(std::string_view header, size_t size, std::vector<ByteRange>& ranges) {
+                ranges.clear();
+                header = trim(header);
+                constexpr std::string_view unit("bytes=");
+                if(header.size() <= unit.size() || !std::equal(unit.begin(), unit.end(), header.begin(), [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); })) {
+                    return RangeParseResult::IGNORED;
+                }
+                header.remove_prefix(unit.size());
+
+                size_t specifications_count(0);
+                while(!header.empty()) {
+                    size_t comma = header.find(',');
+                    std::string_view specification(trim(header.substr(0, comma)));
+                    header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+                    if(specification.empty()) {
+                        continue;
+                    }
+                    if(++specifications_count > MAX_RANGES) {
+                        return RangeParseResult::IGNORED;
+                    }
+
+                    size_t dash = specification.find('-');
+                    if(dash == std::string_view::npos) {
+                        return RangeParseResult::IGNORED;
+                    }
+                    size_t first(0);
+                    size_t last(0);
+                    std::string_view first_str(trim(specification.substr(0, dash)));
+                    std::string_view last_str(trim(specification.substr(dash + 1)));
+                    if(first_str.empty()) {
+                        /* Suffix range: the last N bytes. */
+                        if(!parseNumber(last_str, last)) {
+                            return RangeParseResult::IGNORED;
+                        }
+                        if(last > 0 && size > 0) {
+                            ranges.push_back({size > last ? size - last : 0, size - 1});
+                        }
+                    } else {
+                        if(!parseNumber(first_str, first) || (!last_str.empty() && (!parseNumber(last_str, last) || last < first))) {
+                            return RangeParseResult::IGNORED;
+                        }
+                        if(first < size) {
+                            ranges.push_back({first, last_str.empty() ? size - 1 : std::min(last, size - 1)});
+                        }
+                    }
+                }
+
+                if(specifications_count == 0) {
+                    return RangeParseResult::IGNORED;
+                }
+                if(ranges.empty()) {
+                    return RangeParseResult::NOT_SATISFIABLE;
+                }
+
+                std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) { return a.first < b.first; });
+                size_t merged(0);
+                for(size_t i = 1; i < ranges.size(); i++) {
+                    if(ranges[i].first <= ranges[merged].last + 1) {
+                        ranges[merged].last = std::max(ranges[merged].last, ranges[i].last);
+                    } else {
+                        ranges[++merged] = ranges[i];
+                    }
+                }
+                ranges.resize(merged + 1);
+                return RangeParseResult::SATISFIABLE;
+            }
+
+            /**
+             * Check an If-Range header against the current version of the content.
+             * @param if_range The If-Range header value, may be empty.
+             * @param entity_tag The entity tag of the content.
+             * @param last_modified The last modification date of the content.
+             * @return true if the Range header must be honored, false if the full content must be sent.
+             */
+            static bool isIfRangeMatching(std::string_view if_range, const std::string& entity_tag, const std::string& last_modified) {
+                if_range = trim(if_range);
+                bool ret(true);
+                if(!if_range.empty()) {
+                    if(if_range.front() == '"' || if_range.starts_with("W/")) {
+                        /* If-Range requires a strong comparison, weak tags never match. */
+                        ret = !entity_tag.empty() && if_range == entity_tag;
+                    } else {
+                        ret = !last_modified.empty() && if_range == last_modified;
+                    }
+                }
+                return ret;
+            }
+
+        private:
+            /* Types */
+            /** A part of the response: literal bytes followed by a part of the content source. */
+            struct Segment {
+                /** Bytes written before the content part, e.g. a multipart header. */
+                std::string m_prefix;
+
+                /** The position of the content part. */
+                size_t m_offset;
+
+                /** The size of the content part. */
+                size_t m_length;
+            };
+
+            /* Constants */
+            /** The maximum number of bytes read from the source for a single chunk. */
+            static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+            /** Requests with more range specifications are served the full content to avoid range flooding. */
+            static constexpr size_t MAX_RANGES = 32;
+
+            /* Functions */
+            /**
+             * Build the producer streaming the given segments.
+             * @param source The content source.
+             * @param segments The segments to stream.
+             * @return The producer.
+             */
+            static Response::ContentProducer buildProducer(const std::shared_ptr<ContentSource>& source, std::vector<Segment>&& segments) {
+                std::shared_ptr<std::vector<Segment>> remaining(std::make_shared<std::vector<Segment>>(std::move(segments)));
+                std::shared_ptr<size_t> index(std::make_shared<size_t>(0));
+                return [source, remaining, index](std::string& chunk) {
+                    while(*index < remaining->size()) {
+                        Segment& segment((*remaining)[*index]);
+                        if(!segment.m_prefix.empty()) {
+                            chunk.swap(segment.m_prefix);
+                            segment.m_prefix.clear();
+                            return true;
+                        }
+                        if(segment.m_length > 0) {
+                            size_t length(std::min(segment.m_length, CHUNK_SIZE));
+                            if(!source->read(segment.m_offset, length, chunk)) {
+                                return false;
+                            }
+                            segment.m_offset += length;
+                            segment.m_length -= length;
+                            return true;
+                        }
+                        (*index)++;
+                    }
+                    return false;
+                };
+            }
+
+            /**
+             * Format the Content-Range value of a range.
+             * @param range The range.
+             * @param size The size of the content.
+             * @return The Content-Range value.
+             */
+            static std::string contentRange(const ByteRange& range, size_t size) {
+                return "bytes " + std::to_string(range.first) + '-' + std::to_string(range.last) + '/' + std::to_string(size);
+            }
+
+            /**
+             * Generate a multipart boundary.
+             * @return A random boundary.
+             */
+            static std::string generateBoundary() {
+                thread_local std::mt19937_64 generator(std::random_device{}());
+                char boundary[32];
+                std::snprintf(boundary, sizeof(boundary), "owebpp%016llx", static_cast<unsigned long long>(generator()));
+                return boundary;
+            }
+
+            /**
+             * Parse a decimal number.
+             * @param str The string to parse.
+             * @param value Receives the number.
+             * @return true if the whole string is a number that doesn't overflow, false otherwise.
+             */
+            static bool parseNumber(std::string_view str, size_t& value) {
+                auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), value);
+                return !str.empty() && error == std::errc() && end == str.data() + str.size();
+            }
+
+            /**
+             * Remove the leading and trailing spaces and tabs.
+             * @param str The string to trim.
+             * @return The trimmed string.
+             */
+            static std::string_view trim(std::string_view str) {
+                size_t begin = str.find_first_not_of(" \t");
+                size_t end = str.find_last_not_of(" \t");
+                return begin == std::string_view::npos ? std::string_view() : str.substr(begin, end - begin + 1);
+            }
+    };
+}
+
+#endif // OWEBPP_RANGE_RESPONSE_HPP
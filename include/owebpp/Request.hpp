@@ -24,9 +24,15 @@
 #ifndef OWEBPP_REQUEST_HPP
 #define OWEBPP_REQUEST_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <map>
 #include <owebpp/HttpMethod.hpp>
+#include <owebpp/Translator.hpp>
 
 namespace owebpp {
     /** Represents an HTTP request. */
@@ -50,7 +56,11 @@ namespace owebpp {
                 m_url(url),
                 m_headers(headers),
                 m_get_parameters(get_parameters),
-                m_body(body){}
+                m_body(body),
+                m_received_time(std::chrono::steady_clock::now()),
+                m_deadline(std::chrono::steady_clock::time_point::max()),
+                m_cancelled(false),
+                m_translator(nullptr) {}
 
             /* Deleted constructors */
             Request(const Request& o) = delete;
@@ -63,7 +73,48 @@ namespace owebpp {
             /* Destructor */
             ~Request() = default;
 
+            /* Functions */
+            /**
+             * Tell if the response to this request is no longer wanted, i.e. the client disconnected or the deadline passed.
+             * Long running client code can check it between steps and give up early.
+             * @return true if the request expired, false otherwise.
+             */
+            bool expired() const {
+                return isCancelled() || (m_deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= m_deadline);
+            }
+
+            /**
+             * Tell if the request was cancelled, this only reads a flag.
+             * @return true if the request was cancelled, false otherwise.
+             */
+            bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+            /** Cancel the request, the backends call it when the client disconnects while the response is being produced, from any thread. */
+            void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+            /**
+             * Bring the deadline of the request forward, a later deadline is ignored.
+             * @param deadline The deadline.
+             * @return The request.
+             */
+            Request& tightenDeadline(std::chrono::steady_clock::time_point deadline) {
+                m_deadline = std::min(m_deadline, deadline);
+                return *this;
+            }
+
             /* Getters and Setters */
+            /**
+             * Getter for the time the request was received at.
+             * @return the time the request was received at.
+             */
+            std::chrono::steady_clock::time_point getReceivedTime() const { return m_received_time; }
+
+            /**
+             * Getter for the deadline of the request.
+             * @return the deadline, std::chrono::steady_clock::time_point::max() if the request has none.
+             */
+            std::chrono::steady_clock::time_point getDeadline() const { return m_deadline; }
+
             /**
              * Getter for the request method.
              * @return the request method.
@@ -82,6 +133,21 @@ namespace owebpp {
              */
             const std::map<std::string,std::string>& getHeaders() const { return m_headers; }
 
+            /**
+             * Get the value of a request header, the name is compared without case sensitivity as HTTP header names are case insensitive.
+             * @param name The name of the header.
+             * @return The header value or an empty string if the header wasn't sent.
+             */
+            const std::string& getHeader(const std::string& name) const {
+                static const std::string empty_value;
+                auto it = std::find_if(m_headers.begin(), m_headers.end(), [&name](const std::pair<const std::string, std::string>& header) {
+                    return std::equal(header.first.begin(), header.first.end(), name.begin(), name.end(), [](char a, char b) {
+                        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                    });
+                });
+                return it == m_headers.end() ? empty_value : it->second;
+            }
+
             /**
              * Getter for the request get parameters.
              * @return the request get parameters.
@@ -94,6 +160,22 @@ namespace owebpp {
              */
             const std::string& getBody() const { return m_body; }
 
+            /**
+             * Getter for the translator negotiated for the request, see owebpp::LocaleNegotiator.
+             * @return the translator of the request, the global one if none was negotiated.
+             */
+            Translator& getTranslator() const { return m_translator != nullptr ? *m_translator : Translator::getInstance(); }
+
+            /**
+             * Setter for the translator of the request.
+             * @param translator The translator, nullptr to use the global one.
+             * @return The request.
+             */
+            Request& setTranslator(const std::shared_ptr<Translator>& translator) {
+                m_translator = translator;
+                return *this;
+            }
+
         private:
             /* Members */
             /** The request method */
@@ -110,6 +192,18 @@ namespace owebpp {
 
             /** The request body */
             std::string m_body;
+
+            /** The time the request was received at. */
+            std::chrono::steady_clock::time_point m_received_time;
+
+            /** The time after which the response is no longer wanted, it is set before the route runs. */
+            std::chrono::steady_clock::time_point m_deadline;
+
+            /** Whether the request was cancelled, it is set by the backend thread while the route may run on another one. */
+            std::atomic<bool> m_cancelled;
+
+            /** The translator negotiated for the request, it is set before the route runs. */
+            std::shared_ptr<Translator> m_translator;
     };
 }
 
@@ -24,6 +24,10 @@
 #ifndef OWEBPP_RESPONSE_HPP
 #define OWEBPP_RESPONSE_HPP
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <owebpp/Generator.hpp>
 #include <owebpp/HttpStatusCode.hpp>
 #include <string>
 #include <vector>
@@ -32,6 +36,14 @@ namespace owebpp {
     /** Represents an HTTP response. */
     class Response {
         public:
+            /* Types */
+            /**
+             * Callback pulled by the backend to stream the response content.
+             * Each call must replace the content of the given chunk with the next part of the content and return true, or return false once the content is over.
+             * The same string is given to every call so its capacity is reused between chunks.
+             */
+            using ContentProducer = std::function<bool(std::string& chunk)>;
+
             /* Constructors */
             /**
              * Construct a Response with default values.
@@ -41,7 +53,9 @@ namespace owebpp {
                 m_charset("utf-8"),
                 m_content_type("text/plain"),
                 m_status_code(HttpStatusCode::OK),
-                m_headers() {}
+                m_headers(),
+                m_content_producer(nullptr),
+                m_streamed_content_length(std::nullopt) {}
 
             /* Deleted constructors */
             Response(const Response& o) = delete;
@@ -71,6 +85,12 @@ namespace owebpp {
                 return *this;
             }
 
+            /**
+             * Getter for the response content buffer, allows to write the content in place, e.g. from generated templates.
+             * @return The response content buffer.
+             */
+            inline std::string& getContentBuffer() { return m_content; }
+
             /**
              * Getter for the response charset.
              * @return The response charset.
@@ -125,6 +145,12 @@ namespace owebpp {
              */
             inline std::vector<std::string>& getHeaders() { return m_headers; }
 
+            /**
+             * Getter for the response headers.
+             * @return The response headers.
+             */
+            inline const std::vector<std::string>& getHeaders() const { return m_headers; }
+
             /**
              * Setter for the response headers.
              * @param headers The headers to use for the response.
@@ -135,6 +161,49 @@ namespace owebpp {
                 return *this;
             }
 
+            /**
+             * Tell if the response content is streamed through a producer instead of being held in the content.
+             * @return true if the response is streamed, false otherwise.
+             */
+            inline bool isStreamed() const { return static_cast<bool>(m_content_producer); }
+
+            /**
+             * Getter for the response content producer.
+             * @return The response content producer, empty if the response is not streamed.
+             */
+            inline const ContentProducer& getContentProducer() const { return m_content_producer; }
+
+            /**
+             * Stream the response content through the given producer, the backend pulls chunks from it while it can write them to the client.
+             * The response content is ignored when a producer is set.
+             * @param producer The producer to pull the response content from.
+             * @param content_length The total size of the streamed content if known in advance, allows to send a Content-Length instead of chunking the content.
+             * @return The response.
+             */
+            inline Response& setContentProducer(const ContentProducer& producer, std::optional<size_t> content_length = std::nullopt) {
+                m_content_producer = producer;
+                m_streamed_content_length = content_length;
+                return *this;
+            }
+
+            /**
+             * Getter for the response content length.
+             * @return The size of the content, or the announced size of the streamed content which may be unknown.
+             */
+            inline std::optional<size_t> getContentLength() const {
+                return isStreamed() ? m_streamed_content_length : std::optional<size_t>(m_content.size());
+            }
+
+            /**
+             * Stream the response content from a coroutine yielding the content chunk by chunk, its size is unknown so it is chunked.
+             * @param generator The generator yielding the response content.
+             * @return The response.
+             */
+            inline Response& setContentGenerator(Generator<std::string>&& generator) {
+                std::shared_ptr<Generator<std::string>> shared_generator(std::make_shared<Generator<std::string>>(std::move(generator)));
+                return setContentProducer([shared_generator](std::string& chunk) { return shared_generator->next(chunk); }, std::nullopt);
+            }
+
         protected:
             /* Members */
             /** The response content. */
@@ -152,6 +221,12 @@ namespace owebpp {
             /** The response headers. */
             std::vector<std::string> m_headers;
 
+            /** The producer streaming the response content, empty if the content is held in m_content. */
+            ContentProducer m_content_producer;
+
+            /** The total size of the streamed content when it is known in advance. */
+            std::optional<size_t> m_streamed_content_length;
+
     };
 }
 #endif //OWEBPP_RESPONSE_HPP
@@ -0,0 +1,223 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_ROUTE_INVOKER_HPP
+#define OWEBPP_ROUTE_INVOKER_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <utility>
+
+#include <owebpp/Executor.hpp>
+#include <owebpp/Priority.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+#include <owebpp/Task.hpp>
+
+namespace owebpp {
+    /**
+     * Calls the client code of a generated route, whether it returns a std::shared_ptr<owebpp::Response> or a coroutine returning an owebpp::Task.
+     * The kind of client code is detected at compile time from its return type. This class doesn't have any use for client code.
+     * @tparam Thandler The client class, it is default constructed for each request.
+     * @tparam Tparameters_number The number of parameters in the URL.
+     */
+    template<class Thandler, size_t Tparameters_number>
+    class RouteInvoker final {
+        public:
+            /* Deleted constructors */
+            RouteInvoker() = delete;
+            RouteInvoker(const RouteInvoker& o) = delete;
+            RouteInvoker(RouteInvoker&& o) = delete;
+
+            /* Deleted assignment operators */
+            RouteInvoker& operator=(const RouteInvoker& o) = delete;
+            RouteInvoker& operator=(RouteInvoker&& o) = delete;
+
+            /* Deleted destructor */
+            ~RouteInvoker() = delete;
+
+            /* Functions */
+            /**
+             * Tell if the client code is a coroutine.
+             * @param call The callable calling the client code with the client object, the request and the URL parameters.
+             * @return true if the client code returns an owebpp::Task.
+             */
+            template<class Tcall>
+            static constexpr bool isAsync([[maybe_unused]] const Tcall& call) {
+                return IS_ASYNC<Tcall>;
+            }
+
+            /**
+             * Run the client code to completion, a coroutine is run synchronously.
+             * @param call The callable calling the client code with the client object, the request and the URL parameters.
+             * @param request The request.
+             * @param sm The parameters in the URL.
+             * @return The response.
+             */
+            template<class Tcall>
+            static std::shared_ptr<Response> execute(const Tcall& call, const std::shared_ptr<Request>& request, std::smatch& sm) {
+                if constexpr(IS_ASYNC<Tcall>) {
+                    return executeAsync(call, request, sm).get();
+                } else {
+                    Thandler handler;
+                    return invoke(call, handler, request, sm, std::make_index_sequence<Tparameters_number>());
+                }
+            }
+
+            /**
+             * Build the Task running the client code, the client code is run as soon as the Task starts if it isn't a coroutine.
+             * @param call The callable calling the client code with the client object, the request and the URL parameters.
+             * @param request The request.
+             * @param sm The parameters in the URL, they are copied into the Task.
+             * @return The Task producing the response.
+             */
+            template<class Tcall>
+            static Task<std::shared_ptr<Response>> executeAsync(const Tcall& call, const std::shared_ptr<Request>& request, std::smatch& sm) {
+                if constexpr(IS_ASYNC<Tcall>) {
+                    return run<Tcall>(request, copyParameters(sm, std::make_index_sequence<Tparameters_number>()));
+                } else {
+                    return Task<std::shared_ptr<Response>>::fromValue(execute(call, request, sm));
+                }
+            }
+
+            /**
+             * Build the Task running the client code on the shared owebpp::Executor, the response is completed back on the thread awaiting the Task.
+             * A coroutine is run to completion on the worker, its awaitables block there.
+             * @param call The callable calling the client code with the client object, the request and the URL parameters.
+             * @param request The request.
+             * @param sm The parameters in the URL, they are copied into the Task.
+             * @param priority The priority class of the job.
+             * @return The Task producing the response.
+             */
+            template<class Tcall>
+            static Task<std::shared_ptr<Response>> executeOnPool([[maybe_unused]] const Tcall& call, const std::shared_ptr<Request>& request, std::smatch& sm, Priority priority) {
+                return offload(makeJob<Tcall>(request, copyParameters(sm, std::make_index_sequence<Tparameters_number>())), priority);
+            }
+
+        private:
+            /* Functions */
+            /**
+             * Declare the result type of the client code, it is never defined.
+             * @return The result of the client code.
+             */
+            template<class Tcall, size_t... Tindexes>
+            static auto resultOf(std::index_sequence<Tindexes...>)
+                -> decltype(std::declval<const Tcall&>()(std::declval<Thandler&>(), std::declval<const std::shared_ptr<Request>&>(), (static_cast<void>(Tindexes), std::declval<const std::string&>())...));
+
+            /**
+             * Call the client code with the URL parameters.
+             * @param call The callable calling the client code.
+             * @param handler The client object.
+             * @param request The request.
+             * @param sm The parameters in the URL.
+             * @return The result of the client code.
+             */
+            template<class Tcall, size_t... Tindexes>
+            static std::shared_ptr<Response> invoke(const Tcall& call, Thandler& handler, const std::shared_ptr<Request>& request, [[maybe_unused]] std::smatch& sm, std::index_sequence<Tindexes...>) {
+                return call(handler, request, sm[Tindexes + 1]...);
+            }
+
+            /**
+             * Copy the URL parameters since the std::smatch doesn't outlive the Task.
+             * @param sm The parameters in the URL.
+             * @return The copied parameters.
+             */
+            template<size_t... Tindexes>
+            static std::array<std::string, Tparameters_number> copyParameters([[maybe_unused]] std::smatch& sm, std::index_sequence<Tindexes...>) {
+                return {sm[Tindexes + 1].str()...};
+            }
+
+            /**
+             * Call the client code with the copied URL parameters.
+             * @param handler The client object.
+             * @param request The request.
+             * @param parameters The parameters in the URL.
+             * @return The result of the client code.
+             */
+            template<class Tcall, size_t... Tindexes>
+            static auto invokeCopied(Thandler& handler, const std::shared_ptr<Request>& request, [[maybe_unused]] const std::array<std::string, Tparameters_number>& parameters, std::index_sequence<Tindexes...>) {
+                return Tcall()(handler, request, parameters[Tindexes]...);
+            }
+
+            /**
+             * The coroutine running asynchronous client code, the client object and the parameters live in its frame while the client code is suspended.
+             * The callable is default constructed by invokeCopied() rather than stored in the frame, since the frame must only hold types with linkage.
+             * @param request The request.
+             * @param parameters The parameters in the URL.
+             * @return The Task producing the response.
+             */
+            OWEBPP_COROUTINE_BEGIN
+            template<class Tcall>
+            static Task<std::shared_ptr<Response>> run(std::shared_ptr<Request> request, std::array<std::string, Tparameters_number> parameters) {
+                Thandler handler;
+                co_return co_await invokeCopied<Tcall>(handler, request, parameters, std::make_index_sequence<Tparameters_number>());
+            }
+            OWEBPP_COROUTINE_END
+
+            /**
+             * Build the job running the client code to completion on a worker of the owebpp::Executor, a request that expired while the job was queued is answered with 504 Gateway Timeout.
+             * @param request The request.
+             * @param parameters The parameters in the URL.
+             * @return The job producing the response.
+             */
+            template<class Tcall>
+            static std::function<std::shared_ptr<Response>()> makeJob(std::shared_ptr<Request> request, std::array<std::string, Tparameters_number> parameters) {
+                return [request, parameters]() -> std::shared_ptr<Response> {
+                    if(request->expired()) {
+                        std::shared_ptr<Response> response(std::make_shared<Response>());
+                        response->setSatusCode(HttpStatusCode::GATEWAY_TIMEOUT);
+                        return response;
+                    }
+                    if constexpr(IS_ASYNC<Tcall>) {
+                        return run<Tcall>(request, parameters).get();
+                    } else {
+                        Thandler handler;
+                        return invokeCopied<Tcall>(handler, request, parameters, std::make_index_sequence<Tparameters_number>());
+                    }
+                };
+            }
+
+            /**
+             * The coroutine awaiting a job run on the owebpp::Executor.
+             * @param job The job.
+             * @param priority The priority class of the job.
+             * @return The Task producing the response.
+             */
+            OWEBPP_COROUTINE_BEGIN
+            static Task<std::shared_ptr<Response>> offload(std::function<std::shared_ptr<Response>()> job, Priority priority) {
+                co_return co_await ExecutorAwaitable<std::shared_ptr<Response>>(Executor::getInstance(), std::move(job), priority);
+            }
+            OWEBPP_COROUTINE_END
+
+            /* Constants */
+            /** Whether the client code called by a callable returns an owebpp::Task. */
+            template<class Tcall>
+            static constexpr bool IS_ASYNC = IsTask<decltype(resultOf<Tcall>(std::make_index_sequence<Tparameters_number>()))>::value;
+    };
+}
+
+#endif // OWEBPP_ROUTE_INVOKER_HPP
@@ -24,10 +24,20 @@
 #ifndef OWEBPP_ROUTER_HPP
 #define OWEBPP_ROUTER_HPP
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <fstream>
 #include <memory>
+#include <regex>
+#include <string>
 
 #include <owebpp/AbstractRoute.hpp>
+#include <owebpp/ConcurrencyLimiter.hpp>
+#include <owebpp/Snapshot.hpp>
+#include <owebpp/Task.hpp>
 
 namespace owebpp {
     /**
@@ -56,14 +66,11 @@ namespace owebpp {
 
             /* Singleton call method */
             /**
-             * Get the router instance.
-             * @return The logger instance.
+             * Get the router instance, it is created by the first thread calling this function and then read without locking.
+             * @return The router instance.
              */
             static Router& getInstance() {
-                if(s_router==nullptr){
-                    s_router = std::make_shared<Router>();
-                }
-                return *s_router;
+                return *s_router.loadOrCreate([]() { return std::make_shared<Router>(); });
             }
 
             /* Functions */
@@ -73,26 +80,155 @@ namespace owebpp {
              * @return The response to the request.
              */
             [[nodiscard]] std::shared_ptr<Response> searchAndExecuteRoute(const std::shared_ptr<Request>& req) {
+                std::smatch sm;
+                AbstractRoute* route = searchRoute(req, sm);
+                if(route != nullptr) {
+                    return executeRoute(*route, req, sm);
+                }
+                std::shared_ptr<Response> response = std::make_shared<Response>();
+                response->setSatusCode(HttpStatusCode::NOT_FOUND);
+                return response;
+            }
+
+            /**
+             * Search the route matching a request without running it, this lets a backend run asynchronous routes with AbstractRoute::executeAsync().
+             * @param req The request.
+             * @param sm Receives the parameters in the URL, it refers to the URL of the request.
+             * @return The matching route, nullptr if none matches.
+             */
+            [[nodiscard]] AbstractRoute* searchRoute(const std::shared_ptr<Request>& req, std::smatch& sm) {
                 for(size_t i = 0; i < m_routes.size(); i++) {
                     int allowed_methods = m_routes[i]->getAllowedMethods();
                     int request_method = (int) req->getMethod();
                     if(allowed_methods & request_method ) {
-                        std::smatch sm;
                         if (regex_search(req->getUrl(), sm, m_routes[i]->getRegex())) {
                             if((sm.size() - 1) == m_routes[i]->getParametersNumber()) {
-                                return m_routes[i]->execute(req, sm);
+                                return m_routes[i].get();
                             }
                         }
                     }
                 }
-                std::shared_ptr<Response> response = std::make_shared<Response>();
-                response->setSatusCode(HttpStatusCode::NOT_FOUND);
+                return nullptr;
+            }
+
+            /**
+             * Run a route, the request is answered with 504 Gateway Timeout if it already expired and shed if the concurrency limit of the route is reached.
+             * @param route The route.
+             * @param req The request.
+             * @param sm The parameters in the URL.
+             * @return The response to the request.
+             */
+            [[nodiscard]] static std::shared_ptr<Response> executeRoute(AbstractRoute& route, const std::shared_ptr<Request>& req, std::smatch& sm) {
+                if(applyDeadline(route, *req)) {
+                    return timeOut();
+                }
+                ConcurrencyLimiter* limiter(route.getLimiter());
+                if(limiter == nullptr) {
+                    return route.execute(req, sm);
+                }
+                if(!limiter->tryAcquire()) {
+                    return limiter->shed();
+                }
+                std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+                std::shared_ptr<Response> response;
+                try {
+                    response = route.execute(req, sm);
+                } catch(...) {
+                    limiter->release(std::chrono::steady_clock::now() - start);
+                    throw;
+                }
+                limiter->release(std::chrono::steady_clock::now() - start);
                 return response;
             }
 
+            /**
+             * Build the Task running a route with AbstractRoute::executeAsync(), the request waits in the queue of the route if its concurrency limit is reached and is shed if the queue is full.
+             * An expired request is answered with 504 Gateway Timeout, before it runs and once it leaves the queue.
+             * @param route The route.
+             * @param req The request.
+             * @param sm The parameters in the URL, they are copied since they refer to the URL of the request.
+             * @return A Task producing the response to the request.
+             */
+            [[nodiscard]] static Task<std::shared_ptr<Response>> executeRouteAsync(AbstractRoute& route, const std::shared_ptr<Request>& req, std::smatch& sm) {
+                if(applyDeadline(route, *req)) {
+                    return Task<std::shared_ptr<Response>>::fromValue(timeOut());
+                }
+                if(route.getLimiter() == nullptr) {
+                    return route.executeAsync(req, sm);
+                }
+                return executeLimitedRoute(route, req, sm);
+            }
+
         private:
 
             /* Methods */
+            /**
+             * The coroutine running a route once its limiter admits the request, the client code isn't called before.
+             * @param route The route.
+             * @param req The request.
+             * @param sm The parameters in the URL.
+             * @return The Task producing the response.
+             */
+            OWEBPP_COROUTINE_BEGIN
+            static Task<std::shared_ptr<Response>> executeLimitedRoute(AbstractRoute& route, std::shared_ptr<Request> req, std::smatch sm) {
+                ConcurrencyLimiter& limiter(*route.getLimiter());
+                if(!co_await limiter.acquire()) {
+                    co_return limiter.shed();
+                }
+                if(req->expired()) {
+                    /* The request expired while waiting in the queue, the slot goes to the next one. */
+                    limiter.releaseUnused();
+                    co_return timeOut();
+                }
+                std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+                std::shared_ptr<Response> response;
+                std::exception_ptr exception(nullptr);
+                try {
+                    response = co_await route.executeAsync(req, sm);
+                } catch(...) {
+                    exception = std::current_exception();
+                }
+                limiter.release(std::chrono::steady_clock::now() - start);
+                if(exception != nullptr) {
+                    std::rethrow_exception(exception);
+                }
+                co_return response;
+            }
+            OWEBPP_COROUTINE_END
+
+            /**
+             * Set the deadline of a request from the time budget of its route and from the TIMEOUT_HEADER header, the tightest one wins.
+             * @param route The route.
+             * @param req The request.
+             * @return true if the request already expired, false otherwise.
+             */
+            static bool applyDeadline(const AbstractRoute& route, Request& req) {
+                if(route.getTimeout().count() > 0) {
+                    req.tightenDeadline(req.getReceivedTime() + route.getTimeout());
+                }
+                const std::string& header(req.getHeader(TIMEOUT_HEADER));
+                if(!header.empty()) {
+                    uint64_t timeout_ms(0);
+                    auto [end, error] = std::from_chars(header.data(), header.data() + header.size(), timeout_ms);
+                    /* Values which don't fit are ignored and larger budgets clamped, so that the deadline can't overflow. */
+                    if(error == std::errc() && end == header.data() + header.size()) {
+                        timeout_ms = std::min<uint64_t>(timeout_ms, static_cast<uint64_t>(MAX_CLIENT_TIMEOUT.count()));
+                        req.tightenDeadline(req.getReceivedTime() + std::chrono::milliseconds(timeout_ms));
+                    }
+                }
+                return req.expired();
+            }
+
+            /**
+             * Build the response to an expired request.
+             * @return A 504 Gateway Timeout response.
+             */
+            static std::shared_ptr<Response> timeOut() {
+                std::shared_ptr<Response> response(std::make_shared<Response>());
+                response->setSatusCode(HttpStatusCode::GATEWAY_TIMEOUT);
+                return response;
+            }
+
             /**
              * This method is used to create an AbstractRoute child class std::shared_ptr object and cast it to a std::shared_ptr<AbstractRoute>.
              * This allows to insert the object into the m_routes container without a type error.
@@ -107,12 +243,19 @@ namespace owebpp {
             /** this methods content is generated automaticaly */
             void loadRoutes();
 
+            /* Constants */
+            /** The request header carrying the time budget of the client in milliseconds, e.g. the time left before the deadline of a proxy. */
+            static inline const std::string TIMEOUT_HEADER = "X-Request-Timeout";
+
+            /** The largest time budget a client can give with the TIMEOUT_HEADER header, larger ones are clamped. */
+            static constexpr std::chrono::milliseconds MAX_CLIENT_TIMEOUT = std::chrono::hours(24);
+
             /* Members */
             /** Contains all the route that are available in the program */
             std::vector<std::shared_ptr<owebpp::AbstractRoute>> m_routes;
 
             /** Singleton object */
-            static std::shared_ptr<Router> s_router;
+            static Snapshot<Router> s_router;
     };
 
 }
@@ -0,0 +1,248 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SNAPSHOT_HPP
+#define OWEBPP_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace owebpp {
+    /**
+     * Publishes a value, e.g. a translation catalog or a singleton, that a writer replaces while any number of threads read it.
+     * Each thread keeps the value it last read with its version, so a read is an atomic load of the version while the value is unchanged,
+     * and only the first read after a replacement loads the value itself. Reads never wait for a replacement to complete.
+     * The values of a thread are indexed by snapshot in a table growing with the number of snapshots it reads, up to MAX_CACHE_SIZE slots.
+     * A replaced value lives until the threads which read it read again, or exit. Use a const type for data that must not change once published.
+     */
+    template<class T>
+    class Snapshot {
+        public:
+            /* Constructors */
+            /** Construct an empty snapshot, it is constant initialized so a static snapshot can be read by static initializers. */
+            constexpr Snapshot() noexcept:
+                m_value(),
+                m_version(0),
+                m_store_mutex(),
+                m_retired() {}
+
+            /**
+             * Publish a first value.
+             * @param value The value.
+             */
+            explicit Snapshot(std::shared_ptr<T> value):
+                m_value(std::move(value)),
+                m_version(s_next_version.fetch_add(1, std::memory_order_relaxed)),
+                m_store_mutex(),
+                m_retired() {}
+
+            /* Deleted constructors */
+            Snapshot(const Snapshot& o) = delete;
+            Snapshot(Snapshot&& o) = delete;
+
+            /* Deleted assignment operators */
+            Snapshot& operator=(const Snapshot& o) = delete;
+            Snapshot& operator=(Snapshot&& o) = delete;
+
+            /* Destructor */
+            ~Snapshot() = default;
+
+            /* Functions */
+            /**
+             * Get the current value, from the copy of the calling thread if it is still current.
+             * @return The value, the reference stays valid until the thread reads a snapshot of the same type again, copy it to keep the value longer.
+             */
+            const std::shared_ptr<T>& load() const {
+                CachedValue& cached(findCachedValue());
+                uint64_t version(m_version.load(std::memory_order_acquire));
+                /* Versions are never reused, so a snapshot created at the address of a destroyed one doesn't match its value, but for empty snapshots. */
+                if(cached.owner != this || cached.version != version) {
+                    cached.owner = this;
+                    cached.value = m_value.load(std::memory_order_acquire);
+                    cached.version = version;
+                }
+                return cached.value;
+            }
+
+            /**
+             * Publish a new value, the threads read it from their next load().
+             * @param value The value.
+             */
+            void store(std::shared_ptr<T> value) {
+                /* Writers are serialized so that the last version published goes with the last value. */
+                std::lock_guard<std::mutex> lock(m_store_mutex);
+                m_value.store(std::move(value), std::memory_order_release);
+                m_version.store(s_next_version.fetch_add(1, std::memory_order_relaxed), std::memory_order_release);
+            }
+
+            /**
+             * Publish a new value and keep the replaced one alive as long as the snapshot.
+             * This is for values used by reference for an unbounded time, e.g. a singleton whose reference a coroutine keeps across a suspension.
+             * @param value The value.
+             */
+            void storeAndRetain(std::shared_ptr<T> value) {
+                std::lock_guard<std::mutex> lock(m_store_mutex);
+                std::shared_ptr<T> replaced(m_value.exchange(std::move(value), std::memory_order_acq_rel));
+                if(replaced != nullptr) {
+                    m_retired.push_back(std::move(replaced));
+                }
+                m_version.store(s_next_version.fetch_add(1, std::memory_order_relaxed), std::memory_order_release);
+            }
+
+            /**
+             * Get the current value, publishing one first if the snapshot is empty, e.g. a singleton created on first use.
+             * @param create Creates the value, it is called by a single thread.
+             * @return The value, the reference stays valid as the one returned by load().
+             */
+            template<class Tcreate>
+            const std::shared_ptr<T>& loadOrCreate(const Tcreate& create) {
+                if(load() == nullptr) {
+                    std::lock_guard<std::mutex> lock(m_store_mutex);
+                    if(m_value.load(std::memory_order_acquire) == nullptr) {
+                        m_value.store(create(), std::memory_order_release);
+                        m_version.store(s_next_version.fetch_add(1, std::memory_order_relaxed), std::memory_order_release);
+                    }
+                }
+                return load();
+            }
+
+        private:
+            /* Constants */
+            /** The initial number of slots of the values kept by each thread. */
+            static constexpr size_t INITIAL_CACHE_SIZE = 16;
+
+            /** The maximum number of slots of the values kept by each thread, the values are all dropped when half of them are used. */
+            static constexpr size_t MAX_CACHE_SIZE = 1024;
+
+            /* Types */
+            /** A value kept by a thread. */
+            struct CachedValue {
+                /** The snapshot the value was read from, nullptr for an empty slot. */
+                const Snapshot* owner{nullptr};
+
+                /** The version of the value, versions are never reused so a slot can't mistake a destroyed snapshot for a new one. */
+                uint64_t version{0};
+
+                /** The value. */
+                std::shared_ptr<T> value{};
+            };
+
+            /** The values kept by a thread, in an open addressing table indexed by snapshot. */
+            struct Cache {
+                /** The slots, their number is a power of two. */
+                std::vector<CachedValue> slots{};
+
+                /** The number of used slots. */
+                size_t used{0};
+            };
+
+            /* Functions */
+            /**
+             * Find the slot of this snapshot in the values kept by the calling thread, taking a slot if it has none.
+             * The table is at most half full so the probing stays short, once it can't grow it is emptied instead.
+             * @return The slot.
+             */
+            CachedValue& findCachedValue() const {
+                Cache& cache(getCache());
+                size_t mask(cache.slots.size() - 1);
+                size_t slot(hash(this) & mask);
+                while(cache.slots[slot].owner != this && cache.slots[slot].owner != nullptr) {
+                    slot = (slot + 1) & mask;
+                }
+                if(cache.slots[slot].owner == nullptr) {
+                    if((cache.used + 1) * 2 <= cache.slots.size()) {
+                        cache.used++;
+                    } else {
+                        grow(cache);
+                        return findCachedValue();
+                    }
+                }
+                return cache.slots[slot];
+            }
+
+            /**
+             * Double the number of slots of a table, or empty it if it has MAX_CACHE_SIZE slots.
+             * @param cache The table.
+             */
+            static void grow(Cache& cache) {
+                if(cache.slots.size() >= MAX_CACHE_SIZE) {
+                    cache.slots.assign(cache.slots.size(), CachedValue());
+                    cache.used = 0;
+                } else {
+                    std::vector<CachedValue> slots(cache.slots.size() * 2);
+                    size_t mask(slots.size() - 1);
+                    for(CachedValue& cached : cache.slots) {
+                        /* The owner may be destroyed, only its address is used. */
+                        if(cached.owner != nullptr) {
+                            size_t slot(hash(cached.owner) & mask);
+                            while(slots[slot].owner != nullptr) {
+                                slot = (slot + 1) & mask;
+                            }
+                            slots[slot] = std::move(cached);
+                        }
+                    }
+                    cache.slots.swap(slots);
+                }
+            }
+
+            /**
+             * Hash the address of a snapshot.
+             * @param snapshot The snapshot.
+             * @return The hash.
+             */
+            static size_t hash(const Snapshot* snapshot) {
+                return static_cast<size_t>((reinterpret_cast<uintptr_t>(snapshot) >> 4) * 0x9e3779b97f4a7c15ULL >> 32);
+            }
+
+            /**
+             * Get the values kept by the calling thread.
+             * @return The values.
+             */
+            static Cache& getCache() {
+                thread_local Cache cache{std::vector<CachedValue>(INITIAL_CACHE_SIZE), 0};
+                return cache;
+            }
+
+            /* Members */
+            /** The current value. */
+            std::atomic<std::shared_ptr<T>> m_value;
+
+            /** The version of the current value. */
+            std::atomic<uint64_t> m_version;
+
+            /** Serializes the writers. */
+            std::mutex m_store_mutex;
+
+            /** The values replaced by storeAndRetain(), protected by m_store_mutex. */
+            std::vector<std::shared_ptr<T>> m_retired;
+
+            /** The next version, shared by the snapshots of a type. */
+            static inline std::atomic<uint64_t> s_next_version = 1;
+    };
+}
+
+#endif // OWEBPP_SNAPSHOT_HPP
@@ -0,0 +1,275 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_TASK_HPP
+#define OWEBPP_TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <owebpp/AsyncContext.hpp>
+
+/**
+ * GCC reports the switch it generates for coroutine bodies with -Wswitch-default, which the build of the framework enables.
+ * A coroutine written between these two macros builds without that warning, e.g. an asynchronous route function.
+ */
+#define OWEBPP_COROUTINE_BEGIN  _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wswitch-default\"")
+#define OWEBPP_COROUTINE_END    _Pragma("GCC diagnostic pop")
+
+namespace owebpp {
+    /**
+     * A lazily started coroutine producing a value through co_return, it can await other Tasks and the awaitables of owebpp/Awaitables.hpp.
+     * Asynchronous route handlers return a Task<std::shared_ptr<owebpp::Response>>, the standalone server suspends them on its event loop while they wait.
+     */
+    template<class T>
+    class Task {
+        public:
+            /** The promise type required by the compiler to build a coroutine returning a Task. */
+            class promise_type {
+                public:
+                    /* Types */
+                    /** Resumes the awaiting coroutine, or notifies the owner of a started Task, once the coroutine is over. */
+                    struct FinalAwaiter {
+                        /** The coroutine always suspends so its result can be read. */
+                        bool await_ready() const noexcept { return false; }
+
+                        /**
+                         * Transfer the execution to the awaiting coroutine or call the completion callback.
+                         * @param handle The finished coroutine.
+                         * @return The coroutine to resume.
+                         */
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                            std::coroutine_handle<> next(std::noop_coroutine());
+                            if(handle.promise().m_continuation) {
+                                next = handle.promise().m_continuation;
+                            } else if(handle.promise().m_on_done) {
+                                /* The callback may release the Task, so it is moved out of the frame first. */
+                                std::function<void()> on_done(std::move(handle.promise().m_on_done));
+                                on_done();
+                            }
+                            return next;
+                        }
+
+                        /** Never called since the coroutine isn't resumed once over. */
+                        void await_resume() const noexcept {}
+                    };
+
+                    /* Functions */
+                    /**
+                     * Build the Task returned to the caller of the coroutine.
+                     * @return The Task associated to this promise.
+                     */
+                    Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+                    /** The coroutine doesn't run until it is awaited or started. */
+                    std::suspend_always initial_suspend() noexcept { return {}; }
+
+                    /** Keep the coroutine frame alive so the result can be read. */
+                    FinalAwaiter final_suspend() noexcept { return {}; }
+
+                    /**
+                     * Store the value produced by co_return.
+                     * @param value The produced value.
+                     */
+                    template<class Tvalue>
+                    void return_value(Tvalue&& value) { m_value = std::forward<Tvalue>(value); }
+
+                    /** Store the exception so it can be rethrown to the consumer. */
+                    void unhandled_exception() { m_exception = std::current_exception(); }
+
+                    /* Members */
+                    /** The produced value. */
+                    std::optional<T> m_value = std::nullopt;
+
+                    /** The exception thrown by the coroutine if any. */
+                    std::exception_ptr m_exception = nullptr;
+
+                    /** The coroutine awaiting this one, resumed once it is over. */
+                    std::coroutine_handle<> m_continuation = nullptr;
+
+                    /** The callback given to start(), called once the coroutine is over. */
+                    std::function<void()> m_on_done = nullptr;
+            };
+
+            /** Starts the Task when it is awaited by another coroutine and resumes that coroutine with the result. */
+            class Awaiter {
+                public:
+                    /* Constructors */
+                    /**
+                     * Construct an Awaiter for the given coroutine.
+                     * @param handle The awaited coroutine.
+                     */
+                    explicit Awaiter(std::coroutine_handle<promise_type> handle): m_handle(handle) {}
+
+                    /* Functions */
+                    /** The awaited coroutine never ran yet. */
+                    bool await_ready() const noexcept { return false; }
+
+                    /**
+                     * Run the awaited coroutine, the awaiting one is resumed once it is over.
+                     * @param continuation The awaiting coroutine.
+                     * @return The coroutine to run.
+                     */
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+                        m_handle.promise().m_continuation = continuation;
+                        return m_handle;
+                    }
+
+                    /**
+                     * Get the result of the awaited coroutine.
+                     * @return The produced value.
+                     * @throw Any exception thrown by the awaited coroutine.
+                     */
+                    T await_resume() { return takeResult(m_handle); }
+
+                private:
+                    /* Members */
+                    /** The awaited coroutine. */
+                    std::coroutine_handle<promise_type> m_handle;
+            };
+
+            /* Constructors */
+            /**
+             * Construct a Task taking the ownership of the given coroutine.
+             * @param handle The coroutine handle.
+             */
+            explicit Task(std::coroutine_handle<promise_type> handle):
+                m_handle(handle) {}
+
+            /**
+             * Move construct a Task, the moved from Task no longer owns any coroutine.
+             * @param o The Task to move from.
+             */
+            Task(Task&& o) noexcept:
+                m_handle(std::exchange(o.m_handle, nullptr)) {}
+
+            /* Deleted constructors */
+            Task() = delete;
+            Task(const Task& o) = delete;
+
+            /* Deleted assignment operators */
+            Task& operator=(const Task& o) = delete;
+            Task& operator=(Task&& o) = delete;
+
+            /* Destructor */
+            ~Task() {
+                if(m_handle) {
+                    m_handle.destroy();
+                }
+            }
+
+            /* Functions */
+            /**
+             * Await the Task from another coroutine.
+             * @return The awaiter.
+             */
+            Awaiter operator co_await() const noexcept { return Awaiter(m_handle); }
+
+            /**
+             * Run the coroutine until it completes or suspends, it is then resumed by the awaited operations.
+             * The Task must stay alive until the callback is called.
+             * @param on_done The callback called once the coroutine is over, it may be called before this function returns.
+             */
+            void start(std::function<void()> on_done) {
+                m_handle.promise().m_on_done = std::move(on_done);
+                m_handle.resume();
+            }
+
+            /**
+             * Run the coroutine to completion on the calling thread, the awaitables of owebpp/Awaitables.hpp block instead of suspending.
+             * This is how an asynchronous route is run by a backend without an event loop.
+             * @return The produced value.
+             * @throw std::logic_error If the coroutine suspended on another awaitable.
+             * @throw Any exception thrown by the coroutine.
+             */
+            T get() {
+                AsyncContext* context(AsyncContext::getCurrent());
+                AsyncContext::setCurrent(nullptr);
+                m_handle.resume();
+                AsyncContext::setCurrent(context);
+                if(!m_handle.done()) {
+                    throw std::logic_error("owebpp::Task suspended while it was run synchronously.");
+                }
+                return takeResult(m_handle);
+            }
+
+            /**
+             * Get the result of a completed Task.
+             * @return The produced value.
+             * @throw Any exception thrown by the coroutine.
+             */
+            T getResult() { return takeResult(m_handle); }
+
+            /**
+             * Build a Task producing an already known value, it completes as soon as it is started.
+             * @param value The value.
+             * @return The Task.
+             */
+            OWEBPP_COROUTINE_BEGIN
+            static Task fromValue(T value) {
+                co_return value;
+            }
+            OWEBPP_COROUTINE_END
+
+            /* Getters and Setters */
+            /**
+             * Tell if the coroutine is over.
+             * @return true if the coroutine is over, false otherwise.
+             */
+            bool isDone() const { return m_handle.done(); }
+
+        private:
+            /* Functions */
+            /**
+             * Get the result of a finished coroutine.
+             * @param handle The coroutine.
+             * @return The produced value.
+             * @throw Any exception thrown by the coroutine.
+             */
+            static T takeResult(std::coroutine_handle<promise_type> handle) {
+                if(handle.promise().m_exception) {
+                    std::rethrow_exception(std::exchange(handle.promise().m_exception, nullptr));
+                }
+                return std::move(*handle.promise().m_value);
+            }
+
+            /* Members */
+            /** The coroutine producing the value. */
+            std::coroutine_handle<promise_type> m_handle;
+    };
+
+    /** Tells if a type is an owebpp::Task. */
+    template<class T>
+    struct IsTask : std::false_type {};
+
+    /** Tells if a type is an owebpp::Task. */
+    template<class T>
+    struct IsTask<Task<T>> : std::true_type {};
+}
+
+#endif // OWEBPP_TASK_HPP
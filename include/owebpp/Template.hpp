@@ -0,0 +1,165 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_TEMPLATE_HPP
+#define OWEBPP_TEMPLATE_HPP
+
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace owebpp {
+    /** Provides the functions used by the templates generated by owebpp-console generate:templates to write values into a response buffer. */
+    class TemplateUtils final {
+        public:
+            /* Deleted constructors */
+            TemplateUtils() = delete;
+            TemplateUtils(const TemplateUtils& o) = delete;
+            TemplateUtils(TemplateUtils&& o) = delete;
+
+            /* Deleted assignment operators */
+            TemplateUtils& operator=(const TemplateUtils& o) = delete;
+            TemplateUtils& operator=(TemplateUtils&& o) = delete;
+
+            /* Deleted destructor */
+            ~TemplateUtils() = delete;
+
+            /* Functions */
+            /**
+             * Append a value to the output, HTML special characters of text values are escaped.
+             * @param out The output buffer.
+             * @param value The value to append.
+             */
+            template<class Tvalue>
+            static void appendEscaped(std::string& out, const Tvalue& value) {
+                if constexpr (std::is_convertible_v<const Tvalue&, std::string_view>) {
+                    std::string_view text(value);
+                    size_t start(0);
+                    for(size_t i = 0; i < text.size(); i++) {
+                        std::string_view entity(escapeCharacter(text[i]));
+                        if(!entity.empty()) {
+                            out.append(text.data() + start, i - start);
+                            out.append(entity);
+                            start = i + 1;
+                        }
+                    }
+                    out.append(text.data() + start, text.size() - start);
+                } else {
+                    appendRaw(out, value);
+                }
+            }
+
+            /**
+             * Append a value to the output without escaping it.
+             * @param out The output buffer.
+             * @param value The value to append.
+             */
+            template<class Tvalue>
+            static void appendRaw(std::string& out, const Tvalue& value) {
+                if constexpr (std::is_convertible_v<const Tvalue&, std::string_view>) {
+                    out.append(std::string_view(value));
+                } else if constexpr (std::is_same_v<Tvalue, bool>) {
+                    out.append(value ? "true" : "false");
+                } else if constexpr (std::is_same_v<Tvalue, char>) {
+                    out.push_back(value);
+                } else if constexpr (std::is_arithmetic_v<Tvalue>) {
+                    char buffer[NUMBER_SIZE];
+                    auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                    if(error == std::errc()) {
+                        out.append(buffer, end);
+                    }
+                } else {
+                    static_assert(std::is_arithmetic_v<Tvalue>, "Template values must be text or arithmetic values.");
+                }
+            }
+
+            /**
+             * Estimate the number of bytes a value takes once written, used to reserve the output buffer once.
+             * @param value The value.
+             * @return The estimated size of the value.
+             */
+            template<class Tvalue>
+            static size_t estimateSize(const Tvalue& value) {
+                if constexpr (std::is_convertible_v<const Tvalue&, std::string_view>) {
+                    return std::string_view(value).size();
+                } else if constexpr (std::is_arithmetic_v<Tvalue>) {
+                    return NUMBER_SIZE;
+                } else {
+                    return 0;
+                }
+            }
+
+            /**
+             * Evaluate a template condition.
+             * @param value The value to evaluate.
+             * @return false for false booleans, zero numbers, null pointers and empty containers, true otherwise.
+             */
+            template<class Tvalue>
+            static bool isTrue(const Tvalue& value) {
+                if constexpr (requires { value.empty(); }) {
+                    return !value.empty();
+                } else {
+                    return static_cast<bool>(value);
+                }
+            }
+
+        private:
+            /* Constants */
+            /** The maximum size of a number once written. */
+            static constexpr size_t NUMBER_SIZE = 32;
+
+            /* Functions */
+            /**
+             * Get the HTML entity replacing a character.
+             * @param c The character to escape.
+             * @return The entity or an empty string if the character doesn't need to be escaped.
+             */
+            static constexpr std::string_view escapeCharacter(char c) {
+                std::string_view entity;
+                switch(c) {
+                    case '&':
+                        entity = "&amp;";
+                        break;
+                    case '<':
+                        entity = "&lt;";
+                        break;
+                    case '>':
+                        entity = "&gt;";
+                        break;
+                    case '"':
+                        entity = "&quot;";
+                        break;
+                    case '\'':
+                        entity = "&#39;";
+                        break;
+                    default:
+                        break;
+                }
+                return entity;
+            }
+    };
+}
+
+#endif // OWEBPP_TEMPLATE_HPP
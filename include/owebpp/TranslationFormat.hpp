@@ -0,0 +1,287 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_TRANSLATION_FORMAT_HPP
+#define OWEBPP_TRANSLATION_FORMAT_HPP
+
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace owebpp {
+    /** Lists the types of the arguments of a translation format. */
+    enum class TranslationArgumentType {
+        /** An integer, e.g %d, %u, %x or %c. */
+        INTEGER,
+        /** A floating point, e.g %f, %e or %g. */
+        FLOATING_POINT,
+        /** A string, %s. */
+        STRING,
+        /** A pointer, %p. */
+        POINTER
+    };
+
+    /**
+     * A translation parsed once into its literal runs and its printf conversions, so it is rendered without being scanned again.
+     * The arguments are checked against the types of the conversions and converted to them, e.g %d accepts any integer and %f any floating point,
+     * the length modifiers of the translation are ignored. The * width and precision and %n aren't supported.
+     */
+    class TranslationFormat {
+        public:
+            /* Constructors */
+            /**
+             * Parse a translation.
+             * @param text The translation.
+             */
+            explicit TranslationFormat(std::string_view text):
+                m_literals(),
+                m_segments(),
+                m_types(),
+                m_tail_offset(0),
+                m_error() {
+                parse(text);
+            }
+
+            /* Functions */
+            /**
+             * Tell if the translation is a valid format.
+             * @return true if it is valid, false otherwise.
+             */
+            bool isValid() const { return m_error.empty(); }
+
+            /**
+             * Tell if arguments of the given types can be rendered by the format.
+             * @return true if the number and the types of the arguments match the conversions, false otherwise.
+             */
+            template<class... Targs>
+            bool matches() const {
+                static constexpr TranslationArgumentType ARGUMENT_TYPES[] = {getArgumentType<Targs>()..., TranslationArgumentType::INTEGER};
+                bool is_matching(isValid() && m_types.size() == sizeof...(Targs));
+                for(size_t i = 0; is_matching && i < m_types.size(); i++) {
+                    /* A %p also prints the address of a string. */
+                    is_matching = m_types[i] == ARGUMENT_TYPES[i]
+                        || (m_types[i] == TranslationArgumentType::POINTER && ARGUMENT_TYPES[i] == TranslationArgumentType::STRING);
+                }
+                return is_matching;
+            }
+
+            /**
+             * Append the translation rendered with the given arguments.
+             * @param out The output buffer, nothing is appended if the arguments don't match.
+             * @param args The arguments replacing the conversions.
+             * @return true if the translation was rendered, false if the arguments don't match the conversions.
+             */
+            template<class... Targs>
+            bool render(std::string& out, const Targs&... args) const {
+                bool is_matching(matches<Targs...>());
+                if(is_matching) {
+                    [[maybe_unused]] size_t index(0);
+                    (renderSegment(out, m_segments[index++], args), ...);
+                    out.append(std::string_view(m_literals).substr(m_tail_offset));
+                }
+                return is_matching;
+            }
+
+            /**
+             * Get the type of the conversions accepting arguments of a type.
+             * @return The type of the conversions.
+             */
+            template<class Targ>
+            static constexpr TranslationArgumentType getArgumentType() {
+                using Tvalue = std::remove_cvref_t<Targ>;
+                TranslationArgumentType type(TranslationArgumentType::POINTER);
+                if constexpr(std::is_floating_point_v<Tvalue>) {
+                    type = TranslationArgumentType::FLOATING_POINT;
+                } else if constexpr(std::is_integral_v<Tvalue> || std::is_enum_v<Tvalue>) {
+                    type = TranslationArgumentType::INTEGER;
+                } else if constexpr(std::is_same_v<Tvalue, std::string> || std::is_same_v<Tvalue, std::string_view>
+                                    || std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<Tvalue>>>, char>) {
+                    type = TranslationArgumentType::STRING;
+                }
+                return type;
+            }
+
+
+            /* Getters and Setters */
+            /**
+             * Getter for the types of the arguments.
+             * @return The type of each argument.
+             */
+            const std::vector<TranslationArgumentType>& getTypes() const { return m_types; }
+
+            /**
+             * Getter for the reason the translation isn't a valid format.
+             * @return The reason, empty if the format is valid.
+             */
+            const std::string& getError() const { return m_error; }
+
+        private:
+            /* Types */
+            /** A literal run followed by a conversion. */
+            struct Segment {
+                /** The offset of the literal run in the literals. */
+                size_t literal_offset{0};
+
+                /** The size of the literal run. */
+                size_t literal_size{0};
+
+                /** The conversion, with the length modifier matching the converted argument. */
+                std::string conversion{};
+
+                /** The type of the argument. */
+                TranslationArgumentType type{TranslationArgumentType::INTEGER};
+            };
+
+            /* Functions */
+            /**
+             * Parse a translation, m_error is set if it isn't a valid format.
+             * @param text The translation.
+             */
+            void parse(std::string_view text) {
+                size_t literal_offset(0);
+                size_t i(0);
+                while(i < text.size() && m_error.empty()) {
+                    if(text[i] != '%') {
+                        m_literals.push_back(text[i++]);
+                    } else if(i + 1 < text.size() && text[i + 1] == '%') {
+                        m_literals.push_back('%');
+                        i += 2;
+                    } else {
+                        size_t start(i++);
+                        std::string conversion("%");
+                        while(i < text.size() && std::string_view("-+ #0").find(text[i]) != std::string_view::npos) {
+                            conversion.push_back(text[i++]);
+                        }
+                        while(i < text.size() && ((text[i] >= '0' && text[i] <= '9') || text[i] == '.')) {
+                            conversion.push_back(text[i++]);
+                        }
+                        while(i < text.size() && std::string_view("hlLqjzt").find(text[i]) != std::string_view::npos) {
+                            i++;
+                        }
+                        char specifier(i < text.size() ? text[i++] : '\0');
+                        TranslationArgumentType type(TranslationArgumentType::INTEGER);
+                        if(std::string_view("diuoxX").find(specifier) != std::string_view::npos) {
+                            conversion.append("ll");
+                        } else if(std::string_view("fFeEgGaA").find(specifier) != std::string_view::npos) {
+                            type = TranslationArgumentType::FLOATING_POINT;
+                        } else if(specifier == 's') {
+                            type = TranslationArgumentType::STRING;
+                        } else if(specifier == 'p') {
+                            type = TranslationArgumentType::POINTER;
+                        } else if(specifier != 'c') {
+                            m_error = "unsupported conversion " + std::string(text.substr(start, i - start)) + " at offset " + std::to_string(start);
+                        }
+                        conversion.push_back(specifier);
+                        m_segments.push_back({literal_offset, m_literals.size() - literal_offset, conversion, type});
+                        m_types.push_back(type);
+                        literal_offset = m_literals.size();
+                    }
+                }
+                m_tail_offset = literal_offset;
+            }
+
+            /**
+             * Append a segment rendered with its argument.
+             * @param out The output buffer.
+             * @param segment The segment.
+             * @param arg The argument.
+             */
+            template<class Targ>
+            void renderSegment(std::string& out, const Segment& segment, const Targ& arg) const {
+                using Tvalue = std::remove_cvref_t<Targ>;
+                out.append(m_literals, segment.literal_offset, segment.literal_size);
+                if constexpr(std::is_same_v<Tvalue, std::string> || std::is_same_v<Tvalue, std::string_view>) {
+                    if(segment.conversion == "%s") {
+                        out.append(arg);
+                    } else if(segment.type == TranslationArgumentType::POINTER) {
+                        renderConversion(out, segment.conversion, static_cast<const void*>(arg.data()));
+                    } else {
+                        renderConversion(out, segment.conversion, std::string(arg).c_str());
+                    }
+                } else if constexpr(getArgumentType<Targ>() == TranslationArgumentType::STRING) {
+                    if(segment.conversion == "%s") {
+                        out.append(arg);
+                    } else {
+                        renderConversion(out, segment.conversion, static_cast<const char*>(arg));
+                    }
+                } else if constexpr(getArgumentType<Targ>() == TranslationArgumentType::POINTER) {
+                    renderConversion(out, segment.conversion, static_cast<const void*>(arg));
+                } else if constexpr(getArgumentType<Targ>() == TranslationArgumentType::FLOATING_POINT) {
+                    renderConversion(out, segment.conversion, static_cast<double>(arg));
+                } else if(segment.conversion.back() == 'c') {
+                    renderConversion(out, segment.conversion, static_cast<int>(arg));
+                } else if(segment.conversion == "%lld" || segment.conversion == "%lli") {
+                    char buffer[24];
+                    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), static_cast<long long>(arg)).ptr);
+                } else if(segment.conversion == "%llu") {
+                    char buffer[24];
+                    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), static_cast<unsigned long long>(arg)).ptr);
+                } else if(segment.conversion.back() == 'd' || segment.conversion.back() == 'i') {
+                    renderConversion(out, segment.conversion, static_cast<long long>(arg));
+                } else {
+                    renderConversion(out, segment.conversion, static_cast<unsigned long long>(arg));
+                }
+            }
+
+            /**
+             * Append a value formatted by a printf conversion, through a buffer on the stack unless it is too long.
+             * @param out The output buffer.
+             * @param conversion The conversion.
+             * @param value The value.
+             */
+            template<class Tvalue>
+            static void renderConversion(std::string& out, const std::string& conversion, Tvalue value) {
+                char buffer[128];
+                int size(std::snprintf(buffer, sizeof(buffer), conversion.c_str(), value));
+                if(size > 0 && static_cast<size_t>(size) < sizeof(buffer)) {
+                    out.append(buffer, static_cast<size_t>(size));
+                } else if(size > 0) {
+                    size_t offset(out.size());
+                    out.resize(offset + static_cast<size_t>(size) + 1);
+                    std::snprintf(out.data() + offset, static_cast<size_t>(size) + 1, conversion.c_str(), value);
+                    out.resize(offset + static_cast<size_t>(size));
+                }
+            }
+
+            /* Members */
+            /** The literal runs, with the %% unescaped. */
+            std::string m_literals;
+
+            /** The literal runs and the conversions following them. */
+            std::vector<Segment> m_segments;
+
+            /** The type of each argument. */
+            std::vector<TranslationArgumentType> m_types;
+
+            /** The offset of the literal run following the last conversion. */
+            size_t m_tail_offset;
+
+            /** The reason the translation isn't a valid format, empty if it is. */
+            std::string m_error;
+    };
+}
+
+#endif // OWEBPP_TRANSLATION_FORMAT_HPP
@@ -24,11 +24,18 @@
 #ifndef OWEBPP_TRANSLATOR_HPP
 #define OWEBPP_TRANSLATOR_HPP
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <type_traits>
 
+#include <owebpp/Logger.hpp>
+#include <owebpp/Snapshot.hpp>
+#include <owebpp/TranslationFormat.hpp>
+
 /** This macro needs to be called at the beginning of the program using the framework. */
-#define OWEBPP_STATIC_INIT_TRANSLATOR std::shared_ptr<owebpp::Translator> owebpp::Translator::s_translator = nullptr;
+#define OWEBPP_STATIC_INIT_TRANSLATOR constinit owebpp::Snapshot<owebpp::Translator> owebpp::Translator::s_translator;
 
 namespace owebpp {
     /** This class is used to perform text translation. */
@@ -51,11 +58,12 @@ namespace owebpp {
 
             /* Functions */
             /**
-             * Set the translator to use.
+             * Set the translator to use, this function can be called while other threads translate.
+             * The replaced translator is kept until the end of the program, since handlers may still hold it.
              * @param translator The translator to use.
              */
             static void setTranslator(std::shared_ptr<Translator> translator) {
-                s_translator = translator;
+                s_translator.storeAndRetain(std::move(translator));
             }
 
             /**
@@ -75,78 +83,63 @@ namespace owebpp {
             }
 
             /**
-             * Call getTranslatedText function to translate key and do parameter replacement.
-             * Thanks to concepts we can make some compile time checking to make sure we can perform replacements in the translated string.
+             * Translate a key and replace the printf conversions of its translation by the given parameters.
+             * The translation is parsed once by getTranslationFormat(), the types of the parameters are checked against its conversions.
              * @param key The key to translate.
              * @param args The parameters that must be replaced in the key translation.
-             * @return getTranslatedText() result with parameter replacement.
-             * @todo If possible add more checks between the format parameters and args checking the type.
+             * @return The translation with parameter replacement, or the key if the parameters don't match the conversions.
              */
-            template<class... Tparams> requires((std::is_integral_v<Tparams> || std::is_floating_point_v<Tparams> || std::is_pointer_v<Tparams>) && ...)
-            std::string translate(const std::string& key, Tparams... args) {
-                std::string result(key);
-                const std::string& format = getTranslatedText(key);
-                size_t param_format_count = parameterCount(format);
-                size_t arg_count = sizeof...(Tparams);
-
-                if( param_format_count == sizeof...(args)) {
-                    int size_s = std::snprintf( nullptr, 0, format.c_str(), args... ) + 1; // Extra space for '\0'
-                    if( size_s <= 0 ) {
-                        OWEBPP_LOG_WARNING("Error translating text. Simply returning key.");
-                    } else {
-                        size_t size = static_cast<size_t>( size_s );
-                        std::unique_ptr<char[]> buf( new char[ size ] );
-                        std::snprintf( buf.get(), size, format.c_str(), args ... );
-                        result.assign( buf.get(), buf.get() + size - 1 ); // We don't want the '\0' inside
-                    }
-                } else {
-                    OWEBPP_LOG_WARNING("Mismatch number of arguments " + std::to_string(arg_count) +
-                                       " provided but " + std::to_string(param_format_count) + " expected. Simply returning key.");
-                }
+            template<class... Tparams> requires((std::is_arithmetic_v<Tparams> || std::is_pointer_v<std::decay_t<Tparams>>
+                                                 || std::is_same_v<Tparams, std::string> || std::is_same_v<Tparams, std::string_view>) && ...)
+            std::string translate(const std::string& key, const Tparams&... args) {
+                std::string result;
+                translateTo(result, key, args...);
                 return result;
             }
 
-            /* Singleton call method */
             /**
-             * Get the translator instance.
-             * @return The translator instance.
+             * Translate a key and append its translation with parameter replacement to a buffer, e.g the body of a response.
+             * @param out The output buffer.
+             * @param key The key to translate.
+             * @param args The parameters that must be replaced in the key translation.
              */
-            static Translator& getInstance() {
-                if(s_translator==nullptr) {
-                    s_translator = std::make_shared<Translator>();
+            template<class... Tparams> requires((std::is_arithmetic_v<Tparams> || std::is_pointer_v<std::decay_t<Tparams>>
+                                                 || std::is_same_v<Tparams, std::string> || std::is_same_v<Tparams, std::string_view>) && ...)
+            void translateTo(std::string& out, const std::string& key, const Tparams&... args) {
+                std::shared_ptr<const TranslationFormat> format(getTranslationFormat(key));
+                if(!format->isValid()) {
+                    OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Translation of key " + key + " has an " + format->getError() + ". Simply returning key.");
+                    out.append(key);
+                } else if(!format->render(out, args...)) {
+                    OWEBPP_LOG_WARNING_LIMITED(10, std::chrono::seconds(10), "Mismatch number or types of arguments " + std::to_string(sizeof...(Tparams)) +
+                                               " provided but " + std::to_string(format->getTypes().size()) + " expected. Simply returning key.");
+                    out.append(key);
                 }
-                return *s_translator;
             }
 
-        private:
-            /* Functions */
             /**
-             * Determine the number of arguments expected by the format following printf synthax.
-             * @param format The format for which to count the number of expected arguments.
-             * @return The number of expected arguments by format.
+             * Get the parsed translation of a key, parsed from getTranslatedText() on each call so that a changed translation is never missed.
+             * Translators which keep their translations parsed override it.
+             * @param key The key.
+             * @return The parsed translation.
              */
-            static size_t parameterCount(const std::string& format) {
-                size_t param_count(0);
-                size_t format_length = format.size();
-                for(size_t i = 0; i < format_length; i++) {
-                    if(format[i] == '%') {
-                        size_t index_check(i+1);
-                        // We are at the end so donc do any checks if index_check == format_length.
-                        if(index_check < format_length) {
-                            if(format[i+1] == '%') {
-                                i++;
-                            } else {
-                                param_count+= 1;
-                                i++;
-                            }
-                        }
-                    }
-                }
-                return param_count;
+            virtual std::shared_ptr<const TranslationFormat> getTranslationFormat(const std::string& key) {
+                return std::make_shared<const TranslationFormat>(getTranslatedText(key));
+            }
+
+            /* Singleton call method */
+            /**
+             * Get the translator instance, the one a thread last got is read without locking while the translator isn't replaced.
+             * @return The translator instance, it stays valid after being replaced by setTranslator().
+             */
+            static Translator& getInstance() {
+                return *s_translator.loadOrCreate([]() { return std::make_shared<Translator>(); });
             }
 
+        private:
+            /* Members */
             /** Singleton object */
-            static std::shared_ptr<Translator> s_translator;
+            static Snapshot<Translator> s_translator;
     };
 }
 
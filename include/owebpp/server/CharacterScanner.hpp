@@ -0,0 +1,200 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_CHARACTER_SCANNER_HPP
+#define OWEBPP_SERVER_CHARACTER_SCANNER_HPP
+
+#include <cstddef>
+#include <cstring>
+
+#if !defined(DISABLE_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define OWEBPP_HAS_X86_SIMD 1
+    #include <immintrin.h>
+#endif
+
+namespace owebpp::server {
+    /** Lists the instruction sets the scanner can use, the best one supported by the CPU is picked at runtime. */
+    enum class InstructionSet {
+        SCALAR,
+        SSE4_2,
+        AVX2
+    };
+
+    /**
+     * Finds the delimiters of HTTP messages with SIMD instructions when the CPU supports them.
+     * The SIMD functions are compiled for their instruction set only, so the library doesn't need to be built for a specific CPU.
+     */
+    class CharacterScanner final {
+        public:
+            /* Deleted constructors */
+            CharacterScanner() = delete;
+            CharacterScanner(const CharacterScanner& o) = delete;
+            CharacterScanner(CharacterScanner&& o) = delete;
+
+            /* Deleted assignment operators */
+            CharacterScanner& operator=(const CharacterScanner& o) = delete;
+            CharacterScanner& operator=(CharacterScanner&& o) = delete;
+
+            /* Deleted destructor */
+            ~CharacterScanner() = delete;
+
+            /* Functions */
+            /**
+             * Find the first control character, i.e a byte lower than 0x20 other than a tab, or DEL.
+             * The line ends of a request head are the only control characters it may contain, so this finds the next line end and validates the line at once.
+             * @param data The data to scan.
+             * @param size The size of the data.
+             * @return The index of the first control character, size if there is none.
+             */
+            static size_t findControl(const char* data, size_t size) {
+#ifdef OWEBPP_HAS_X86_SIMD
+                switch(getInstructionSet()) {
+                    case InstructionSet::AVX2:
+                        return findControlAvx2(data, size);
+                    case InstructionSet::SSE4_2:
+                        return findControlSse42(data, size);
+                    case InstructionSet::SCALAR:
+                    default:
+                        break;
+                }
+#endif
+                return findControlScalar(data, size, 0);
+            }
+
+            /**
+             * Find the first occurrence of a byte, glibc already implements memchr with SIMD instructions.
+             * @param data The data to scan.
+             * @param size The size of the data.
+             * @param c The byte to find.
+             * @return The index of the first occurrence, size if there is none.
+             */
+            static size_t findByte(const char* data, size_t size, char c) {
+                const void* found(std::memchr(data, c, size));
+                return found == nullptr ? size : static_cast<size_t>(static_cast<const char*>(found) - data);
+            }
+
+            /**
+             * Get the instruction set used by the scanner.
+             * @return The best instruction set supported by the CPU.
+             */
+            static InstructionSet getInstructionSet() {
+                static const InstructionSet s_instruction_set(detectInstructionSet());
+                return s_instruction_set;
+            }
+
+        private:
+            /* Functions */
+            /**
+             * Detect the best instruction set supported by the CPU.
+             * @return The instruction set.
+             */
+            static InstructionSet detectInstructionSet() {
+                InstructionSet instruction_set(InstructionSet::SCALAR);
+#ifdef OWEBPP_HAS_X86_SIMD
+                __builtin_cpu_init();
+                if(__builtin_cpu_supports("avx2")) {
+                    instruction_set = InstructionSet::AVX2;
+                } else if(__builtin_cpu_supports("sse4.2")) {
+                    instruction_set = InstructionSet::SSE4_2;
+                }
+#endif
+                return instruction_set;
+            }
+
+            /**
+             * Tell if a byte is a control character.
+             * @param c The byte.
+             * @return true if the byte is a control character other than a tab or DEL, false otherwise.
+             */
+            static bool isControl(char c) {
+                unsigned char byte(static_cast<unsigned char>(c));
+                return (byte < 0x20 && byte != '\t') || byte == 0x7f;
+            }
+
+            /**
+             * Find the first control character one byte at a time.
+             * @param data The data to scan.
+             * @param size The size of the data.
+             * @param start The index to start from.
+             * @return The index of the first control character, size if there is none.
+             */
+            static size_t findControlScalar(const char* data, size_t size, size_t start) {
+                size_t i(start);
+                while(i < size && !isControl(data[i])) {
+                    i++;
+                }
+                return i;
+            }
+
+#ifdef OWEBPP_HAS_X86_SIMD
+            /**
+             * Find the first control character 16 bytes at a time with the SSE4.2 range comparison.
+             * @param data The data to scan.
+             * @param size The size of the data.
+             * @return The index of the first control character, size if there is none.
+             */
+            __attribute__((target("sse4.2")))
+            static size_t findControlSse42(const char* data, size_t size) {
+                /* The ranges [0x00, 0x08], [0x0a, 0x1f] and [0x7f, 0x7f], a tab is allowed. */
+                const __m128i ranges(_mm_setr_epi8(0x00, 0x08, 0x0a, 0x1f, 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+                size_t i(0);
+                for(; i + 16 <= size; i += 16) {
+                    __m128i chunk(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+                    int index(_mm_cmpestri(ranges, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT));
+                    if(index != 16) {
+                        return i + static_cast<size_t>(index);
+                    }
+                }
+                return findControlScalar(data, size, i);
+            }
+
+            /**
+             * Find the first control character 32 bytes at a time with AVX2.
+             * @param data The data to scan.
+             * @param size The size of the data.
+             * @return The index of the first control character, size if there is none.
+             */
+            __attribute__((target("avx2")))
+            static size_t findControlAvx2(const char* data, size_t size) {
+                const __m256i max_control(_mm256_set1_epi8(0x1f));
+                const __m256i tab(_mm256_set1_epi8('\t'));
+                const __m256i del(_mm256_set1_epi8(0x7f));
+                size_t i(0);
+                for(; i + 32 <= size; i += 32) {
+                    __m256i chunk(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+                    /* An unsigned byte is at most 0x1f when the minimum with 0x1f is itself. */
+                    __m256i controls(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, max_control), chunk));
+                    controls = _mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, tab), controls);
+                    controls = _mm256_or_si256(controls, _mm256_cmpeq_epi8(chunk, del));
+                    unsigned int mask(static_cast<unsigned int>(_mm256_movemask_epi8(controls)));
+                    if(mask != 0) {
+                        return i + static_cast<size_t>(__builtin_ctz(mask));
+                    }
+                }
+                return findControlScalar(data, size, i);
+            }
+#endif
+    };
+}
+
+#endif // OWEBPP_SERVER_CHARACTER_SCANNER_HPP
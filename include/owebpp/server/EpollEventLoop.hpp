@@ -0,0 +1,565 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_EPOLL_EVENT_LOOP_HPP
+#define OWEBPP_SERVER_EPOLL_EVENT_LOOP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <owebpp/ConcurrencyLimiter.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/server/EventLoop.hpp>
+#include <owebpp/server/HttpConnection.hpp>
+#include <owebpp/server/ServerConfig.hpp>
+
+namespace owebpp::server {
+    /**
+     * An event loop serving HTTP connections with epoll.
+     * Each loop owns its listening socket (SO_REUSEPORT) so the kernel balances the connections between the loops and no state is shared between threads.
+     * The responses queued on a connection are gathered into a single sendmsg, and are held back for the cork window while the client is sending its next pipelined request.
+     * The coroutines of the asynchronous routes wait for file descriptors with one-shot registrations in the same epoll instance, file reads are done in place as epoll doesn't support regular files.
+     */
+    class EpollEventLoop final : public EventLoop {
+        public:
+            /* Constructors */
+            /**
+             * Construct the event loop, create its listening socket and its epoll instance.
+             * @param config The server configuration.
+             * @throw std::system_error If a socket or the epoll instance can't be created.
+             */
+            explicit EpollEventLoop(const ServerConfig& config):
+                EventLoop(),
+                m_config(config),
+                m_listen_fd(-1),
+                m_epoll_fd(-1),
+                m_wakeup_fd(-1),
+                m_connections(),
+                m_corked_connections(),
+                m_completed_connections(),
+                m_waiters(),
+                m_running(true),
+                m_has_epoll_pwait2(true),
+                m_receive_buffer() {
+                try {
+                    m_listen_fd = createListeningSocket(config);
+                    m_epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+                    if(m_epoll_fd < 0) {
+                        throw std::system_error(errno, std::generic_category(), "epoll_create1");
+                    }
+                    m_wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                    if(m_wakeup_fd < 0) {
+                        throw std::system_error(errno, std::generic_category(), "eventfd");
+                    }
+                    control(EPOLL_CTL_ADD, m_listen_fd, EPOLLIN);
+                    control(EPOLL_CTL_ADD, m_wakeup_fd, EPOLLIN);
+                } catch(...) {
+                    closeDescriptors();
+                    throw;
+                }
+            }
+
+            /* Deleted constructors */
+            EpollEventLoop() = delete;
+            EpollEventLoop(const EpollEventLoop& o) = delete;
+            EpollEventLoop(EpollEventLoop&& o) = delete;
+
+            /* Deleted assignment operators */
+            EpollEventLoop& operator=(const EpollEventLoop& o) = delete;
+            EpollEventLoop& operator=(EpollEventLoop&& o) = delete;
+
+            /* Destructor */
+            ~EpollEventLoop() override {
+                ConcurrencyLimiter::cancelWaiters(*this);
+                waitForExpectedPosts();
+                for(const auto& [fd, connection] : m_connections) {
+                    ::close(fd);
+                }
+                closeDescriptors();
+            }
+
+            /* Functions */
+            /**
+             * Run the loop on the calling thread until stop() is called, a stopped loop can't be run again.
+             */
+            void run() override {
+                AsyncContext::setCurrent(this);
+                epoll_event events[MAX_EVENTS];
+                std::chrono::steady_clock::time_point next_sweep(std::chrono::steady_clock::now() + SWEEP_INTERVAL);
+                std::chrono::steady_clock::time_point next_uncork(std::chrono::steady_clock::time_point::max());
+                std::chrono::steady_clock::time_point next_operation(std::chrono::steady_clock::time_point::max());
+                while(m_running.load(std::memory_order_acquire)) {
+                    int count = wait(events, std::min({next_sweep, next_uncork, next_operation}));
+                    if(count < 0 && errno != EINTR) {
+                        OWEBPP_LOG_ERROR(std::string("epoll_wait failed: ") + std::system_category().message(errno));
+                        break;
+                    }
+                    for(int i = 0; i < count; i++) {
+                        int fd = events[i].data.fd;
+                        if(fd == m_listen_fd) {
+                            acceptConnections();
+                        } else if(fd == m_wakeup_fd) {
+                            uint64_t value;
+                            [[maybe_unused]] ssize_t ignored = ::read(m_wakeup_fd, &value, sizeof(value));
+                        } else if(!resumeWaiter(fd, events[i].events)) {
+                            handleEvent(fd, events[i].events);
+                        }
+                    }
+                    next_operation = runOperations();
+                    flushCompletedConnections();
+                    std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                    next_uncork = uncorkConnections(now);
+                    if(now >= next_sweep) {
+                        closeIdleConnections(now);
+                        next_sweep = now + SWEEP_INTERVAL;
+                    }
+                }
+                AsyncContext::setCurrent(nullptr);
+            }
+
+            /**
+             * Ask the loop to stop, this function can be called from any thread.
+             */
+            void stop() override {
+                m_running.store(false, std::memory_order_release);
+                wakeUp();
+            }
+
+            /**
+             * Wait for events on a file descriptor with a one-shot registration, the file descriptor must not be waited for by another operation.
+             * @param fd The file descriptor.
+             * @param events The poll events to wait for.
+             * @param operation The operation, its result is the received events or -errno.
+             */
+            void waitFor(int fd, short events, AsyncOperation& operation) override {
+                epoll_event event{};
+                event.events = static_cast<uint32_t>(static_cast<unsigned short>(events)) | EPOLLONESHOT;
+                event.data.fd = fd;
+                if(::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0 && (errno != EEXIST || ::epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0)) {
+                    complete(operation, -errno);
+                } else {
+                    m_waiters[fd] = &operation;
+                }
+            }
+
+            /**
+             * Read from a file, the read is done in place and completed on the next loop iteration.
+             * @param fd The file descriptor.
+             * @param buffer The buffer receiving the data.
+             * @param size The size of the buffer.
+             * @param offset The offset to read at.
+             * @param operation The operation, its result is the number of bytes read or -errno.
+             */
+            void read(int fd, void* buffer, size_t size, off_t offset, AsyncOperation& operation) override {
+                ssize_t result = ::pread(fd, buffer, size, offset);
+                complete(operation, result < 0 ? -errno : result);
+            }
+
+        protected:
+            /* Functions */
+            /** Wake the loop up by writing to its eventfd, this function can be called from any thread. */
+            void wakeUp() override {
+                uint64_t value(1);
+                [[maybe_unused]] ssize_t ignored = ::write(m_wakeup_fd, &value, sizeof(value));
+            }
+
+        private:
+            /* Types */
+            /** The state of a client connection. */
+            struct Connection {
+                /**
+                 * Construct the state of a new client connection.
+                 * @param config The server configuration.
+                 */
+                explicit Connection(const ServerConfig& config):
+                    http(config),
+                    last_activity(std::chrono::steady_clock::now()),
+                    cork_deadline(std::chrono::steady_clock::time_point::max()),
+                    is_writing(false),
+                    is_reading(true),
+                    is_read_closed(false) {}
+
+                /** The HTTP state of the connection. */
+                HttpConnection http;
+
+                /** The last time data was received or sent. */
+                std::chrono::steady_clock::time_point last_activity;
+
+                /** The time the held back output must be sent at, the maximum time point if the output isn't held back. */
+                std::chrono::steady_clock::time_point cork_deadline;
+
+                /** Whether the connection is registered for EPOLLOUT. */
+                bool is_writing;
+
+                /** Whether the connection is registered for EPOLLIN. */
+                bool is_reading;
+
+                /** Whether the client closed its side of the connection, the connection is closed once the pending output is sent. */
+                bool is_read_closed;
+            };
+
+            /* Constants */
+            /** The maximum number of events handled per epoll_wait call. */
+            static constexpr int MAX_EVENTS = 256;
+
+            /** The size of the buffer receiving client data. */
+            static constexpr size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+
+            /** The maximum number of output segments gathered by a sendmsg call. */
+            static constexpr size_t MAX_IOVECS = 64;
+
+            /** The interval between two idle connection sweeps. */
+            static constexpr std::chrono::milliseconds SWEEP_INTERVAL{1000};
+
+            /* Functions */
+            /**
+             * Wait for events until a deadline, with a microsecond resolution when the kernel supports epoll_pwait2.
+             * @param events The array receiving the events.
+             * @param deadline The time to stop waiting at.
+             * @return The number of events, -1 on error.
+             */
+            int wait(epoll_event* events, std::chrono::steady_clock::time_point deadline) {
+                std::chrono::nanoseconds timeout(std::max(std::chrono::nanoseconds(0), deadline - std::chrono::steady_clock::now()));
+                int count(-1);
+                if(m_has_epoll_pwait2) {
+                    timespec timeout_spec{};
+                    timeout_spec.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+                    timeout_spec.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+                    count = ::epoll_pwait2(m_epoll_fd, events, MAX_EVENTS, &timeout_spec, nullptr);
+                    m_has_epoll_pwait2 = count >= 0 || errno != ENOSYS;
+                }
+                if(!m_has_epoll_pwait2) {
+                    count = ::epoll_wait(m_epoll_fd, events, MAX_EVENTS, static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(timeout).count()));
+                }
+                return count;
+            }
+
+            /**
+             * Register, modify or unregister a file descriptor in the epoll instance.
+             * @param operation The epoll_ctl operation.
+             * @param fd The file descriptor.
+             * @param events The events to watch.
+             * @throw std::system_error If epoll_ctl fails.
+             */
+            void control(int operation, int fd, uint32_t events) {
+                epoll_event event{};
+                event.events = events;
+                event.data.fd = fd;
+                if(::epoll_ctl(m_epoll_fd, operation, fd, &event) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+                }
+            }
+
+            /** Accept all the pending connections. */
+            void acceptConnections() {
+                while(true) {
+                    int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if(fd < 0) {
+                        if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                            OWEBPP_LOG_ERROR(std::string("accept4 failed: ") + std::system_category().message(errno));
+                        }
+                        if(errno != EINTR && errno != ECONNABORTED) {
+                            return;
+                        }
+                        continue;
+                    }
+                    int enable(1);
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                    try {
+                        control(EPOLL_CTL_ADD, fd, EPOLLIN | EPOLLRDHUP);
+                    } catch(const std::system_error& e) {
+                        OWEBPP_LOG_ERROR(e.what());
+                        ::close(fd);
+                        continue;
+                    }
+                    m_connections.try_emplace(fd, std::make_unique<Connection>(m_config)).first->second->http.setAsyncResponseCallback([this, fd]() { m_completed_connections.push_back(fd); });
+                }
+            }
+
+            /**
+             * Resume the coroutine waiting for events on a file descriptor, if any.
+             * @param fd The file descriptor.
+             * @param events The epoll events.
+             * @return true if a coroutine was waiting for the file descriptor, false otherwise.
+             */
+            bool resumeWaiter(int fd, uint32_t events) {
+                auto it = m_waiters.find(fd);
+                if(it == m_waiters.end()) {
+                    return false;
+                }
+                AsyncOperation* operation(it->second);
+                m_waiters.erase(it);
+                ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                operation->result = events;
+                operation->handle.resume();
+                return true;
+            }
+
+            /** Send the responses of the asynchronous routes completed during the loop iteration. */
+            void flushCompletedConnections() {
+                /* The list is swapped out since sending may complete other coroutines. */
+                std::vector<int> completed_connections;
+                completed_connections.swap(m_completed_connections);
+                for(int fd : completed_connections) {
+                    auto it = m_connections.find(fd);
+                    if(it != m_connections.end() && !cork(fd, *it->second)) {
+                        flush(fd, *it->second, true);
+                    }
+                }
+            }
+
+            /**
+             * Handle the events of a client connection.
+             * @param fd The client socket.
+             * @param events The epoll events.
+             */
+            void handleEvent(int fd, uint32_t events) {
+                auto it = m_connections.find(fd);
+                if(it == m_connections.end()) {
+                    return;
+                }
+                Connection& connection(*it->second);
+                bool is_open(true);
+                if(events & (EPOLLERR | EPOLLHUP)) {
+                    is_open = false;
+                }
+                if(is_open && (events & (EPOLLIN | EPOLLRDHUP))) {
+                    is_open = receive(fd, connection);
+                }
+                if(!is_open || !cork(fd, connection)) {
+                    flush(fd, connection, is_open);
+                }
+            }
+
+            /**
+             * Hold the output of a connection back while the client is sending its next pipelined request, for at most the cork window.
+             * @param fd The client socket.
+             * @param connection The connection state.
+             * @return true if the output is held back, false if it must be sent now.
+             */
+            bool cork(int fd, Connection& connection) {
+                bool is_corked(false);
+                if(m_config.getCorkWindow().count() > 0 && !connection.is_writing && !connection.is_read_closed && connection.http.hasPendingOutput() && connection.http.isCorkable()) {
+                    std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                    if(connection.cork_deadline == std::chrono::steady_clock::time_point::max()) {
+                        connection.cork_deadline = now + m_config.getCorkWindow();
+                        m_corked_connections.push_back(fd);
+                    }
+                    is_corked = now < connection.cork_deadline;
+                }
+                if(!is_corked) {
+                    connection.cork_deadline = std::chrono::steady_clock::time_point::max();
+                }
+                return is_corked;
+            }
+
+            /**
+             * Send the output held back by the connections whose cork window is over.
+             * @param now The current time.
+             * @return The earliest cork deadline of the connections still held back, the maximum time point if none.
+             */
+            std::chrono::steady_clock::time_point uncorkConnections(std::chrono::steady_clock::time_point now) {
+                std::chrono::steady_clock::time_point next_deadline(std::chrono::steady_clock::time_point::max());
+                size_t kept(0);
+                for(size_t i = 0; i < m_corked_connections.size(); i++) {
+                    int fd = m_corked_connections[i];
+                    auto it = m_connections.find(fd);
+                    /* Connections uncorked or closed meanwhile are only removed from the list here. */
+                    if(it == m_connections.end() || it->second->cork_deadline == std::chrono::steady_clock::time_point::max()) {
+                        continue;
+                    }
+                    if(it->second->cork_deadline <= now) {
+                        it->second->cork_deadline = std::chrono::steady_clock::time_point::max();
+                        flush(fd, *it->second, true);
+                    } else {
+                        next_deadline = std::min(next_deadline, it->second->cork_deadline);
+                        m_corked_connections[kept++] = fd;
+                    }
+                }
+                m_corked_connections.resize(kept);
+                return next_deadline;
+            }
+
+            /**
+             * Send the pending output of a connection, then close it or update its epoll registration.
+             * @param fd The client socket.
+             * @param connection The connection state.
+             * @param is_open false if the connection must be closed.
+             */
+            void flush(int fd, Connection& connection, bool is_open) {
+                if(is_open && connection.http.hasPendingOutput()) {
+                    is_open = send(fd, connection);
+                }
+                if(is_open && (connection.http.isClosing()
+                               || (connection.is_read_closed && !connection.http.hasPendingOutput() && !connection.http.hasPendingTask()))) {
+                    is_open = false;
+                }
+                if(!is_open) {
+                    closeConnection(fd);
+                } else if(connection.is_writing != connection.http.hasPendingOutput() || connection.is_reading == connection.is_read_closed) {
+                    /* A connection closed by the client stops polling for input, which would be reported as long as the socket is open. */
+                    connection.is_writing = connection.http.hasPendingOutput();
+                    connection.is_reading = !connection.is_read_closed;
+                    control(EPOLL_CTL_MOD, fd, (connection.is_reading ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0U)
+                                               | (connection.is_writing ? static_cast<uint32_t>(EPOLLOUT) : 0U));
+                }
+            }
+
+            /**
+             * Read the data available on a client socket.
+             * @param fd The client socket.
+             * @param connection The connection state.
+             * @return false if the connection must be closed, true otherwise.
+             */
+            bool receive(int fd, Connection& connection) {
+                while(true) {
+                    ssize_t received = ::recv(fd, m_receive_buffer, RECEIVE_BUFFER_SIZE, 0);
+                    if(received > 0) {
+                        connection.last_activity = std::chrono::steady_clock::now();
+                        connection.http.onReceived(m_receive_buffer, static_cast<size_t>(received));
+                        if(static_cast<size_t>(received) < RECEIVE_BUFFER_SIZE) {
+                            return true;
+                        }
+                    } else if(received == 0) {
+                        /* The client may only have shut down its side, the responses to its pipelined requests are still sent. */
+                        connection.is_read_closed = true;
+                        connection.http.onPeerClosed();
+                        return true;
+                    } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        return true;
+                    } else if(errno != EINTR) {
+                        return false;
+                    }
+                }
+            }
+
+            /**
+             * Write the pending output of a connection until the socket buffer is full, the queued responses are gathered by each sendmsg call.
+             * @param fd The client socket.
+             * @param connection The connection state.
+             * @return false if the connection must be closed, true otherwise.
+             */
+            bool send(int fd, Connection& connection) {
+                iovec iovecs[MAX_IOVECS];
+                while(connection.http.hasPendingOutput()) {
+                    msghdr message{};
+                    message.msg_iov = iovecs;
+                    message.msg_iovlen = connection.http.getPendingOutput(iovecs, MAX_IOVECS);
+                    ssize_t sent = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+                    if(sent >= 0) {
+                        connection.last_activity = std::chrono::steady_clock::now();
+                        connection.http.onSent(static_cast<size_t>(sent));
+                    } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                        return true;
+                    } else if(errno != EINTR) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * Close a client connection and release its state.
+             * @param fd The client socket.
+             */
+            void closeConnection(int fd) {
+                ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                ::close(fd);
+                m_connections.erase(fd);
+            }
+
+            /**
+             * Close the connections that were inactive for longer than the keep alive timeout.
+             * @param now The current time.
+             */
+            void closeIdleConnections(std::chrono::steady_clock::time_point now) {
+                for(auto it = m_connections.begin(); it != m_connections.end();) {
+                    int fd = it->first;
+                    ++it;
+                    if(!m_connections[fd]->http.hasPendingTask() && now - m_connections[fd]->last_activity > m_config.getKeepAliveTimeout()) {
+                        closeConnection(fd);
+                    }
+                }
+            }
+
+            /** Close the listening socket, the epoll instance and the wakeup descriptor. */
+            void closeDescriptors() {
+                for(int fd : {m_wakeup_fd, m_epoll_fd, m_listen_fd}) {
+                    if(fd >= 0) {
+                        ::close(fd);
+                    }
+                }
+            }
+
+            /* Members */
+            /** The server configuration. */
+            const ServerConfig& m_config;
+
+            /** The listening socket. */
+            int m_listen_fd;
+
+            /** The epoll instance. */
+            int m_epoll_fd;
+
+            /** The eventfd used to wake the loop up when it is stopped or an operation is posted. */
+            int m_wakeup_fd;
+
+            /** The client connections by socket. */
+            std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+
+            /** The sockets of the connections whose output is held back, it may contain connections uncorked or closed since. */
+            std::vector<int> m_corked_connections;
+
+            /** The sockets of the connections whose asynchronous route completed during the loop iteration. */
+            std::vector<int> m_completed_connections;
+
+            /** The operations waiting for events by file descriptor. */
+            std::unordered_map<int, AsyncOperation*> m_waiters;
+
+            /** Whether the loop is running. */
+            std::atomic<bool> m_running;
+
+            /** Whether the kernel supports epoll_pwait2, epoll_wait and its millisecond timeout are used otherwise. */
+            bool m_has_epoll_pwait2;
+
+            /** The buffer receiving client data, shared by all the connections of the loop. */
+            char m_receive_buffer[RECEIVE_BUFFER_SIZE];
+    };
+}
+
+#endif // OWEBPP_SERVER_EPOLL_EVENT_LOOP_HPP
@@ -0,0 +1,225 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_EVENT_LOOP_HPP
+#define OWEBPP_SERVER_EVENT_LOOP_HPP
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <queue>
+#include <string>
+#include <sys/socket.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include <owebpp/AsyncContext.hpp>
+#include <owebpp/server/ServerConfig.hpp>
+
+namespace owebpp::server {
+    /**
+     * The interface of the event loops serving HTTP connections, one event loop runs on one thread.
+     * An event loop is the owebpp::AsyncContext of its thread: it resumes the coroutines of the asynchronous routes it runs.
+     */
+    class EventLoop : public AsyncContext {
+        public:
+            /* Constructors */
+            EventLoop():
+                AsyncContext(),
+                m_timers(),
+                m_completed_operations(),
+                m_resumed_operations(),
+                m_posted_mutex(),
+                m_posted_operations() {}
+
+            /* Deleted constructors */
+            EventLoop(const EventLoop& o) = delete;
+            EventLoop(EventLoop&& o) = delete;
+
+            /* Deleted assignment operators */
+            EventLoop& operator=(const EventLoop& o) = delete;
+            EventLoop& operator=(EventLoop&& o) = delete;
+
+            /* Destructor */
+            virtual ~EventLoop() = default;
+
+            /* Functions */
+            /**
+             * Run the loop on the calling thread until stop() is called, a stopped loop can't be run again.
+             */
+            virtual void run() = 0;
+
+            /**
+             * Ask the loop to stop, this function can be called from any thread.
+             */
+            virtual void stop() = 0;
+
+            /**
+             * Complete an operation at the given time.
+             * @param deadline The time to complete the operation at.
+             * @param operation The operation, its result is 0.
+             */
+            void wakeAt(std::chrono::steady_clock::time_point deadline, AsyncOperation& operation) override {
+                m_timers.push(Timer{deadline, &operation});
+            }
+
+            /**
+             * Complete an operation from another thread, the loop is woken up to resume the coroutine.
+             * @param operation The operation, its result is set by the caller beforehand.
+             */
+            void post(AsyncOperation& operation) override {
+                {
+                    std::lock_guard<std::mutex> lock(m_posted_mutex);
+                    m_posted_operations.push_back(&operation);
+                }
+                wakeUp();
+                onPosted();
+            }
+
+        protected:
+            /* Functions */
+            /** Wake the loop up from its wait for events, this function can be called from any thread. */
+            virtual void wakeUp() = 0;
+
+            /**
+             * Complete an operation on the next runOperations() call, this is how operations done in place are completed without resuming the coroutine from its await_suspend.
+             * @param operation The operation.
+             * @param result The result of the operation.
+             */
+            void complete(AsyncOperation& operation, int64_t result) {
+                operation.result = result;
+                m_completed_operations.push_back(&operation);
+            }
+
+            /**
+             * Resume the coroutines whose operation was completed in place or by another thread, or whose timer expired.
+             * @return The time the loop must run the operations again at, the maximum time point if no operation is pending.
+             */
+            std::chrono::steady_clock::time_point runOperations() {
+                /* The operations completed by the resumed coroutines are run on the next call so they can't starve the I/O. */
+                m_resumed_operations.swap(m_completed_operations);
+                {
+                    std::lock_guard<std::mutex> lock(m_posted_mutex);
+                    m_resumed_operations.insert(m_resumed_operations.end(), m_posted_operations.begin(), m_posted_operations.end());
+                    m_posted_operations.clear();
+                }
+                for(AsyncOperation* operation : m_resumed_operations) {
+                    operation->handle.resume();
+                }
+                m_resumed_operations.clear();
+                std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                while(!m_timers.empty() && m_timers.top().deadline <= now) {
+                    AsyncOperation* operation(m_timers.top().operation);
+                    m_timers.pop();
+                    operation->handle.resume();
+                }
+                std::chrono::steady_clock::time_point next_run(std::chrono::steady_clock::time_point::max());
+                if(!m_completed_operations.empty()) {
+                    next_run = now;
+                } else if(!m_timers.empty()) {
+                    next_run = m_timers.top().deadline;
+                }
+                return next_run;
+            }
+
+            /* Functions */
+            /**
+             * Create a non blocking listening socket bound to the configured address.
+             * SO_REUSEPORT lets each loop own a listening socket on the same port, the kernel then balances the connections between the loops.
+             * @param config The server configuration.
+             * @return The listening socket.
+             * @throw std::system_error If the socket can't be created, bound or listened on.
+             */
+            static int createListeningSocket(const ServerConfig& config) {
+                sockaddr_storage address{};
+                socklen_t address_size;
+                sockaddr_in* address_v4(reinterpret_cast<sockaddr_in*>(&address));
+                sockaddr_in6* address_v6(reinterpret_cast<sockaddr_in6*>(&address));
+                if(::inet_pton(AF_INET, config.getAddress().c_str(), &address_v4->sin_addr) == 1) {
+                    address_v4->sin_family = AF_INET;
+                    address_v4->sin_port = htons(config.getPort());
+                    address_size = sizeof(sockaddr_in);
+                } else if(::inet_pton(AF_INET6, config.getAddress().c_str(), &address_v6->sin6_addr) == 1) {
+                    address_v6->sin6_family = AF_INET6;
+                    address_v6->sin6_port = htons(config.getPort());
+                    address_size = sizeof(sockaddr_in6);
+                } else {
+                    throw std::system_error(EINVAL, std::generic_category(), "Invalid listening address " + config.getAddress());
+                }
+                int fd = ::socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if(fd < 0) {
+                    throw std::system_error(errno, std::generic_category(), "socket");
+                }
+                int enable(1);
+                if(::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0
+                   || ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0
+                   || ::bind(fd, reinterpret_cast<sockaddr*>(&address), address_size) < 0
+                   || ::listen(fd, config.getBacklog()) < 0) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "Can't listen on " + config.getAddress() + ":" + std::to_string(config.getPort()));
+                }
+                return fd;
+            }
+
+        private:
+            /* Types */
+            /** A coroutine waiting for a deadline. */
+            struct Timer {
+                /**
+                 * Order the timers by deadline.
+                 * @param o The other timer.
+                 * @return true if this timer expires after the other one.
+                 */
+                bool operator>(const Timer& o) const { return deadline > o.deadline; }
+
+                /** The time to resume the coroutine at. */
+                std::chrono::steady_clock::time_point deadline;
+
+                /** The operation of the coroutine. */
+                AsyncOperation* operation;
+            };
+
+            /* Members */
+            /** The pending timers, the earliest first. */
+            std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+
+            /** The operations completed in place, their coroutines are resumed by the next runOperations() call. */
+            std::vector<AsyncOperation*> m_completed_operations;
+
+            /** The operations being resumed by runOperations(), kept to reuse its memory. */
+            std::vector<AsyncOperation*> m_resumed_operations;
+
+            /** The mutex protecting m_posted_operations. */
+            std::mutex m_posted_mutex;
+
+            /** The operations completed by other threads. */
+            std::vector<AsyncOperation*> m_posted_operations;
+    };
+}
+
+#endif // OWEBPP_SERVER_EVENT_LOOP_HPP
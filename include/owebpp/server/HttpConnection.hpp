@@ -0,0 +1,665 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_HTTP_CONNECTION_HPP
+#define OWEBPP_SERVER_HTTP_CONNECTION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <owebpp/AccessLog.hpp>
+#include <owebpp/LocaleNegotiator.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/Request.hpp>
+#include <owebpp/Response.hpp>
+#include <owebpp/Router.hpp>
+#include <owebpp/Task.hpp>
+#include <owebpp/server/HttpRequestParser.hpp>
+#include <owebpp/server/OutputQueue.hpp>
+#include <owebpp/server/ResponseSerializer.hpp>
+#include <owebpp/server/ServerConfig.hpp>
+
+namespace owebpp::server {
+    /**
+     * Holds the HTTP state of a client connection: it parses the received data, dispatches the requests through the owebpp::Router and buffers the responses.
+     * Pipelined requests received together are dispatched in order and their responses are queued together, so an event loop sends them with a single writev/sendmsg.
+     * This class doesn't perform any I/O so it can be driven by any event loop.
+     * The requests following a suspended asynchronous route wait for its response, which is buffered once the coroutine completes on the event loop.
+     */
+    class HttpConnection {
+        public:
+            /* Constructors */
+            /**
+             * Construct the state of a new connection.
+             * @param config The server configuration.
+             */
+            explicit HttpConnection(const ServerConfig& config):
+                m_parser(config.getMaxHeaderSize(), config.getMaxBodySize()),
+                m_input(),
+                m_max_input_size(config.getMaxHeaderSize() + config.getMaxBodySize()),
+                m_output(),
+                m_head(),
+                m_streamed_response(nullptr),
+                m_streamed_framing(BodyFraming::CONTENT_LENGTH),
+                m_streamed_remaining(0),
+                m_chunk(),
+                m_continue_sent(false),
+                m_close_after_output(false),
+                m_is_processing_input(false),
+                m_task(nullptr),
+                m_task_request(nullptr),
+                m_task_minor_version(1),
+                m_task_is_head_request(false),
+                m_task_keep_alive(true),
+                m_is_starting_task(false),
+                m_self(std::make_shared<HttpConnection*>(this)),
+                m_on_async_response(),
+                m_access_log(config.getAccessLog()),
+                m_access_record(),
+                m_locale_negotiator(config.getLocaleNegotiator()),
+                m_is_parsing(false),
+                m_phase_start(),
+                m_sending_records(),
+                m_taken_bytes(0),
+                m_sent_bytes(0) {}
+
+            /* Deleted constructors */
+            HttpConnection() = delete;
+            HttpConnection(const HttpConnection& o) = delete;
+            HttpConnection(HttpConnection&& o) = delete;
+
+            /* Deleted assignment operators */
+            HttpConnection& operator=(const HttpConnection& o) = delete;
+            HttpConnection& operator=(HttpConnection&& o) = delete;
+
+            /* Destructor */
+            /** Cancel the request of the suspended asynchronous route, the client is gone, and write the access records of the responses that weren't fully sent. */
+            ~HttpConnection() {
+                onPeerClosed();
+                for(SendingRecord& sending : m_sending_records) {
+                    sending.record.bytes = m_sent_bytes > sending.start_offset ? std::min(m_sent_bytes, sending.end_offset) - sending.start_offset : 0;
+                    sending.record.write_time = elapsedSince(sending.write_start);
+                    m_access_log->write(sending.record);
+                }
+            }
+
+            /* Functions */
+            /**
+             * Process data received from the client, complete requests are dispatched and their responses are buffered.
+             * The connection is closed once more data than the largest request is waiting to be consumed.
+             * @param data The received data.
+             * @param size The size of the received data.
+             */
+            void onReceived(const char* data, size_t size) {
+                if(!m_close_after_output) {
+                    m_input.append(data, size);
+                    processInput();
+                    /* Pipelined requests pile up while a response is pending, the client can't be answered in order so the connection is closed after it. */
+                    if(m_input.size() > m_max_input_size) {
+                        if(m_task == nullptr && m_streamed_response == nullptr) {
+                            writeError(HttpStatusCode::PAYLOAD_TOO_LARGE);
+                        }
+                        m_input.clear();
+                        m_close_after_output = true;
+                    }
+                }
+            }
+
+            /**
+             * Tell the connection the client closed its side, the request of the suspended asynchronous route is cancelled so the client code can give up early.
+             * Its response is still buffered if the client code completes anyway.
+             */
+            void onPeerClosed() {
+                if(m_task_request != nullptr) {
+                    m_task_request->cancel();
+                }
+            }
+
+            /**
+             * Describe the data waiting to be sent to the client as an I/O vector.
+             * @param iovecs The I/O vector to fill.
+             * @param max_count The size of the I/O vector.
+             * @return The number of filled entries.
+             */
+            size_t getPendingOutput(iovec* iovecs, size_t max_count) const {
+                return m_output.fillIovecs(iovecs, max_count);
+            }
+
+            /**
+             * Mark data as sent to the client, streamed content is pulled as the output drains.
+             * @param size The number of bytes sent.
+             */
+            void onSent(size_t size) {
+                m_output.consume(size);
+                m_taken_bytes += size;
+                onTakenOutputSent(size);
+                if(m_streamed_response != nullptr) {
+                    pullContent();
+                }
+            }
+
+            /**
+             * Move the data waiting to be sent to a queue that stays stable while it is being sent, this avoids copying the output of completion based I/O.
+             * Streamed content is pulled again as the output is now empty.
+             * @param output The queue receiving the data, its previous content is discarded.
+             */
+            void takePendingOutput(OutputQueue& output) {
+                output.clear();
+                m_taken_bytes += m_output.size();
+                output.swap(m_output);
+                if(m_streamed_response != nullptr) {
+                    pullContent();
+                }
+            }
+
+            /**
+             * Mark data taken with takePendingOutput() as sent, the access records of the responses fully sent are written.
+             * @param size The number of bytes sent.
+             */
+            void onTakenOutputSent(size_t size) {
+                m_sent_bytes += size;
+                while(!m_sending_records.empty() && m_sending_records.front().is_complete && m_sending_records.front().end_offset <= m_sent_bytes) {
+                    SendingRecord& sending(m_sending_records.front());
+                    sending.record.bytes = sending.end_offset - sending.start_offset;
+                    sending.record.write_time = elapsedSince(sending.write_start);
+                    m_access_log->write(sending.record);
+                    m_sending_records.pop_front();
+                }
+            }
+
+            /**
+             * Tell if there is data waiting to be sent.
+             * @return true if data is waiting to be sent, false otherwise.
+             */
+            bool hasPendingOutput() const { return !m_output.empty(); }
+
+            /**
+             * Tell if the pending output may be held back for a short time, i.e. the client is in the middle of sending another request whose response can be sent along with it.
+             * @return true if the output may be held back, false if it should be sent right away.
+             */
+            bool isCorkable() const {
+                return !m_input.empty() && !m_continue_sent && !m_close_after_output && m_streamed_response == nullptr && m_task == nullptr && m_output.size() < OUTPUT_LOW_WATERMARK;
+            }
+
+            /**
+             * Tell if the connection must be closed, i.e the last response was fully sent and the connection can't be reused.
+             * @return true if the connection must be closed, false otherwise.
+             */
+            bool isClosing() const { return m_close_after_output && !hasPendingOutput() && m_streamed_response == nullptr && m_task == nullptr; }
+
+            /**
+             * Tell if an asynchronous route is suspended, the connection must then be kept open even if idle.
+             * @return true if an asynchronous route is suspended, false otherwise.
+             */
+            bool hasPendingTask() const { return m_task != nullptr; }
+
+            /**
+             * Set the function called when the response of a suspended asynchronous route is buffered, the event loop then sends the pending output.
+             * The function isn't called if the coroutine completes without suspending or after the connection is destroyed.
+             * @param on_async_response The function.
+             * @return The connection.
+             */
+            HttpConnection& setAsyncResponseCallback(std::function<void()> on_async_response) {
+                m_on_async_response = std::move(on_async_response);
+                return *this;
+            }
+
+        private:
+            /* Constants */
+            /** Streamed content is pulled until this amount of data is waiting to be sent, this bounds the memory used by a streamed response. */
+            static constexpr size_t OUTPUT_LOW_WATERMARK = 64 * 1024;
+
+            /* Types */
+            /** The access record of a response being sent. */
+            struct SendingRecord {
+                /** The record. */
+                AccessLogRecord record{};
+
+                /** The time the response was buffered. */
+                std::chrono::steady_clock::time_point write_start{};
+
+                /** The offset of the response in the output of the connection. */
+                uint64_t start_offset{0};
+
+                /** The offset of the end of the response, once it is complete. */
+                uint64_t end_offset{0};
+
+                /** Whether the response is fully buffered, a streamed response isn't until its content is over. */
+                bool is_complete{false};
+            };
+
+            /* Functions */
+            /** Parse and dispatch the complete requests found in the input, in order. */
+            void processInput() {
+                /* The request being handled isn't consumed yet, parsing the input again would handle it twice. */
+                if(m_is_processing_input) {
+                    return;
+                }
+                m_is_processing_input = true;
+                size_t consumed(0);
+                while(m_streamed_response == nullptr && m_task == nullptr && !m_close_after_output && consumed < m_input.size()) {
+                    if(m_access_log != nullptr && !m_is_parsing) {
+                        m_is_parsing = true;
+                        m_phase_start = std::chrono::steady_clock::now();
+                    }
+                    ParseStatus status(m_parser.parse(std::string_view(m_input).substr(consumed)));
+                    if(status == ParseStatus::COMPLETE) {
+                        handleRequest();
+                        consumed += m_parser.getConsumed();
+                        m_continue_sent = false;
+                    } else if(status == ParseStatus::INCOMPLETE) {
+                        if(m_parser.isExpectContinue() && !m_continue_sent) {
+                            m_output.append(std::string_view("HTTP/1.1 100 Continue\r\n\r\n"));
+                            m_continue_sent = true;
+                        }
+                        break;
+                    } else {
+                        writeError(m_parser.getError());
+                    }
+                }
+                m_input.erase(0, consumed);
+                m_is_processing_input = false;
+            }
+
+            /** Build the owebpp::Request of the parsed request, run the matching route and buffer the response, or start the coroutine of an asynchronous route. */
+            void handleRequest() {
+                std::map<std::string, std::string> headers;
+                for(const auto& [name, value] : m_parser.getHeaders()) {
+                    auto [it, inserted] = headers.try_emplace(std::string(name), value);
+                    if(!inserted) {
+                        it->second.append(", ").append(value);
+                    }
+                }
+                std::map<std::string, std::string> get_parameters;
+                std::string_view query(m_parser.getQuery());
+                while(!query.empty()) {
+                    size_t ampersand = query.find('&');
+                    std::string_view parameter(query.substr(0, ampersand));
+                    size_t equal = parameter.find('=');
+                    get_parameters[std::string(parameter.substr(0, equal))] = equal == std::string_view::npos ? "" : std::string(parameter.substr(equal + 1));
+                    query = ampersand == std::string_view::npos ? std::string_view() : query.substr(ampersand + 1);
+                }
+                std::shared_ptr<Request> request(std::make_shared<Request>(m_parser.getMethod(),
+                                                                           HttpRequestParser::decodePath(m_parser.getPath()),
+                                                                           headers,
+                                                                           get_parameters,
+                                                                           std::string(m_parser.getBody())));
+                if(m_access_log != nullptr) {
+                    startAccessRecord(m_parser.getMethod(), request->getUrl());
+                }
+                if(m_locale_negotiator != nullptr) {
+                    request->setTranslator(m_locale_negotiator->resolve(request->getHeader("Accept-Language")));
+                }
+
+                std::shared_ptr<Response> response;
+                try {
+                    std::smatch sm;
+                    /* A method the server doesn't recognize isn't searched in the routes, it is answered with 501 Not Implemented. */
+                    bool is_known_method(m_parser.getMethod() != HttpMethod::HTTP_UNKNOWN);
+                    AbstractRoute* route(is_known_method ? Router::getInstance().searchRoute(request, sm) : nullptr);
+                    if(m_access_log != nullptr) {
+                        m_access_record.routing_time = lapAccessTime();
+                        m_access_record.route = route == nullptr ? std::string() : route->getRegexString();
+                    }
+                    if(route == nullptr) {
+                        response = std::make_shared<Response>();
+                        response->setSatusCode(is_known_method ? HttpStatusCode::NOT_FOUND : HttpStatusCode::NOT_IMPLEMENTED);
+                    } else if(route->isAsync() || route->getLimiter() != nullptr) {
+                        /* A limited route runs as a Task so the request can wait for a slot. */
+                        m_task_request = request;
+                        startTask(Router::executeRouteAsync(*route, request, sm));
+                        return;
+                    } else {
+                        response = Router::executeRoute(*route, request, sm);
+                    }
+                } catch(const std::exception& e) {
+                    OWEBPP_LOG_ERROR(std::string("Route threw an exception: ") + e.what());
+                    response = nullptr;
+                }
+                if(response == nullptr) {
+                    response = std::make_shared<Response>();
+                    response->setSatusCode(HttpStatusCode::INTERNAL_SERVER_ERROR);
+                }
+                if(m_access_log != nullptr) {
+                    m_access_record.handler_time = lapAccessTime();
+                }
+                writeResponse(response, m_parser.getMinorVersion(), m_parser.getMethod() == HttpMethod::HTTP_HEAD, m_parser.isKeepAlive());
+            }
+
+            /**
+             * Start the coroutine of an asynchronous route, its response is buffered once it completes and the next requests wait until then.
+             * @param task The task of the route.
+             */
+            void startTask(Task<std::shared_ptr<Response>>&& task) {
+                m_task = std::make_shared<Task<std::shared_ptr<Response>>>(std::move(task));
+                m_task_minor_version = m_parser.getMinorVersion();
+                m_task_is_head_request = m_parser.getMethod() == HttpMethod::HTTP_HEAD;
+                m_task_keep_alive = m_parser.isKeepAlive();
+                /* The completion callback owns the task so the coroutine frame outlives a connection closed while it is suspended. */
+                std::shared_ptr<Task<std::shared_ptr<Response>>> task_owner(m_task);
+                std::weak_ptr<HttpConnection*> self(m_self);
+                m_is_starting_task = true;
+                m_task->start([task_owner, self]() {
+                    std::shared_ptr<HttpConnection*> connection(self.lock());
+                    if(connection != nullptr && !(*connection)->m_is_starting_task) {
+                        (*connection)->finishTask(true);
+                    }
+                });
+                m_is_starting_task = false;
+                if(m_task->isDone()) {
+                    finishTask(false);
+                }
+            }
+
+            /**
+             * Buffer the response of the completed asynchronous route.
+             * @param is_resumed true if the coroutine completed after being suspended, the next requests are then processed and the event loop is notified.
+             */
+            void finishTask(bool is_resumed) {
+                std::shared_ptr<Response> response;
+                try {
+                    response = m_task->getResult();
+                } catch(const std::exception& e) {
+                    OWEBPP_LOG_ERROR(std::string("Route threw an exception: ") + e.what());
+                    response = nullptr;
+                }
+                m_task = nullptr;
+                m_task_request = nullptr;
+                if(response == nullptr) {
+                    response = std::make_shared<Response>();
+                    response->setSatusCode(HttpStatusCode::INTERNAL_SERVER_ERROR);
+                }
+                if(m_access_log != nullptr) {
+                    m_access_record.handler_time = lapAccessTime();
+                }
+                writeResponse(response, m_task_minor_version, m_task_is_head_request, m_task_keep_alive);
+                if(is_resumed) {
+                    processInput();
+                    if(m_on_async_response) {
+                        m_on_async_response();
+                    }
+                }
+            }
+
+            /**
+             * Buffer a response, streamed content is pulled as the output drains.
+             * @param response The response.
+             * @param minor_version The HTTP minor version of the request.
+             * @param is_head_request true if the request method is HEAD.
+             * @param keep_alive true if the client allows to reuse the connection.
+             */
+            void writeResponse(const std::shared_ptr<Response>& response, int minor_version, bool is_head_request, bool keep_alive) {
+                BodyFraming framing(ResponseSerializer::chooseFraming(*response, minor_version));
+                bool has_body(ResponseSerializer::hasBody(*response, is_head_request));
+                keep_alive = keep_alive && !m_close_after_output && (framing != BodyFraming::CLOSE_DELIMITED || !has_body);
+                if(m_access_log != nullptr) {
+                    queueAccessRecord(response->getSatusCode());
+                }
+                m_head.clear();
+                ResponseSerializer::appendHead(m_head, *response, framing, keep_alive, minor_version);
+                m_output.append(std::string_view(m_head));
+                m_close_after_output = !keep_alive;
+                if(has_body) {
+                    if(response->isStreamed()) {
+                        m_streamed_response = response;
+                        m_streamed_framing = framing;
+                        m_streamed_remaining = response->getContentLength().value_or(0);
+                        pullContent();
+                    } else {
+                        /* Large contents are sent from the response itself, which is kept alive until then. */
+                        m_output.append(std::string_view(response->getContent()), response);
+                    }
+                }
+                if(!has_body || !response->isStreamed()) {
+                    completeAccessRecord();
+                }
+            }
+
+            /**
+             * Buffer an error response and close the connection once it is sent.
+             * @param status_code The error status code.
+             */
+            void writeError(HttpStatusCode status_code) {
+                Response response;
+                response.setSatusCode(status_code);
+                if(m_access_log != nullptr) {
+                    startAccessRecord(HttpMethod::HTTP_UNKNOWN, std::string_view());
+                    queueAccessRecord(status_code);
+                }
+                m_head.clear();
+                ResponseSerializer::appendHead(m_head, response, BodyFraming::CONTENT_LENGTH, false, 1);
+                m_output.append(std::string_view(m_head));
+                m_close_after_output = true;
+                completeAccessRecord();
+            }
+
+            /** Pull the streamed content until enough data is waiting to be sent or the content is over. */
+            void pullContent() {
+                bool is_over(false);
+                try {
+                    while(!is_over && m_output.size() < OUTPUT_LOW_WATERMARK) {
+                        m_chunk.clear();
+                        if(m_streamed_response->getContentProducer()(m_chunk)) {
+                            if(m_chunk.empty()) {
+                                continue;
+                            }
+                            /* The chunk is moved to the output rather than copied. */
+                            if(m_streamed_framing == BodyFraming::CHUNKED) {
+                                m_head.clear();
+                                ResponseSerializer::appendChunkHeader(m_head, m_chunk.size());
+                                m_output.append(std::string_view(m_head));
+                                m_output.append(std::move(m_chunk));
+                                m_output.append(std::string_view("\r\n"));
+                            } else if(m_chunk.size() <= m_streamed_remaining) {
+                                m_streamed_remaining -= m_chunk.size();
+                                m_output.append(std::move(m_chunk));
+                            } else {
+                                OWEBPP_LOG_ERROR("Content producer produced more than the content length of the response.");
+                                abortStreamedResponse();
+                                return;
+                            }
+                        } else {
+                            is_over = true;
+                        }
+                    }
+                } catch(const std::exception& e) {
+                    OWEBPP_LOG_ERROR(std::string("Content producer threw an exception: ") + e.what());
+                    abortStreamedResponse();
+                    return;
+                }
+                if(is_over && m_streamed_framing == BodyFraming::CONTENT_LENGTH && m_streamed_remaining > 0) {
+                    OWEBPP_LOG_ERROR("Content producer ended before the content length of the response.");
+                    abortStreamedResponse();
+                } else if(is_over) {
+                    if(m_streamed_framing == BodyFraming::CHUNKED) {
+                        m_head.clear();
+                        ResponseSerializer::appendLastChunk(m_head);
+                        m_output.append(std::string_view(m_head));
+                    }
+                    m_streamed_response = nullptr;
+                    m_chunk = std::string();
+                    completeAccessRecord();
+                    processInput();
+                }
+            }
+
+            /** Stop streaming a response whose content can't be sent as announced, the connection is closed once the output is sent. */
+            void abortStreamedResponse() {
+                /* The status line is already sent, the only way to report the error is to close the connection before the end of the content. */
+                m_streamed_response = nullptr;
+                m_chunk = std::string();
+                m_close_after_output = true;
+                completeAccessRecord();
+            }
+
+            /**
+             * Start the access record of a parsed request, its parse time ends now.
+             * @param method The method of the request.
+             * @param path The path of the request.
+             */
+            void startAccessRecord(HttpMethod method, std::string_view path) {
+                m_access_record.parse_time = lapAccessTime();
+                m_access_record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+                                            - static_cast<int64_t>(m_access_record.parse_time);
+                m_access_record.request_id = m_access_log->nextRequestId(m_access_record.pid);
+                m_access_record.method = method;
+                m_access_record.path.assign(path);
+                m_access_record.route.clear();
+                m_access_record.routing_time = 0;
+                m_access_record.handler_time = 0;
+                m_is_parsing = false;
+            }
+
+            /**
+             * Queue the access record of the request whose response is being buffered, it is written once the response is sent.
+             * @param status_code The status code of the response.
+             */
+            void queueAccessRecord(HttpStatusCode status_code) {
+                m_access_record.status = static_cast<uint16_t>(status_code);
+                m_sending_records.push_back(SendingRecord{m_access_record, std::chrono::steady_clock::now(), m_taken_bytes + m_output.size(), 0, false});
+            }
+
+            /** Mark the response of the last queued access record as fully buffered, the record is written once the output is sent up to here. */
+            void completeAccessRecord() {
+                if(!m_sending_records.empty() && !m_sending_records.back().is_complete) {
+                    m_sending_records.back().end_offset = m_taken_bytes + m_output.size();
+                    m_sending_records.back().is_complete = true;
+                }
+            }
+
+            /**
+             * Get the time spent in the current phase of the request and start the next one.
+             * @return The time spent in nanoseconds.
+             */
+            uint64_t lapAccessTime() {
+                std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                uint64_t elapsed(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_phase_start).count()));
+                m_phase_start = now;
+                return elapsed;
+            }
+
+            /**
+             * Get the time elapsed since a point in time.
+             * @param start The point in time.
+             * @return The elapsed time in nanoseconds.
+             */
+            static uint64_t elapsedSince(std::chrono::steady_clock::time_point start) {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            /* Members */
+            /** The request parser. */
+            HttpRequestParser m_parser;
+
+            /** The received data that wasn't consumed by a request yet. */
+            std::string m_input;
+
+            /** The maximum size of the received data waiting to be consumed, the size of the largest request. */
+            size_t m_max_input_size;
+
+            /** The data waiting to be sent. */
+            OutputQueue m_output;
+
+            /** The buffer the response heads and chunk framing are serialized to before being queued. */
+            std::string m_head;
+
+            /** The response whose content is being streamed, nullptr if none. */
+            std::shared_ptr<Response> m_streamed_response;
+
+            /** The framing of the streamed content. */
+            BodyFraming m_streamed_framing;
+
+            /** The number of bytes of the streamed content still expected with the CONTENT_LENGTH framing. */
+            size_t m_streamed_remaining;
+
+            /** The buffer given to the content producer, large chunks are moved to the output and small ones are copied so the buffer is reused. */
+            std::string m_chunk;
+
+            /** Whether a 100 Continue response was sent for the request being received. */
+            bool m_continue_sent;
+
+            /** Whether the connection must be closed once the output is sent. */
+            bool m_close_after_output;
+
+            /** Whether the input is being processed, a streamed content ending while its response is buffered then lets processInput() go on. */
+            bool m_is_processing_input;
+
+            /** The task of the suspended asynchronous route, nullptr if none. */
+            std::shared_ptr<Task<std::shared_ptr<Response>>> m_task;
+
+            /** The request of the suspended asynchronous route, nullptr if none. */
+            std::shared_ptr<Request> m_task_request;
+
+            /** The HTTP minor version of the request of the asynchronous route. */
+            int m_task_minor_version;
+
+            /** Whether the request of the asynchronous route is a HEAD request. */
+            bool m_task_is_head_request;
+
+            /** Whether the client of the asynchronous route allows to reuse the connection. */
+            bool m_task_keep_alive;
+
+            /** Whether the task is being started, a task completing without suspending is then finished by startTask(). */
+            bool m_is_starting_task;
+
+            /** The token the completion callbacks of the tasks use to tell if the connection still exists. */
+            std::shared_ptr<HttpConnection*> m_self;
+
+            /** The function called when the response of a suspended asynchronous route is buffered. */
+            std::function<void()> m_on_async_response;
+
+            /** The access log, nullptr if the requests aren't logged. */
+            std::shared_ptr<AccessLog> m_access_log;
+
+            /** The access record of the request being processed. */
+            AccessLogRecord m_access_record;
+
+            /** The locale negotiator, nullptr if the requests use the global translator. */
+            std::shared_ptr<LocaleNegotiator> m_locale_negotiator;
+
+            /** Whether a request is being received, its parse time started. */
+            bool m_is_parsing;
+
+            /** The start of the current phase of the request being processed. */
+            std::chrono::steady_clock::time_point m_phase_start;
+
+            /** The access records of the responses being sent, in order. */
+            std::deque<SendingRecord> m_sending_records;
+
+            /** The number of bytes taken from the output, either sent or taken with takePendingOutput(). */
+            uint64_t m_taken_bytes;
+
+            /** The number of bytes sent. */
+            uint64_t m_sent_bytes;
+    };
+}
+
+#endif // OWEBPP_SERVER_HTTP_CONNECTION_HPP
@@ -0,0 +1,509 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_HTTP_REQUEST_PARSER_HPP
+#define OWEBPP_SERVER_HTTP_REQUEST_PARSER_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <owebpp/HttpMethod.hpp>
+#include <owebpp/HttpStatusCode.hpp>
+#include <owebpp/server/CharacterScanner.hpp>
+
+namespace owebpp::server {
+    /** Lists the possible outcomes of a request parsing. */
+    enum class ParseStatus {
+        /** A full request, including its body, was parsed. */
+        COMPLETE,
+        /** More data is needed to parse the request. */
+        INCOMPLETE,
+        /** The request is invalid, see HttpRequestParser::getError(). */
+        ERROR
+    };
+
+    /**
+     * Parses HTTP/1.x requests incrementally, the parsed parts are views into the parsed buffer.
+     * The request head is parsed line by line as it is received: a partial read resumes at the line being received and each byte is scanned once.
+     * The line ends are found with CharacterScanner, which also rejects the control characters a request head can't contain.
+     */
+    class HttpRequestParser {
+        public:
+            /* Constructors */
+            /**
+             * Construct a parser.
+             * @param max_header_size The maximum size of the request line and headers.
+             * @param max_body_size The maximum size of a request body.
+             */
+            HttpRequestParser(size_t max_header_size, size_t max_body_size):
+                m_max_header_size(max_header_size),
+                m_max_body_size(max_body_size),
+                m_state(State::REQUEST_LINE),
+                m_head_start(0),
+                m_line_start(0),
+                m_scan_position(0),
+                m_method_span(),
+                m_path_span(),
+                m_query_span(),
+                m_header_spans(),
+                m_body_start(0),
+                m_content_length(0),
+                m_has_content_length(false),
+                m_method(HttpMethod::HTTP_UNKNOWN),
+                m_method_name(),
+                m_path(),
+                m_query(),
+                m_minor_version(1),
+                m_headers(),
+                m_body(),
+                m_keep_alive(true),
+                m_expect_continue(false),
+                m_consumed(0),
+                m_error(HttpStatusCode::BAD_REQUEST) {}
+
+            /* Deleted constructors */
+            HttpRequestParser() = delete;
+            HttpRequestParser(const HttpRequestParser& o) = delete;
+            HttpRequestParser(HttpRequestParser&& o) = delete;
+
+            /* Deleted assignment operators */
+            HttpRequestParser& operator=(const HttpRequestParser& o) = delete;
+            HttpRequestParser& operator=(HttpRequestParser&& o) = delete;
+
+            /* Destructor */
+            ~HttpRequestParser() = default;
+
+            /* Functions */
+            /**
+             * Parse the request at the start of the buffer, resuming where the previous call stopped if it returned INCOMPLETE.
+             * After an INCOMPLETE result the next call must get the same data followed by the newly received data, the buffer may have moved in memory.
+             * After a COMPLETE or ERROR result the next call parses a new request.
+             * The parsed parts stay valid as long as the buffer isn't modified.
+             * @param buffer The received data that wasn't consumed by a previous request.
+             * @return COMPLETE if a full request was parsed, INCOMPLETE if more data is needed, ERROR if the request is invalid.
+             */
+            ParseStatus parse(std::string_view buffer) {
+                if(m_state == State::DONE) {
+                    reset();
+                }
+                ParseStatus status(ParseStatus::INCOMPLETE);
+                while(status == ParseStatus::INCOMPLETE && m_state != State::BODY) {
+                    size_t line_end(m_scan_position + CharacterScanner::findControl(buffer.data() + m_scan_position, buffer.size() - m_scan_position));
+                    if(line_end - m_head_start > m_max_header_size) {
+                        return fail(HttpStatusCode::REQUEST_HEADER_FIELDS_TOO_LARGE);
+                    }
+                    if(line_end + 1 >= buffer.size()) {
+                        /* The line isn't complete yet, the next call resumes the scan where this one stopped. */
+                        m_scan_position = std::min(line_end, buffer.size());
+                        return ParseStatus::INCOMPLETE;
+                    }
+                    if(buffer[line_end] != '\r' || buffer[line_end + 1] != '\n') {
+                        return fail(HttpStatusCode::BAD_REQUEST);
+                    }
+                    std::string_view line(buffer.substr(m_line_start, line_end - m_line_start));
+                    if(m_state == State::REQUEST_LINE) {
+                        if(line.empty()) {
+                            /* Empty lines before the request line must be ignored. */
+                            m_head_start = line_end + 2;
+                        } else {
+                            status = parseRequestLine(line);
+                        }
+                    } else if(line.empty()) {
+                        status = endHead(line_end + 2);
+                    } else {
+                        status = parseHeaderLine(line);
+                    }
+                    m_line_start = line_end + 2;
+                    m_scan_position = m_line_start;
+                }
+                if(status == ParseStatus::INCOMPLETE) {
+                    status = parseBody(buffer);
+                }
+                return status;
+            }
+
+            /**
+             * Decode the percent encoded characters of a path, invalid sequences are kept as is.
+             * @param path The path to decode.
+             * @return The decoded path.
+             */
+            static std::string decodePath(std::string_view path) {
+                std::string decoded;
+                decoded.reserve(path.size());
+                for(size_t i = 0; i < path.size(); i++) {
+                    unsigned char value(0);
+                    if(path[i] == '%' && i + 2 < path.size() && std::from_chars(path.data() + i + 1, path.data() + i + 3, value, 16).ptr == path.data() + i + 3) {
+                        decoded += static_cast<char>(value);
+                        i += 2;
+                    } else {
+                        decoded += path[i];
+                    }
+                }
+                return decoded;
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the request method.
+             * @return the request method, HTTP_UNKNOWN for methods the framework doesn't support.
+             */
+            HttpMethod getMethod() const { return m_method; }
+
+            /**
+             * Getter for the request method as sent by the client.
+             * @return the request method name.
+             */
+            std::string_view getMethodName() const { return m_method_name; }
+
+            /**
+             * Getter for the path of the request target, still percent encoded.
+             * @return the request path.
+             */
+            std::string_view getPath() const { return m_path; }
+
+            /**
+             * Getter for the query string of the request target.
+             * @return the query string without the '?'.
+             */
+            std::string_view getQuery() const { return m_query; }
+
+            /**
+             * Getter for the HTTP minor version, 0 for HTTP/1.0 and 1 for HTTP/1.1.
+             * @return the HTTP minor version.
+             */
+            int getMinorVersion() const { return m_minor_version; }
+
+            /**
+             * Getter for the request headers in the order they were sent.
+             * @return the request headers.
+             */
+            const std::vector<std::pair<std::string_view, std::string_view>>& getHeaders() const { return m_headers; }
+
+            /**
+             * Getter for the request body.
+             * @return the request body.
+             */
+            std::string_view getBody() const { return m_body; }
+
+            /**
+             * Tell if the connection can be kept open after this request.
+             * @return true if the connection can be reused, false otherwise.
+             */
+            bool isKeepAlive() const { return m_keep_alive; }
+
+            /**
+             * Tell if the client waits for a 100 Continue response before sending the body, once the request head is parsed.
+             * @return true if the client expects a 100 Continue response.
+             */
+            bool isExpectContinue() const { return m_expect_continue && m_state == State::BODY; }
+
+            /**
+             * Getter for the number of bytes of the parsed request, including its body.
+             * @return the number of bytes of the request.
+             */
+            size_t getConsumed() const { return m_consumed; }
+
+            /**
+             * Getter for the status code to answer when parsing failed.
+             * @return the error status code.
+             */
+            HttpStatusCode getError() const { return m_error; }
+
+        private:
+            /* Functions */
+            /**
+             * Parse the request line.
+             * @param line The request line without its line end.
+             * @return INCOMPLETE if the line is valid, ERROR otherwise.
+             */
+            ParseStatus parseRequestLine(std::string_view line) {
+                size_t method_end(CharacterScanner::findByte(line.data(), line.size(), ' '));
+                size_t target_end(line.rfind(' '));
+                if(method_end == line.size() || target_end <= method_end + 1) {
+                    return fail(HttpStatusCode::BAD_REQUEST);
+                }
+                std::string_view version(line.substr(target_end + 1));
+                if(version.size() != 8 || !version.starts_with("HTTP/1.") || !std::isdigit(static_cast<unsigned char>(version[7]))) {
+                    return fail(version.starts_with("HTTP/") ? HttpStatusCode::HTTP_VERSION_NOT_SUPPORTED : HttpStatusCode::BAD_REQUEST);
+                }
+                m_minor_version = version[7] - '0';
+                m_keep_alive = m_minor_version >= 1;
+                m_method = HttpMethodUtils::convertMethodTokenToValue(line.substr(0, method_end));
+
+                size_t target_start(method_end + 1);
+                std::string_view target(line.substr(target_start, target_end - target_start));
+                size_t query_start(CharacterScanner::findByte(target.data(), target.size(), '?'));
+                if(target.front() != '/') {
+                    return fail(HttpStatusCode::BAD_REQUEST);
+                }
+                m_method_span = Span{m_line_start, method_end};
+                m_path_span = Span{m_line_start + target_start, query_start};
+                m_query_span = query_start == target.size() ? Span{m_line_start + target_end, 0} : Span{m_line_start + target_start + query_start + 1, target.size() - query_start - 1};
+                m_state = State::HEADERS;
+                return ParseStatus::INCOMPLETE;
+            }
+
+            /**
+             * Parse a header line, the headers framing the request are interpreted right away.
+             * @param line The header line without its line end.
+             * @return INCOMPLETE if the header is valid, ERROR otherwise.
+             */
+            ParseStatus parseHeaderLine(std::string_view line) {
+                size_t colon(CharacterScanner::findByte(line.data(), line.size(), ':'));
+                if(colon == line.size() || colon == 0 || line.front() == ' ' || line.front() == '\t' || line[colon - 1] == ' ' || line[colon - 1] == '\t') {
+                    return fail(HttpStatusCode::BAD_REQUEST);
+                }
+                std::string_view name(line.substr(0, colon));
+                std::string_view raw_value(line.substr(colon + 1));
+                std::string_view value(trim(raw_value));
+                size_t value_offset(value.empty() ? 0 : static_cast<size_t>(value.data() - line.data()));
+                m_header_spans.emplace_back(Span{m_line_start, colon}, Span{m_line_start + value_offset, value.size()});
+
+                if(equalsIgnoreCase(name, "content-length")) {
+                    size_t length(0);
+                    auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+                    if(value.empty() || error != std::errc() || ptr != value.data() + value.size() || (m_has_content_length && length != m_content_length)) {
+                        return fail(HttpStatusCode::BAD_REQUEST);
+                    }
+                    m_content_length = length;
+                    m_has_content_length = true;
+                } else if(equalsIgnoreCase(name, "transfer-encoding")) {
+                    /* Chunked request bodies aren't supported, the request can't be delimited so it is refused. */
+                    return fail(HttpStatusCode::NOT_IMPLEMENTED);
+                } else if(equalsIgnoreCase(name, "connection")) {
+                    if(containsToken(value, "close")) {
+                        m_keep_alive = false;
+                    } else if(containsToken(value, "keep-alive")) {
+                        m_keep_alive = true;
+                    }
+                } else if(equalsIgnoreCase(name, "expect")) {
+                    m_expect_continue = equalsIgnoreCase(value, "100-continue");
+                }
+                return ParseStatus::INCOMPLETE;
+            }
+
+            /**
+             * Handle the empty line ending the request head.
+             * @param body_start The offset of the body.
+             * @return INCOMPLETE if the body size is acceptable, ERROR otherwise.
+             */
+            ParseStatus endHead(size_t body_start) {
+                if(m_content_length > m_max_body_size) {
+                    return fail(HttpStatusCode::PAYLOAD_TOO_LARGE);
+                }
+                m_body_start = body_start;
+                m_state = State::BODY;
+                return ParseStatus::INCOMPLETE;
+            }
+
+            /**
+             * Wait for the body then expose the parsed parts as views into the buffer.
+             * @param buffer The parsed buffer.
+             * @return COMPLETE if the body is received, INCOMPLETE otherwise.
+             */
+            ParseStatus parseBody(std::string_view buffer) {
+                if(m_state != State::BODY || buffer.size() - m_body_start < m_content_length) {
+                    return ParseStatus::INCOMPLETE;
+                }
+                m_method_name = m_method_span.view(buffer);
+                m_path = m_path_span.view(buffer);
+                m_query = m_query_span.view(buffer);
+                m_headers.clear();
+                for(const auto& [name, value] : m_header_spans) {
+                    m_headers.emplace_back(name.view(buffer), value.view(buffer));
+                }
+                m_body = buffer.substr(m_body_start, m_content_length);
+                m_consumed = m_body_start + m_content_length;
+                m_state = State::DONE;
+                return ParseStatus::COMPLETE;
+            }
+
+            /** Reset the parser to parse a new request. */
+            void reset() {
+                m_state = State::REQUEST_LINE;
+                m_head_start = 0;
+                m_line_start = 0;
+                m_scan_position = 0;
+                m_header_spans.clear();
+                m_body_start = 0;
+                m_content_length = 0;
+                m_has_content_length = false;
+                m_expect_continue = false;
+            }
+
+            /**
+             * Record a parsing error, the next call to parse() starts a new request.
+             * @param error The status code to answer.
+             * @return ParseStatus::ERROR.
+             */
+            ParseStatus fail(HttpStatusCode error) {
+                m_error = error;
+                m_state = State::DONE;
+                return ParseStatus::ERROR;
+            }
+
+            /**
+             * Remove the leading and trailing spaces and tabs.
+             * @param str The string to trim.
+             * @return The trimmed string.
+             */
+            static std::string_view trim(std::string_view str) {
+                size_t begin = str.find_first_not_of(" \t");
+                size_t end = str.find_last_not_of(" \t");
+                return begin == std::string_view::npos ? std::string_view() : str.substr(begin, end - begin + 1);
+            }
+
+            /**
+             * Compare two strings without case sensitivity.
+             * @param a The first string.
+             * @param b The second string, lower case.
+             * @return true if the strings are equal, false otherwise.
+             */
+            static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+                return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char c, char lower) {
+                    return std::tolower(static_cast<unsigned char>(c)) == lower;
+                });
+            }
+
+            /**
+             * Tell if a comma separated header value contains a token.
+             * @param value The header value.
+             * @param token The token, lower case.
+             * @return true if the token is found, false otherwise.
+             */
+            static bool containsToken(std::string_view value, std::string_view token) {
+                bool found(false);
+                while(!found && !value.empty()) {
+                    size_t comma = value.find(',');
+                    found = equalsIgnoreCase(trim(value.substr(0, comma)), token);
+                    value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+                }
+                return found;
+            }
+
+            /* Types */
+            /** Lists the parts of a request the parser can be waiting for. */
+            enum class State {
+                REQUEST_LINE,
+                HEADERS,
+                BODY,
+                DONE
+            };
+
+            /** Locates a part of the request by offset, so it stays valid when the buffer moves between two partial reads. */
+            struct Span {
+                /** The offset of the part in the buffer. */
+                size_t offset;
+
+                /** The size of the part. */
+                size_t size;
+
+                /**
+                 * Get the part as a view into the buffer.
+                 * @param buffer The parsed buffer.
+                 * @return The view.
+                 */
+                std::string_view view(std::string_view buffer) const { return buffer.substr(offset, size); }
+            };
+
+            /* Members */
+            /** The maximum size of the request line and headers. */
+            size_t m_max_header_size;
+
+            /** The maximum size of a request body. */
+            size_t m_max_body_size;
+
+            /** The part of the request the parser is waiting for. */
+            State m_state;
+
+            /** The offset of the request line, after the ignored empty lines. */
+            size_t m_head_start;
+
+            /** The offset of the line being parsed. */
+            size_t m_line_start;
+
+            /** The offset where the search for the end of the line being parsed resumes. */
+            size_t m_scan_position;
+
+            /** The location of the method token. */
+            Span m_method_span;
+
+            /** The location of the path. */
+            Span m_path_span;
+
+            /** The location of the query string. */
+            Span m_query_span;
+
+            /** The locations of the header names and values. */
+            std::vector<std::pair<Span, Span>> m_header_spans;
+
+            /** The offset of the body. */
+            size_t m_body_start;
+
+            /** The size of the body. */
+            size_t m_content_length;
+
+            /** Whether a Content-Length header was received. */
+            bool m_has_content_length;
+
+            /** The request method. */
+            HttpMethod m_method;
+
+            /** The request method as sent by the client. */
+            std::string_view m_method_name;
+
+            /** The path of the request target. */
+            std::string_view m_path;
+
+            /** The query string of the request target. */
+            std::string_view m_query;
+
+            /** The HTTP minor version. */
+            int m_minor_version;
+
+            /** The request headers. */
+            std::vector<std::pair<std::string_view, std::string_view>> m_headers;
+
+            /** The request body. */
+            std::string_view m_body;
+
+            /** Whether the connection can be kept open after this request. */
+            bool m_keep_alive;
+
+            /** Whether the client waits for a 100 Continue response. */
+            bool m_expect_continue;
+
+            /** The number of bytes of the parsed request. */
+            size_t m_consumed;
+
+            /** The status code to answer when parsing failed. */
+            HttpStatusCode m_error;
+    };
+}
+
+#endif // OWEBPP_SERVER_HTTP_REQUEST_PARSER_HPP
@@ -0,0 +1,282 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_IO_URING_HPP
+#define OWEBPP_SERVER_IO_URING_HPP
+
+#if !defined(DISABLE_IO_URING) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+#endif
+
+/* Multishot recv, provided buffer rings and single issuer rings need Linux 6.0 headers. */
+#if defined(IORING_SETUP_SINGLE_ISSUER) && defined(IORING_RECV_MULTISHOT)
+    #define OWEBPP_HAS_IO_URING 1
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace owebpp::server {
+    /**
+     * A minimal io_uring instance driven through the raw system calls, so the library doesn't depend on liburing.
+     * It must only be used by one thread.
+     */
+    class IoUring final {
+        public:
+            /* Constructors */
+            /**
+             * Create an io_uring instance and map its rings.
+             * @param entries The number of submission queue entries, the completion queue is four times bigger.
+             * @param flags The IORING_SETUP_* flags.
+             * @throw std::system_error If the kernel doesn't support io_uring or the requested flags.
+             */
+            IoUring(unsigned int entries, unsigned int flags):
+                m_fd(-1),
+                m_ring(MAP_FAILED),
+                m_ring_size(0),
+                m_sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+                m_sqes_size(0),
+                m_sq_head(nullptr),
+                m_sq_tail(nullptr),
+                m_sq_mask(0),
+                m_sq_entries(0),
+                m_sq_local_tail(0),
+                m_cq_head(nullptr),
+                m_cq_tail(nullptr),
+                m_cq_mask(0),
+                m_cqes(nullptr) {
+                io_uring_params params{};
+                params.flags = flags | IORING_SETUP_CQSIZE;
+                params.cq_entries = entries * 4;
+                m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if(m_fd < 0) {
+                    throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+                }
+                if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+                    ::close(m_fd);
+                    throw std::system_error(ENOSYS, std::generic_category(), "io_uring is missing required features");
+                }
+                m_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+                                       params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+                m_ring = ::mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+                m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                m_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES));
+                if(m_ring == MAP_FAILED || m_sqes == MAP_FAILED) {
+                    int error = errno;
+                    release();
+                    throw std::system_error(error, std::generic_category(), "io_uring mmap");
+                }
+                char* ring(static_cast<char*>(m_ring));
+                m_sq_head = reinterpret_cast<unsigned int*>(ring + params.sq_off.head);
+                m_sq_tail = reinterpret_cast<unsigned int*>(ring + params.sq_off.tail);
+                m_sq_mask = *reinterpret_cast<unsigned int*>(ring + params.sq_off.ring_mask);
+                m_sq_entries = params.sq_entries;
+                m_sq_local_tail = *m_sq_tail;
+                m_cq_head = reinterpret_cast<unsigned int*>(ring + params.cq_off.head);
+                m_cq_tail = reinterpret_cast<unsigned int*>(ring + params.cq_off.tail);
+                m_cq_mask = *reinterpret_cast<unsigned int*>(ring + params.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+                /* The submission entries are used in order, the indirection array is filled once. */
+                unsigned int* array(reinterpret_cast<unsigned int*>(ring + params.sq_off.array));
+                for(unsigned int i = 0; i < m_sq_entries; i++) {
+                    array[i] = i;
+                }
+            }
+
+            /* Deleted constructors */
+            IoUring() = delete;
+            IoUring(const IoUring& o) = delete;
+            IoUring(IoUring&& o) = delete;
+
+            /* Deleted assignment operators */
+            IoUring& operator=(const IoUring& o) = delete;
+            IoUring& operator=(IoUring&& o) = delete;
+
+            /* Destructor */
+            ~IoUring() { release(); }
+
+            /* Functions */
+            /**
+             * Get a cleared submission queue entry, it is submitted by the next call to submit().
+             * @return The entry, nullptr if the submission queue is full.
+             */
+            io_uring_sqe* getSqe() {
+                if(getSqSpace() == 0) {
+                    return nullptr;
+                }
+                io_uring_sqe* sqe(&m_sqes[m_sq_local_tail & m_sq_mask]);
+                std::memset(sqe, 0, sizeof(io_uring_sqe));
+                m_sq_local_tail++;
+                return sqe;
+            }
+
+            /**
+             * Get the number of free submission queue entries.
+             * @return The number of free entries.
+             */
+            unsigned int getSqSpace() const {
+                return m_sq_entries - (m_sq_local_tail - std::atomic_ref<unsigned int>(*m_sq_head).load(std::memory_order_acquire));
+            }
+
+            /**
+             * Submit the pending entries and optionally wait for completions, in a single system call.
+             * @param wait_count The number of completions to wait for.
+             * @param timeout The maximum time to wait for, nullptr to wait without limit.
+             * @throw std::system_error If io_uring_enter fails.
+             */
+            void submit(unsigned int wait_count, const __kernel_timespec* timeout = nullptr) {
+                std::atomic_ref<unsigned int>(*m_sq_tail).store(m_sq_local_tail, std::memory_order_release);
+                unsigned int to_submit(m_sq_local_tail - std::atomic_ref<unsigned int>(*m_sq_head).load(std::memory_order_acquire));
+                unsigned int flags(wait_count > 0 ? IORING_ENTER_GETEVENTS : 0);
+                io_uring_getevents_arg argument{};
+                if(timeout != nullptr) {
+                    /* The timeout is passed without submitting an IORING_OP_TIMEOUT entry. */
+                    flags |= IORING_ENTER_EXT_ARG;
+                    argument.ts = reinterpret_cast<uint64_t>(timeout);
+                }
+                while(::syscall(__NR_io_uring_enter, m_fd, to_submit, wait_count, flags, timeout != nullptr ? &argument : nullptr, timeout != nullptr ? sizeof(argument) : 0) < 0) {
+                    if(errno == ETIME) {
+                        return;
+                    } else if(errno == EINTR) {
+                        /* The entries may have been consumed before the interruption. */
+                        to_submit = m_sq_local_tail - std::atomic_ref<unsigned int>(*m_sq_head).load(std::memory_order_acquire);
+                    } else if(errno != EAGAIN && errno != EBUSY) {
+                        throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+                    } else if(wait_count == 0) {
+                        return;
+                    }
+                }
+            }
+
+            /**
+             * Call a function on every available completion then release them to the kernel.
+             * @param function The function receiving each const io_uring_cqe&.
+             * @return The number of completions handled.
+             */
+            template<class Tfunction>
+            unsigned int forEachCqe(Tfunction&& function) {
+                unsigned int head(*m_cq_head);
+                unsigned int tail(std::atomic_ref<unsigned int>(*m_cq_tail).load(std::memory_order_acquire));
+                for(unsigned int i = head; i != tail; i++) {
+                    function(static_cast<const io_uring_cqe&>(m_cqes[i & m_cq_mask]));
+                }
+                std::atomic_ref<unsigned int>(*m_cq_head).store(tail, std::memory_order_release);
+                return tail - head;
+            }
+
+            /**
+             * Register a provided buffer ring.
+             * @param ring The page aligned ring memory.
+             * @param entries The number of ring entries, a power of 2.
+             * @param group The buffer group id used by the requests selecting a buffer.
+             * @throw std::system_error If the kernel doesn't support provided buffer rings.
+             */
+            void registerBufferRing(io_uring_buf_ring* ring, unsigned int entries, uint16_t group) {
+                io_uring_buf_reg registration{};
+                registration.ring_addr = reinterpret_cast<uint64_t>(ring);
+                registration.ring_entries = entries;
+                registration.bgid = group;
+                if(::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "io_uring_register(IORING_REGISTER_PBUF_RING)");
+                }
+            }
+
+            /**
+             * Enable a ring created with IORING_SETUP_R_DISABLED, a single issuer ring is then bound to the calling thread.
+             * @throw std::system_error If the ring can't be enabled.
+             */
+            void enable() {
+                if(::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0) {
+                    throw std::system_error(errno, std::generic_category(), "io_uring_register(IORING_REGISTER_ENABLE_RINGS)");
+                }
+            }
+
+        private:
+            /* Functions */
+            /** Unmap the rings and close the instance. */
+            void release() {
+                if(m_sqes != MAP_FAILED) {
+                    ::munmap(m_sqes, m_sqes_size);
+                }
+                if(m_ring != MAP_FAILED) {
+                    ::munmap(m_ring, m_ring_size);
+                }
+                if(m_fd >= 0) {
+                    ::close(m_fd);
+                }
+            }
+
+            /* Members */
+            /** The io_uring file descriptor. */
+            int m_fd;
+
+            /** The mapping holding both the submission and the completion rings. */
+            void* m_ring;
+
+            /** The size of m_ring. */
+            size_t m_ring_size;
+
+            /** The submission queue entries. */
+            io_uring_sqe* m_sqes;
+
+            /** The size of m_sqes. */
+            size_t m_sqes_size;
+
+            /** The submission queue head, written by the kernel. */
+            unsigned int* m_sq_head;
+
+            /** The submission queue tail, published to the kernel on submit. */
+            unsigned int* m_sq_tail;
+
+            /** The submission queue index mask. */
+            unsigned int m_sq_mask;
+
+            /** The number of submission queue entries. */
+            unsigned int m_sq_entries;
+
+            /** The submission queue tail including the entries not submitted yet. */
+            unsigned int m_sq_local_tail;
+
+            /** The completion queue head, written by the application. */
+            unsigned int* m_cq_head;
+
+            /** The completion queue tail, written by the kernel. */
+            unsigned int* m_cq_tail;
+
+            /** The completion queue index mask. */
+            unsigned int m_cq_mask;
+
+            /** The completion queue entries. */
+            io_uring_cqe* m_cqes;
+    };
+}
+
+#endif // defined(IORING_SETUP_SINGLE_ISSUER) && defined(IORING_RECV_MULTISHOT)
+
+#endif // OWEBPP_SERVER_IO_URING_HPP
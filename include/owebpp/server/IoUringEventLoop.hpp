@@ -0,0 +1,709 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_IO_URING_EVENT_LOOP_HPP
+#define OWEBPP_SERVER_IO_URING_EVENT_LOOP_HPP
+
+#include <owebpp/server/IoUring.hpp>
+
+#ifdef OWEBPP_HAS_IO_URING
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <owebpp/ConcurrencyLimiter.hpp>
+#include <owebpp/Logger.hpp>
+#include <owebpp/server/EventLoop.hpp>
+#include <owebpp/server/HttpConnection.hpp>
+#include <owebpp/server/OutputQueue.hpp>
+#include <owebpp/server/ServerConfig.hpp>
+
+namespace owebpp::server {
+    /**
+     * An event loop serving HTTP connections with io_uring.
+     * Connections are accepted with a multishot accept and read with multishot recvs into a ring of provided buffers, so the loop doesn't issue a system call per read.
+     * The responses of a loop iteration are sent with a single io_uring_enter call, the last response of a connection is linked to its shutdown.
+     * The responses queued on a connection are gathered into a single sendmsg, and are held back for the cork window while the client is sending its next pipelined request.
+     * The coroutines of the asynchronous routes wait for file descriptors and read files with operations submitted to the same ring.
+     */
+    class IoUringEventLoop final : public EventLoop {
+        public:
+            /* Constructors */
+            /**
+             * Construct the event loop, create its listening socket, its io_uring instance and its provided buffer ring.
+             * @param config The server configuration.
+             * @throw std::system_error If the kernel doesn't support the io_uring features used by the loop or a socket can't be created.
+             */
+            explicit IoUringEventLoop(const ServerConfig& config):
+                EventLoop(),
+                m_config(config),
+                m_ring(std::make_unique<IoUring>(RING_ENTRIES, IORING_SETUP_R_DISABLED | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER)),
+                m_listen_fd(-1),
+                m_wakeup_fd(-1),
+                m_wakeup_value(0),
+                m_sweep_timeout{},
+                m_buffer_ring(static_cast<io_uring_buf_ring*>(MAP_FAILED)),
+                m_buffers(BUFFER_COUNT * BUFFER_SIZE),
+                m_buffer_ring_tail(0),
+                m_connections(),
+                m_dirty_connections(),
+                m_corked_connections(),
+                m_next_uncork(std::chrono::steady_clock::time_point::max()),
+                m_running(true) {
+                try {
+                    m_buffer_ring = static_cast<io_uring_buf_ring*>(::mmap(nullptr, BUFFER_COUNT * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+                    if(m_buffer_ring == MAP_FAILED) {
+                        throw std::system_error(errno, std::generic_category(), "mmap");
+                    }
+                    m_ring->registerBufferRing(m_buffer_ring, BUFFER_COUNT, BUFFER_GROUP);
+                    for(uint16_t i = 0; i < BUFFER_COUNT; i++) {
+                        recycleBuffer(i);
+                    }
+                    publishBuffers();
+                    m_listen_fd = createListeningSocket(config);
+                    m_wakeup_fd = ::eventfd(0, EFD_CLOEXEC);
+                    if(m_wakeup_fd < 0) {
+                        throw std::system_error(errno, std::generic_category(), "eventfd");
+                    }
+                } catch(...) {
+                    closeDescriptors();
+                    throw;
+                }
+            }
+
+            /* Deleted constructors */
+            IoUringEventLoop() = delete;
+            IoUringEventLoop(const IoUringEventLoop& o) = delete;
+            IoUringEventLoop(IoUringEventLoop&& o) = delete;
+
+            /* Deleted assignment operators */
+            IoUringEventLoop& operator=(const IoUringEventLoop& o) = delete;
+            IoUringEventLoop& operator=(IoUringEventLoop&& o) = delete;
+
+            /* Destructor */
+            ~IoUringEventLoop() override {
+                ConcurrencyLimiter::cancelWaiters(*this);
+                waitForExpectedPosts();
+                /* Tear the ring down first so the kernel stops using the buffers before they are released. */
+                m_ring.reset();
+                for(const auto& [fd, connection] : m_connections) {
+                    ::close(fd);
+                }
+                closeDescriptors();
+            }
+
+            /* Functions */
+            /**
+             * Run the loop on the calling thread until stop() is called, a stopped loop can't be run again.
+             */
+            void run() override {
+                try {
+                    /* The ring accepts submissions from the thread that enables it only. */
+                    m_ring->enable();
+                    prepareAccept();
+                    prepareWakeup();
+                    prepareSweep();
+                    AsyncContext::setCurrent(this);
+                    while(m_running.load(std::memory_order_acquire)) {
+                        std::chrono::steady_clock::time_point next_operation(runOperations());
+                        uncorkConnections();
+                        flushConnections();
+                        publishBuffers();
+                        std::chrono::steady_clock::time_point deadline(std::min(m_next_uncork, next_operation));
+                        if(deadline == std::chrono::steady_clock::time_point::max()) {
+                            m_ring->submit(1);
+                        } else {
+                            std::chrono::nanoseconds timeout(std::max(std::chrono::nanoseconds(0), deadline - std::chrono::steady_clock::now()));
+                            __kernel_timespec timeout_spec{};
+                            timeout_spec.tv_sec = timeout.count() / 1000000000;
+                            timeout_spec.tv_nsec = timeout.count() % 1000000000;
+                            m_ring->submit(1, &timeout_spec);
+                        }
+                        m_ring->forEachCqe([this](const io_uring_cqe& cqe) { handleCompletion(cqe); });
+                    }
+                } catch(const std::system_error& e) {
+                    OWEBPP_LOG_ERROR(std::string("io_uring event loop failed: ") + e.what());
+                }
+                AsyncContext::setCurrent(nullptr);
+            }
+
+            /**
+             * Ask the loop to stop, this function can be called from any thread.
+             */
+            void stop() override {
+                m_running.store(false, std::memory_order_release);
+                wakeUp();
+            }
+
+            /**
+             * Wait for events on a file descriptor with a poll operation.
+             * @param fd The file descriptor.
+             * @param events The poll events to wait for.
+             * @param operation The operation, its result is the received events or -errno.
+             */
+            void waitFor(int fd, short events, AsyncOperation& operation) override {
+                io_uring_sqe* sqe(getSqe(operation));
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = fd;
+                sqe->poll32_events = static_cast<unsigned short>(events);
+            }
+
+            /**
+             * Read from a file with a read operation.
+             * @param fd The file descriptor.
+             * @param buffer The buffer receiving the data.
+             * @param size The size of the buffer.
+             * @param offset The offset to read at.
+             * @param operation The operation, its result is the number of bytes read or -errno.
+             */
+            void read(int fd, void* buffer, size_t size, off_t offset, AsyncOperation& operation) override {
+                io_uring_sqe* sqe(getSqe(operation));
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = fd;
+                sqe->addr = reinterpret_cast<uint64_t>(buffer);
+                sqe->len = static_cast<uint32_t>(std::min(size, static_cast<size_t>(UINT32_MAX)));
+                sqe->off = static_cast<uint64_t>(offset);
+            }
+
+        protected:
+            /* Functions */
+            /** Wake the loop up by writing to its eventfd, this function can be called from any thread. */
+            void wakeUp() override {
+                uint64_t value(1);
+                [[maybe_unused]] ssize_t ignored = ::write(m_wakeup_fd, &value, sizeof(value));
+            }
+
+        private:
+            /* Constants */
+            /** The maximum number of output segments gathered by a sendmsg. */
+            static constexpr size_t MAX_IOVECS = 64;
+
+            /** The number of submission queue entries. */
+            static constexpr unsigned int RING_ENTRIES = 1024;
+
+            /** The number of provided receive buffers, a power of 2. */
+            static constexpr uint16_t BUFFER_COUNT = 512;
+
+            /** The size of a provided receive buffer. */
+            static constexpr size_t BUFFER_SIZE = 8 * 1024;
+
+            /** The buffer group id of the provided receive buffers. */
+            static constexpr uint16_t BUFFER_GROUP = 0;
+
+            /** The mask extracting the operation from the user data. */
+            static constexpr uint64_t OPERATION_MASK = 7;
+
+            /** The interval between two idle connection sweeps. */
+            static constexpr std::chrono::seconds SWEEP_INTERVAL{1};
+
+            /* Types */
+            /** The operations submitted by the loop, stored in the low bits of the user data next to the connection or owebpp::AsyncOperation address. */
+            enum class Operation : uint64_t {
+                ACCEPT = 1,
+                RECV = 2,
+                SEND = 3,
+                SHUTDOWN = 4,
+                WAKEUP = 5,
+                SWEEP = 6,
+                ASYNC = 7
+            };
+
+            /** The state of a client connection. */
+            struct alignas(8) Connection {
+                /**
+                 * Construct the state of a new client connection.
+                 * @param config The server configuration.
+                 * @param socket The client socket.
+                 */
+                Connection(const ServerConfig& config, int socket):
+                    http(config),
+                    fd(socket),
+                    send_queue(),
+                    send_iovecs(),
+                    send_message(),
+                    send_size(0),
+                    last_activity(std::chrono::steady_clock::now()),
+                    cork_deadline(std::chrono::steady_clock::time_point::max()),
+                    pending_operations(0),
+                    is_sending(false),
+                    is_read_closed(false),
+                    is_closing(false),
+                    is_dirty(false) {}
+
+                /** The HTTP state of the connection. */
+                HttpConnection http;
+
+                /** The client socket. */
+                int fd;
+
+                /** The data being sent, it must stay stable until the send completes. */
+                OutputQueue send_queue;
+
+                /** The I/O vector of the send in flight. */
+                iovec send_iovecs[MAX_IOVECS];
+
+                /** The message header of the send in flight. */
+                msghdr send_message;
+
+                /** The number of bytes of the send in flight. */
+                size_t send_size;
+
+                /** The last time data was received or sent. */
+                std::chrono::steady_clock::time_point last_activity;
+
+                /** The time the held back output must be sent at, the maximum time point if the output isn't held back. */
+                std::chrono::steady_clock::time_point cork_deadline;
+
+                /** The number of submitted operations that didn't complete yet, the connection is released when it drops to 0. */
+                unsigned int pending_operations;
+
+                /** Whether a send is in flight, sends are not overlapped to keep the data in order. */
+                bool is_sending;
+
+                /** Whether the client closed its side of the connection, the connection is closed once the pending output is sent. */
+                bool is_read_closed;
+
+                /** Whether the connection is shutting down, no more data is sent once it is set. */
+                bool is_closing;
+
+                /** Whether the connection is in m_dirty_connections. */
+                bool is_dirty;
+            };
+
+            /* Functions */
+            /**
+             * Get a submission queue entry, submitting the pending entries first if the queue is full.
+             * @param operation The operation of the entry.
+             * @param connection The connection the operation is for, nullptr if none.
+             * @return The entry.
+             */
+            io_uring_sqe* getSqe(Operation operation, Connection* connection) {
+                io_uring_sqe* sqe(m_ring->getSqe());
+                if(sqe == nullptr) {
+                    m_ring->submit(0);
+                    sqe = m_ring->getSqe();
+                    if(sqe == nullptr) {
+                        throw std::system_error(EBUSY, std::generic_category(), "io_uring submission queue full");
+                    }
+                }
+                sqe->user_data = reinterpret_cast<uint64_t>(connection) | static_cast<uint64_t>(operation);
+                if(connection != nullptr) {
+                    connection->pending_operations++;
+                }
+                return sqe;
+            }
+
+            /**
+             * Get a submission queue entry for an operation of a coroutine.
+             * @param operation The operation of the coroutine.
+             * @return The entry.
+             */
+            io_uring_sqe* getSqe(AsyncOperation& operation) {
+                io_uring_sqe* sqe(getSqe(Operation::ASYNC, nullptr));
+                sqe->user_data = reinterpret_cast<uint64_t>(&operation) | static_cast<uint64_t>(Operation::ASYNC);
+                return sqe;
+            }
+
+            /** Submit a multishot accept on the listening socket. */
+            void prepareAccept() {
+                io_uring_sqe* sqe(getSqe(Operation::ACCEPT, nullptr));
+                sqe->opcode = IORING_OP_ACCEPT;
+                sqe->fd = m_listen_fd;
+                sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+                sqe->accept_flags = SOCK_CLOEXEC;
+            }
+
+            /**
+             * Submit a multishot recv selecting its buffers from the provided buffer ring.
+             * @param connection The connection to read from.
+             */
+            void prepareRecv(Connection& connection) {
+                io_uring_sqe* sqe(getSqe(Operation::RECV, &connection));
+                sqe->opcode = IORING_OP_RECV;
+                sqe->fd = connection.fd;
+                sqe->ioprio = IORING_RECV_MULTISHOT;
+                sqe->flags = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = BUFFER_GROUP;
+            }
+
+            /** Submit a read of the wakeup eventfd. */
+            void prepareWakeup() {
+                io_uring_sqe* sqe(getSqe(Operation::WAKEUP, nullptr));
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = m_wakeup_fd;
+                sqe->addr = reinterpret_cast<uint64_t>(&m_wakeup_value);
+                sqe->len = sizeof(m_wakeup_value);
+            }
+
+            /** Submit the timeout triggering the next idle connection sweep. */
+            void prepareSweep() {
+                m_sweep_timeout.tv_sec = SWEEP_INTERVAL.count();
+                io_uring_sqe* sqe(getSqe(Operation::SWEEP, nullptr));
+                sqe->opcode = IORING_OP_TIMEOUT;
+                sqe->fd = -1;
+                sqe->addr = reinterpret_cast<uint64_t>(&m_sweep_timeout);
+                sqe->len = 1;
+            }
+
+            /**
+             * Dispatch a completion to its handler.
+             * @param cqe The completion.
+             */
+            void handleCompletion(const io_uring_cqe& cqe) {
+                if(static_cast<Operation>(cqe.user_data & OPERATION_MASK) == Operation::ASYNC) {
+                    AsyncOperation* operation(reinterpret_cast<AsyncOperation*>(cqe.user_data & ~OPERATION_MASK));
+                    operation->result = cqe.res;
+                    operation->handle.resume();
+                    return;
+                }
+                Connection* connection(reinterpret_cast<Connection*>(cqe.user_data & ~OPERATION_MASK));
+                bool has_more(cqe.flags & IORING_CQE_F_MORE);
+                if(connection != nullptr && !has_more) {
+                    connection->pending_operations--;
+                }
+                switch(static_cast<Operation>(cqe.user_data & OPERATION_MASK)) {
+                    case Operation::ACCEPT:
+                        handleAccept(cqe.res, has_more);
+                        break;
+                    case Operation::RECV:
+                        handleRecv(*connection, cqe, has_more);
+                        break;
+                    case Operation::SEND:
+                        handleSend(*connection, cqe.res);
+                        break;
+                    case Operation::SHUTDOWN:
+                        if(cqe.res < 0) {
+                            /* The linked send failed, shut the socket down so the pending recv completes. */
+                            ::shutdown(connection->fd, SHUT_RDWR);
+                        }
+                        break;
+                    case Operation::WAKEUP:
+                        if(m_running.load(std::memory_order_acquire)) {
+                            prepareWakeup();
+                        }
+                        break;
+                    case Operation::SWEEP:
+                        closeIdleConnections();
+                        prepareSweep();
+                        break;
+                    case Operation::ASYNC:
+                        /* Completed above, the user data isn't a connection. */
+                    default:
+                        break;
+                }
+                if(connection != nullptr) {
+                    markDirty(*connection);
+                }
+            }
+
+            /**
+             * Handle an accept completion.
+             * @param result The client socket or a negative error.
+             * @param has_more Whether the multishot accept is still armed.
+             */
+            void handleAccept(int result, bool has_more) {
+                if(result >= 0) {
+                    int enable(1);
+                    ::setsockopt(result, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                    std::unique_ptr<Connection>& connection(m_connections[result]);
+                    connection = std::make_unique<Connection>(m_config, result);
+                    connection->http.setAsyncResponseCallback([this, client = connection.get()]() { markDirty(*client); });
+                    prepareRecv(*connection);
+                } else if(result != -EAGAIN && result != -EINTR && result != -ECONNABORTED) {
+                    OWEBPP_LOG_ERROR(std::string("accept failed: ") + std::system_category().message(-result));
+                }
+                if(!has_more) {
+                    prepareAccept();
+                }
+            }
+
+            /**
+             * Handle a recv completion.
+             * @param connection The connection.
+             * @param cqe The completion.
+             * @param has_more Whether the multishot recv is still armed.
+             */
+            void handleRecv(Connection& connection, const io_uring_cqe& cqe, bool has_more) {
+                if(cqe.flags & IORING_CQE_F_BUFFER) {
+                    uint16_t buffer_id(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+                    if(cqe.res > 0 && !connection.is_closing) {
+                        connection.last_activity = std::chrono::steady_clock::now();
+                        connection.http.onReceived(&m_buffers[buffer_id * BUFFER_SIZE], static_cast<size_t>(cqe.res));
+                    }
+                    recycleBuffer(buffer_id);
+                }
+                if(!has_more && !connection.is_closing) {
+                    if(cqe.res > 0 || cqe.res == -ENOBUFS) {
+                        /* The recv ran out of provided buffers, they are recycled by now. */
+                        prepareRecv(connection);
+                    } else if(cqe.res == 0) {
+                        connection.is_read_closed = true;
+                        connection.http.onPeerClosed();
+                    } else {
+                        closeConnection(connection);
+                    }
+                }
+            }
+
+            /**
+             * Handle a send completion.
+             * @param connection The connection.
+             * @param result The number of bytes sent or a negative error.
+             */
+            void handleSend(Connection& connection, int result) {
+                connection.is_sending = false;
+                if(result < 0) {
+                    closeConnection(connection);
+                } else {
+                    connection.send_queue.consume(static_cast<size_t>(result));
+                    connection.http.onTakenOutputSent(static_cast<size_t>(result));
+                    connection.last_activity = std::chrono::steady_clock::now();
+                }
+            }
+
+            /**
+             * Queue a connection to be flushed at the end of the loop iteration.
+             * @param connection The connection.
+             */
+            void markDirty(Connection& connection) {
+                if(!connection.is_dirty) {
+                    connection.is_dirty = true;
+                    m_dirty_connections.push_back(&connection);
+                }
+            }
+
+            /**
+             * Hold the output of a connection back while the client is sending its next pipelined request, for at most the cork window.
+             * @param connection The connection.
+             * @return true if the output is held back, false if it must be sent now.
+             */
+            bool cork(Connection& connection) {
+                bool is_corked(false);
+                if(m_config.getCorkWindow().count() > 0 && !connection.is_read_closed && connection.http.isCorkable()) {
+                    std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                    if(connection.cork_deadline == std::chrono::steady_clock::time_point::max()) {
+                        connection.cork_deadline = now + m_config.getCorkWindow();
+                        m_corked_connections.push_back(connection.fd);
+                        m_next_uncork = std::min(m_next_uncork, connection.cork_deadline);
+                    }
+                    is_corked = now < connection.cork_deadline;
+                }
+                if(!is_corked) {
+                    connection.cork_deadline = std::chrono::steady_clock::time_point::max();
+                }
+                return is_corked;
+            }
+
+            /** Mark the connections whose cork window is over as dirty so their output is sent, and compute the next cork deadline. */
+            void uncorkConnections() {
+                std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                m_next_uncork = std::chrono::steady_clock::time_point::max();
+                size_t kept(0);
+                for(size_t i = 0; i < m_corked_connections.size(); i++) {
+                    auto it = m_connections.find(m_corked_connections[i]);
+                    /* Connections uncorked or released meanwhile are only removed from the list here. */
+                    if(it == m_connections.end() || it->second->cork_deadline == std::chrono::steady_clock::time_point::max()) {
+                        continue;
+                    }
+                    if(it->second->cork_deadline <= now) {
+                        markDirty(*it->second);
+                    } else {
+                        m_next_uncork = std::min(m_next_uncork, it->second->cork_deadline);
+                        m_corked_connections[kept++] = m_corked_connections[i];
+                    }
+                }
+                m_corked_connections.resize(kept);
+            }
+
+            /**
+             * Submit a sendmsg gathering the start of the send queue of a connection, the last send of a closing connection is linked to its shutdown.
+             * @param connection The connection.
+             */
+            void prepareSend(Connection& connection) {
+                size_t count(connection.send_queue.fillIovecs(connection.send_iovecs, MAX_IOVECS));
+                connection.send_size = 0;
+                for(size_t i = 0; i < count; i++) {
+                    connection.send_size += connection.send_iovecs[i].iov_len;
+                }
+                connection.send_message = msghdr{};
+                connection.send_message.msg_iov = connection.send_iovecs;
+                connection.send_message.msg_iovlen = count;
+                /* Reserve both entries so the send and its linked shutdown are submitted together. */
+                if(m_ring->getSqSpace() < 2) {
+                    m_ring->submit(0);
+                }
+                io_uring_sqe* sqe(getSqe(Operation::SEND, &connection));
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->fd = connection.fd;
+                sqe->addr = reinterpret_cast<uint64_t>(&connection.send_message);
+                sqe->len = 1;
+                /* MSG_WAITALL makes the kernel retry short sends, which also keeps the link chain intact. */
+                sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+                connection.is_sending = true;
+                if(connection.send_size == connection.send_queue.size() && connection.http.isClosing()) {
+                    sqe->flags = IOSQE_IO_LINK;
+                    io_uring_sqe* shutdown_sqe(getSqe(Operation::SHUTDOWN, &connection));
+                    shutdown_sqe->opcode = IORING_OP_SHUTDOWN;
+                    shutdown_sqe->fd = connection.fd;
+                    shutdown_sqe->len = SHUT_RDWR;
+                    connection.is_closing = true;
+                }
+            }
+
+            /** Submit the pending output of the dirty connections and release the closed ones. */
+            void flushConnections() {
+                for(Connection* connection : m_dirty_connections) {
+                    connection->is_dirty = false;
+                    if(!connection->is_closing && !connection->is_sending && connection->send_queue.empty()
+                       && connection->http.hasPendingOutput() && !cork(*connection)) {
+                        connection->http.takePendingOutput(connection->send_queue);
+                    }
+                    if(!connection->is_closing && !connection->is_sending && !connection->send_queue.empty()) {
+                        prepareSend(*connection);
+                    } else if(!connection->is_sending && connection->send_queue.empty() && !connection->http.hasPendingOutput()
+                              && (connection->http.isClosing() || (connection->is_read_closed && !connection->http.hasPendingTask()))) {
+                        closeConnection(*connection);
+                    }
+                    if(connection->is_closing && connection->pending_operations == 0) {
+                        int fd(connection->fd);
+                        ::close(fd);
+                        m_connections.erase(fd);
+                    }
+                }
+                m_dirty_connections.clear();
+            }
+
+            /**
+             * Shut a connection down, its pending operations complete and it is released once they are all done.
+             * @param connection The connection.
+             */
+            void closeConnection(Connection& connection) {
+                if(!connection.is_closing) {
+                    connection.is_closing = true;
+                    ::shutdown(connection.fd, SHUT_RDWR);
+                }
+            }
+
+            /** Close the connections that were inactive for longer than the keep alive timeout. */
+            void closeIdleConnections() {
+                std::chrono::steady_clock::time_point now(std::chrono::steady_clock::now());
+                for(const auto& [fd, connection] : m_connections) {
+                    if(!connection->is_sending && !connection->http.hasPendingTask() && now - connection->last_activity > m_config.getKeepAliveTimeout()) {
+                        closeConnection(*connection);
+                    }
+                }
+            }
+
+            /**
+             * Give a receive buffer back to the kernel, it is visible to the kernel after the next publishBuffers() call.
+             * @param buffer_id The buffer id.
+             */
+            void recycleBuffer(uint16_t buffer_id) {
+                /* The entries are indexed from the ring start, the bufs member of the kernel header is misplaced when compiled as C++. */
+                io_uring_buf& buffer(reinterpret_cast<io_uring_buf*>(m_buffer_ring)[m_buffer_ring_tail & (BUFFER_COUNT - 1)]);
+                buffer.addr = reinterpret_cast<uint64_t>(&m_buffers[buffer_id * BUFFER_SIZE]);
+                buffer.len = BUFFER_SIZE;
+                buffer.bid = buffer_id;
+                m_buffer_ring_tail++;
+            }
+
+            /** Publish the recycled receive buffers to the kernel. */
+            void publishBuffers() {
+                std::atomic_ref<uint16_t>(m_buffer_ring->tail).store(m_buffer_ring_tail, std::memory_order_release);
+            }
+
+            /** Close the listening socket, the wakeup descriptor and unmap the buffer ring. */
+            void closeDescriptors() {
+                for(int fd : {m_wakeup_fd, m_listen_fd}) {
+                    if(fd >= 0) {
+                        ::close(fd);
+                    }
+                }
+                if(m_buffer_ring != MAP_FAILED) {
+                    ::munmap(m_buffer_ring, BUFFER_COUNT * sizeof(io_uring_buf));
+                }
+            }
+
+            /* Members */
+            /** The server configuration. */
+            const ServerConfig& m_config;
+
+            /** The io_uring instance. */
+            std::unique_ptr<IoUring> m_ring;
+
+            /** The listening socket. */
+            int m_listen_fd;
+
+            /** The eventfd used to wake the loop up when it is stopped or an operation is posted. */
+            int m_wakeup_fd;
+
+            /** The value read from the wakeup eventfd. */
+            uint64_t m_wakeup_value;
+
+            /** The duration of the sweep timeout, it must stay valid while the timeout is pending. */
+            __kernel_timespec m_sweep_timeout;
+
+            /** The provided buffer ring shared with the kernel. */
+            io_uring_buf_ring* m_buffer_ring;
+
+            /** The memory of the provided receive buffers. */
+            std::vector<char> m_buffers;
+
+            /** The tail of the provided buffer ring, including the buffers not published yet. */
+            uint16_t m_buffer_ring_tail;
+
+            /** The client connections by socket. */
+            std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+
+            /** The connections that received completions during the loop iteration. */
+            std::vector<Connection*> m_dirty_connections;
+
+            /** The sockets of the connections whose output is held back, it may contain connections uncorked or released since. */
+            std::vector<int> m_corked_connections;
+
+            /** The earliest cork deadline, the maximum time point if no output is held back. */
+            std::chrono::steady_clock::time_point m_next_uncork;
+
+            /** Whether the loop is running. */
+            std::atomic<bool> m_running;
+    };
+}
+
+#endif // OWEBPP_HAS_IO_URING
+
+#endif // OWEBPP_SERVER_IO_URING_EVENT_LOOP_HPP
@@ -0,0 +1,206 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_OUTPUT_QUEUE_HPP
+#define OWEBPP_SERVER_OUTPUT_QUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+#include <utility>
+
+namespace owebpp::server {
+    /**
+     * Queues the data waiting to be sent on a connection as segments gathered by a single writev/sendmsg.
+     * Small writes are coalesced into a shared buffer, large bodies are referenced where they live instead of being copied.
+     */
+    class OutputQueue {
+        public:
+            /* Constructors */
+            /** Construct an empty queue. */
+            OutputQueue(): m_segments(), m_front_offset(0), m_size(0) {}
+
+            /* Deleted constructors */
+            OutputQueue(const OutputQueue& o) = delete;
+            OutputQueue(OutputQueue&& o) = delete;
+
+            /* Deleted assignment operators */
+            OutputQueue& operator=(const OutputQueue& o) = delete;
+            OutputQueue& operator=(OutputQueue&& o) = delete;
+
+            /* Destructor */
+            ~OutputQueue() = default;
+
+            /* Functions */
+            /**
+             * Copy data at the end of the queue, it is coalesced with the previous small writes.
+             * @param data The data.
+             */
+            void append(std::string_view data) {
+                if(data.empty()) {
+                    return;
+                }
+                if(m_segments.empty() || m_segments.back().owner != nullptr || m_segments.back().buffer.size() + data.size() > COALESCE_LIMIT) {
+                    m_segments.emplace_back();
+                }
+                m_segments.back().buffer.append(data);
+                m_segments.back().data = m_segments.back().buffer;
+                m_size += data.size();
+            }
+
+            /**
+             * Move a buffer at the end of the queue without copying it.
+             * @param data The buffer.
+             */
+            void append(std::string&& data) {
+                if(data.size() <= SHARE_THRESHOLD) {
+                    append(std::string_view(data));
+                } else {
+                    m_size += data.size();
+                    Segment& segment(m_segments.emplace_back());
+                    segment.buffer = std::move(data);
+                    segment.data = segment.buffer;
+                }
+            }
+
+            /**
+             * Reference data at the end of the queue without copying it, small data is copied since a separate segment would cost more.
+             * @param data The data, it must stay valid as long as its owner is alive.
+             * @param owner The object owning the data, it is kept alive until the data is sent.
+             */
+            void append(std::string_view data, std::shared_ptr<const void> owner) {
+                if(data.size() <= SHARE_THRESHOLD) {
+                    append(data);
+                } else {
+                    m_size += data.size();
+                    Segment& segment(m_segments.emplace_back());
+                    segment.data = data;
+                    segment.owner = std::move(owner);
+                }
+            }
+
+            /**
+             * Describe the queued data, from its start, as an I/O vector.
+             * @param iovecs The I/O vector to fill.
+             * @param max_count The size of the I/O vector.
+             * @return The number of filled entries.
+             */
+            size_t fillIovecs(iovec* iovecs, size_t max_count) const {
+                size_t count(0);
+                size_t offset(m_front_offset);
+                for(auto it = m_segments.begin(); it != m_segments.end() && count < max_count; ++it) {
+                    if(it->data.size() > offset) {
+                        iovecs[count].iov_base = const_cast<char*>(it->data.data() + offset);
+                        iovecs[count].iov_len = it->data.size() - offset;
+                        count++;
+                    }
+                    offset = 0;
+                }
+                return count;
+            }
+
+            /**
+             * Remove sent data from the start of the queue.
+             * @param size The number of bytes sent.
+             */
+            void consume(size_t size) {
+                m_size -= size;
+                size += m_front_offset;
+                while(!m_segments.empty() && size >= m_segments.front().data.size()) {
+                    size -= m_segments.front().data.size();
+                    if(m_segments.size() == 1 && m_segments.front().owner == nullptr) {
+                        /* The last buffer is kept to be reused by the next writes. */
+                        m_segments.front().buffer.clear();
+                        m_segments.front().data = std::string_view();
+                        break;
+                    }
+                    m_segments.pop_front();
+                }
+                m_front_offset = size;
+            }
+
+            /**
+             * Swap the content of two queues.
+             * @param o The other queue.
+             */
+            void swap(OutputQueue& o) {
+                m_segments.swap(o.m_segments);
+                std::swap(m_front_offset, o.m_front_offset);
+                std::swap(m_size, o.m_size);
+            }
+
+            /** Remove all the queued data. */
+            void clear() {
+                consume(m_size);
+            }
+
+            /* Getters and Setters */
+            /**
+             * Getter for the number of queued bytes.
+             * @return The number of queued bytes.
+             */
+            size_t size() const { return m_size; }
+
+            /**
+             * Tell if the queue is empty.
+             * @return true if no data is queued, false otherwise.
+             */
+            bool empty() const { return m_size == 0; }
+
+        private:
+            /* Types */
+            /** A contiguous piece of queued data. */
+            struct Segment {
+                /** The data of the segment, it points into buffer or into the data of owner. */
+                std::string_view data{};
+
+                /** The buffer owning the data of the segment when it was copied or moved. */
+                std::string buffer{};
+
+                /** The object owning the data of the segment when it is referenced. */
+                std::shared_ptr<const void> owner{};
+            };
+
+            /* Constants */
+            /** Copied writes are coalesced into one buffer up to this size. */
+            static constexpr size_t COALESCE_LIMIT = 16 * 1024;
+
+            /** Data up to this size is copied rather than referenced. */
+            static constexpr size_t SHARE_THRESHOLD = 1024;
+
+            /* Members */
+            /** The queued segments. */
+            std::deque<Segment> m_segments;
+
+            /** The number of bytes of the first segment already sent. */
+            size_t m_front_offset;
+
+            /** The number of queued bytes. */
+            size_t m_size;
+    };
+}
+
+#endif // OWEBPP_SERVER_OUTPUT_QUEUE_HPP
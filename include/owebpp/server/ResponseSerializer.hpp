@@ -0,0 +1,208 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_RESPONSE_SERIALIZER_HPP
+#define OWEBPP_SERVER_RESPONSE_SERIALIZER_HPP
+
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include <owebpp/HttpStatusCode.hpp>
+#include <owebpp/Response.hpp>
+
+namespace owebpp::server {
+    /** Lists the ways the end of a response body is signaled to the client. */
+    enum class BodyFraming {
+        /** The body size is sent in the Content-Length header. */
+        CONTENT_LENGTH,
+        /** The body is sent with chunked transfer encoding. */
+        CHUNKED,
+        /** The end of the body is signaled by closing the connection, used for HTTP/1.0 clients when the size is unknown. */
+        CLOSE_DELIMITED,
+        /** The response never has a body and sends no framing header, used for the 1xx, 204 and 304 status codes. */
+        NONE
+    };
+
+    /** Writes HTTP/1.1 responses to an output buffer. */
+    class ResponseSerializer final {
+        public:
+            /* Deleted constructors */
+            ResponseSerializer() = delete;
+            ResponseSerializer(const ResponseSerializer& o) = delete;
+            ResponseSerializer(ResponseSerializer&& o) = delete;
+
+            /* Deleted assignment operators */
+            ResponseSerializer& operator=(const ResponseSerializer& o) = delete;
+            ResponseSerializer& operator=(ResponseSerializer&& o) = delete;
+
+            /* Deleted destructor */
+            ~ResponseSerializer() = delete;
+
+            /* Functions */
+            /**
+             * Choose how the body of a response is delimited.
+             * @param response The response.
+             * @param minor_version The HTTP minor version of the request.
+             * @return The body framing to use.
+             */
+            static BodyFraming chooseFraming(const Response& response, int minor_version) {
+                BodyFraming framing(BodyFraming::CONTENT_LENGTH);
+                if(!canHaveBody(response.getSatusCode())) {
+                    framing = BodyFraming::NONE;
+                } else if(!response.getContentLength().has_value()) {
+                    framing = minor_version >= 1 ? BodyFraming::CHUNKED : BodyFraming::CLOSE_DELIMITED;
+                }
+                return framing;
+            }
+
+            /**
+             * Tell if a response to the given request carries a body.
+             * @param response The response.
+             * @param is_head_request true if the request method is HEAD.
+             * @return true if a body must be sent, false otherwise.
+             */
+            static bool hasBody(const Response& response, bool is_head_request) {
+                return !is_head_request && canHaveBody(response.getSatusCode());
+            }
+
+            /**
+             * Append the status line and headers of a response.
+             * @param out The output buffer.
+             * @param response The response.
+             * @param framing The body framing.
+             * @param keep_alive true if the connection stays open after the response.
+             * @param minor_version The HTTP minor version of the request.
+             */
+            static void appendHead(std::string& out, const Response& response, BodyFraming framing, bool keep_alive, int minor_version) {
+                HttpStatusCode status_code(response.getSatusCode());
+                out.append("HTTP/1.1 ");
+                appendNumber(out, static_cast<size_t>(status_code));
+                out.push_back(' ');
+                out.append(HttpStatusCodeUtils::getReasonPhrase(status_code));
+                out.append("\r\nDate: ");
+                out.append(getDate());
+                out.append("\r\nContent-Type: ");
+                out.append(response.getContentType());
+                if(!response.getCharset().empty()) {
+                    out.append("; charset=");
+                    out.append(response.getCharset());
+                }
+                if(framing == BodyFraming::CONTENT_LENGTH) {
+                    out.append("\r\nContent-Length: ");
+                    appendNumber(out, response.getContentLength().value_or(0));
+                } else if(framing == BodyFraming::CHUNKED) {
+                    out.append("\r\nTransfer-Encoding: chunked");
+                }
+                if(!keep_alive) {
+                    out.append("\r\nConnection: close");
+                } else if(minor_version == 0) {
+                    out.append("\r\nConnection: keep-alive");
+                }
+                out.append("\r\n");
+                for(const std::string& header : response.getHeaders()) {
+                    out.append(header);
+                    out.append("\r\n");
+                }
+                out.append("\r\n");
+            }
+
+            /**
+             * Append a chunk of a chunked body, empty data is skipped since an empty chunk ends the body.
+             * @param out The output buffer.
+             * @param data The chunk data.
+             */
+            static void appendChunk(std::string& out, std::string_view data) {
+                if(!data.empty()) {
+                    appendChunkHeader(out, data.size());
+                    out.append(data);
+                    out.append("\r\n");
+                }
+            }
+
+            /**
+             * Append the size line preceding the data of a chunk, the data must then be followed by CRLF.
+             * @param out The output buffer.
+             * @param size The chunk size, it must not be 0.
+             */
+            static void appendChunkHeader(std::string& out, size_t size) {
+                char buffer[20];
+                auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), size, 16);
+                out.append(buffer, end);
+                out.append("\r\n");
+            }
+
+            /**
+             * Append the last chunk ending a chunked body.
+             * @param out The output buffer.
+             */
+            static void appendLastChunk(std::string& out) {
+                out.append("0\r\n\r\n");
+            }
+
+        private:
+            /* Functions */
+            /**
+             * Tell if a response with the given status code can have a body, the 1xx, 204 and 304 responses never have one.
+             * @param status_code The status code.
+             * @return true if the response can have a body, false otherwise.
+             */
+            static bool canHaveBody(HttpStatusCode status_code) {
+                size_t status(static_cast<size_t>(status_code));
+                return status >= 200 && status != 204 && status != 304;
+            }
+
+            /**
+             * Append a decimal number.
+             * @param out The output buffer.
+             * @param value The number.
+             */
+            static void appendNumber(std::string& out, size_t value) {
+                char buffer[20];
+                auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                out.append(buffer, end);
+            }
+
+            /**
+             * Get the current date formatted for the Date header, the date is formatted once per second and per thread.
+             * @return The current HTTP date.
+             */
+            static std::string_view getDate() {
+                thread_local std::time_t cached_time(0);
+                thread_local char cached_date[32] = {0};
+                thread_local size_t cached_size(0);
+                std::time_t now(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+                if(now != cached_time) {
+                    struct tm gmt;
+                    ::gmtime_r(&now, &gmt);
+                    cached_size = std::strftime(cached_date, sizeof(cached_date), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+                    cached_time = now;
+                }
+                return std::string_view(cached_date, cached_size);
+            }
+    };
+}
+
+#endif // OWEBPP_SERVER_RESPONSE_SERIALIZER_HPP
@@ -0,0 +1,169 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_SERVER_HPP
+#define OWEBPP_SERVER_SERVER_HPP
+
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <owebpp/Logger.hpp>
+#include <owebpp/Router.hpp>
+#include <owebpp/server/EpollEventLoop.hpp>
+#include <owebpp/server/EventLoop.hpp>
+#include <owebpp/server/IoUringEventLoop.hpp>
+#include <owebpp/server/ServerConfig.hpp>
+
+namespace owebpp::server {
+    /**
+     * A standalone HTTP/1.1 server running the owebpp::Router routes without nginx.
+     * It runs one event loop per thread, each thread can be pinned to a core.
+     * The io_uring backend falls back to epoll when the kernel or the build doesn't support it.
+     */
+    class Server final {
+        public:
+            /* Constructors */
+            /**
+             * Construct a server.
+             * @param config The server configuration.
+             */
+            explicit Server(const ServerConfig& config): m_config(config), m_loops(), m_threads(), m_is_using_io_uring(false) {}
+
+            /* Deleted constructors */
+            Server() = delete;
+            Server(const Server& o) = delete;
+            Server(Server&& o) = delete;
+
+            /* Deleted assignment operators */
+            Server& operator=(const Server& o) = delete;
+            Server& operator=(Server&& o) = delete;
+
+            /* Destructor */
+            ~Server() {
+                stop();
+                wait();
+            }
+
+            /* Functions */
+            /**
+             * Start listening and serving requests on the configured number of threads.
+             * @throw std::system_error If the listening sockets can't be created.
+             */
+            void start() {
+                /* The router and the logger are lazy singletons, load them before the loops may race to create them. */
+                [[maybe_unused]] Router& router(Router::getInstance());
+                [[maybe_unused]] Logger& logger(Logger::getInstance());
+                for(unsigned int i = 0; i < m_config.getThreads(); i++) {
+                    m_loops.push_back(createEventLoop());
+                }
+                unsigned int cores(std::thread::hardware_concurrency());
+                for(unsigned int i = 0; i < m_loops.size(); i++) {
+                    m_threads.emplace_back(&EventLoop::run, m_loops[i].get());
+                    if(m_config.isPinThreads() && cores > 0) {
+                        cpu_set_t cpu_set;
+                        CPU_ZERO(&cpu_set);
+                        CPU_SET(i % cores, &cpu_set);
+                        if(::pthread_setaffinity_np(m_threads.back().native_handle(), sizeof(cpu_set), &cpu_set) != 0) {
+                            OWEBPP_LOG_WARNING("Can't pin server thread " + std::to_string(i) + " to core " + std::to_string(i % cores) + ".");
+                        }
+                    }
+                }
+                OWEBPP_LOG_INFO("Listening on " + m_config.getAddress() + ":" + std::to_string(m_config.getPort()) + " with " + std::to_string(m_loops.size()) + (m_is_using_io_uring ? " io_uring" : " epoll") + " threads.");
+            }
+
+            /**
+             * Ask all the event loops to stop, this function can be called from any thread.
+             */
+            void stop() {
+                for(const std::unique_ptr<EventLoop>& loop : m_loops) {
+                    loop->stop();
+                }
+            }
+
+            /**
+             * Wait until all the event loops are stopped.
+             */
+            void wait() {
+                for(std::thread& thread : m_threads) {
+                    if(thread.joinable()) {
+                        thread.join();
+                    }
+                }
+            }
+
+            /**
+             * Tell if the server runs on io_uring, which is only known once the server is started.
+             * @return true if the event loops use io_uring, false if they use epoll.
+             */
+            bool isUsingIoUring() const { return m_is_using_io_uring; }
+
+        private:
+            /* Functions */
+            /**
+             * Create an event loop using the configured backend.
+             * @return The event loop.
+             * @throw std::system_error If the listening socket can't be created.
+             */
+            std::unique_ptr<EventLoop> createEventLoop() {
+#ifdef OWEBPP_HAS_IO_URING
+                if(m_config.getBackend() == ServerBackend::IO_URING && (m_loops.empty() || m_is_using_io_uring)) {
+                    try {
+                        std::unique_ptr<EventLoop> loop(std::make_unique<IoUringEventLoop>(m_config));
+                        m_is_using_io_uring = true;
+                        return loop;
+                    } catch(const std::system_error& e) {
+                        if(!m_loops.empty()) {
+                            throw;
+                        }
+                        OWEBPP_LOG_WARNING(std::string("io_uring is not available, falling back to epoll: ") + e.what());
+                    }
+                }
+#else
+                if(m_config.getBackend() == ServerBackend::IO_URING && m_loops.empty()) {
+                    OWEBPP_LOG_WARNING("io_uring support is not compiled in, falling back to epoll.");
+                }
+#endif
+                return std::make_unique<EpollEventLoop>(m_config);
+            }
+
+            /* Members */
+            /** The server configuration. */
+            ServerConfig m_config;
+
+            /** The event loops, one per thread. */
+            std::vector<std::unique_ptr<EventLoop>> m_loops;
+
+            /** The threads running the event loops. */
+            std::vector<std::thread> m_threads;
+
+            /** Whether the event loops use io_uring. */
+            bool m_is_using_io_uring;
+    };
+}
+
+#endif // OWEBPP_SERVER_SERVER_HPP
@@ -0,0 +1,298 @@
+/*************************************************************************************
+ *    MIT License
+ *
+ *    Copyright (c) 2023 Oliver Gibson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy
+ *    of this software and associated documentation files (the "Software"), to deal
+ *    in the Software without restriction, including without limitation the rights
+ *    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *    copies of the Software, and to permit persons to whom the Software is
+ *    furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included in all
+ *    copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *    SOFTWARE.
+*************************************************************************************/
+#ifndef OWEBPP_SERVER_SERVER_CONFIG_HPP
+#define OWEBPP_SERVER_SERVER_CONFIG_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <owebpp/AccessLog.hpp>
+#include <owebpp/LocaleNegotiator.hpp>
+
+namespace owebpp::server {
+    /** Lists the I/O backends the server can run its event loops on. */
+    enum class ServerBackend {
+        /** Readiness based event loops using epoll. */
+        EPOLL,
+        /** Completion based event loops using io_uring, the server falls back to epoll when the kernel doesn't support it. */
+        IO_URING
+    };
+
+    /** Holds the settings of the standalone HTTP server. */
+    class ServerConfig {
+        public:
+            /* Constructors */
+            /** Construct a configuration listening on all interfaces on port 8888 with one event loop per core. */
+            ServerConfig():
+                m_address("0.0.0.0"),
+                m_port(8888),
+                m_threads(std::max(1u, std::thread::hardware_concurrency())),
+                m_pin_threads(true),
+                m_backlog(1024),
+                m_keep_alive_timeout(std::chrono::seconds(65)),
+                m_max_header_size(16 * 1024),
+                m_max_body_size(8 * 1024 * 1024),
+                m_cork_window(200),
+                m_backend(ServerBackend::EPOLL),
+                m_access_log(nullptr),
+                m_locale_negotiator(nullptr) {}
+
+            /* Getters and Setters */
+            /**
+             * Getter for the address to listen on.
+             * @return The address to listen on.
+             */
+            const std::string& getAddress() const { return m_address; }
+
+            /**
+             * Setter for the address to listen on.
+             * @param address The IPv4 or IPv6 address to listen on.
+             * @return The configuration.
+             */
+            ServerConfig& setAddress(const std::string& address) {
+                m_address = address;
+                return *this;
+            }
+
+            /**
+             * Getter for the port to listen on.
+             * @return The port to listen on.
+             */
+            uint16_t getPort() const { return m_port; }
+
+            /**
+             * Setter for the port to listen on.
+             * @param port The port to listen on.
+             * @return The configuration.
+             */
+            ServerConfig& setPort(uint16_t port) {
+                m_port = port;
+                return *this;
+            }
+
+            /**
+             * Getter for the number of event loops, each one runs on its own thread with its own listening socket.
+             * @return The number of event loops.
+             */
+            unsigned int getThreads() const { return m_threads; }
+
+            /**
+             * Setter for the number of event loops.
+             * @param threads The number of event loops, at least one.
+             * @return The configuration.
+             */
+            ServerConfig& setThreads(unsigned int threads) {
+                m_threads = std::max(1u, threads);
+                return *this;
+            }
+
+            /**
+             * Tell if each event loop thread is pinned to a core.
+             * @return true if the threads are pinned, false otherwise.
+             */
+            bool isPinThreads() const { return m_pin_threads; }
+
+            /**
+             * Setter for the thread pinning.
+             * @param pin_threads true to pin each event loop thread to a core.
+             * @return The configuration.
+             */
+            ServerConfig& setPinThreads(bool pin_threads) {
+                m_pin_threads = pin_threads;
+                return *this;
+            }
+
+            /**
+             * Getter for the listen backlog.
+             * @return The listen backlog.
+             */
+            int getBacklog() const { return m_backlog; }
+
+            /**
+             * Setter for the listen backlog.
+             * @param backlog The listen backlog.
+             * @return The configuration.
+             */
+            ServerConfig& setBacklog(int backlog) {
+                m_backlog = backlog;
+                return *this;
+            }
+
+            /**
+             * Getter for the time an idle keep-alive connection is kept open.
+             * @return The keep-alive timeout.
+             */
+            std::chrono::milliseconds getKeepAliveTimeout() const { return m_keep_alive_timeout; }
+
+            /**
+             * Setter for the time an idle keep-alive connection is kept open.
+             * @param keep_alive_timeout The keep-alive timeout.
+             * @return The configuration.
+             */
+            ServerConfig& setKeepAliveTimeout(std::chrono::milliseconds keep_alive_timeout) {
+                m_keep_alive_timeout = keep_alive_timeout;
+                return *this;
+            }
+
+            /**
+             * Getter for the maximum size of the request line and headers.
+             * @return The maximum header size in bytes.
+             */
+            size_t getMaxHeaderSize() const { return m_max_header_size; }
+
+            /**
+             * Setter for the maximum size of the request line and headers, bigger requests are answered with REQUEST_HEADER_FIELDS_TOO_LARGE.
+             * @param max_header_size The maximum header size in bytes.
+             * @return The configuration.
+             */
+            ServerConfig& setMaxHeaderSize(size_t max_header_size) {
+                m_max_header_size = max_header_size;
+                return *this;
+            }
+
+            /**
+             * Getter for the maximum size of a request body.
+             * @return The maximum body size in bytes.
+             */
+            size_t getMaxBodySize() const { return m_max_body_size; }
+
+            /**
+             * Setter for the maximum size of a request body, bigger requests are answered with PAYLOAD_TOO_LARGE.
+             * @param max_body_size The maximum body size in bytes.
+             * @return The configuration.
+             */
+            ServerConfig& setMaxBodySize(size_t max_body_size) {
+                m_max_body_size = max_body_size;
+                return *this;
+            }
+
+            /**
+             * Getter for the time responses may be held back while the client is sending its next pipelined request.
+             * @return The cork window.
+             */
+            std::chrono::microseconds getCorkWindow() const { return m_cork_window; }
+
+            /**
+             * Setter for the time responses may be held back while the client is sending its next pipelined request, so their responses are sent with a single system call.
+             * @param cork_window The cork window, 0 sends every response as soon as it is ready.
+             * @return The configuration.
+             */
+            ServerConfig& setCorkWindow(std::chrono::microseconds cork_window) {
+                m_cork_window = cork_window;
+                return *this;
+            }
+
+            /**
+             * Getter for the I/O backend of the event loops.
+             * @return The I/O backend.
+             */
+            ServerBackend getBackend() const { return m_backend; }
+
+            /**
+             * Setter for the I/O backend of the event loops.
+             * @param backend The I/O backend.
+             * @return The configuration.
+             */
+            ServerConfig& setBackend(ServerBackend backend) {
+                m_backend = backend;
+                return *this;
+            }
+
+            /**
+             * Getter for the access log.
+             * @return The access log, nullptr if the requests aren't logged.
+             */
+            const std::shared_ptr<AccessLog>& getAccessLog() const { return m_access_log; }
+
+            /**
+             * Setter for the access log, a record with the timing of each phase of a request is written once its response is sent.
+             * @param access_log The access log, nullptr to not log the requests.
+             * @return The configuration.
+             */
+            ServerConfig& setAccessLog(const std::shared_ptr<AccessLog>& access_log) {
+                m_access_log = access_log;
+                return *this;
+            }
+
+            /**
+             * Getter for the locale negotiator.
+             * @return The locale negotiator, nullptr if the requests use the global translator.
+             */
+            const std::shared_ptr<LocaleNegotiator>& getLocaleNegotiator() const { return m_locale_negotiator; }
+
+            /**
+             * Setter for the locale negotiator, the translator of each request is chosen from its Accept-Language header before the route runs.
+             * @param locale_negotiator The locale negotiator, nullptr to use the global translator.
+             * @return The configuration.
+             */
+            ServerConfig& setLocaleNegotiator(const std::shared_ptr<LocaleNegotiator>& locale_negotiator) {
+                m_locale_negotiator = locale_negotiator;
+                return *this;
+            }
+
+        private:
+            /* Members */
+            /** The address to listen on. */
+            std::string m_address;
+
+            /** The port to listen on. */
+            uint16_t m_port;
+
+            /** The number of event loops. */
+            unsigned int m_threads;
+
+            /** Whether each event loop thread is pinned to a core. */
+            bool m_pin_threads;
+
+            /** The listen backlog. */
+            int m_backlog;
+
+            /** The time an idle keep-alive connection is kept open. */
+            std::chrono::milliseconds m_keep_alive_timeout;
+
+            /** The maximum size of the request line and headers. */
+            size_t m_max_header_size;
+
+            /** The maximum size of a request body. */
+            size_t m_max_body_size;
+
+            /** The time responses may be held back while the client is sending its next pipelined request. */
+            std::chrono::microseconds m_cork_window;
+
+            /** The I/O backend of the event loops. */
+            ServerBackend m_backend;
+
+            /** The access log, nullptr if the requests aren't logged. */
+            std::shared_ptr<AccessLog> m_access_log;
+
+            /** The locale negotiator, nullptr if the requests use the global translator. */
+            std::shared_ptr<LocaleNegotiator> m_locale_negotiator;
+    };
+}
+
+#endif // OWEBPP_SERVER_SERVER_CONFIG_HPP